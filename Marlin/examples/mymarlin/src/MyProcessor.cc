@@ -21,6 +21,8 @@ using namespace marlin ;
 
 MyProcessor aMyProcessor ;
 
+MARLIN_PROCESSOR_ONLY_LIBRARY
+
 
 MyProcessor::MyProcessor() : Processor("MyProcessor") {
 
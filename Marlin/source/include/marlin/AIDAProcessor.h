@@ -8,6 +8,8 @@
 #include "marlin/Processor.h"
 #include "lcio.h"
 
+#include <ctime>
+
 namespace AIDA{
   class IAnalysisFactory ;
   class ITreeFactory ;
@@ -15,6 +17,7 @@ namespace AIDA{
   class IHistogramFactory ;
   class ITupleFactory ;
   class IDataPointSetFactory ;
+  class ICloud1D ;
 }
 
 class HistoManager ;
@@ -27,6 +30,7 @@ namespace marlin {
 /** Provides access to AIDA histograms, ntuples, etc.
  *  This module  creates an AIDA file and histogram and tuple factories that 
  *  can be used in all processors of a Marlin application.
+ *  Use the HistogramService to fill histograms from processors that might run concurrently.
  * 
  *  <h4>Input - Prerequisites</h4>
  *  No input needed for this processor. Make sure it is included in the list of active processors 
@@ -77,7 +81,8 @@ class AIDAProcessor : public marlin::Processor {
 
   /** Returns an AIDA histogram factory for the given processor with
    *  the current directory set to the processor's name.
-   *  Call right before using the factory to create histograms.
+   *  Call right before using the factory to create histograms, holding
+   *  HistogramService::mutex() if processors run concurrently.
    */
   static AIDA::IHistogramFactory* histogramFactory( const Processor* proc ) ;
   
@@ -118,6 +123,9 @@ protected:
   std::string _fileType ;
   std::string _fileName ;
   int _compress ;
+
+  AIDA::ICloud1D* _hEvtTime ;
+  clock_t _eventTime ;
     
 private:
   
@@ -0,0 +1,109 @@
+#ifndef AsyncLogBuffer_h
+#define AsyncLogBuffer_h 1
+
+#include <streambuf>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace marlin{
+
+  /** Stream buffer that takes the writing of log output off the event loop.<br>
+   *  Every thread collects its output in its own line buffer and hands complete lines
+   *  (or whatever is pending on a flush) to a lock free single producer/single consumer
+   *  ring buffer. A background thread collects the lines from all rings and writes them to the
+   *  original stream buffer, so the output of one thread keeps its order. A thread only waits,
+   *  blocked, if its ring is full.<br>
+   *  Enabled with the global parameter AsynchronousLogging, which routes std::cout - and thus
+   *  streamlog::out and the processors' direct output - through the buffer.<br>
+   *  This only defers the I/O - it does not make logging thread safe: streamlog formats every
+   *  message, its prefix and scope in its one global logstream before the text reaches this
+   *  buffer (see ProcessorScheduler::logMutex()).
+   *
+   *  @version $Id:$
+   */
+  class AsyncLogBuffer : public std::streambuf {
+
+  public:
+
+    /** The unique instance - never deleted, as streams might refer to it until the end of the program.
+     */
+    static AsyncLogBuffer* instance() ;
+
+    /** Route all output of os through this buffer and start the background thread.
+     *  The pending output is written with stop(), which is also called at exit().
+     */
+    void start( std::ostream& os ) ;
+
+    /** Write all pending output and stop the background thread - further output is written
+     *  synchronously. Waits for writes in progress on other threads.
+     */
+    void stop() ;
+
+    /** True between start() and stop().
+     */
+    bool isAsynchronous() const { return _async.load( std::memory_order_relaxed ) ; }
+
+  protected:
+
+    /** Ring buffer of one thread - written only by its thread, read only by the background thread.
+     */
+    struct Ring{
+      Ring() : data( RINGSIZE ), head(0), tail(0), line() {}
+      std::vector<char> data ;
+      std::atomic<size_t> head ; // total number of bytes committed by the writing thread
+      std::atomic<size_t> tail ; // total number of bytes written to the target
+      std::string line ;         // output of the current line - not yet committed
+    } ;
+
+    static const size_t RINGSIZE = 1 << 16 ;
+
+    AsyncLogBuffer() ;
+    AsyncLogBuffer( const AsyncLogBuffer& ) ;
+    AsyncLogBuffer& operator=( const AsyncLogBuffer& ) ;
+
+    virtual int overflow( int c ) ;
+    virtual std::streamsize xsputn( const char* s, std::streamsize n ) ;
+    virtual int sync() ;
+
+    /** The ring of the calling thread - created on first use. */
+    Ring* ring() ;
+
+    /** Copy the committed lines of the current thread to its ring. */
+    void commit( Ring* r, const char* s, size_t n ) ;
+
+    /** Marks a write in progress, so that stop() waits for it - true if the write goes
+     *  to the rings, false if it is written synchronously. */
+    bool beginWrite() ;
+
+    /** End of a write started with beginWrite(). */
+    void endWrite() ;
+
+    /** Write the committed output of all rings to the target - returns the number of bytes. */
+    size_t drain() ;
+
+    /** Main loop of the background thread. */
+    void flushLoop() ;
+
+    std::streambuf* _target ;
+    std::atomic<bool> _async ;
+    std::atomic<bool> _running ;
+    std::atomic<int> _nWriters ;   // writes in progress
+    std::atomic<int> _nWaiting ;   // writers waiting for space in their ring
+
+    std::vector<Ring*> _rings ;
+    std::mutex _ringsMutex ;
+    std::mutex _writeMutex ;  // serializes the writing to the target
+    std::mutex _waitMutex ;
+    std::condition_variable _wakeUp ;         // wakes the background thread
+    std::condition_variable _spaceAvailable ; // wakes writers waiting for a full ring
+    std::condition_variable _writesDone ;     // wakes stop() waiting for the writers
+    std::thread _thread ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -0,0 +1,77 @@
+#ifndef FastMCBatch_h
+#define FastMCBatch_h 1
+
+#include "lcio.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/MCParticle.h"
+#include "IMPL/LCCollectionVec.h"
+
+#include <vector>
+
+using namespace lcio ;
+
+namespace marlin{
+
+  /** Batch version of the fast Monte Carlo used by the SimpleFastMCProcessor in BatchMode.<br>
+   *  The stable MCParticles of an event are gathered into contiguous arrays (structure of arrays),
+   *  the resolutions are looked up and the smearing is applied in plain loops over these arrays
+   *  that the compiler can vectorize. The Gaussian random numbers come from a counter based
+   *  generator (Philox4x32-10) keyed with the event seed and indexed by the position of the
+   *  particle in the MCParticle collection - so the result of an event does not depend on the
+   *  order or the threads in which events are processed.<br>
+   *  The resolution functions, particle types and the momentum cut are the same as for the
+   *  SimpleParticleFactory with the SimpleTrackSmearer and the SimpleClusterSmearer, but the
+   *  random numbers differ. Does not need CLHEP.
+   *
+   *  @see SimpleFastMCProcessor
+   *  @version $Id:$
+   */
+  class FastMCBatch {
+
+  public:
+
+    /** The resolutions as given for the SimpleFastMCProcessor parameters ChargedResolution,
+     *  PhotonResolution and NeutralHadronResolution.
+     */
+    FastMCBatch( const FloatVec& chargedRes, const FloatVec& photonRes,
+		 const FloatVec& neutralHadronRes, double momentumCut ) ;
+
+    /** Creates ReconstructedParticles for the stable particles in mcpCol with the given seed,
+     *  adds them to recCol and their relations to the MCParticles to relCol (of type LCRELATION).
+     */
+    void process( const LCCollection* mcpCol, unsigned seed,
+		  IMPL::LCCollectionVec* recCol, IMPL::LCCollectionVec* relCol ) ;
+
+  protected:
+
+    /** Resolution in a polar angle range - for charged particles B is not used */
+    struct Resolution {
+      float A ;
+      float B ;
+      float ThMin ;
+      float ThMax ;
+    } ;
+
+    void initResolutions( std::vector<Resolution>& resVec, const FloatVec& par, bool charged ) ;
+
+    /** The index of the resolution for the particle type at the polar angle - -1 if none */
+    int findResolution( int type, double theta ) const ;
+
+    /** Resolutions per FastMCParticleType */
+    std::vector<Resolution> _res[3] ;
+    double _momentumCut ;
+
+    /** The stable particles of the current event - reused between events */
+    std::vector<EVENT::MCParticle*> _mcp ;
+    std::vector<int> _index ;     // position in the MCParticle collection
+    std::vector<int> _type ;
+    std::vector<int> _pdg ;
+    std::vector<double> _px, _py, _pz, _e ;
+    std::vector<double> _resA, _resB ;
+    std::vector<double> _gauss ;
+    std::vector<double> _scale, _energy, _mass ;
+    std::vector<char>   _keep ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -0,0 +1,71 @@
+#ifndef FieldMap_h
+#define FieldMap_h 1
+
+#include <vector>
+#include <functional>
+
+namespace marlin{
+
+  /** Magnetic field map shared by all processors through Global::FIELDMAP.<br>
+   *  The field is taken from a field function (e.g. GEAR or DD4hep) and precomputed on a regular
+   *  grid, so that queries inside the grid are a trilinear interpolation of the eight neighbouring
+   *  grid points instead of a call to the geometry package. Outside the grid - or if no grid is
+   *  defined - the field function is called, which then has to be thread safe.<br>
+   *  The map is read only after construction and can be used from several threads.
+   *  Positions are given in mm, the field in the units of the field function (Tesla).
+   *
+   *  @see Global
+   *  @version $Id:$
+   */
+  class FieldMap {
+
+  public:
+
+    /** Function computing the field vector at the given position. */
+    typedef std::function< void( const double* pos, double* field ) > FieldFunction ;
+
+    /** Create the map from the given function on a grid of n[i] points in [min[i],max[i]]
+     *  for x,y and z.
+     */
+    FieldMap( const FieldFunction& f, const double* min, const double* max, const int* n ) ;
+
+    /** Create the map without a grid - every query calls the function.
+     */
+    explicit FieldMap( const FieldFunction& f ) ;
+
+    /** Create the map with the grid given in the global parameter FieldMapGrid
+     *  as "xmin xmax nx ymin ymax ny zmin zmax nz" - without grid if it is not given.
+     */
+    static FieldMap* create( const FieldFunction& f ) ;
+
+    /** The field vector at pos.
+     */
+    void field( const double* pos, double* b ) const ;
+
+    /** The z component of the field at pos.
+     */
+    double bz( const double* pos ) const ;
+
+    /** The z component of the field at the origin - computed once.
+     */
+    double bzAtOrigin() const { return _bzOrigin ; }
+
+    /** True if the field is interpolated on a grid. */
+    bool hasGrid() const { return ! _grid.empty() ; }
+
+    /** True if pos is inside the grid. */
+    bool contains( const double* pos ) const ;
+
+  protected:
+
+    FieldFunction _function ;
+    double _min[3] ;
+    double _max[3] ;
+    double _step[3] ;
+    int _n[3] ;
+    std::vector<double> _grid ;  // field vectors, x running slowest and z fastest
+    double _bzOrigin ;
+  } ;
+
+} // end namespace marlin
+#endif
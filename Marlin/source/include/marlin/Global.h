@@ -13,6 +13,7 @@ namespace marlin{
 
   class ProcessorEventSeeder;
   class StringParameters ;
+  class FieldMap ;
 
   /** Simple global class for Marlin.
    *  Holds global parameters.
@@ -33,6 +34,11 @@ namespace marlin{
 
     static ProcessorEventSeeder* EVENTSEEDER ;
 
+    /** The magnetic field - created from GEAR if it has a field, otherwise it can be
+     *  set by a processor in init(). Deleted at the end of the job.
+     */
+    static FieldMap* FIELDMAP ;
+
 
   };
   
@@ -0,0 +1,104 @@
+#ifndef HistogramService_h
+#define HistogramService_h 1
+
+#include "marlin/MarlinConfig.h"
+
+#ifdef MARLIN_AIDA
+
+#include <vector>
+#include <mutex>
+
+namespace AIDA{
+  class ICloud1D ;
+  class ICloud2D ;
+  class IHistogram1D ;
+  class IHistogram2D ;
+  class IProfile1D ;
+}
+
+namespace marlin {
+
+  /** Thread safe filling of the AIDA histograms, clouds and profiles created with the
+   *  AIDAProcessor factories.<br>
+   *  Fills are collected in a buffer per thread and applied to the AIDA objects in blocks of
+   *  BUFFERSIZE fills under a single lock, so that processors running concurrently
+   *  (see ProcessorScheduler) do not serialize on every fill. The remaining fills of all
+   *  threads are merged by the AIDAProcessor before the AIDA file is written.<br>
+   *  Objects have to be created while holding mutex(), as the AIDAProcessor factories share
+   *  the current directory of the AIDA tree, e.g.
+   *  <pre>
+   *    if( isFirstEvent() ) {
+   *      std::lock_guard<std::mutex> lock( HistogramService::instance()->mutex() ) ;
+   *      _hEnergy = AIDAProcessor::histogramFactory(this)->createHistogram1D( "hEnergy", "E/GeV", 100, 0., 100. ) ;
+   *    }
+   *    HistogramService::instance()->fill( _hEnergy , e ) ;
+   *  </pre>
+   *  Call flush() before reading back the contents of an object filled by the current thread.
+   *
+   *  @see AIDAProcessor
+   *  @version $Id:$
+   */
+  class HistogramService {
+
+  public:
+
+    /** The unique instance.
+     */
+    static HistogramService* instance() ;
+
+    /** The mutex to hold while creating or accessing AIDA objects directly.
+     */
+    std::mutex& mutex() { return _mutex ; }
+
+    void fill( AIDA::ICloud1D* c, double x, double weight=1. ) ;
+    void fill( AIDA::ICloud2D* c, double x, double y, double weight=1. ) ;
+    void fill( AIDA::IHistogram1D* h, double x, double weight=1. ) ;
+    void fill( AIDA::IHistogram2D* h, double x, double y, double weight=1. ) ;
+    void fill( AIDA::IProfile1D* p, double x, double y, double weight=1. ) ;
+
+    /** Apply the buffered fills of the calling thread.
+     */
+    void flush() ;
+
+    /** Apply the buffered fills of all threads - must not be called while other threads fill.
+     */
+    void flushAll() ;
+
+    static const unsigned BUFFERSIZE = 1024 ;
+
+  protected:
+
+    enum FillType { CLOUD1D, CLOUD2D, HISTOGRAM1D, HISTOGRAM2D, PROFILE1D } ;
+
+    /** One buffered fill. */
+    struct Fill{
+      FillType type ;
+      void* object ;
+      double x ;
+      double y ;
+      double weight ;
+    } ;
+
+    typedef std::vector<Fill> FillBuffer ;
+
+    HistogramService() ;
+    HistogramService( const HistogramService& ) ;
+    HistogramService& operator=( const HistogramService& ) ;
+
+    /** Buffer a fill for the calling thread - applies the buffer when full. */
+    void add( FillType type, void* object, double x, double y, double weight ) ;
+
+    /** The buffer of the calling thread - created on first use. */
+    FillBuffer* buffer() ;
+
+    /** Apply and clear the given buffer - called with the lock held. */
+    void apply( FillBuffer& buf ) ;
+
+    std::mutex _mutex ;
+    std::vector<FillBuffer*> _buffers ;
+  } ;
+
+} // end namespace marlin
+
+#endif // MARLIN_AIDA
+#endif // HistogramService_h
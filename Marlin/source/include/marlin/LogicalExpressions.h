@@ -156,6 +156,9 @@ namespace marlin{
      */
     void addCondition( const std::string& name, const std::string& expression ) ;
 
+    /** The expression of the named condition - empty if no condition with this name exists */
+    std::string getCondition( const std::string& name ) const ;
+
     /** Clear all boolean values */
     void clear() ;
 
@@ -65,6 +65,7 @@ namespace marlin{
     friend class ProcessorMgr ;
     friend class CMProcessor ;
     friend class XMLFixCollTypes ;
+    friend class ProcessorScheduler ;
 
   private:
     //prevent users from making (default) copies of processors
@@ -120,7 +121,15 @@ namespace marlin{
      *  for all following processors.
      */
     virtual void end(){ }
-  
+
+    /** Return true if init() does not depend on the initialization of any other processor
+     *  (e.g. geometry, histogram files) and may run concurrently with the init() of other
+     *  processors - used if the global parameter ConcurrentInit is true. Default is false.
+     *  Such an init() has to hold a LogLock while writing log output (printParameters() does
+     *  this) and logs in the global scope and log level.
+     */
+    virtual bool hasIndependentInit() const { return false ; }
+
 
     /** Return type name for the processor (as set in constructor).
      */
@@ -155,6 +164,9 @@ namespace marlin{
     void printParameters() {
     
       
+      // might be called from a concurrent init() or processEvent()
+      LogLock lock ;
+
       if( streamlog::out.template write<T>() ) {
 
 	
@@ -195,6 +207,11 @@ namespace marlin{
     /** True if first event in processEvent(evt) - use this e.g. to initialize histograms etc.
      */
     bool isFirstEvent() { return _isFirstEvent ; } ;
+
+    /** True if the processor declared with setConcurrent() that it can be run concurrently
+     *  with other processors.
+     */
+    bool isConcurrent() const { return _concurrent ; }
     
     /** Return the LCIO input type for the collection colName - empty string if colName is
      *  not  a registered collection name */
@@ -221,7 +238,19 @@ namespace marlin{
     
   protected:
 
-    /** Set the return value for this processor - typically at end of processEvent(). 
+    /** Holds ProcessorScheduler::logMutex() while in scope - create one around streamlog
+     *  output that may be written concurrently with other processors.
+     */
+    class LogLock{
+    public:
+      LogLock() ;
+      ~LogLock() ;
+    private:
+      LogLock( const LogLock& ) ;
+      LogLock& operator=( const LogLock& ) ;
+    };
+
+    /** Set the return value for this processor - typically at end of processEvent().
      *  The value can be used in a condition in the steering file referred to by the name
      *  of the processor. 
      */
@@ -318,6 +347,20 @@ namespace marlin{
     /** Tests whether the parameter has been set in the steering file
      */
     bool parameterSet( const std::string& name ) ;
+
+    /** Declare that processEvent() and check() can run concurrently with other processors
+     *  if the global parameter ConcurrentProcessors is set - call in the constructor. The
+     *  processor then promises that<br>
+     *  - it only accesses the event collections registered with registerInputCollection(s)()
+     *    and registerOutputCollection(),<br>
+     *  - it is reentrant with respect to any state it shares with other processors,<br>
+     *  - it writes streamlog output in processEvent() and check() only while holding a
+     *    LogLock, as streamlog is not thread safe.<br>
+     *  All other processors run on their own, after all earlier and before all later processors.
+     *
+     *  @see ProcessorScheduler
+     */
+    void setConcurrent( bool concurrent=true ) { _concurrent = concurrent ; }
     
     
 
@@ -446,6 +489,7 @@ namespace marlin{
     
   private:
     mutable std::stringstream* _str ;
+    bool _concurrent ;
 
     Processor() ; 
   
@@ -453,4 +497,11 @@ namespace marlin{
  
 } // end namespace marlin 
 
+
+/** Put once into the source of a processor library that registers nothing but processors - no
+ *  conditions handlers, plugins or other global objects - so that Marlin can skip loading it if
+ *  none of its processors is active (see MARLIN_DLL_MANIFEST and ProcessorLoader).
+ */
+#define MARLIN_PROCESSOR_ONLY_LIBRARY extern "C" const int marlin_processor_only_library = 1 ;
+
 #endif
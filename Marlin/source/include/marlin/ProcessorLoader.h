@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include <set>
 
 namespace marlin{
   
@@ -15,7 +16,14 @@ namespace marlin{
   /** Processor loader - loads shared libraries with marlin processors. 
    *  The shared libraries are loaded in the constructor with dlopen and 
    *  closed in the destructor, i.e. their lifetime is the same as that 
-   *  of the ProcessorLoader instance.
+   *  of the ProcessorLoader instance.<br>
+   *  With a manifest file (environment variable MARLIN_DLL_MANIFEST) only the libraries providing
+   *  the processor types used in the steering file are loaded. The manifest caches the processor
+   *  types registered by every library, together with its size and modification time - libraries
+   *  that are new or have changed are loaded and their entry is updated. Only libraries that
+   *  declare with MARLIN_PROCESSOR_ONLY_LIBRARY that they register nothing but processors are
+   *  ever skipped, as other static registrations (e.g. conditions handlers or global objects)
+   *  cannot be seen. All remaining libraries are loaded if a type is still missing.
    *
    *  @author F. Gaede, DESY
    *  @version $Id: ProcessorLoader.h,v 1.3 2008-03-11 15:17:14 engels Exp $ 
@@ -28,6 +36,11 @@ namespace marlin{
   public:
     
     ProcessorLoader( lcio::StringVec::const_iterator  first, lcio::StringVec::const_iterator last ) ;
+
+    /** Load only the libraries needed for the given processor types, using the manifest file.
+     */
+    ProcessorLoader( lcio::StringVec::const_iterator  first, lcio::StringVec::const_iterator last,
+		     const std::string& manifestFile, const std::set<std::string>& processorTypes ) ;
     
     virtual ~ProcessorLoader() ;
 
@@ -35,8 +48,12 @@ namespace marlin{
     
     
   protected:
+
+    /** Check for duplicates and dlopen the library - sets the load error on failure. */
+    bool load( const std::string& libName ) ;
     
     LibVec _libs ;
+    std::set<std::string> _libBaseNames ;
 
   private:
     bool _loadError;
@@ -11,6 +11,7 @@
 #include "EVENT/LCEvent.h"
 #include "EVENT/LCRunHeader.h"
 #include "LogicalExpressions.h"
+#include "ProcessorScheduler.h"
 
 #include <map>
 #include <set>
@@ -38,6 +39,7 @@ class ProcessorMgr : public LCRunListener, public LCEventListener {
 friend class  Processor ;   
 friend class  CMProcessor ;   
 friend class  MarlinSteerCheck ;   
+friend class  ProcessorLoader ;
 
 public:
   
@@ -83,6 +85,11 @@ public:
   /** Dump information of all registered  processors in XML format to stdout.
    */
   void dumpRegisteredProcessorsXML() ;
+
+  /** Check the steering parameters of all active processors against the parameters they
+   *  register - prints every unknown parameter and returns their number.
+   */
+  int validateActiveProcessors() ;
   
   virtual void init() ;
   virtual void processRunHeader( LCRunHeader* ) ;   
@@ -129,6 +136,9 @@ private:
   LogicalExpressions _conditions ;
 //   LCIOOutputProcessor* _outputProcessor ;
 
+  /** Runs the processors concurrently if the global parameter ConcurrentProcessors is > 1 */
+  ProcessorScheduler* _scheduler ;
+
 };
   
 } // end namespace marlin 
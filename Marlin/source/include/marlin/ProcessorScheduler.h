@@ -0,0 +1,175 @@
+#ifndef ProcessorScheduler_h
+#define ProcessorScheduler_h 1
+
+#include "lcio.h"
+#include "EVENT/LCEvent.h"
+
+#include <list>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+using namespace lcio ;
+
+namespace streamlog{
+  class logscope ;
+}
+
+namespace marlin{
+
+  class Processor ;
+  class LogicalExpressions ;
+
+  /** Runs the processEvent() methods of the active processors concurrently on a pool of
+   *  threads, respecting the dependencies between the processors.<br>
+   *  The dependency graph is built once from the collections declared with
+   *  registerInputCollection(s)() and registerOutputCollection(), i.e. a processor runs after
+   *  every earlier processor (in the order of the &lt;execute&gt; section) that creates one of its
+   *  input collections, and from the conditions, i.e. a processor runs after every processor
+   *  whose return value appears in its condition. Only processors that opt in with
+   *  Processor::setConcurrent() run concurrently, as collections accessed by other means than the
+   *  registered parameters cannot be seen. All other processors, processors that declare no
+   *  collections at all, LCIOOutputProcessors and EventModifiers are treated as barriers that run
+   *  after all earlier and before all later processors.<br>
+   *  Enabled with the global parameter ConcurrentProcessors (number of threads).
+   *  Processors scheduled concurrently have to be reentrant with respect to any state they share
+   *  (e.g. histograms, static variables) and receive a synchronized view of the event and its
+   *  parameters that is not an LCEventImpl.<br>
+   *  streamlog is not thread safe - it formats every message in one global stream - so
+   *  concurrent processors have to hold logMutex() while they write log output. While they
+   *  hold it, the stream has their name and verbosity, as in sequential processing.
+   *
+   *  @see ProcessorMgr
+   *  @version $Id:$
+   */
+  class ProcessorScheduler {
+
+  public:
+
+    /** Build the dependency graph of the given (initialized) processors and start nThreads threads.
+     *  The conditions are evaluated and set under the given mutex.
+     */
+    ProcessorScheduler( const std::list<Processor*>& processors,
+			LogicalExpressions& conditions,
+			std::mutex& conditionsMutex,
+			unsigned nThreads ) ;
+
+    /** Stops and joins the threads.
+     */
+    ~ProcessorScheduler() ;
+
+    /** Calls processEvent() (and check() if requested) for all processors whose condition is true.
+     *  Rethrows the first exception thrown by a processor after the running processors have
+     *  finished - no further processors are started for this event once a processor has thrown.
+     */
+    void processEvent( LCEvent* evt, bool check ) ;
+
+    /** Mutex for the log output of processors running concurrently - the log scope (name and
+     *  verbosity) of the processor set for the calling thread with ProcessorLogScope is
+     *  opened on streamlog::out while the mutex is held.
+     */
+    class LogMutex{
+
+    public:
+      LogMutex() : _mutex(), _scope(0) {}
+
+      void lock() ;
+      void unlock() ;
+
+    private:
+      LogMutex( const LogMutex& ) ;
+      LogMutex& operator=( const LogMutex& ) ;
+
+      std::mutex _mutex ;
+      streamlog::logscope* _scope ;
+    } ;
+
+    /** Sets the processor whose log scope logMutex() opens on the calling thread, for the
+     *  lifetime of the object - used around the processors' methods called on other threads
+     *  than the main thread.
+     */
+    class ProcessorLogScope{
+
+    public:
+      ProcessorLogScope( const Processor* p ) ;
+      ~ProcessorLogScope() ;
+
+    private:
+      ProcessorLogScope( const ProcessorLogScope& ) ;
+      ProcessorLogScope& operator=( const ProcessorLogScope& ) ;
+
+      const Processor* _previous ;
+    } ;
+
+    /** Mutex to be held by processors running concurrently for every streamlog_out() in
+     *  processEvent() and check(), e.g.<br>
+     *  &nbsp;&nbsp; { std::lock_guard<ProcessorScheduler::LogMutex> lock( ProcessorScheduler::logMutex() ) ;<br>
+     *  &nbsp;&nbsp;&nbsp;&nbsp; streamlog_out( DEBUG ) << ... ; }
+     */
+    static LogMutex& logMutex() ;
+
+    /** Print the dependencies of every processor with verbosity MESSAGE.
+     */
+    void printDependencies() const ;
+
+    /** Print the wall clock time per processor and per event, the critical path through the
+     *  dependency graph and the resulting bound on the speed up, with verbosity MESSAGE.
+     */
+    void printStatistics() const ;
+
+  protected:
+
+    /** A processor in the dependency graph.
+     */
+    struct Node{
+      Processor* proc ;
+      std::vector<unsigned> inputs ;     // nodes this node depends on
+      std::vector<unsigned> dependents ; // nodes depending on this node
+      double time ;                      // total wall clock time in processEvent() and check()
+      int nCalls ;
+      bool barrier ;                     // runs after all earlier and before all later nodes
+    } ;
+
+    ProcessorScheduler() ;
+    ProcessorScheduler( const ProcessorScheduler& ) ;
+    ProcessorScheduler& operator=( const ProcessorScheduler& ) ;
+
+    /** Main loop of the worker threads.
+     */
+    void work() ;
+
+    /** Evaluate the condition and call the processor for the given node - called without lock.
+     */
+    void runNode( unsigned i ) ;
+
+    std::vector<Node> _nodes ;
+    LogicalExpressions& _conditions ;
+    std::mutex& _conditionsMutex ;
+
+    // ---- per event state - protected by _mutex
+    std::mutex _mutex ;
+    std::condition_variable _workAvailable ;
+    std::condition_variable _eventDone ;
+    std::vector<unsigned> _ready ;
+    std::vector<unsigned> _nOpenInputs ;
+    unsigned _nDone ;
+    bool _stop ;
+    bool _failed ;
+    std::exception_ptr _exception ;
+    LCEvent* _evt ;
+    bool _check ;
+
+    std::vector<std::thread> _threads ;
+
+    // ---- per event timing
+    int _nEvents ;
+    double _evtTime ;
+    double _evtTimeMin ;
+    double _evtTimeMax ;
+  } ;
+
+} // end namespace marlin
+#endif
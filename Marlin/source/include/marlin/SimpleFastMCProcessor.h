@@ -8,11 +8,17 @@
 #include <string>
 
 
+namespace AIDA{
+  class ICloud1D ;
+  class IHistogram1D ;
+  class IProfile1D ;
+}
 
 using namespace lcio ;
 
 namespace marlin{
  
+  class FastMCBatch ;
 
   /** A simple smearing "Monte Carlo" processor.
    *  It creates ReconstructedParticles from MCParticles according to
@@ -59,6 +65,7 @@ namespace marlin{
    * @param MomentumCut          No reconstructed particles are produced for smaller momenta (in [GeV])
    * @param NeutralHadronResolution Resolution dE/E=A+B/sqrt(E/GeV) of neutral hadrons in polar angle range: A  B th_min  th_max
    * @param PhotonResolution   Resolution dE/E=A+B/sqrt(E/GeV) of photons in polar angle range: A  B th_min  th_max
+   * @param BatchMode          Smear all particles of an event at once with the FastMCBatch - does not need CLHEP
    *
    * @param RecoParticleCollectionName    default is "ReconstructedParticles"
    * @param MCTruthMappingCollectionName  default is "MCTruthMapping"
@@ -123,8 +130,22 @@ namespace marlin{
     /** The particle factory */
     IRecoParticleFactory* _factory ;
 
+    /** Smear all particles of an event at once */
+    bool _batchMode ;
+    FastMCBatch* _batch ;
+
     int _nRun ;
     int _nEvt ;
+
+    /** Check plots - created in the first call to check() */
+    AIDA::ICloud1D* _hChargedRes ;
+    AIDA::ICloud1D* _hChargedEnergy ;
+    AIDA::ICloud1D* _hPhotonEnergy ;
+    AIDA::ICloud1D* _hHadronEnergy ;
+    AIDA::IHistogram1D* _hPhotonRes ;
+    AIDA::IHistogram1D* _hHadronRes ;
+    AIDA::IProfile1D* _hGamHelperP1 ;
+    AIDA::IProfile1D* _hHadHelperP1 ;
     
   } ;
   
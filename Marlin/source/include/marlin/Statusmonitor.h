@@ -29,6 +29,9 @@ class Statusmonitor : public Processor {
   Statusmonitor() ;
 
   virtual void init() ;
+
+  /** Only resets the counters. */
+  virtual bool hasIndependentInit() const { return true ; }
   
   /** Called for every run.
    */
@@ -20,6 +20,9 @@ namespace marlin{
    *  LCEvent with MCParticle collection.
    *
    * @param StdHepFileName   name of input file
+   * @param UseNewConverter  use LCStdHepRdrNew instead of LCStdHepRdr (default false)
+   * @param ReadAheadEvents  number of events read and converted ahead on a separate thread, only
+   *                         with UseNewConverter (default 0: none)
    *
    * @author F. Gaede, DESY
    * @version $Id: StdHepReader.h,v 1.3 2005-10-11 12:56:28 gaede Exp $ 
@@ -43,10 +46,19 @@ namespace marlin{
     
     virtual void init() ;
     virtual void end() ;
+
+    /** The file is only opened in readDataSource(). */
+    virtual bool hasIndependentInit() const { return true ; }
     
   protected:
+
+    /** Creates and processes the events read with the given LCStdHepRdr or LCStdHepRdrNew. */
+    template <class Rdr>
+    void readEvents( Rdr& rdr , int numEvents ) ;
     
     std::string _fileName ;
+    bool _useNewConverter ;
+    int _readAhead ;
 
   };
  
@@ -0,0 +1,49 @@
+#ifndef SteeringCache_h
+#define SteeringCache_h 1
+
+#include "XMLParser.h"
+
+#include <string>
+
+namespace marlin{
+
+  /** Cache of parsed steering files.<br>
+   *  The resolved parameters of all sections - global parameters with the active processors and
+   *  their conditions, and the processor parameters with their types - are written to a binary
+   *  file in the cache directory, named after a 64 bit hash of the steering file and the command
+   *  line parameters. A job with the same steering file and command line reads them from there
+   *  instead of parsing the XML. Used by the XMLParser if MARLIN_STEERING_CACHE is set to the
+   *  cache directory. The files are in the native byte order - they are a local cache, not a
+   *  format for exchanging steering files.
+   *
+   *  @see XMLParser
+   *  @version $Id:$
+   */
+  class SteeringCache {
+
+  public:
+
+    /** Cache in the given directory - created if it does not exist. */
+    SteeringCache( const std::string& directory ) ;
+
+    /** The key for the given steering file and command line parameters - 0 if the file
+     *  cannot be read.
+     */
+    static unsigned long long key( const std::string& fileName, const CommandLineParametersMap& cmdlineparams ) ;
+
+    /** Read the parameters for the given key - false if they are not in the cache. */
+    bool read( unsigned long long key, StringParametersMap& parameters ) const ;
+
+    /** Write the parameters for the given key - a failure is only reported. */
+    void write( unsigned long long key, const StringParametersMap& parameters ) const ;
+
+  protected:
+
+    /** The cache file for the given key. */
+    std::string fileName( unsigned long long key ) const ;
+
+    std::string _directory ;
+  } ;
+
+} // end namespace marlin
+#endif
@@ -3,6 +3,7 @@
 #ifdef MARLIN_AIDA
 
 #include "marlin/AIDAProcessor.h"
+#include "marlin/HistogramService.h"
 
 #include <iostream>
 #include <assert.h>
@@ -29,7 +30,9 @@ namespace marlin {
   _tree(NULL),
   _histoFactory(NULL),
   _tupleFactory(NULL),
-  _dataPointSetFactory(NULL) {
+  _dataPointSetFactory(NULL),
+  _hEvtTime(NULL),
+  _eventTime(0) {
     
     _description = "Processor that handles AIDA files. Creates on directory per processor. "
       " Processors only need to create and fill the histograms, clouds and tuples. Needs to be the first ActiveProcessor" ;
@@ -129,34 +132,36 @@ namespace marlin {
 
   void AIDAProcessor::check( LCEvent * evt ) { 
     
-    static AIDA::ICloud1D* hEvtTime ;    
-    static clock_t eventTime =  clock () ; 
-    
-    
     // create directory for this processor
     if( isFirstEvent() ) { 
+
+      std::lock_guard<std::mutex> lock( HistogramService::instance()->mutex() ) ;
+
       _tree->cd( "/" ) ;
       assert( _tree->mkdir( name()  ) ) ; 
       
       _tree->cd( "/" + name()  ) ;
       
-      hEvtTime = _histoFactory->createCloud1D( "hEvtProcessingTime", "event processing time [s] ", 100 ) ; 
+      _hEvtTime = _histoFactory->createCloud1D( "hEvtProcessingTime", "event processing time [s] ", 100 ) ; 
       
       _tree->cd("..") ;
       
+      _eventTime = clock () ;
       
     } else { 
       
       clock_t now =  clock () ; 
       
-      hEvtTime->fill(  double(now - eventTime) / double(CLOCKS_PER_SEC) ) ;
-      eventTime =  now ;
+      HistogramService::instance()->fill( _hEvtTime , double(now - _eventTime) / double(CLOCKS_PER_SEC) ) ;
+      _eventTime =  now ;
       
     } 
   }
   
   void AIDAProcessor::end(){ 
     
+    // merge the fills still buffered by the processors
+    HistogramService::instance()->flushAll() ;
     
     _tree->commit() ;
     
@@ -0,0 +1,303 @@
+#include "marlin/AsyncLogBuffer.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+namespace marlin{
+
+  namespace {
+    void stopAtExit(){
+      AsyncLogBuffer::instance()->stop() ;
+    }
+  }
+
+
+  AsyncLogBuffer* AsyncLogBuffer::instance(){
+
+    static AsyncLogBuffer* me = new AsyncLogBuffer ;
+    return me ;
+  }
+
+
+  AsyncLogBuffer::AsyncLogBuffer() :
+    std::streambuf(),
+    _target(0),
+    _async(false),
+    _running(false),
+    _nWriters(0),
+    _nWaiting(0),
+    _rings(),
+    _ringsMutex(),
+    _writeMutex(),
+    _waitMutex(),
+    _wakeUp(),
+    _spaceAvailable(),
+    _writesDone(),
+    _thread() {
+  }
+
+
+  void AsyncLogBuffer::start( std::ostream& os ){
+
+    if( _async || _thread.joinable() ) return ;
+
+    _target = os.rdbuf() ;
+    os.rdbuf( this ) ;
+
+    _running = true ;
+    _async = true ;
+    _thread = std::thread( &AsyncLogBuffer::flushLoop , this ) ;
+
+    static bool atExitRegistered = false ;
+    if( ! atExitRegistered ){
+      std::atexit( stopAtExit ) ;
+      atExitRegistered = true ;
+    }
+  }
+
+
+  void AsyncLogBuffer::stop(){
+
+    if( ! _thread.joinable() ) return ;
+
+    _async = false ;
+
+    // writers that already chose the rings finish while the background thread still drains them
+    {
+      std::unique_lock<std::mutex> lock( _waitMutex ) ;
+      _writesDone.wait( lock , [this]{ return _nWriters.load() == 0 ; } ) ;
+    }
+
+    _running = false ;
+    _wakeUp.notify_all() ;
+    _thread.join() ;
+
+    drain() ;
+
+    // write what is left over from unterminated lines
+    std::lock_guard<std::mutex> lockR( _ringsMutex ) ;
+    std::lock_guard<std::mutex> lockW( _writeMutex ) ;
+
+    for( unsigned i=0 ; i < _rings.size() ; ++i ){
+
+      std::string& line = _rings[i]->line ;
+
+      if( ! line.empty() ){
+	_target->sputn( line.data() , line.size() ) ;
+	line.clear() ;
+      }
+    }
+    _target->pubsync() ;
+  }
+
+
+  AsyncLogBuffer::Ring* AsyncLogBuffer::ring(){
+
+    static thread_local Ring* r = 0 ;
+
+    if( r == 0 ){
+
+      r = new Ring ;
+
+      std::lock_guard<std::mutex> lock( _ringsMutex ) ;
+      _rings.push_back( r ) ;
+    }
+    return r ;
+  }
+
+
+  int AsyncLogBuffer::overflow( int c ){
+
+    if( c == traits_type::eof() )
+      return traits_type::not_eof( c ) ;
+
+    char ch = traits_type::to_char_type( c ) ;
+    xsputn( &ch , 1 ) ;
+
+    return c ;
+  }
+
+
+  bool AsyncLogBuffer::beginWrite(){
+
+    ++_nWriters ;
+
+    if( _async )
+      return true ;
+
+    endWrite() ;
+    return false ;
+  }
+
+
+  void AsyncLogBuffer::endWrite(){
+
+    if( --_nWriters == 0 && ! _async ){
+
+      std::lock_guard<std::mutex> lock( _waitMutex ) ;
+      _writesDone.notify_all() ;
+    }
+  }
+
+
+  std::streamsize AsyncLogBuffer::xsputn( const char* s, std::streamsize n ){
+
+    if( ! beginWrite() ){
+
+      std::lock_guard<std::mutex> lock( _writeMutex ) ;
+      return _target->sputn( s , n ) ;
+    }
+
+    Ring* r = ring() ;
+
+    // commit everything up to the last newline, keep the rest for the next call
+    const char* end = s + n ;
+    const char* last = end ;
+    while( last != s && *( last - 1 ) != '\n' ) --last ;
+
+    if( last == s ){
+
+      r->line.append( s , n ) ;
+
+    } else {
+
+      if( r->line.empty() ){
+
+	commit( r , s , last - s ) ;
+
+      } else {
+
+	r->line.append( s , last - s ) ;
+	commit( r , r->line.data() , r->line.size() ) ;
+	r->line.clear() ;
+      }
+      r->line.append( last , end - last ) ;
+    }
+
+    endWrite() ;
+    return n ;
+  }
+
+
+  int AsyncLogBuffer::sync(){
+
+    if( ! beginWrite() ){
+
+      std::lock_guard<std::mutex> lock( _writeMutex ) ;
+      return _target->pubsync() ;
+    }
+
+    Ring* r = ring() ;
+
+    if( ! r->line.empty() ){
+
+      commit( r , r->line.data() , r->line.size() ) ;
+      r->line.clear() ;
+    }
+
+    endWrite() ;
+    return 0 ;
+  }
+
+
+  void AsyncLogBuffer::commit( Ring* r, const char* s, size_t n ){
+
+    size_t head = r->head.load( std::memory_order_relaxed ) ;
+
+    while( n > 0 ){
+
+      // lines are committed as a whole, only output longer than the ring is split
+      size_t k = std::min( n , RINGSIZE ) ;
+
+      if( RINGSIZE - ( head - r->tail.load( std::memory_order_acquire ) ) < k ){  // wait for the background thread
+
+	std::unique_lock<std::mutex> lock( _waitMutex ) ;
+
+	++_nWaiting ;
+	_wakeUp.notify_one() ;
+	_spaceAvailable.wait( lock , [r,head,k]{ return RINGSIZE - ( head - r->tail.load() ) >= k ; } ) ;
+	--_nWaiting ;
+
+	continue ;
+      }
+
+      size_t pos = head % RINGSIZE ;
+      size_t k1 = std::min( k , RINGSIZE - pos ) ;
+
+      std::memcpy( &r->data[ pos ] , s , k1 ) ;
+      std::memcpy( &r->data[ 0 ] , s + k1 , k - k1 ) ;
+
+      head += k ;
+      r->head.store( head , std::memory_order_release ) ;
+
+      s += k ;
+      n -= k ;
+    }
+
+    if( head - r->tail.load( std::memory_order_relaxed ) > RINGSIZE / 2 )
+      _wakeUp.notify_one() ;
+  }
+
+
+  size_t AsyncLogBuffer::drain(){
+
+    std::vector<Ring*> rings ;
+    {
+      std::lock_guard<std::mutex> lock( _ringsMutex ) ;
+      rings = _rings ;
+    }
+
+    std::lock_guard<std::mutex> lock( _writeMutex ) ;
+
+    size_t nBytes = 0 ;
+
+    for( unsigned i=0 ; i < rings.size() ; ++i ){
+
+      Ring* r = rings[i] ;
+
+      size_t head = r->head.load( std::memory_order_acquire ) ;
+      size_t tail = r->tail.load( std::memory_order_relaxed ) ;
+
+      if( head == tail ) continue ;
+
+      size_t n = head - tail ;
+      size_t pos = tail % RINGSIZE ;
+      size_t n1 = std::min( n , RINGSIZE - pos ) ;
+
+      _target->sputn( &r->data[ pos ] , n1 ) ;
+      _target->sputn( &r->data[ 0 ] , n - n1 ) ;
+
+      r->tail.store( head ) ;
+
+      nBytes += n ;
+    }
+
+    if( nBytes > 0 )
+      _target->pubsync() ;
+
+    // wake the writers waiting for space - they test the tails under _waitMutex
+    if( nBytes > 0 && _nWaiting.load() > 0 ){
+
+      std::lock_guard<std::mutex> lockW( _waitMutex ) ;
+      _spaceAvailable.notify_all() ;
+    }
+
+    return nBytes ;
+  }
+
+
+  void AsyncLogBuffer::flushLoop(){
+
+    while( _running ){
+
+      if( drain() == 0 ){
+
+	std::unique_lock<std::mutex> lock( _waitMutex ) ;
+	_wakeUp.wait_for( lock , std::chrono::milliseconds( 5 ) ) ;
+      }
+    }
+  }
+
+} // end namespace marlin
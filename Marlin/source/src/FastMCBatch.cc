@@ -0,0 +1,230 @@
+#include "marlin/FastMCBatch.h"
+#include "marlin/FastMCParticleType.h"
+
+#include "IMPL/ReconstructedParticleImpl.h"
+#include "IMPL/LCRelationImpl.h"
+
+#include <cmath>
+#include <cstdlib>
+
+// same masses as in SimpleTrackSmearer.h - which is only available with CLHEP
+#define FASTMC_ELECTRON_MASS 0.0005109989
+#define FASTMC_MUON_MASS     0.10565836
+#define FASTMC_PION_MASS     0.139570
+
+using namespace lcio ;
+
+namespace marlin{
+
+  namespace {
+
+    /** Philox4x32-10 counter based random number generator (Salmon et al., SC'11):
+     *  four random 32 bit words for the counter ctr and the key.
+     */
+    inline void philox4x32( unsigned ctr[4], unsigned key0, unsigned key1 ){
+
+      for( int r=0 ; r<10 ; ++r ){
+
+	unsigned long long p0 = 0xD2511F53ULL * ctr[0] ;
+	unsigned long long p1 = 0xCD9E8D57ULL * ctr[2] ;
+
+	unsigned c0 = unsigned( p1 >> 32 ) ^ ctr[1] ^ key0 ;
+	unsigned c1 = unsigned( p1 ) ;
+	unsigned c2 = unsigned( p0 >> 32 ) ^ ctr[3] ^ key1 ;
+	unsigned c3 = unsigned( p0 ) ;
+
+	ctr[0] = c0 ; ctr[1] = c1 ; ctr[2] = c2 ; ctr[3] = c3 ;
+
+	key0 += 0x9E3779B9U ;
+	key1 += 0xBB67AE85U ;
+      }
+    }
+
+    // identifies the stream of random numbers used by the fast MC for a given seed
+    const unsigned FASTMC_STREAM = 0x46434D43U ; // "FCMC"
+  }
+
+
+  FastMCBatch::FastMCBatch( const FloatVec& chargedRes, const FloatVec& photonRes,
+			    const FloatVec& neutralHadronRes, double momentumCut ) :
+    _momentumCut( momentumCut ) {
+
+    initResolutions( _res[ CHARGED - 1 ],        chargedRes,       true  ) ;
+    initResolutions( _res[ PHOTON - 1 ],         photonRes,        false ) ;
+    initResolutions( _res[ NEUTRAL_HADRON - 1 ], neutralHadronRes, false ) ;
+  }
+
+
+  void FastMCBatch::initResolutions( std::vector<Resolution>& resVec, const FloatVec& par, bool charged ){
+
+    // charged: d(1/P) th_min th_max - neutral: A B th_min th_max
+    unsigned nPar = ( charged ? 3 : 4 ) ;
+
+    resVec.resize( par.size() / nPar ) ;
+
+    int index = 0 ;
+
+    for( unsigned i=0 ; i < resVec.size() ; i++ ){
+
+      resVec[i].A     = par[ index++ ] ;
+      resVec[i].B     = ( charged ? 0. : par[ index++ ] ) ;
+      resVec[i].ThMin = par[ index++ ] ;
+      resVec[i].ThMax = par[ index++ ] ;
+    }
+  }
+
+
+  int FastMCBatch::findResolution( int type, double theta ) const {
+
+    const std::vector<Resolution>& resVec = _res[ type - 1 ] ;
+
+    if( theta > M_PI_2 )  theta = M_PI - theta ; // need to transform to [0,pi/2]
+
+    for( unsigned i=0 ; i < resVec.size() ; i++ ){
+
+      if( theta <= resVec[i].ThMax  &&  theta > resVec[i].ThMin )
+	return ( resVec[i].A > -1e-10 ? int(i) : -1 ) ;
+    }
+    return -1 ;
+  }
+
+
+  void FastMCBatch::process( const LCCollection* mcpCol, unsigned seed,
+			     IMPL::LCCollectionVec* recCol, IMPL::LCCollectionVec* relCol ){
+
+    int nMCP = mcpCol->getNumberOfElements() ;
+
+    _mcp.clear() ; _index.clear() ; _type.clear() ; _pdg.clear() ;
+    _px.clear() ; _py.clear() ; _pz.clear() ; _e.clear() ;
+    _resA.clear() ; _resB.clear() ;
+
+    //---- gather the stable particles that have a resolution at their polar angle
+
+    for( int i=0 ; i < nMCP ; i++ ){
+
+      MCParticle* mcp = static_cast<MCParticle*>( mcpCol->getElementAt( i ) ) ;
+
+      if( mcp->getGeneratorStatus() != 1 )  // stable particles only
+	continue ;
+
+      // same classification as SimpleParticleFactory::getParticleType()
+      int pdg = mcp->getPDG() ;
+      float charge = mcp->getCharge() ;
+      int type ;
+
+      if( charge > 1e-10 || charge < -1e-10 )
+	type = CHARGED ;
+      else if( pdg == 22 )
+	type = PHOTON ;
+      else if( std::abs( pdg ) == 12 || std::abs( pdg ) == 14 || std::abs( pdg ) == 16 || std::abs( pdg ) == 18 )
+	continue ;  // neutrinos are not reconstructed
+      else
+	type = NEUTRAL_HADRON ;
+
+      const double* p = mcp->getMomentum() ;
+
+      int iRes = findResolution( type, std::atan2( std::sqrt( p[0]*p[0] + p[1]*p[1] ), p[2] ) ) ;
+
+      if( iRes < 0 )
+	continue ;
+
+      _mcp.push_back( mcp ) ;
+      _index.push_back( i ) ;
+      _type.push_back( type ) ;
+      _pdg.push_back( pdg ) ;
+      _px.push_back( p[0] ) ;
+      _py.push_back( p[1] ) ;
+      _pz.push_back( p[2] ) ;
+      _e.push_back( mcp->getEnergy() ) ;
+      _resA.push_back( _res[ type - 1 ][ iRes ].A ) ;
+      _resB.push_back( _res[ type - 1 ][ iRes ].B ) ;
+    }
+
+    unsigned n = _mcp.size() ;
+
+    _gauss.resize( n ) ;
+    _scale.resize( n ) ;
+    _energy.resize( n ) ;
+    _mass.resize( n ) ;
+    _keep.resize( n ) ;
+
+    //---- one Gaussian random number per particle (Box-Muller) from the counter based generator
+
+    for( unsigned i=0 ; i < n ; i++ ){
+
+      unsigned ctr[4] = { unsigned( _index[i] ), 0, 0, 0 } ;
+
+      philox4x32( ctr, seed, FASTMC_STREAM ) ;
+
+      double u1 = ( double( ctr[0] ) + 1. ) * ( 1. / 4294967296. ) ;  // (0,1]
+      double u2 =   double( ctr[1] )        * ( 1. / 4294967296. ) ;  // [0,1)
+
+      _gauss[i] = std::sqrt( -2. * std::log( u1 ) ) * std::cos( 2. * M_PI * u2 ) ;
+    }
+
+    //---- smearing - see SimpleTrackSmearer and SimpleClusterSmearer
+
+    for( unsigned i=0 ; i < n ; i++ ){
+
+      bool charged = ( _type[i] == CHARGED ) ;
+
+      double P = std::sqrt( _px[i]*_px[i] + _py[i]*_py[i] + _pz[i]*_pz[i] ) ;
+
+      // tracks: dP = P*P*d(1/P) - clusters: dE/E = A "+" B / sqrt(E/GeV)
+      double x = ( charged ? P : _e[i] ) ;
+
+      double sigma = ( charged ? x * x * _resA[i] :
+		       x * std::sqrt( _resA[i] * _resA[i] + _resB[i] * _resB[i] / x ) ) ;
+
+      double mag = x + _gauss[i] * sigma ;
+
+      int pdg = std::abs( _pdg[i] ) ;
+
+      // clusters are massless - tracks get the masses used by the SimpleTrackSmearer
+      double mass = ( ! charged ? 0. :
+		      pdg == 12 ? FASTMC_ELECTRON_MASS :
+		      pdg == 13 ? FASTMC_MUON_MASS : FASTMC_PION_MASS ) ;
+
+      // the smeared momentum has the direction of the true one (flipped for a negative magnitude)
+      _scale[i]  = ( P > 0. ? mag / P : 0. ) ;
+      _mass[i]   = mass ;
+      _energy[i] = std::sqrt( mag * mag + mass * mass ) ;
+      _keep[i]   = ( P > 0. && std::fabs( mag ) > _momentumCut ) ;
+    }
+
+    //---- create the output objects
+
+    recCol->reserve( recCol->size() + n ) ;
+    relCol->reserve( relCol->size() + n ) ;
+
+    for( unsigned i=0 ; i < n ; i++ ){
+
+      if( ! _keep[i] )
+	continue ;
+
+      IMPL::ReconstructedParticleImpl* rec = new IMPL::ReconstructedParticleImpl ;
+
+      float p[3] ;
+      p[0] = _px[i] * _scale[i] ;
+      p[1] = _py[i] * _scale[i] ;
+      p[2] = _pz[i] * _scale[i] ;
+
+      rec->setMomentum( p ) ;
+      rec->setEnergy( _energy[i] ) ;
+      rec->setMass( _mass[i] ) ;
+      rec->setCharge( _mcp[i]->getCharge() ) ;
+
+      float vtx[3] ;
+      vtx[0] = _mcp[i]->getVertex()[0] ;
+      vtx[1] = _mcp[i]->getVertex()[1] ;
+      vtx[2] = _mcp[i]->getVertex()[2] ;
+      rec->setReferencePoint( vtx ) ;
+
+      rec->setType( _type[i] ) ;
+
+      recCol->addElement( rec ) ;
+      relCol->addElement( new IMPL::LCRelationImpl( rec , _mcp[i] ) ) ;
+    }
+  }
+
+} // end namespace marlin
@@ -0,0 +1,164 @@
+#include "marlin/FieldMap.h"
+#include "marlin/Global.h"
+#include "marlin/StringParameters.h"
+#include "marlin/Exceptions.h"
+
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+namespace marlin{
+
+
+  FieldMap::FieldMap( const FieldFunction& f, const double* min, const double* max, const int* n ) :
+    _function( f ),
+    _grid(),
+    _bzOrigin(0) {
+
+    for( int i=0 ; i<3 ; ++i ){
+
+      if( n[i] < 2 || ! ( max[i] > min[i] ) ){
+	std::stringstream sstr ;
+	sstr << " FieldMap: invalid grid for coordinate " << i << ": "
+	     << min[i] << " " << max[i] << " " << n[i] ;
+	throw Exception( sstr.str() ) ;
+      }
+      _min[i] = min[i] ;
+      _max[i] = max[i] ;
+      _n[i] = n[i] ;
+      _step[i] = ( max[i] - min[i] ) / ( n[i] - 1 ) ;
+    }
+
+    _grid.resize( 3 * _n[0] * _n[1] * _n[2] ) ;
+
+    double pos[3] ;
+    double* b = &_grid[0] ;
+
+    for( int ix=0 ; ix < _n[0] ; ++ix ){
+      pos[0] = _min[0] + ix * _step[0] ;
+
+      for( int iy=0 ; iy < _n[1] ; ++iy ){
+	pos[1] = _min[1] + iy * _step[1] ;
+
+	for( int iz=0 ; iz < _n[2] ; ++iz , b += 3 ){
+	  pos[2] = _min[2] + iz * _step[2] ;
+
+	  _function( pos , b ) ;
+	}
+      }
+    }
+
+    const double origin[3] = { 0., 0., 0. } ;
+    double bOrigin[3] ;
+    _function( origin , bOrigin ) ;
+    _bzOrigin = bOrigin[2] ;
+  }
+
+
+  FieldMap::FieldMap( const FieldFunction& f ) :
+    _function( f ),
+    _grid(),
+    _bzOrigin(0) {
+
+    std::fill( _min , _min + 3 , 0. ) ;
+    std::fill( _max , _max + 3 , 0. ) ;
+    std::fill( _step , _step + 3 , 0. ) ;
+    std::fill( _n , _n + 3 , 0 ) ;
+
+    const double origin[3] = { 0., 0., 0. } ;
+    double bOrigin[3] ;
+    _function( origin , bOrigin ) ;
+    _bzOrigin = bOrigin[2] ;
+  }
+
+
+  FieldMap* FieldMap::create( const FieldFunction& f ){
+
+    FloatVec grid ;
+
+    if( Global::parameters != 0 )
+      Global::parameters->getFloatVals( "FieldMapGrid" , grid ) ;
+
+    if( grid.empty() )
+      return new FieldMap( f ) ;
+
+    if( grid.size() != 9 ){
+      throw Exception( " FieldMap: global parameter FieldMapGrid needs 9 values:"
+		       " xmin xmax nx ymin ymax ny zmin zmax nz " ) ;
+    }
+
+    double min[3] , max[3] ;
+    int n[3] ;
+
+    for( int i=0 ; i<3 ; ++i ){
+      min[i] = grid[ 3*i ] ;
+      max[i] = grid[ 3*i + 1 ] ;
+      n[i] = int( grid[ 3*i + 2 ] ) ;
+    }
+
+    return new FieldMap( f , min , max , n ) ;
+  }
+
+
+  bool FieldMap::contains( const double* pos ) const {
+
+    if( _grid.empty() ) return false ;
+
+    for( int i=0 ; i<3 ; ++i ){
+      if( ! ( pos[i] >= _min[i] && pos[i] <= _max[i] ) )
+	return false ;
+    }
+    return true ;
+  }
+
+
+  void FieldMap::field( const double* pos, double* b ) const {
+
+    if( ! contains( pos ) ){
+      _function( pos , b ) ;
+      return ;
+    }
+
+    // lower grid point and fractional distance to it for every coordinate
+    int idx[3] ;
+    double t[3] ;
+
+    for( int i=0 ; i<3 ; ++i ){
+
+      double u = ( pos[i] - _min[i] ) / _step[i] ;
+
+      idx[i] = std::min( int( u ) , _n[i] - 2 ) ;
+      t[i] = u - idx[i] ;
+    }
+
+    const int sz = 3 ;
+    const int sy = sz * _n[2] ;
+    const int sx = sy * _n[1] ;
+
+    const double* p = &_grid[ idx[0] * sx + idx[1] * sy + idx[2] * sz ] ;
+
+    for( int c=0 ; c<3 ; ++c ){
+
+      // interpolate along z, then y, then x
+      double c00 = p[ c           ] + t[2] * ( p[ c + sz           ] - p[ c           ] ) ;
+      double c01 = p[ c + sy      ] + t[2] * ( p[ c + sy + sz      ] - p[ c + sy      ] ) ;
+      double c10 = p[ c + sx      ] + t[2] * ( p[ c + sx + sz      ] - p[ c + sx      ] ) ;
+      double c11 = p[ c + sx + sy ] + t[2] * ( p[ c + sx + sy + sz ] - p[ c + sx + sy ] ) ;
+
+      double c0 = c00 + t[1] * ( c01 - c00 ) ;
+      double c1 = c10 + t[1] * ( c11 - c10 ) ;
+
+      b[c] = c0 + t[0] * ( c1 - c0 ) ;
+    }
+  }
+
+
+  double FieldMap::bz( const double* pos ) const {
+
+    double b[3] ;
+    field( pos , b ) ;
+
+    return b[2] ;
+  }
+
+} // end namespace marlin
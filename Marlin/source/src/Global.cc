@@ -12,4 +12,6 @@ namespace marlin{
 
   ProcessorEventSeeder* Global::EVENTSEEDER = 0 ;
 
+  FieldMap* Global::FIELDMAP = 0 ;
+
 }
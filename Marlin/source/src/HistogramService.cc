@@ -0,0 +1,129 @@
+#include "marlin/MarlinConfig.h" // defines MARLIN_CLHEP / MARLIN_AIDA
+
+#ifdef MARLIN_AIDA
+
+#include "marlin/HistogramService.h"
+
+#include <AIDA/ICloud1D.h>
+#include <AIDA/ICloud2D.h>
+#include <AIDA/IHistogram1D.h>
+#include <AIDA/IHistogram2D.h>
+#include <AIDA/IProfile1D.h>
+
+
+namespace marlin {
+
+  HistogramService* HistogramService::instance(){
+
+    static HistogramService* me = new HistogramService ;
+    return me ;
+  }
+
+
+  HistogramService::HistogramService() :
+    _mutex(),
+    _buffers() {
+  }
+
+
+  void HistogramService::fill( AIDA::ICloud1D* c, double x, double weight ){
+    add( CLOUD1D , c , x , 0. , weight ) ;
+  }
+
+  void HistogramService::fill( AIDA::ICloud2D* c, double x, double y, double weight ){
+    add( CLOUD2D , c , x , y , weight ) ;
+  }
+
+  void HistogramService::fill( AIDA::IHistogram1D* h, double x, double weight ){
+    add( HISTOGRAM1D , h , x , 0. , weight ) ;
+  }
+
+  void HistogramService::fill( AIDA::IHistogram2D* h, double x, double y, double weight ){
+    add( HISTOGRAM2D , h , x , y , weight ) ;
+  }
+
+  void HistogramService::fill( AIDA::IProfile1D* p, double x, double y, double weight ){
+    add( PROFILE1D , p , x , y , weight ) ;
+  }
+
+
+  void HistogramService::add( FillType type, void* object, double x, double y, double weight ){
+
+    FillBuffer* buf = buffer() ;
+
+    Fill f = { type , object , x , y , weight } ;
+    buf->push_back( f ) ;
+
+    if( buf->size() >= BUFFERSIZE ){
+
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      apply( *buf ) ;
+    }
+  }
+
+
+  HistogramService::FillBuffer* HistogramService::buffer(){
+
+    static thread_local FillBuffer* buf = 0 ;
+
+    if( buf == 0 ){
+
+      buf = new FillBuffer ;
+      buf->reserve( BUFFERSIZE ) ;
+
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      _buffers.push_back( buf ) ;
+    }
+    return buf ;
+  }
+
+
+  void HistogramService::flush(){
+
+    FillBuffer* buf = buffer() ;
+
+    if( buf->empty() ) return ;
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    apply( *buf ) ;
+  }
+
+
+  void HistogramService::flushAll(){
+
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+
+    for( unsigned i=0 ; i < _buffers.size() ; ++i )
+      apply( *_buffers[i] ) ;
+  }
+
+
+  void HistogramService::apply( FillBuffer& buf ){
+
+    for( FillBuffer::const_iterator it = buf.begin() ; it != buf.end() ; ++it ){
+
+      switch( it->type ){
+
+      case CLOUD1D:
+	static_cast<AIDA::ICloud1D*>( it->object )->fill( it->x , it->weight ) ;
+	break ;
+      case CLOUD2D:
+	static_cast<AIDA::ICloud2D*>( it->object )->fill( it->x , it->y , it->weight ) ;
+	break ;
+      case HISTOGRAM1D:
+	static_cast<AIDA::IHistogram1D*>( it->object )->fill( it->x , it->weight ) ;
+	break ;
+      case HISTOGRAM2D:
+	static_cast<AIDA::IHistogram2D*>( it->object )->fill( it->x , it->y , it->weight ) ;
+	break ;
+      case PROFILE1D:
+	static_cast<AIDA::IProfile1D*>( it->object )->fill( it->x , it->y , it->weight ) ;
+	break ;
+      }
+    }
+    buf.clear() ;
+  }
+
+} // namespace
+
+#endif // MARLIN_AIDA
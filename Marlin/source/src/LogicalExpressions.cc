@@ -31,6 +31,13 @@ namespace marlin{
 //     std::cout << " LogicalExpressions::addCondition( " << name << ", " << expression << " ) " << std::endl ;
   }
   
+  std::string LogicalExpressions::getCondition( const std::string& name ) const {
+
+    ConditionsMap::const_iterator it = _condMap.find( name ) ;
+
+    return ( it != _condMap.end() ? it->second : "" ) ;
+  }
+
   void LogicalExpressions::clear() {
 
     for( ResultMap::iterator it = _resultMap.begin() ; it != _resultMap.end() ; it++){
@@ -20,6 +20,8 @@
 #include "marlin/XMLParser.h"
 
 #include "marlin/Global.h"
+#include "marlin/AsyncLogBuffer.h"
+#include "marlin/FieldMap.h"
 
 #include "marlin/MarlinSteerCheck.h"
 #include "marlin/XMLFixCollTypes.h"
@@ -32,12 +34,19 @@
 
 #include <cstring>
 #include <algorithm>
+#include <memory>
+#include <set>
+#include <vector>
+#include <iomanip>
+#include <chrono>
 
 
 #include "gearimpl/Util.h"
 #include "gearxml/GearXML.h"
 #include "gearxml/MergeXML.h"
 #include "gearimpl/GearMgrImpl.h"
+#include "gearimpl/Vector3D.h"
+#include "gear/BField.h"
 
 #include "marlin/ProcessorLoader.h"
 
@@ -57,6 +66,10 @@ void listAvailableProcessors() ;
 void listAvailableProcessorsXML() ;
 int printUsage() ;
 
+std::set<std::string> activeProcessorTypes( const IParser& parser ) ;
+void startupStep( const std::string& step ) ;
+void printStartupTimes() ;
+
 
 // Handle user interruption
 // This allows you to ^\ at any point to exit in a controlled way
@@ -108,9 +121,27 @@ int main(int argc, char** argv ){
 
     std::for_each( marlinProcs.begin(), marlinProcs.end(), t ) ;
 
-    ProcessorLoader loader( libs.begin() , libs.end()  ) ;
-    if( loader.failedLoading() ){
-        return(1);
+    // with a manifest the libraries declared with MARLIN_PROCESSOR_ONLY_LIBRARY are only loaded
+    // if they provide an active processor - after parsing the steering file - unless an option
+    // like -x or -c needs all processors; all other libraries are always loaded
+    const char* manifest = getenv("MARLIN_DLL_MANIFEST" ) ;
+
+    bool lazyLoading = ( manifest != 0 ) ;
+
+    for( int i = 1 ; i < argc ; i++ ) {
+        if( argv[i][0] == '-' && argv[i][1] != '-' && std::string(argv[i]) != "-v" )
+            lazyLoading = false ;
+    }
+
+    std::unique_ptr<ProcessorLoader> loader ;
+
+    if( ! lazyLoading ){
+
+        loader.reset( new ProcessorLoader( libs.begin() , libs.end()  ) ) ;
+        if( loader->failedLoading() ){
+            return(1);
+        }
+        startupStep( "load libraries" ) ;
     }
 
     //------- end processor libs -------------------------
@@ -120,6 +151,9 @@ int main(int argc, char** argv ){
 
     const char* steeringFileName = "none"  ;
 
+    // only check the steering file and the processors' parameters - no GEAR, no init()
+    bool validateOnly = false ;
+
     //map<string, map<string,string> > cmdlineparams; 
     CommandLineParametersMap cmdlineparams; 
 
@@ -251,10 +285,19 @@ int main(int argc, char** argv ){
 
             return printUsage() ;
         }
+        else if( std::string(argv[1]) == "-v" ){
+            if( argc == 3 ){
+                validateOnly = true ;
+            }
+            else{
+                std::cout << "  usage: Marlin -v steer.xml" << std::endl << std::endl;
+                return(1);
+            }
+        }
 
 
         // one argument given: the steering file for normal running :
-        steeringFileName = argv[1] ;
+        steeringFileName = argv[ validateOnly ? 2 : 1 ] ;
 
     } else {
 
@@ -300,6 +343,23 @@ int main(int argc, char** argv ){
         return(1) ;
     }
 
+    startupStep( "parse steering file" ) ;
+
+    if( lazyLoading ){
+
+        loader.reset( new ProcessorLoader( libs.begin() , libs.end() , manifest , activeProcessorTypes( *parser ) ) ) ;
+        if( loader->failedLoading() ){
+            return(1);
+        }
+        startupStep( "load libraries" ) ;
+    }
+
+    //-------- optionally write all output from a background thread ------------
+    if( Global::parameters->getStringVal("AsynchronousLogging") == "true" ) {
+
+        AsyncLogBuffer::instance()->start( std::cout ) ;
+    }
+
 
     // //-----  register log level names with the logstream ---------
     streamlog::out.addLevelName<DEBUG>() ;
@@ -357,6 +417,18 @@ int main(int argc, char** argv ){
 
     createProcessors( *parser ) ;
 
+    startupStep( "create processors" ) ;
+
+    if( validateOnly ){
+
+        int nErrors = ProcessorMgr::instance()->validateActiveProcessors() ;
+
+        std::cout << std::endl << "<!-- steering file " << steeringFileName
+                  << ( nErrors == 0 ? " is valid" : " has errors" ) << " -->" << std::endl ;
+
+        return( nErrors == 0 ? 0 : 1 ) ;
+    }
+
 
     //#ifdef USE_GEAR
 
@@ -415,6 +487,23 @@ int main(int argc, char** argv ){
         Global::GEAR = new gear::GearMgrImpl ;
     }
 
+    //-------- field map shared by all processors ------------
+    try{
+
+      const gear::BField& bField = Global::GEAR->getBField() ;
+
+      Global::FIELDMAP = FieldMap::create( [&bField]( const double* pos, double* b ){
+	  gear::Vector3D v = bField.at( gear::Vector3D( pos[0], pos[1], pos[2] ) ) ;
+	  b[0] = v.x() ; b[1] = v.y() ; b[2] = v.z() ;
+	} ) ;
+
+    } catch( gear::UnknownParameterException& ) {
+
+      streamlog_out( DEBUG ) << " ---- no magnetic field in GEAR - Global::FIELDMAP not created " << std::endl ;
+    }
+
+    startupStep( "GEAR and field map" ) ;
+
     //#endif
 
     StringVec lcioInputFiles ; 
@@ -423,6 +512,8 @@ int main(int argc, char** argv ){
 
         int maxRecord = Global::parameters->getIntVal("MaxRecordNumber");
         ProcessorMgr::instance()->init() ; 
+        startupStep( "init processors" ) ;
+        printStartupTimes() ;
         // fixme: pass maxRecord-1 (because of the runheader, which is generated)?
         ProcessorMgr::instance()->readDataSource(maxRecord) ; 
         ProcessorMgr::instance()->end() ; 
@@ -474,6 +565,8 @@ int main(int argc, char** argv ){
         lcReader->registerLCEventListener( ProcessorMgr::instance() ) ; 
 
         ProcessorMgr::instance()->init() ; 
+        startupStep( "init processors" ) ;
+        printStartupTimes() ;
 
         bool rewind = true ;
 
@@ -553,6 +646,8 @@ int main(int argc, char** argv ){
 
     //#ifdef USE_GEAR  
 
+    delete Global::FIELDMAP ;
+
     if(  Global::GEAR != 0 ) 
         delete Global::GEAR ; 
 
@@ -655,6 +750,60 @@ void listAvailableProcessorsXML() {
 }
 
 
+std::set<std::string> activeProcessorTypes( const IParser& parser ) {
+
+    std::set<std::string> types ;
+
+    StringVec activeProcessors ;
+    Global::parameters->getStringVals("ActiveProcessors" , activeProcessors ) ;
+
+    for(unsigned int i=0 ; i<  activeProcessors.size() ; i++ ) {
+
+        StringParameters* p = parser.getParameters( activeProcessors[i] )  ;
+
+        if( p!=0 )
+            types.insert( p->getStringVal("ProcessorType") ) ;
+    }
+    return types ;
+}
+
+
+// wall clock time of the steps before the event loop
+typedef std::chrono::steady_clock StartupClock ;
+static StartupClock::time_point startupStepBegin = StartupClock::now() ;
+static std::vector< std::pair< std::string , double > > startupTimes ;
+
+void startupStep( const std::string& step ) {
+
+    StartupClock::time_point now = StartupClock::now() ;
+
+    startupTimes.push_back( std::make_pair( step , std::chrono::duration<double>( now - startupStepBegin ).count() ) ) ;
+
+    startupStepBegin = now ;
+}
+
+void printStartupTimes() {
+
+    streamlog_out(MESSAGE)  << " --------------------------------------------------------- " << std::endl
+        << "      Startup time :      " << std::endl
+        << std::endl ;
+
+    double tTotal = 0.0 ;
+
+    for( unsigned i=0 ; i < startupTimes.size() ; ++i ) {
+
+        streamlog_out(MESSAGE)  << "   " << std::left << std::setw(34) << startupTimes[i].first << std::right
+            <<  std::setw(12) << std::scientific  << startupTimes[i].second << " s " << std::endl ;
+
+        tTotal += startupTimes[i].second ;
+    }
+
+    streamlog_out(MESSAGE)  <<  "            Total:                   "
+        <<  std::setw(12) << std::scientific  << tTotal << " s " << std::endl
+        << " --------------------------------------------------------- " << std::endl ;
+}
+
+
 int printUsage() {
 
   std::cout << " Usage: Marlin [OPTION] [FILE]..." << std::endl 
@@ -666,6 +815,7 @@ int printUsage() {
 	    << "   Marlin [-h/-?]             \t print this help information" << std::endl 
 	    << "   Marlin -x                  \t print an example steering file to stdout" << std::endl 
 	    << "   Marlin -c steer.xml        \t check the given steering file for consistency" << std::endl 
+	    << "   Marlin -v steer.xml        \t only check processor types and parameters of the steering file" << std::endl 
 	    << "   Marlin -u old.xml new.xml  \t consistency check with update of xml file"  << std::endl
 	    << "   Marlin -d steer.xml flow.dot\t create a program flow diagram (see: http://www.graphviz.org)" << std::endl 
 	    << "   Marlin -l                  \t [deprecated: old format steering file example]" << std::endl 
@@ -682,6 +832,11 @@ int printUsage() {
 	    << "     Marlin --global.LCIOInputFiles=\"input1.slcio input2.slcio\" --global.GearXMLFile=mydetector.xml" << std::endl 
 	    << "            --MyLCIOOutputProcessor.LCIOWriteMode=WRITE_APPEND --MyLCIOOutputProcessor.LCIOOutputFile=out.slcio steer.xml" << std::endl << std::endl
 	    << "     NOTE: Dynamic options do NOT work together with Marlin options (-x, -f, -l) nor with the MarlinGUI or old steering files" << std::endl 
+	    << std::endl 
+	    << " Environment: " << std::endl 
+	    << "   MARLIN_DLL             \t colon separated list of processor libraries" << std::endl 
+	    << "   MARLIN_DLL_MANIFEST    \t cache file of the processor types per library - only the needed libraries are loaded" << std::endl 
+	    << "   MARLIN_STEERING_CACHE  \t directory for parsed xml steering files - unchanged files are not parsed again" << std::endl 
 	    << std::endl ;
   
   return(0) ;
@@ -1,5 +1,6 @@
 #include "marlin/Processor.h"
 #include "marlin/ProcessorMgr.h" 
+#include "marlin/ProcessorScheduler.h"
 #include "marlin/Global.h"
 #include "marlin/VerbosityLevels.h"
 
@@ -17,7 +18,8 @@ namespace marlin{
     _parameters(0) ,
     _isFirstEvent( true ),
     _logLevelName(""),
-    _str(0) {
+    _str(0),
+    _concurrent(false) {
   
     //register processor in map
     ProcessorMgr::instance()->registerProcessor( this ) ;
@@ -31,7 +33,7 @@ namespace marlin{
   }
 
 
-  Processor::Processor() : _parameters(NULL), _isFirstEvent(false), _str(NULL) {}
+  Processor::Processor() : _parameters(NULL), _isFirstEvent(false), _str(NULL), _concurrent(false) {}
 
   Processor::~Processor() {
 
@@ -88,6 +90,11 @@ namespace marlin{
 
 
 
+  Processor::LogLock::LogLock() { ProcessorScheduler::logMutex().lock() ; }
+
+  Processor::LogLock::~LogLock() { ProcessorScheduler::logMutex().unlock() ; }
+
+
   void Processor::printParameters() { printParameters<MESSAGE>() ;  }
 
   void Processor::printDescription() {
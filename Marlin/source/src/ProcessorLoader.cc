@@ -1,9 +1,18 @@
 #include "marlin/ProcessorLoader.h"
+#include "marlin/ProcessorMgr.h"
 
 #include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <cstdlib>
+#include <cstdio>
 #include <set>
+#include <map>
+#include <iterator>
+#include <algorithm>
 
 
 namespace marlin{
@@ -17,59 +26,261 @@ ProcessorLoader::ProcessorLoader(
     _loadError=false;
     lcio::StringVec::const_iterator current = first ;
 
-    std::set<std::string> _checkDuplicateLibs;
-
     while( current != last ){
 
-        std::string libName( *current ) ;
-        size_t idx;
-        idx = libName.find_last_of("/");
-        // the library basename, i.e. /path/to/libBlah.so --> libBlah.so
-        std::string libBaseName( libName.substr( idx + 1 ) );
+        load( *current ) ;
+
+        ++current ;
+
+    }
+}
+
+
+namespace {
+
+    /** Manifest entry: size and modification time of the library, whether it declared with
+     *  MARLIN_PROCESSOR_ONLY_LIBRARY that it registers nothing but processors, and the processor
+     *  types it registers */
+    struct ManifestEntry {
+        long long size ;
+        long long mtime ;
+        bool processorsOnly ;
+        std::set<std::string> types ;
+    } ;
+
+    typedef std::map< std::string, ManifestEntry > Manifest ;
+
+    bool fileStat( const std::string& fileName, long long& size, long long& mtime ){
+
+        struct stat st ;
+
+        if( stat( fileName.c_str() , &st ) != 0 )
+            return false ;
+
+        size = st.st_size ;
+        mtime = st.st_mtime ;
+        return true ;
+    }
+
+    /** True if the library with the given handle defines the symbol of MARLIN_PROCESSOR_ONLY_LIBRARY
+     *  itself, i.e. not only one of the libraries it depends on */
+    bool isProcessorsOnly( void* handle, const std::string& libName ){
+
+        void* sym = dlsym( handle , "marlin_processor_only_library" ) ;
+
+        Dl_info info ;
+
+        if( sym == 0 || dladdr( sym , &info ) == 0 || info.dli_fname == 0 )
+            return false ;
+
+        char* symPath = realpath( info.dli_fname , NULL ) ;
+        char* libPath = realpath( libName.c_str() , NULL ) ;
+
+        bool same = ( symPath != NULL && libPath != NULL && std::string( symPath ) == libPath ) ;
+
+        free( symPath ) ;
+        free( libPath ) ;
+
+        return same ;
+    }
+
+    // one line per library:  path size mtime +|- type1 type2 ...   ( + : only processors )
+    void readManifest( const std::string& fileName, Manifest& manifest ){
+
+        std::ifstream in( fileName.c_str() ) ;
+        std::string line ;
 
-        char *real_path = realpath(libName.c_str(), NULL);
+        while( std::getline( in , line ) ){
 
-        if( real_path != NULL ){
-            std::cout << "<!-- Loading shared library : " << real_path << " ("<< libBaseName << ")-->" << std::endl ;
+            std::istringstream fields( line ) ;
+            std::string lib , flag ;
+            ManifestEntry e ;
 
-            // use real_path
-            free(real_path);
+            if( ! ( fields >> lib >> e.size >> e.mtime >> flag ) || ( flag != "+" && flag != "-" ) )
+                continue ;
+
+            e.processorsOnly = ( flag == "+" ) ;
+
+            std::string type ;
+            while( fields >> type )
+                e.types.insert( type ) ;
+
+            manifest[ lib ] = e ;
         }
-        else{
-            std::cout << "<!-- Loading shared library : " << libName << " ("<< libBaseName << ")-->" << std::endl ;
+    }
+
+    void writeManifest( const std::string& fileName, const Manifest& manifest ){
+
+        // write to a temporary file and rename, so that concurrent jobs never read a partial manifest
+        std::stringstream tmpName ;
+        tmpName << fileName << ".tmp." << getpid() ;
+
+        {
+            std::ofstream out( tmpName.str().c_str() ) ;
+
+            for( Manifest::const_iterator it = manifest.begin() ; it != manifest.end() ; ++it ){
+
+                out << it->first << " " << it->second.size << " " << it->second.mtime
+                    << " " << ( it->second.processorsOnly ? "+" : "-" ) ;
+
+                for( std::set<std::string>::const_iterator t = it->second.types.begin() ; t != it->second.types.end() ; ++t )
+                    out << " " << *t ;
+
+                out << "\n" ;
+            }
+
+            if( ! out ){
+                std::cout << "<!-- WARNING could not write processor manifest : " << tmpName.str() << " -->" << std::endl ;
+                return ;
+            }
         }
 
-        
-        if( _checkDuplicateLibs.find( libBaseName ) == _checkDuplicateLibs.end() ){
-            _checkDuplicateLibs.insert( libBaseName ) ;
+        if( rename( tmpName.str().c_str() , fileName.c_str() ) != 0 ){
+            std::cout << "<!-- WARNING could not write processor manifest : " << fileName << " -->" << std::endl ;
+            remove( tmpName.str().c_str() ) ;
         }
-        else{
-            std::cout << std::endl << "<!-- ERROR loading shared library : " << libName << std::endl
-                << "    ->    Trying to load DUPLICATE library -->" << std::endl << std::endl ;
-            _loadError=true;
+    }
+
+    bool intersect( const std::set<std::string>& a , const std::set<std::string>& b ){
+
+        for( std::set<std::string>::const_iterator it = a.begin() ; it != a.end() ; ++it ){
+            if( b.find( *it ) != b.end() )
+                return true ;
         }
+        return false ;
+    }
+}
 
 
-        if( ! _loadError ){
+ProcessorLoader::ProcessorLoader(
+        lcio::StringVec::const_iterator first, 
+        lcio::StringVec::const_iterator last,
+        const std::string& manifestFile,
+        const std::set<std::string>& processorTypes ) {
 
-            //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW) ;
-            //void* libPointer  = dlopen( libName.c_str() , RTLD_LAZY ) ;
-            //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW | RTLD_GLOBAL) ;
-            void* libPointer  = dlopen( libName.c_str() , RTLD_LAZY | RTLD_GLOBAL) ;
 
-            if( libPointer == 0 ){
-                std::cout << std::endl << "<!-- ERROR loading shared library : " << libName << std::endl
-                          << "    ->    "   << dlerror() << " -->" << std::endl << std::endl ;
-                _loadError=true;
-            }
-            else{
-                _libs.push_back( libPointer ) ;
-            }
+    _loadError=false;
+
+    Manifest manifest ;
+    readManifest( manifestFile , manifest ) ;
+
+    bool modified = false ;
+
+    std::vector<std::string> skipped ;
+
+    for( lcio::StringVec::const_iterator current = first ; current != last && ! _loadError ; ++current ){
+
+        const std::string& libName = *current ;
+
+        long long size = -1 , mtime = -1 ;
+        fileStat( libName , size , mtime ) ;
+
+        Manifest::iterator it = manifest.find( libName ) ;
+
+        bool known = ( it != manifest.end() && it->second.size == size && it->second.mtime == mtime ) ;
+
+        // libraries that might register anything else than processors, e.g. conditions handlers or
+        // other global objects, are always loaded
+        if( known && it->second.processorsOnly && ! intersect( it->second.types , processorTypes ) ){
+
+            skipped.push_back( libName ) ;
+            continue ;
         }
 
-        ++current ;
+        std::set<std::string> before = ProcessorMgr::instance()->getAvailableProcessorTypes() ;
+
+        if( ! load( libName ) || known )
+            continue ;
+
+        // new or changed library - record the processor types it registered
+        std::set<std::string> after = ProcessorMgr::instance()->getAvailableProcessorTypes() ;
+
+        ManifestEntry& e = manifest[ libName ] ;
+        e.size = size ;
+        e.mtime = mtime ;
+        e.processorsOnly = isProcessorsOnly( _libs.back() , libName ) ;
+        e.types.clear() ;
+        std::set_difference( after.begin() , after.end() , before.begin() , before.end() ,
+                             std::inserter( e.types , e.types.begin() ) ) ;
+        modified = true ;
+    }
+
+    // fall back to loading everything if a processor type is still missing, e.g. a stale manifest
+    std::set<std::string> available = ProcessorMgr::instance()->getAvailableProcessorTypes() ;
+
+    bool missing = false ;
+    for( std::set<std::string>::const_iterator t = processorTypes.begin() ; t != processorTypes.end() ; ++t ){
+        if( available.find( *t ) == available.end() )
+            missing = true ;
+    }
+
+    if( missing && ! skipped.empty() && ! _loadError ){
+
+        std::cout << "<!-- processor type(s) not found in manifest " << manifestFile
+                  << " - loading all libraries -->" << std::endl ;
+
+        for( unsigned i=0 ; i < skipped.size() && ! _loadError ; ++i )
+            load( skipped[i] ) ;
+
+        skipped.clear() ;
+    }
+
+    for( unsigned i=0 ; i < skipped.size() ; ++i )
+        std::cout << "<!-- Skipping shared library : " << skipped[i] << " (no active processor) -->" << std::endl ;
+
+    if( modified && ! _loadError )
+        writeManifest( manifestFile , manifest ) ;
+}
+
+
+bool ProcessorLoader::load( const std::string& libName ){
+
+    size_t idx;
+    idx = libName.find_last_of("/");
+    // the library basename, i.e. /path/to/libBlah.so --> libBlah.so
+    std::string libBaseName( libName.substr( idx + 1 ) );
+
+    char *real_path = realpath(libName.c_str(), NULL);
+
+    if( real_path != NULL ){
+        std::cout << "<!-- Loading shared library : " << real_path << " ("<< libBaseName << ")-->" << std::endl ;
+
+        // use real_path
+        free(real_path);
+    }
+    else{
+        std::cout << "<!-- Loading shared library : " << libName << " ("<< libBaseName << ")-->" << std::endl ;
+    }
+
 
+    if( _libBaseNames.find( libBaseName ) == _libBaseNames.end() ){
+        _libBaseNames.insert( libBaseName ) ;
     }
+    else{
+        std::cout << std::endl << "<!-- ERROR loading shared library : " << libName << std::endl
+            << "    ->    Trying to load DUPLICATE library -->" << std::endl << std::endl ;
+        _loadError=true;
+    }
+
+
+    if( ! _loadError ){
+
+        //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW) ;
+        //void* libPointer  = dlopen( libName.c_str() , RTLD_LAZY ) ;
+        //void* libPointer  = dlopen( libName.c_str() , RTLD_NOW | RTLD_GLOBAL) ;
+        void* libPointer  = dlopen( libName.c_str() , RTLD_LAZY | RTLD_GLOBAL) ;
+
+        if( libPointer == 0 ){
+            std::cout << std::endl << "<!-- ERROR loading shared library : " << libName << std::endl
+                      << "    ->    "   << dlerror() << " -->" << std::endl << std::endl ;
+            _loadError=true;
+        }
+        else{
+            _libs.push_back( libPointer ) ;
+        }
+    }
+
+    return ! _loadError ;
 }
 
 
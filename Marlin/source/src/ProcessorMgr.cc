@@ -15,6 +15,10 @@
 #include "streamlog/logbuffer.h"
 
 #include <time.h>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <exception>
 
 namespace marlin{
 
@@ -24,6 +28,11 @@ namespace marlin{
     typedef std::map< Processor* , std::pair< double  , int > > TimeMap ;
     static TimeMap tMap ;
 
+    // protects the conditions while processors run concurrently
+    static std::mutex conditionsMutex ;
+
+    typedef std::chrono::steady_clock InitClock ;
+
 
 
     // helper for sorting procs wrt to processing time
@@ -45,7 +54,45 @@ namespace marlin{
     // create a dummy streamlog stream for std::cout 
     streamlog::logstream my_cout ;
 
-  ProcessorMgr::ProcessorMgr(){
+
+    // print the wall clock time of every processor's init() in the order of the execute section
+    static void printInitTimes( const ProcessorList& procs , const std::map< Processor* , double >& initTimes , double tWall ){
+
+        streamlog_out(MESSAGE)  << " --------------------------------------------------------- " << std::endl
+            << "      Time used by processors ( in init() ) :      " << std::endl
+            << std::endl ;
+
+        double tTotal = 0.0 ;
+
+        for( std::map< Processor* , double >::const_iterator it = initTimes.begin() ; it != initTimes.end() ; ++it )
+            tTotal += it->second ;
+
+        for( ProcessorList::const_iterator it = procs.begin() ; it != procs.end() ; ++it ) {
+
+            std::map< Processor* , double >::const_iterator itT = initTimes.find( *it ) ;
+
+            if( itT == initTimes.end() ) continue ;
+
+            // copy string to fixed size char* - see end()
+            char cName[40] = "                                     "  ;
+            const std::string& sName = (*it)->name()  ;
+            unsigned nChar = ( sName.size() > 30 ?  30 : sName.size() )  ;
+            for(unsigned  i=0 ; i< nChar ; i++ ) {
+                cName[i] = sName[i] ;
+            }
+
+            streamlog_out(MESSAGE)  <<  cName
+                <<  std::setw(12) << std::scientific  << itT->second << " s "
+                <<  ( (*it)->hasIndependentInit() ? " (independent)" : "" ) << std::endl ;
+        }
+
+        streamlog_out(MESSAGE)  <<  "            Total:                   "
+            <<  std::setw(12) << std::scientific  << tTotal << " s  - wall clock: "
+            <<  std::setw(12) << std::scientific  << tWall << " s " << std::endl
+            << " --------------------------------------------------------- " << std::endl ;
+    }
+
+  ProcessorMgr::ProcessorMgr() : _scheduler(0) {
     if( Global::EVENTSEEDER == NULL ) {
       Global::EVENTSEEDER = new ProcessorEventSeeder() ;
     }
@@ -68,6 +115,7 @@ namespace marlin{
   
   
   ProcessorMgr::~ProcessorMgr(){
+    delete _scheduler ;
     delete Global::EVENTSEEDER ;
     Global::EVENTSEEDER = NULL ;
   }
@@ -177,6 +225,14 @@ namespace marlin{
 		   <<  "  <parameter name=\"RandomSeed\" value=\"1234567890\" />" << std::endl
 		   <<  "  <!-- optionally limit the collections that are read from the input file: -->  " << std::endl
 		   <<  "  <!--parameter name=\"LCIOReadCollectionNames\">MCParticle PandoraPFOs</parameter-->" << std::endl
+		   <<  "  <!-- optionally run independent processors concurrently on n threads: -->  " << std::endl
+		   <<  "  <!--parameter name=\"ConcurrentProcessors\" value=\"4\" /-->" << std::endl
+		   <<  "  <!-- optionally call init() of processors with an independent init concurrently: -->  " << std::endl
+		   <<  "  <!--parameter name=\"ConcurrentInit\" value=\"true\" /-->" << std::endl
+		   <<  "  <!-- optionally write the log output from a background thread: -->  " << std::endl
+		   <<  "  <!--parameter name=\"AsynchronousLogging\" value=\"true\" /-->" << std::endl
+		   <<  "  <!-- optionally precompute the magnetic field on a grid: xmin xmax nx ymin ymax ny zmin zmax nz [mm] -->  " << std::endl
+		   <<  "  <!--parameter name=\"FieldMapGrid\"> -3000 3000 61 -3000 3000 61 -4000 4000 81 </parameter-->" << std::endl
 		   <<  " </global>" << std::endl
 		   << std::endl ;
 
@@ -190,6 +246,37 @@ namespace marlin{
 
     }
 
+    int ProcessorMgr::validateActiveProcessors(){
+
+        int nErrors = 0 ;
+
+        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
+
+            StringParameters* parameters = (*it)->parameters() ;
+
+            if( parameters == 0 ) continue ;
+
+            StringVec keys ;
+            parameters->getStringKeys( keys ) ;
+
+            for( unsigned i=0 ; i < keys.size() ; ++i ) {
+
+                // added by the parser
+                if( keys[i] == "ProcessorType" || keys[i].compare( 0 , 8 , "_marlin." ) == 0 )
+                    continue ;
+
+                if( (*it)->_map.find( keys[i] ) == (*it)->_map.end() ) {
+
+                    streamlog_out( ERROR ) << " processor " << (*it)->name() << " of type " << (*it)->type()
+                                           << " has no parameter " << keys[i] << std::endl ;
+                    ++nErrors ;
+                }
+            }
+        }
+
+        return nErrors ;
+    }
+
     std::set< std::string > ProcessorMgr::getAvailableProcessorTypes(){
 
         std::set< std::string > ptypes;
@@ -268,14 +355,63 @@ namespace marlin{
 
         //     for_each( _list.begin() , _list.end() , std::mem_fun( &Processor::baseInit ) ) ;
 
-        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
-	  
+	// processors with an independent init() are initialized on their own threads after the
+	// others have been initialized in the order of the execute section, so that the global
+	// log scopes set for these are not changed while the threads run - the threads log in
+	// the global scope under ProcessorScheduler::logMutex()
+	bool concurrentInit = ( Global::parameters->getStringVal("ConcurrentInit") == "true" ) ;
+
+	std::vector<std::thread> initThreads ;
+	std::exception_ptr initError ;
+	std::mutex initMutex ;
+	std::map< Processor* , double > initTimes ;
+
+	InitClock::time_point tInit = InitClock::now() ;
+
+	auto timedInit = [&]( Processor* p ){
+	  InitClock::time_point t0 = InitClock::now() ;
+	  try{
+	    p->baseInit() ;
+	  } catch(...) {
+	    std::lock_guard<std::mutex> lock( initMutex ) ;
+	    if( ! initError ) initError = std::current_exception() ;
+	  }
+	  std::lock_guard<std::mutex> lock( initMutex ) ;
+	  initTimes[ p ] = std::chrono::duration<double>( InitClock::now() - t0 ).count() ;
+	} ;
+
+	bool failed = false ;
+
+        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() && ! failed ; ++it ) {
+
+	  if( concurrentInit && (*it)->hasIndependentInit() )
+	    continue ;
+
 	  streamlog::logscope scope( streamlog::out ) ; scope.setName(  (*it)->name()  ) ;
 	  scope.setLevel( (*it)->logLevelName() ) ;
 	  
 	  streamlog::logscope scope1(  my_cout ) ; scope1.setName(  (*it)->name()  ) ;
 	  
-	  (*it)->baseInit() ;
+	  timedInit( *it ) ;
+
+	  failed = ( initError != nullptr ) ;
+	}
+
+        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() && ! failed ; ++it ) {
+
+	  if( concurrentInit && (*it)->hasIndependentInit() )
+	    initThreads.push_back( std::thread( timedInit , *it ) ) ;
+	}
+
+	for( unsigned i=0 ; i < initThreads.size() ; ++i )
+	  initThreads[i].join() ;
+
+	if( initError )
+	  std::rethrow_exception( initError ) ;
+
+	printInitTimes( _list , initTimes , std::chrono::duration<double>( InitClock::now() - tInit ).count() ) ;
+
+        for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
 	  
 	  tMap[ *it ] = std::make_pair( 0 , 0 )  ;
 	  
@@ -293,6 +429,23 @@ namespace marlin{
 	  }
 
 	}
+
+	// processors are called sequentially unless ConcurrentProcessors > 1
+	int nThreads = Global::parameters->getIntVal("ConcurrentProcessors") ;
+
+	bool modify = ( Global::parameters->getStringVal("AllowToModifyEvent") == "true" ) ;
+
+	if( nThreads > 1 && modify ) {
+
+	  streamlog_out( WARNING ) << " ConcurrentProcessors is ignored with AllowToModifyEvent=true "
+				   << " - processors are called sequentially" << std::endl ;
+
+	} else if( nThreads > 1 ) {
+
+	  _scheduler = new ProcessorScheduler( _list , _conditions , conditionsMutex , nThreads ) ;
+
+	  _scheduler->printDependencies() ;
+	}
     }
 
     void ProcessorMgr::processRunHeader( LCRunHeader* run){ 
@@ -458,6 +611,19 @@ namespace marlin{
 	// refresh the seeds for this event
 	Global::EVENTSEEDER->refreshSeeds( evt ) ;
  
+        if( _scheduler != 0 ) {
+
+	  try{ 
+
+	    _scheduler->processEvent( evt , check ) ;
+
+	  } catch( SkipEventException& e){
+
+	    ++ _skipMap[ e.what() ] ;
+	  }  
+	  return ;
+	}
+
         try{ 
 
             for( ProcessorList::iterator it = _list.begin() ; it != _list.end() ; ++it ) {
@@ -497,6 +663,7 @@ namespace marlin{
 
     void ProcessorMgr::setProcessorReturnValue( Processor* proc, bool val ) {
 
+        std::lock_guard<std::mutex> lock( conditionsMutex ) ;
         _conditions.setValue( proc->name() , val ) ;
 
     }
@@ -504,6 +671,8 @@ namespace marlin{
             const std::string& name){
 
         std::string valName = proc->name() + "." + name ;
+
+        std::lock_guard<std::mutex> lock( conditionsMutex ) ;
         _conditions.setValue( valName , val ) ;
     }
 
@@ -541,6 +710,15 @@ namespace marlin{
 
         // ----- print timing information ----------
 
+        if( _scheduler != 0 ) {
+
+	  _scheduler->printStatistics() ;
+
+	  delete _scheduler ;
+	  _scheduler = 0 ;
+	  return ;
+	}
+
         streamlog_out(MESSAGE)  << " --------------------------------------------------------- " << std::endl
             << "      Time used by processors ( in processEvent() ) :      " << std::endl 
                                                                                 << std::endl ;
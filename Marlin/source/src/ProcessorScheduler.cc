@@ -0,0 +1,651 @@
+#include "marlin/ProcessorScheduler.h"
+#include "marlin/Processor.h"
+#include "marlin/LogicalExpressions.h"
+#include "marlin/LCIOOutputProcessor.h"
+#include "marlin/EventModifier.h"
+#include "marlin/Exceptions.h"
+
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCParameters.h"
+
+#include "streamlog/streamlog.h"
+
+#include <set>
+#include <map>
+#include <deque>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+
+namespace marlin{
+
+  namespace {
+
+    typedef std::chrono::steady_clock Clock ;
+
+    double seconds( const Clock::time_point& t0 , const Clock::time_point& t1 ){
+      return std::chrono::duration<double>( t1 - t0 ).count() ;
+    }
+
+
+    /** View of the LCParameters of an event that serializes all access with the mutex of
+     *  the event view.
+     */
+    class SynchronizedParameters : public LCParameters {
+
+    public:
+      SynchronizedParameters( LCParameters& params , std::mutex& mutex ) :
+	_params( params ), _mutex( mutex ), _stringVals(), _stringCopies() {}
+
+      virtual int getIntVal(const std::string & key) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getIntVal( key ) ;
+      }
+
+      virtual float getFloatVal(const std::string & key) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getFloatVal( key ) ;
+      }
+
+      virtual const std::string & getStringVal(const std::string & key) const {
+	// the value might be changed by another thread - return a copy that is kept unchanged
+	// for the lifetime of this view, i.e. the event; a new copy is made if the value changed
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	const std::string& value = _params.getStringVal( key ) ;
+	std::map<std::string, const std::string*>::iterator it = _stringVals.find( key ) ;
+	if( it != _stringVals.end() && *it->second == value )
+	  return *it->second ;
+	_stringCopies.push_back( value ) ;
+	_stringVals[ key ] = &_stringCopies.back() ;
+	return _stringCopies.back() ;
+      }
+
+      virtual IntVec & getIntVals(const std::string & key, IntVec & values) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getIntVals( key , values ) ;
+      }
+
+      virtual FloatVec & getFloatVals(const std::string & key, FloatVec & values) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getFloatVals( key , values ) ;
+      }
+
+      virtual StringVec & getStringVals(const std::string & key, StringVec & values) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getStringVals( key , values ) ;
+      }
+
+      virtual const StringVec & getIntKeys(StringVec & keys) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getIntKeys( keys ) ;
+      }
+
+      virtual const StringVec & getFloatKeys(StringVec & keys) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getFloatKeys( keys ) ;
+      }
+
+      virtual const StringVec & getStringKeys(StringVec & keys) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getStringKeys( keys ) ;
+      }
+
+      virtual int getNInt(const std::string & key) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getNInt( key ) ;
+      }
+
+      virtual int getNFloat(const std::string & key) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getNFloat( key ) ;
+      }
+
+      virtual int getNString(const std::string & key) const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _params.getNString( key ) ;
+      }
+
+      virtual void setValue(const std::string & key, int value) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_params.setValue( key , value ) ;
+      }
+
+      virtual void setValue(const std::string & key, float value) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_params.setValue( key , value ) ;
+      }
+
+      virtual void setValue(const std::string & key, const std::string & value) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_params.setValue( key , value ) ;
+      }
+
+      virtual void setValues(const std::string & key, const IntVec & values) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_params.setValues( key , values ) ;
+      }
+
+      virtual void setValues(const std::string & key, const FloatVec & values) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_params.setValues( key , values ) ;
+      }
+
+      virtual void setValues(const std::string & key, const StringVec & values) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_params.setValues( key , values ) ;
+      }
+
+    protected:
+      SynchronizedParameters( const SynchronizedParameters& ) ;
+      SynchronizedParameters& operator=( const SynchronizedParameters& ) ;
+
+      LCParameters& _params ;
+      std::mutex& _mutex ;
+      mutable std::map<std::string, const std::string*> _stringVals ; // latest copy per key
+      mutable std::deque<std::string> _stringCopies ;                 // all copies handed out
+    } ;
+
+
+    /** View of an LCEvent that serializes all access to the underlying event and its
+     *  parameters, so that concurrently running processors can read and add collections.
+     */
+    class SynchronizedEvent : public LCEvent {
+
+    public:
+      SynchronizedEvent( LCEvent* evt ) : _evt( evt ), _mutex(), _params( evt->parameters() , _mutex ) {}
+
+      virtual int getRunNumber() const { return _evt->getRunNumber() ; }
+      virtual int getEventNumber() const { return _evt->getEventNumber() ; }
+      virtual const std::string & getDetectorName() const { return _evt->getDetectorName() ; }
+      virtual long64 getTimeStamp() const { return _evt->getTimeStamp() ; }
+
+      virtual double getWeight() const {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _evt->getWeight() ;
+      }
+
+      virtual const std::vector<std::string>  * getCollectionNames() const {
+	// the event reuses its vector of names - return a copy per thread
+	static thread_local std::vector<std::string> names ;
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	names = *_evt->getCollectionNames() ;
+	return &names ;
+      }
+
+      virtual LCCollection * getCollection(const std::string & name) const
+	throw (DataNotAvailableException, std::exception ) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _evt->getCollection( name ) ;
+      }
+
+      virtual LCCollection * takeCollection(const std::string & name) const
+	throw (DataNotAvailableException, std::exception ) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	return _evt->takeCollection( name ) ;
+      }
+
+      virtual void addCollection(LCCollection * col, const std::string & name)
+	throw (EventException, std::exception ) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_evt->addCollection( col, name ) ;
+      }
+
+      virtual void removeCollection(const std::string & name)
+	throw (ReadOnlyException, std::exception ) {
+	std::lock_guard<std::mutex> lock( _mutex ) ;
+	_evt->removeCollection( name ) ;
+      }
+
+      virtual const LCParameters & getParameters() const { return _params ; }
+      virtual LCParameters & parameters() { return _params ; }
+
+    protected:
+      SynchronizedEvent( const SynchronizedEvent& ) ;
+      SynchronizedEvent& operator=( const SynchronizedEvent& ) ;
+
+      LCEvent* _evt ;
+      mutable std::mutex _mutex ;
+      SynchronizedParameters _params ;
+    } ;
+
+
+    /** The collection names of all parameters registered in the given type map.
+     */
+    std::set<std::string> collectionNames( const LCIOTypeMap& typeMap , const ProcParamMap& paramMap ){
+      std::set<std::string> names ;
+
+      for( LCIOTypeMap::const_iterator it = typeMap.begin() ; it != typeMap.end() ; ++it ){
+
+	ProcParamMap::const_iterator p = paramMap.find( it->first ) ;
+
+	if( p == paramMap.end() )
+	  continue ;
+
+	std::stringstream values( p->second->value() ) ;
+	std::string name ;
+
+	while( values >> name )
+	  names.insert( name ) ;
+      }
+      return names ;
+    }
+
+    /** The processor names referenced in a condition, e.g. "A && ( B.x || !C )" -> A, B, C.
+     */
+    std::set<std::string> conditionNames( const std::string& condition ){
+
+      std::set<std::string> names ;
+      std::string token ;
+
+      for( unsigned i=0 ; i <= condition.size() ; ++i ){
+
+	char c = ( i < condition.size() ? condition[i] : ' ' ) ;
+
+	if( c==' ' || c=='\t' || c=='(' || c==')' || c=='!' || c=='&' || c=='|' ){
+
+	  if( ! token.empty() )
+	    names.insert( token.substr( 0 , token.find('.') ) ) ;
+
+	  token.clear() ;
+
+	} else {
+
+	  token += c ;
+	}
+      }
+      return names ;
+    }
+
+    bool intersect( const std::set<std::string>& a , const std::set<std::string>& b ){
+
+      for( std::set<std::string>::const_iterator it = a.begin() ; it != a.end() ; ++it ){
+	if( b.find( *it ) != b.end() )
+	  return true ;
+      }
+      return false ;
+    }
+  }
+
+
+  ProcessorScheduler::ProcessorScheduler( const std::list<Processor*>& processors,
+					  LogicalExpressions& conditions,
+					  std::mutex& conditionsMutex,
+					  unsigned nThreads ) :
+    _nodes(),
+    _conditions( conditions ),
+    _conditionsMutex( conditionsMutex ),
+    _mutex(),
+    _workAvailable(),
+    _eventDone(),
+    _ready(),
+    _nOpenInputs(),
+    _nDone(0),
+    _stop(false),
+    _failed(false),
+    _exception(),
+    _evt(0),
+    _check(false),
+    _threads(),
+    _nEvents(0),
+    _evtTime(0.),
+    _evtTimeMin(0.),
+    _evtTimeMax(0.) {
+
+    unsigned n = processors.size() ;
+
+    std::vector< std::set<std::string> > in( n ), out( n ), cond( n ) ;
+    std::vector< bool > barrier( n ) ;
+
+    unsigned i = 0 ;
+    for( std::list<Processor*>::const_iterator it = processors.begin() ; it != processors.end() ; ++it , ++i ){
+
+      Processor* p = *it ;
+
+      Node node ;
+      node.proc = p ;
+      node.time = 0. ;
+      node.nCalls = 0 ;
+      node.barrier = false ;
+      _nodes.push_back( node ) ;
+
+      in[i]  = collectionNames( p->_inTypeMap  , p->_map ) ;
+      out[i] = collectionNames( p->_outTypeMap , p->_map ) ;
+
+      {
+	std::lock_guard<std::mutex> lock( _conditionsMutex ) ;
+	cond[i] = conditionNames( _conditions.getCondition( p->name() ) ) ;
+      }
+
+      // only processors that declared with setConcurrent() that they access no other collections
+      // than the registered ones and are reentrant run concurrently
+      barrier[i] = ( ! p->isConcurrent()
+		     || ( p->_inTypeMap.empty() && p->_outTypeMap.empty() )
+		     || dynamic_cast<LCIOOutputProcessor*>( p ) != 0
+		     || dynamic_cast<EventModifier*>( p ) != 0 ) ;
+
+      _nodes[i].barrier = barrier[i] ;
+
+      // a processor depends on earlier processors that create its input, read or write its
+      // output, or set a return value used in its condition
+      for( unsigned j=0 ; j < i ; ++j ){
+
+	if( barrier[i] || barrier[j]
+	    || intersect( out[j] , in[i] )
+	    || intersect( in[j] , out[i] )
+	    || intersect( out[j] , out[i] )
+	    || cond[i].find( _nodes[j].proc->name() ) != cond[i].end() ){
+
+	  _nodes[i].inputs.push_back( j ) ;
+	  _nodes[j].dependents.push_back( i ) ;
+	}
+      }
+    }
+
+    _nOpenInputs.resize( n ) ;
+
+    if( nThreads < 1 )
+      nThreads = 1 ;
+
+    for( unsigned t=0 ; t < nThreads ; ++t )
+      _threads.push_back( std::thread( &ProcessorScheduler::work , this ) ) ;
+  }
+
+
+  ProcessorScheduler::~ProcessorScheduler(){
+
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      _stop = true ;
+    }
+    _workAvailable.notify_all() ;
+
+    for( unsigned t=0 ; t < _threads.size() ; ++t )
+      _threads[t].join() ;
+  }
+
+
+  void ProcessorScheduler::processEvent( LCEvent* evt, bool check ){
+
+    Clock::time_point t0 = Clock::now() ;
+
+    SynchronizedEvent syncEvt( evt ) ;
+
+    std::unique_lock<std::mutex> lock( _mutex ) ;
+
+    _evt = &syncEvt ;
+    _check = check ;
+    _nDone = 0 ;
+    _failed = false ;
+    _exception = std::exception_ptr() ;
+    _ready.clear() ;
+
+    // push in reverse order, so that processors are started in the order of the steering file
+    for( unsigned i = _nodes.size() ; i > 0 ; --i ){
+
+      _nOpenInputs[i-1] = _nodes[i-1].inputs.size() ;
+
+      if( _nOpenInputs[i-1] == 0 )
+	_ready.push_back( i-1 ) ;
+    }
+
+    _workAvailable.notify_all() ;
+
+    while( _nDone < _nodes.size() )
+      _eventDone.wait( lock ) ;
+
+    _evt = 0 ;
+
+    double t = seconds( t0 , Clock::now() ) ;
+
+    _evtTime += t ;
+    if( _nEvents == 0 || t < _evtTimeMin ) _evtTimeMin = t ;
+    if( _nEvents == 0 || t > _evtTimeMax ) _evtTimeMax = t ;
+    ++_nEvents ;
+
+    if( _failed )
+      std::rethrow_exception( _exception ) ;
+  }
+
+
+  void ProcessorScheduler::work(){
+
+    std::unique_lock<std::mutex> lock( _mutex ) ;
+
+    while( true ){
+
+      while( ! _stop && _ready.empty() )
+	_workAvailable.wait( lock ) ;
+
+      if( _stop )
+	return ;
+
+      unsigned i = _ready.back() ;
+      _ready.pop_back() ;
+
+      if( ! _failed ){
+
+	lock.unlock() ;
+
+	std::exception_ptr ex ;
+
+	try{
+
+	  runNode( i ) ;
+
+	} catch( ... ){
+
+	  ex = std::current_exception() ;
+	}
+
+	lock.lock() ;
+
+	if( ex && ! _failed ){
+	  _failed = true ;
+	  _exception = ex ;
+	}
+      }
+
+      // release the dependents - after a failure they are only marked as done
+      const std::vector<unsigned>& deps = _nodes[i].dependents ;
+
+      for( unsigned k=0 ; k < deps.size() ; ++k ){
+
+	if( --_nOpenInputs[ deps[k] ] == 0 )
+	  _ready.push_back( deps[k] ) ;
+      }
+
+      if( ++_nDone == _nodes.size() )
+	_eventDone.notify_all() ;
+      else if( _ready.size() > 1 )
+	_workAvailable.notify_all() ;
+    }
+  }
+
+
+  void ProcessorScheduler::runNode( unsigned i ){
+
+    Processor* p = _nodes[i].proc ;
+
+    bool isTrue = false ;
+    {
+      std::lock_guard<std::mutex> lock( _conditionsMutex ) ;
+      isTrue = _conditions.conditionIsTrue( p->name() ) ;
+    }
+
+    if( ! isTrue )
+      return ;
+
+    // the name and verbosity of the processor are used while it holds logMutex()
+    ProcessorLogScope procScope( p ) ;
+
+    Clock::time_point t0 = Clock::now() ;
+
+    if( _nodes[i].barrier ){
+
+      // a barrier runs alone - its log scope is opened for all its output, as in sequential processing
+      streamlog::logscope scope( streamlog::out ) ; scope.setName( p->name() ) ;
+      scope.setLevel( p->logLevelName() ) ;
+
+      p->processEvent( _evt ) ;
+
+      if( _check )
+	p->check( _evt ) ;
+
+    } else {
+
+      p->processEvent( _evt ) ;
+
+      if( _check )
+	p->check( _evt ) ;
+    }
+
+    // only this thread runs the node during the event
+    _nodes[i].time += seconds( t0 , Clock::now() ) ;
+    ++_nodes[i].nCalls ;
+
+    p->setFirstEvent( false ) ;
+  }
+
+
+  namespace {
+    // the processor run by the current thread, see ProcessorScheduler::ProcessorLogScope
+    thread_local const Processor* threadProcessor = 0 ;
+  }
+
+
+  ProcessorScheduler::ProcessorLogScope::ProcessorLogScope( const Processor* p ) : _previous( threadProcessor ) {
+    threadProcessor = p ;
+  }
+
+
+  ProcessorScheduler::ProcessorLogScope::~ProcessorLogScope(){
+    threadProcessor = _previous ;
+  }
+
+
+  void ProcessorScheduler::LogMutex::lock(){
+
+    _mutex.lock() ;
+
+    if( threadProcessor != 0 ){
+
+      _scope = new streamlog::logscope( streamlog::out ) ;
+      _scope->setName( threadProcessor->name() ) ;
+      _scope->setLevel( threadProcessor->logLevelName() ) ;
+    }
+  }
+
+
+  void ProcessorScheduler::LogMutex::unlock(){
+
+    // restores the name and verbosity of the stream
+    delete _scope ;
+    _scope = 0 ;
+
+    _mutex.unlock() ;
+  }
+
+
+  ProcessorScheduler::LogMutex& ProcessorScheduler::logMutex(){
+
+    static LogMutex m ;
+    return m ;
+  }
+
+
+  void ProcessorScheduler::printDependencies() const {
+
+    streamlog_out( MESSAGE ) << " --------------------------------------------------------- " << std::endl
+			     << "  Concurrent processing with " << _threads.size() << " threads - "
+			     << " processor dependencies : " << std::endl ;
+
+    for( unsigned i=0 ; i < _nodes.size() ; ++i ){
+
+      streamlog_out( MESSAGE ) << "    " << _nodes[i].proc->name() << " <- " ;
+
+      for( unsigned k=0 ; k < _nodes[i].inputs.size() ; ++k )
+	streamlog_out( MESSAGE ) << _nodes[ _nodes[i].inputs[k] ].proc->name() << " " ;
+
+      streamlog_out( MESSAGE ) << std::endl ;
+    }
+
+    streamlog_out( MESSAGE ) << " --------------------------------------------------------- " << std::endl ;
+  }
+
+
+  void ProcessorScheduler::printStatistics() const {
+
+    unsigned n = _nodes.size() ;
+
+    // ---- critical path: longest path of mean processor times, inputs are always earlier nodes
+    std::vector<double> path( n , 0. ) ;
+    std::vector<int> prev( n , -1 ) ;
+
+    double tSum = 0. ;
+    int last = -1 ;
+
+    for( unsigned i=0 ; i < n ; ++i ){
+
+      double t = ( _nEvents > 0 ? _nodes[i].time / _nEvents : 0. ) ;
+
+      tSum += t ;
+
+      for( unsigned k=0 ; k < _nodes[i].inputs.size() ; ++k ){
+
+	unsigned j = _nodes[i].inputs[k] ;
+
+	if( prev[i] < 0 || path[j] > path[ prev[i] ] )
+	  prev[i] = j ;
+      }
+
+      path[i] = t + ( prev[i] < 0 ? 0. : path[ prev[i] ] ) ;
+
+      if( last < 0 || path[i] > path[last] )
+	last = i ;
+    }
+
+    streamlog_out(MESSAGE) << " --------------------------------------------------------- " << std::endl
+			   << "      Wall clock time used by processors ( in processEvent() ) :      " << std::endl
+			   << std::endl ;
+
+    for( unsigned i=0 ; i < n ; ++i ){
+
+      streamlog_out(MESSAGE) << "    " << std::left << std::setw(30) << _nodes[i].proc->name() << std::right
+			     << std::setw(12) << std::scientific << _nodes[i].time << " s in "
+			     << std::setw(12) << _nodes[i].nCalls << " events" << std::endl ;
+    }
+
+    if( _nEvents == 0 ){
+      streamlog_out(MESSAGE) << " --------------------------------------------------------- " << std::endl ;
+      return ;
+    }
+
+    double evtMean = _evtTime / _nEvents ;
+
+    streamlog_out(MESSAGE) << std::endl
+			   << "    Time per event:  mean " << std::scientific << evtMean
+			   << " s   min " << _evtTimeMin << " s   max " << _evtTimeMax
+			   << " s   in " << _nEvents << " events" << std::endl
+			   << "    Sum of processor times per event:  " << tSum << " s" << std::endl ;
+
+    std::vector<unsigned> critical ;
+    for( int i = last ; i >= 0 ; i = prev[i] )
+      critical.push_back( i ) ;
+
+    streamlog_out(MESSAGE) << "    Critical path ( " << path[last] << " s per event ) : " ;
+
+    for( unsigned k = critical.size() ; k > 0 ; --k )
+      streamlog_out(MESSAGE) << _nodes[ critical[k-1] ].proc->name() << ( k > 1 ? " -> " : "" ) ;
+
+    streamlog_out(MESSAGE) << std::endl ;
+
+    if( path[last] > 0. )
+      streamlog_out(MESSAGE) << "    Maximal speed up from concurrent processors: "
+			     << std::fixed << std::setprecision(2) << tSum / path[last]
+			     << "   achieved: " << tSum / evtMean << std::endl ;
+
+    streamlog_out(MESSAGE) << " --------------------------------------------------------- " << std::endl ;
+  }
+
+} // namespace marlin
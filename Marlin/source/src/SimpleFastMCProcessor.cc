@@ -7,6 +7,9 @@
 #include "marlin/SimpleClusterSmearer.h"
 #include "marlin/FastMCParticleType.h"
 #include "marlin/ErrorOfSigma.h"
+#include "marlin/FastMCBatch.h"
+#include "marlin/Global.h"
+#include "marlin/ProcessorEventSeeder.h"
 
 
 //--- LCIO headers 
@@ -17,6 +20,7 @@
 
 #ifdef MARLIN_AIDA
 #include <marlin/AIDAProcessor.h>
+#include <marlin/HistogramService.h>
 #include <AIDA/IHistogramFactory.h>
 #include <AIDA/ICloud1D.h>
 //#include <AIDA/ICloud2D.h>
@@ -45,8 +49,18 @@ namespace marlin{
   
   SimpleFastMCProcessor::SimpleFastMCProcessor() : Processor("SimpleFastMCProcessor"),
     _factory(NULL),
+    _batchMode(false),
+    _batch(NULL),
     _nRun(-1),
-    _nEvt(-1)
+    _nEvt(-1),
+    _hChargedRes(NULL),
+    _hChargedEnergy(NULL),
+    _hPhotonEnergy(NULL),
+    _hHadronEnergy(NULL),
+    _hPhotonRes(NULL),
+    _hHadronRes(NULL),
+    _hGamHelperP1(NULL),
+    _hHadHelperP1(NULL)
     {
     
     // modify processor description
@@ -116,6 +130,10 @@ namespace marlin{
 				hadronResDefault ,
 				hadronResDefault.size() ) ;
  
+    registerProcessorParameter( "BatchMode" , 
+				"Smear all stable particles of an event at once (vectorized, counter based random numbers)"  ,
+				_batchMode ,
+				bool( false ) ) ;
 
 
   }
@@ -133,6 +151,17 @@ namespace marlin{
 
     _factory = 0 ;
 
+    if( _batchMode ) {
+
+      _batch = new FastMCBatch( _initChargedRes, _initPhotonRes, _initNeutralHadronRes, _momentumCut ) ;
+
+      Global::EVENTSEEDER->registerProcessor( this ) ;
+
+      streamlog_out( MESSAGE )  << " SimpleFastMCProcessor::init() : using FastMCBatch " << std::endl ;
+
+      return ;
+    }
+
 #ifdef MARLIN_CLHEP
 
     SimpleParticleFactory* simpleFactory  =  new SimpleParticleFactory() ; 
@@ -162,6 +191,23 @@ namespace marlin{
 
     LCCollectionVec* recVec = new LCCollectionVec( LCIO::RECONSTRUCTEDPARTICLE ) ;
 
+    if( _batch != 0 ) {
+
+      LCCollectionVec* relVec = new LCCollectionVec( LCIO::LCRELATION ) ;
+      relVec->parameters().setValue( "FromType" , LCIO::RECONSTRUCTEDPARTICLE ) ;
+      relVec->parameters().setValue( "ToType" , LCIO::MCPARTICLE ) ;
+
+      _batch->process( mcpCol, Global::EVENTSEEDER->getSeed( this ), recVec, relVec ) ;
+
+      recVec->setDefault( true ) ;
+
+      evt->addCollection( recVec, _recoParticleCollectionName ) ;
+      evt->addCollection( relVec, _mcTruthCollectionName ) ;
+
+      _nEvt ++ ;
+      return ;
+    }
+
     LCRelationNavigator relNav( LCIO::RECONSTRUCTEDPARTICLE , LCIO::MCPARTICLE ) ;
 
     for(int i=0; i<mcpCol->getNumberOfElements() ; i++){
@@ -200,56 +246,46 @@ namespace marlin{
     
 #ifdef MARLIN_AIDA
     
-    // define a histogram pointer
-    static AIDA::ICloud1D* hChargedRes ;    
-    
-    static AIDA::ICloud1D* hChargedEnergy ;    
-    static AIDA::ICloud1D* hPhotonEnergy ;    
-    static AIDA::ICloud1D* hHadronEnergy ;    
-    //~ static AIDA::ICloud1D* hLostEnergy ;    
-    
-    static AIDA::IHistogram1D* hPhotonRes ;    
-    static AIDA::IHistogram1D* hHadronRes ;    
-    
-    static AIDA::IProfile1D* hGamHelperP1 ;    
-    static AIDA::IProfile1D* hHadHelperP1 ;    
-    
-    
     if( isFirstEvent() ) { 
+
+      // the AIDA tree is shared with processors that might run concurrently
+      std::lock_guard<std::mutex> lock( HistogramService::instance()->mutex() ) ;
       
-      hChargedRes = AIDAProcessor::histogramFactory(this)->
+      _hChargedRes = AIDAProcessor::histogramFactory(this)->
 	createCloud1D( "hChargedRes", "dP/P for charged tracks", 100 ) ; 
       
       
-      hChargedEnergy = AIDAProcessor::histogramFactory(this)->
+      _hChargedEnergy = AIDAProcessor::histogramFactory(this)->
        	createCloud1D( "hChargedEnergy", "E/GeV for charged particles", 100 ) ; 
 
-      hPhotonEnergy = AIDAProcessor::histogramFactory(this)->
+      _hPhotonEnergy = AIDAProcessor::histogramFactory(this)->
        	createCloud1D( "hPhotonEnergy", "E/GeV for photons", 100 ) ; 
       
-      hHadronEnergy = AIDAProcessor::histogramFactory(this)->
+      _hHadronEnergy = AIDAProcessor::histogramFactory(this)->
        	createCloud1D( "hHadronEnergy", "E/GeV for neutral hadrons", 100 ) ; 
 
       //~ hLostEnergy = AIDAProcessor::histogramFactory(this)->
        	//~ createCloud1D( "hLostEnergy", "E/GeV for not reconstructed particles", 100 ) ; 
       
       
-      hPhotonRes = AIDAProcessor::histogramFactory(this)->
+      _hPhotonRes = AIDAProcessor::histogramFactory(this)->
 	createHistogram1D( "hPhotonRes", "dE/E for photons", 100, -2.,2. ) ; 
       
-      hHadronRes = AIDAProcessor::histogramFactory(this)->
+      _hHadronRes = AIDAProcessor::histogramFactory(this)->
 	createHistogram1D( "hHadronRes", "dE/E  for neutral hadrons", 100, -2., 2. ) ;
       
       
-      hGamHelperP1 = AIDAProcessor::histogramFactory(this)->
+      _hGamHelperP1 = AIDAProcessor::histogramFactory(this)->
 	 createProfile1D( "hGamHelperP1", " helper profile of energy spread", 10, 0.,20. ) ; 
       
-      hHadHelperP1 = AIDAProcessor::histogramFactory(this)->
+      _hHadHelperP1 = AIDAProcessor::histogramFactory(this)->
 	createProfile1D( "hHadHelperP1", " helper profile of energy spread",  10, 0.,20. ) ; 
     }
     
     
     // fill histogram from LCIO data :
+
+    HistogramService* hs = HistogramService::instance() ;
     
     LCCollection* recCol = evt->getCollection(_recoParticleCollectionName ) ;
     
@@ -285,9 +321,9 @@ namespace marlin{
 				   mcp->getMomentum()[1] *  mcp->getMomentum()[1] +
 				   mcp->getMomentum()[2] *  mcp->getMomentum()[2] ) ;
 	  
-	  hChargedRes->fill( ( recP - mcpP ) / recP    ) ;
+	  hs->fill( _hChargedRes , ( recP - mcpP ) / recP    ) ;
 
-	  hChargedEnergy->fill( rec->getEnergy() ) ; 
+	  hs->fill( _hChargedEnergy , rec->getEnergy() ) ; 
 
 	} else {  // not charged
 	  
@@ -298,18 +334,18 @@ namespace marlin{
 	  
 	  if( rec->getType() == PHOTON) { 
 	    
-	    hPhotonEnergy->fill( mE ) ;
-	    hGamHelperP1->fill(  mE  ,   dEoverE  ) ;
-	    hPhotonRes->fill(  dEoverE , mE    ) ;
+	    hs->fill( _hPhotonEnergy , mE ) ;
+	    hs->fill( _hGamHelperP1 , mE  ,   dEoverE  ) ;
+	    hs->fill( _hPhotonRes , dEoverE , mE    ) ;
 	    
 	  }
 	  else if( rec->getType() == NEUTRAL_HADRON ) { 
 	    
 	    // 	    if( mE > 0.9 && mE < 1.1 ){ 
 
-	    hHadronRes->fill(  dEoverE , mE   ) ;
-	    hHadronEnergy->fill( mE ) ;
-	    hHadHelperP1->fill(  mE , dEoverE  ) ;
+	    hs->fill( _hHadronRes , dEoverE , mE   ) ;
+	    hs->fill( _hHadronEnergy , mE ) ;
+	    hs->fill( _hHadHelperP1 , mE , dEoverE  ) ;
 	    
 	      // 	    }
 
@@ -333,6 +369,9 @@ namespace marlin{
     streamlog_out( MESSAGE4 )  << "SimpleFastMCProcessor::end()  " << name() 
 			       << " processed " << _nEvt << " events in " << _nRun << " runs "
 			       << std::endl ;
+
+    delete _batch ;
+    _batch = 0 ;
     
 #ifdef MARLIN_AIDA_IGNORE_FOR_NOW
     // FIXME:
@@ -30,7 +30,11 @@ Statusmonitor::Statusmonitor() : Processor("Statusmonitor") {
 
 
 void Statusmonitor::init() { 
-  streamlog_out(DEBUG) << "INIT CALLED  " << std::endl ;
+  // init() may run concurrently ( hasIndependentInit() )
+  {
+    LogLock lock ;
+    streamlog_out(DEBUG) << "INIT CALLED  " << std::endl ;
+  }
 
   // usually a good idea to
   printParameters() ;
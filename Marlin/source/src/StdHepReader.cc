@@ -7,6 +7,7 @@
 #include "IMPL/LCRunHeaderImpl.h"
 
 #include "UTIL/LCStdHepRdr.h"
+#include "UTIL/LCStdHepRdrNew.h"
 #include "UTIL/LCTOOLS.h"
 
 
@@ -27,6 +28,16 @@ namespace marlin{
 				_fileName ,
 				std::string("input.stdhep") ) ;
     
+    registerOptionalParameter( "UseNewConverter" , 
+			       "use LCStdHepRdrNew, which also takes the parent/daughter relations from the JMOHEP/JDAHEP ranges, instead of LCStdHepRdr"  ,
+			       _useNewConverter ,
+			       bool(false) ) ;
+    
+    registerOptionalParameter( "ReadAheadEvents" , 
+			       "number of events that are read and converted ahead on a separate thread while the current event is processed (only with UseNewConverter) - 0: read every event when it is needed"  ,
+			       _readAhead ,
+			       int(0) ) ;
+    
   }
   
   StdHepReader*  StdHepReader::newProcessor() { 
@@ -40,7 +51,29 @@ namespace marlin{
 
   void StdHepReader::readDataSource( int numEvents ) {
     
-    LCStdHepRdr* rdr = new  LCStdHepRdr( _fileName.c_str()  ) ;
+    if( _useNewConverter ) {
+
+      LCStdHepRdrNew rdr( _fileName.c_str() ) ;
+
+      if( _readAhead > 0 )
+	rdr.setReadAhead( _readAhead ) ;
+
+      readEvents( rdr , numEvents ) ;
+
+    } else {
+
+      if( _readAhead > 0 )
+	streamlog_out( WARNING ) << " ReadAheadEvents is ignored without UseNewConverter=true" << std::endl ;
+
+      LCStdHepRdr rdr( _fileName.c_str() ) ;
+
+      readEvents( rdr , numEvents ) ;
+    }
+  }
+
+
+  template <class Rdr>
+  void StdHepReader::readEvents( Rdr& rdr , int numEvents ) {
     
     LCCollection* col ;
     LCEventImpl* evt ;
@@ -48,7 +81,7 @@ namespace marlin{
     int evtNum = 0 ;
     int runNum = 0 ;
 
-    while( ( col = rdr->readEvent() ) != 0 ) {
+    while( ( col = rdr.readEvent() ) != 0 ) {
       
       if ( numEvents > 0 && evtNum+1 > numEvents )
 	{
@@ -78,8 +111,6 @@ namespace marlin{
 
       delete evt ;
     }
-    
-    delete rdr ;
   }
   
 
@@ -0,0 +1,239 @@
+#include "marlin/SteeringCache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace marlin{
+
+  namespace {
+
+    const char MAGIC[4] = { 'M', 'C', 'F', 'G' } ;
+    const unsigned VERSION = 1 ;
+
+    // 64 bit FNV-1a
+    void hash( unsigned long long& h, const char* data, size_t n ){
+
+      for( size_t i=0 ; i<n ; ++i ){
+	h ^= (unsigned char) data[i] ;
+	h *= 1099511628211ULL ;
+      }
+    }
+
+    void hash( unsigned long long& h, const std::string& s ){
+
+      // include the length so that "ab"+"c" and "a"+"bc" differ
+      unsigned n = s.size() ;
+      hash( h, (const char*) &n, sizeof(n) ) ;
+      hash( h, s.data(), s.size() ) ;
+    }
+
+
+    void writeUInt( std::string& buf, unsigned val ){
+      buf.append( (const char*) &val, sizeof(val) ) ;
+    }
+
+    void writeString( std::string& buf, const std::string& s ){
+      writeUInt( buf, s.size() ) ;
+      buf.append( s ) ;
+    }
+
+
+    /** Reads values from a buffer - sets ok to false if the buffer is too short. */
+    struct Reader {
+
+      Reader( const std::string& buf ) : _buf( buf ), _pos( 0 ), ok( true ) {}
+
+      unsigned readUInt(){
+	unsigned val = 0 ;
+	if( _pos + sizeof(val) > _buf.size() ){ ok = false ; return 0 ; }
+	memcpy( &val, _buf.data() + _pos, sizeof(val) ) ;
+	_pos += sizeof(val) ;
+	return val ;
+      }
+
+      std::string readString(){
+	unsigned n = readUInt() ;
+	if( ! ok || _pos + n > _buf.size() ){ ok = false ; return "" ; }
+	std::string s( _buf, _pos, n ) ;
+	_pos += n ;
+	return s ;
+      }
+
+      const std::string& _buf ;
+      size_t _pos ;
+      bool ok ;
+    } ;
+  }
+
+
+  SteeringCache::SteeringCache( const std::string& directory ) : _directory( directory ) {
+
+    mkdir( _directory.c_str() , 0755 ) ;  // fails harmlessly if it exists
+  }
+
+
+  unsigned long long SteeringCache::key( const std::string& fileName, const CommandLineParametersMap& cmdlineparams ){
+
+    std::ifstream in( fileName.c_str() , std::ios::binary ) ;
+
+    if( ! in )
+      return 0 ;
+
+    std::stringstream content ;
+    content << in.rdbuf() ;
+
+    unsigned long long h = 14695981039346656037ULL ;
+
+    hash( h, (const char*) &VERSION, sizeof(VERSION) ) ;
+    hash( h, content.str() ) ;
+
+    for( CommandLineParametersMap::const_iterator it = cmdlineparams.begin() ; it != cmdlineparams.end() ; ++it ){
+
+      for( std::map<std::string,std::string>::const_iterator p = it->second.begin() ; p != it->second.end() ; ++p ){
+	hash( h, it->first ) ;
+	hash( h, p->first ) ;
+	hash( h, p->second ) ;
+      }
+    }
+
+    return ( h != 0 ? h : 1 ) ;
+  }
+
+
+  std::string SteeringCache::fileName( unsigned long long key ) const {
+
+    std::stringstream name ;
+    name << _directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".mcfg" ;
+    return name.str() ;
+  }
+
+
+  bool SteeringCache::read( unsigned long long key, StringParametersMap& parameters ) const {
+
+    std::ifstream in( fileName( key ).c_str() , std::ios::binary ) ;
+
+    if( ! in )
+      return false ;
+
+    std::stringstream content ;
+    content << in.rdbuf() ;
+    const std::string buf = content.str() ;
+
+    if( buf.size() < sizeof(MAGIC) + sizeof(unsigned) + sizeof(key) || memcmp( buf.data() , MAGIC , sizeof(MAGIC) ) != 0 )
+      return false ;
+
+    Reader r( buf ) ;
+    r._pos = sizeof(MAGIC) ;
+
+    if( r.readUInt() != VERSION )
+      return false ;
+
+    unsigned long long fileKey ;
+    memcpy( &fileKey, buf.data() + r._pos, sizeof(fileKey) ) ;
+    r._pos += sizeof(fileKey) ;
+
+    if( fileKey != key )
+      return false ;
+
+    StringParametersMap sections ;
+
+    unsigned nSections = r.readUInt() ;
+
+    for( unsigned i=0 ; i < nSections && r.ok ; ++i ){
+
+      std::string name = r.readString() ;
+      StringParameters* p = new StringParameters ;
+      sections[ name ] = p ;
+
+      unsigned nKeys = r.readUInt() ;
+
+      for( unsigned k=0 ; k < nKeys && r.ok ; ++k ){
+
+	std::string parName = r.readString() ;
+	std::vector<std::string> values( r.readUInt() ) ;
+
+	for( unsigned v=0 ; v < values.size() && r.ok ; ++v )
+	  values[v] = r.readString() ;
+
+	p->add( parName , values ) ;
+      }
+    }
+
+    if( ! r.ok || r._pos != buf.size() ){
+
+      for( StringParametersMap::iterator it = sections.begin() ; it != sections.end() ; ++it )
+	delete it->second ;
+
+      std::cout << "<!-- WARNING ignoring corrupt steering cache file : " << fileName( key ) << " -->" << std::endl ;
+      return false ;
+    }
+
+    parameters.insert( sections.begin() , sections.end() ) ;
+    return true ;
+  }
+
+
+  void SteeringCache::write( unsigned long long key, const StringParametersMap& parameters ) const {
+
+    std::string buf( MAGIC , sizeof(MAGIC) ) ;
+    writeUInt( buf, VERSION ) ;
+    buf.append( (const char*) &key, sizeof(key) ) ;
+
+    unsigned nSections = 0 ;
+    for( StringParametersMap::const_iterator it = parameters.begin() ; it != parameters.end() ; ++it ){
+      if( it->second != 0 ) ++nSections ;
+    }
+    writeUInt( buf, nSections ) ;
+
+    for( StringParametersMap::const_iterator it = parameters.begin() ; it != parameters.end() ; ++it ){
+
+      if( it->second == 0 ) continue ;  // sections looked up but not defined
+
+      writeString( buf, it->first ) ;
+
+      StringVec keys ;
+      it->second->getStringKeys( keys ) ;
+      writeUInt( buf, keys.size() ) ;
+
+      for( unsigned k=0 ; k < keys.size() ; ++k ){
+
+	StringVec values ;
+	it->second->getStringVals( keys[k] , values ) ;
+
+	writeString( buf, keys[k] ) ;
+	writeUInt( buf, values.size() ) ;
+
+	for( unsigned v=0 ; v < values.size() ; ++v )
+	  writeString( buf, values[v] ) ;
+      }
+    }
+
+    // write to a temporary file and rename, so that concurrent jobs never read a partial file
+    std::stringstream tmpName ;
+    tmpName << fileName( key ) << ".tmp." << getpid() ;
+
+    {
+      std::ofstream out( tmpName.str().c_str() , std::ios::binary ) ;
+      out.write( buf.data() , buf.size() ) ;
+
+      if( ! out ){
+	std::cout << "<!-- WARNING could not write steering cache file : " << tmpName.str() << " -->" << std::endl ;
+	remove( tmpName.str().c_str() ) ;
+	return ;
+      }
+    }
+
+    if( rename( tmpName.str().c_str() , fileName( key ).c_str() ) != 0 ){
+      std::cout << "<!-- WARNING could not write steering cache file : " << fileName( key ) << " -->" << std::endl ;
+      remove( tmpName.str().c_str() ) ;
+    }
+  }
+
+} // end namespace marlin
@@ -1,5 +1,6 @@
 
 #include "marlin/XMLParser.h"
+#include "marlin/SteeringCache.h"
 #include "marlin/Exceptions.h"
 #include "marlin/tinyxml.h"
 
@@ -10,6 +11,7 @@
 
 
 #include <memory>
+#include <cstdlib>
 
 namespace marlin{
 
@@ -23,6 +25,21 @@ namespace marlin{
 
     void XMLParser::parse(){
 
+        // take the parameters from the steering cache if the file and the command line are unchanged
+        std::auto_ptr<SteeringCache> cache ;
+        unsigned long long cacheKey = 0 ;
+
+        const char* cacheDir = getenv( "MARLIN_STEERING_CACHE" ) ;
+
+        if( cacheDir != 0 && ! _forCCheck ){
+
+            cache.reset( new SteeringCache( cacheDir ) ) ;
+            cacheKey = SteeringCache::key( _fileName , _cmdlineparams ) ;
+
+            if( cacheKey != 0 && cache->read( cacheKey , _map ) )
+                return ;
+        }
+
 
         _doc = new TiXmlDocument ;
         bool loadOkay = _doc->LoadFile(_fileName  ) ;
@@ -269,6 +286,9 @@ namespace marlin{
 	  throw ParseException( str.str() ) ;
 	}
 	//===================================================================
+
+        if( cacheKey != 0 )
+            cache->write( cacheKey , _map ) ;
     }
 
 
@@ -0,0 +1,81 @@
+#ifndef TestFastMCBatch_h
+#define TestFastMCBatch_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+namespace marlin{
+  class FastMCBatch ;
+}
+
+
+/**  test processor for the BatchMode of the SimpleFastMCProcessor - run after it.<br>
+ *   Checks that every ReconstructedParticle is related to exactly one stable, visible MCParticle
+ *   with the same charge and direction and a consistent energy, that the FastMCBatch with the
+ *   resolutions and the event seed of the SimpleFastMCProcessor reproduces the collection exactly
+ *   and that another seed gives different results. Prints an ERROR for every failed check.
+ *
+ * @param FastMCProcessorName          Name of the SimpleFastMCProcessor - its resolutions and
+ *                                     momentum cut have to be set in the steering file
+ * @param InputCollectionName          Name of the MCParticle input collection of the fast MC
+ * @param RecoParticleCollectionName   Name of the ReconstructedParticles created by the fast MC
+ * @param MCTruthMappingCollectionName Name of the relations created by the fast MC
+ *
+ * @version $Id:$
+ */
+
+class TestFastMCBatch : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestFastMCBatch ; }
+
+
+  TestFastMCBatch() ;
+
+  virtual ~TestFastMCBatch() ;
+
+  /** Called at the begin of the job before anything is read.
+   */
+  virtual void init() ;
+
+  /** Called for every event - checks the output of the fast MC.
+   */
+  virtual void processEvent( LCEvent * evt ) ;
+
+  /** Called after data processing for clean up.
+   */
+  virtual void end() ;
+
+
+ protected:
+
+  /** Prints an error for the event and counts it */
+  void fail( LCEvent* evt, const std::string& what ) ;
+
+  std::string _fastMCName ;
+  std::string _inputCollectionName ;
+  std::string _recoParticleCollectionName ;
+  std::string _mcTruthCollectionName ;
+
+  Processor* _fastMC ;
+  FastMCBatch* _batch ;
+
+  int _nEvt ;
+  int _nRec ;
+  int _nError ;
+
+ private:
+  TestFastMCBatch( const TestFastMCBatch& ) ;
+  TestFastMCBatch& operator=( const TestFastMCBatch& ) ;
+} ;
+
+#endif
+
+
+
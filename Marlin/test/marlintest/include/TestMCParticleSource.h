@@ -0,0 +1,53 @@
+#ifndef TestMCParticleSource_h
+#define TestMCParticleSource_h 1
+
+#include "marlin/Processor.h"
+
+#include "lcio.h"
+#include <string>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/**  test processor that adds a collection of generator MCParticles to every event - stable charged
+ *   particles, photons, neutral hadrons and neutrinos and some unstable particles, with momenta
+ *   depending on the event number. Input for the fast Monte Carlo tests (the MCParticles in
+ *   simjob.slcio are not stable).
+ *
+ * @param CollectionName Name of the MCParticle collection created
+ *
+ * @version $Id:$
+ */
+
+class TestMCParticleSource : public Processor {
+
+ public:
+
+  virtual Processor*  newProcessor() { return new TestMCParticleSource ; }
+
+
+  TestMCParticleSource() ;
+
+  /** Called at the begin of the job before anything is read.
+   */
+  virtual void init() ;
+
+  /** Called for every event - adds the MCParticle collection.
+   */
+  virtual void processEvent( LCEvent * evt ) ;
+
+
+ protected:
+
+  /** Output collection name.
+   */
+  std::string _colName ;
+
+  int _nEvt ;
+} ;
+
+#endif
+
+
+
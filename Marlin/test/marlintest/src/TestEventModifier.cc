@@ -12,6 +12,8 @@ using namespace marlin ;
 
 TestEventModifier aTestEventModifier ;
 
+MARLIN_PROCESSOR_ONLY_LIBRARY
+
 
 TestEventModifier::TestEventModifier() : Processor("TestEventModifier") {
   
@@ -0,0 +1,238 @@
+#include "TestFastMCBatch.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "marlin/Global.h"
+#include "marlin/ProcessorMgr.h"
+#include "marlin/ProcessorEventSeeder.h"
+#include "marlin/FastMCBatch.h"
+#include "marlin/FastMCParticleType.h"
+
+#include "EVENT/LCRelation.h"
+#include "EVENT/ReconstructedParticle.h"
+#include "IMPL/LCCollectionVec.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <set>
+#include <sstream>
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestFastMCBatch aTestFastMCBatch ;
+
+
+TestFastMCBatch::TestFastMCBatch() : Processor("TestFastMCBatch"),
+				     _fastMC(0),
+				     _batch(0),
+				     _nEvt(-1),
+				     _nRec(-1),
+				     _nError(-1) {
+
+  // modify processor description
+  _description = "TestFastMCBatch checks the output of the SimpleFastMCProcessor in BatchMode" ;
+
+  registerProcessorParameter( "FastMCProcessorName" ,
+			      "Name of the SimpleFastMCProcessor - its resolutions have to be set in the steering file" ,
+			      _fastMCName ,
+			      std::string("MyFastMC") ) ;
+
+  registerInputCollection( LCIO::MCPARTICLE,
+			   "InputCollectionName" ,
+			   "Name of the MCParticle input collection of the fast MC"  ,
+			   _inputCollectionName ,
+			   std::string("MCParticle") ) ;
+
+  registerInputCollection( LCIO::RECONSTRUCTEDPARTICLE,
+			   "RecoParticleCollectionName" ,
+			   "Name of the ReconstructedParticles created by the fast MC"  ,
+			   _recoParticleCollectionName ,
+			   std::string("ReconstructedParticles") ) ;
+
+  registerInputCollection( LCIO::LCRELATION,
+			   "MCTruthMappingCollectionName" ,
+			   "Name of the relations created by the fast MC"  ,
+			   _mcTruthCollectionName ,
+			   std::string("MCTruthMapping") ) ;
+}
+
+
+TestFastMCBatch::~TestFastMCBatch() {
+  delete _batch ;
+}
+
+
+void TestFastMCBatch::init() {
+
+  printParameters() ;
+
+  _nEvt = 0 ;
+  _nRec = 0 ;
+  _nError = 0 ;
+
+  _fastMC = ProcessorMgr::instance()->getActiveProcessor( _fastMCName ) ;
+
+  if( _fastMC == 0 ) {
+    streamlog_out(ERROR) << " no active processor " << _fastMCName << std::endl ;
+    ++_nError ;
+    return ;
+  }
+
+  // use the same resolutions as the fast MC
+  StringParameters* par = _fastMC->parameters() ;
+
+  FloatVec chargedRes, photonRes, neutralHadronRes ;
+  par->getFloatVals( "ChargedResolution" , chargedRes ) ;
+  par->getFloatVals( "PhotonResolution" , photonRes ) ;
+  par->getFloatVals( "NeutralHadronResolution" , neutralHadronRes ) ;
+
+  if( chargedRes.empty() || photonRes.empty() || neutralHadronRes.empty() || ! par->isParameterSet( "MomentumCut" ) ) {
+    streamlog_out(ERROR) << " the resolutions and the momentum cut of " << _fastMCName
+			 << " have to be set in the steering file " << std::endl ;
+    ++_nError ;
+    return ;
+  }
+
+  _batch = new FastMCBatch( chargedRes, photonRes, neutralHadronRes, par->getFloatVal( "MomentumCut" ) ) ;
+}
+
+
+void TestFastMCBatch::fail( LCEvent* evt, const std::string& what ) {
+
+  streamlog_out(ERROR) << " event " << evt->getEventNumber() << " in run " << evt->getRunNumber()
+		       << " : " << what << std::endl ;
+  ++_nError ;
+}
+
+
+void TestFastMCBatch::processEvent( LCEvent * evt ) {
+
+  ++_nEvt ;
+
+  if( _batch == 0 )
+    return ;
+
+  const LCCollection* mcpCol = evt->getCollection( _inputCollectionName ) ;
+  LCCollection* recCol = evt->getCollection( _recoParticleCollectionName ) ;
+  LCCollection* relCol = evt->getCollection( _mcTruthCollectionName ) ;
+
+  int nRec = recCol->getNumberOfElements() ;
+
+  if( relCol->getNumberOfElements() != nRec ) {
+    fail( evt , "not one relation per ReconstructedParticle" ) ;
+    return ;
+  }
+
+  //---- every particle comes from a different stable, visible MCParticle
+
+  int nVisible = 0 ;
+  for( int i=0 ; i < mcpCol->getNumberOfElements() ; i++ ){
+    MCParticle* mcp = static_cast<MCParticle*>( mcpCol->getElementAt( i ) ) ;
+    int pdg = std::abs( mcp->getPDG() ) ;
+    if( mcp->getGeneratorStatus() == 1 && pdg != 12 && pdg != 14 && pdg != 16 && pdg != 18 )
+      ++nVisible ;
+  }
+
+  if( nRec == 0 || nRec > nVisible ) {
+    std::stringstream s ;
+    s << nRec << " ReconstructedParticles for " << nVisible << " stable visible MCParticles" ;
+    fail( evt , s.str() ) ;
+  }
+
+  std::set<MCParticle*> used ;
+
+  for( int i=0 ; i < nRec ; i++ ){
+
+    ReconstructedParticle* rec = static_cast<ReconstructedParticle*>( recCol->getElementAt( i ) ) ;
+    LCRelation* rel = static_cast<LCRelation*>( relCol->getElementAt( i ) ) ;
+    MCParticle* mcp = dynamic_cast<MCParticle*>( rel->getTo() ) ;
+
+    if( rel->getFrom() != rec || mcp == 0 ) {
+      fail( evt , "relation does not point from the ReconstructedParticle to an MCParticle" ) ;
+      continue ;
+    }
+
+    if( ! used.insert( mcp ).second )
+      fail( evt , "MCParticle reconstructed twice" ) ;
+
+    int pdg = std::abs( mcp->getPDG() ) ;
+
+    if( mcp->getGeneratorStatus() != 1 || pdg == 12 || pdg == 14 || pdg == 16 || pdg == 18 )
+      fail( evt , "reconstructed an unstable MCParticle or a neutrino" ) ;
+
+    int type = ( std::fabs( mcp->getCharge() ) > 1e-10 ? CHARGED : pdg == 22 ? PHOTON : NEUTRAL_HADRON ) ;
+
+    if( rec->getType() != type || rec->getCharge() != mcp->getCharge() )
+      fail( evt , "wrong type or charge" ) ;
+
+    const double* r = rec->getMomentum() ;
+    const double* m = mcp->getMomentum() ;
+
+    double rP2 = r[0]*r[0] + r[1]*r[1] + r[2]*r[2] ;
+    double mP2 = m[0]*m[0] + m[1]*m[1] + m[2]*m[2] ;
+
+    double cx = r[1]*m[2] - r[2]*m[1] ;
+    double cy = r[2]*m[0] - r[0]*m[2] ;
+    double cz = r[0]*m[1] - r[1]*m[0] ;
+
+    if( cx*cx + cy*cy + cz*cz > 1e-10 * rP2 * mP2 )
+      fail( evt , "smeared momentum not parallel to the true one" ) ;
+
+    double m2 = rec->getMass() * rec->getMass() ;
+    double e2 = rec->getEnergy() * rec->getEnergy() ;
+
+    if( std::fabs( e2 - rP2 - m2 ) > 1e-5 * e2 )
+      fail( evt , "energy does not match momentum and mass" ) ;
+  }
+
+  //---- the FastMCBatch reproduces the event with the seed of the fast MC - and not with another
+
+  unsigned seed = Global::EVENTSEEDER->getSeed( _fastMC ) ;
+
+  for( unsigned s=seed ; s <= seed + 1 ; ++s ){
+
+    LCCollectionVec recVec( LCIO::RECONSTRUCTEDPARTICLE ) ;
+    LCCollectionVec relVec( LCIO::LCRELATION ) ;
+
+    _batch->process( mcpCol, s, &recVec, &relVec ) ;
+
+    bool same = ( recVec.getNumberOfElements() == nRec ) ;
+
+    for( int i=0 ; same && i < nRec ; i++ ){
+
+      ReconstructedParticle* rec = static_cast<ReconstructedParticle*>( recCol->getElementAt( i ) ) ;
+      ReconstructedParticle* ref = static_cast<ReconstructedParticle*>( recVec.getElementAt( i ) ) ;
+
+      same = ( rec->getType() == ref->getType() &&
+	       rec->getMomentum()[0] == ref->getMomentum()[0] &&
+	       rec->getMomentum()[1] == ref->getMomentum()[1] &&
+	       rec->getMomentum()[2] == ref->getMomentum()[2] &&
+	       rec->getEnergy() == ref->getEnergy() &&
+	       static_cast<LCRelation*>( relCol->getElementAt( i ) )->getTo() ==
+	       static_cast<LCRelation*>( relVec.getElementAt( i ) )->getTo() ) ;
+    }
+
+    if( s == seed && ! same )
+      fail( evt , "not reproduced with the event seed of the fast MC" ) ;
+
+    if( s != seed && same )
+      fail( evt , "same result with a different seed" ) ;
+  }
+
+  _nRec += nRec ;
+
+  streamlog_out(DEBUG) << " checked " << nRec << " ReconstructedParticles in event " << evt->getEventNumber()
+		       << " with seed " << seed << std::endl ;
+}
+
+
+void TestFastMCBatch::end(){
+
+  streamlog_out(MESSAGE4) << name()
+			  << " checked " << _nRec << " reconstructed particles in " << _nEvt << " events with "
+			  << _nError << " errors" << std::endl ;
+}
+
@@ -0,0 +1,82 @@
+#include "TestMCParticleSource.h"
+
+// ----- include for verbosity dependend logging ---------
+#include "marlin/VerbosityLevels.h"
+
+#include "IMPL/LCCollectionVec.h"
+#include "IMPL/MCParticleImpl.h"
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+TestMCParticleSource aTestMCParticleSource ;
+
+
+// particle types created - cycled through for every event
+static const int   nTypes = 10 ;
+static const int   pdgs[nTypes]    = {  211, -13,     11,      22,  2112, 12,  -211,  130,   22,  310 } ;
+static const float charges[nTypes] = {   1.,  1.,     -1.,     0.,    0., 0.,   -1.,   0.,   0.,   0. } ;
+static const float masses[nTypes]  = { .1396, .1057, .000511,  0., .9396, 0., .1396, .4976,  0., .4976 } ;
+static const int   status[nTypes]  = {    1,   1,      1,       1,     1,  1,     1,    1,    1,    2 } ;
+
+
+TestMCParticleSource::TestMCParticleSource() : Processor("TestMCParticleSource") {
+
+  // modify processor description
+  _description = "TestMCParticleSource adds a collection of stable and unstable generator MCParticles to every event" ;
+
+  registerOutputCollection( LCIO::MCPARTICLE,
+			    "CollectionName" ,
+			    "Name of the MCParticle collection created"  ,
+			    _colName ,
+			    std::string("TestMCParticles") ) ;
+
+  _nEvt = -1 ;
+}
+
+
+void TestMCParticleSource::init() {
+
+  printParameters() ;
+
+  _nEvt = 0 ;
+}
+
+
+void TestMCParticleSource::processEvent( LCEvent * evt ) {
+
+  LCCollectionVec* col = new LCCollectionVec( LCIO::MCPARTICLE ) ;
+
+  int nPart = 3 * nTypes + _nEvt % nTypes ;
+
+  for( int i=0 ; i < nPart ; i++ ){
+
+    int t = ( i + _nEvt ) % nTypes ;
+
+    MCParticleImpl* mcp = new MCParticleImpl ;
+
+    mcp->setPDG( pdgs[t] ) ;
+    mcp->setCharge( charges[t] ) ;
+    mcp->setMass( masses[t] ) ;
+    mcp->setGeneratorStatus( status[t] ) ;
+
+    // forward, central and backward particles from 0.5 to ~50 GeV
+    double p[3] ;
+    p[0] = 0.5 * ( 1 + i % 7 ) ;
+    p[1] = 0.3 * ( i % 5 - 2 ) ;
+    p[2] = 2.0 * ( ( i + 3 * _nEvt ) % 9 - 4 ) * ( 1 + i % 3 ) ;
+    mcp->setMomentum( p ) ;
+
+    double vtx[3] = { 0.01 * i , -0.01 * i , 0.1 * _nEvt } ;
+    mcp->setVertex( vtx ) ;
+
+    col->addElement( mcp ) ;
+  }
+
+  evt->addCollection( col , _colName ) ;
+
+  streamlog_out(DEBUG) << " added " << nPart << " MCParticles to event " << evt->getEventNumber() << std::endl ;
+
+  ++_nEvt ;
+}
@@ -6,12 +6,19 @@
 #include "MarlinTrk/Factory.h"
 #include "marlin/Global.h"
 #include <EVENT/Track.h>
+#include <UTIL/BitField64.h>
 #include "DDRec/Surface.h"
 #include "DDRec/DetectorSurfaces.h"
 #include "DDRec/SurfaceManager.h"
 #include "DDRec/SurfaceHelper.h"
 
 #include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
 
 #include "TH1.h"
 #include "TCanvas.h"
@@ -28,8 +35,7 @@ using namespace MarlinTrk ;
 using namespace DD4hep::DDRec;
 
 
-class TFile;
-class TTree;
+class OutputTree;
 
 class HitResiduals : public Processor {
   
@@ -55,6 +61,34 @@ class HitResiduals : public Processor {
   virtual void end() ;
   
   LCCollection* GetCollection( LCEvent*& evt, std::string colName );
+
+  /** Residuals of one hit of a track. */
+  struct HitResidual {
+    int subdet ;
+    int layer ;
+    double resX ;
+    double resY ;
+    double resU ;  // in the local coordinates of the sensor
+    double resV ;
+    bool ok ;      // false if the track could not be propagated to the layer of the hit
+  } ;
+
+  /** Debug output of the refit of one track. The refit may run on a worker thread, which must
+   *  not use streamlog, so the lines are collected here and written by processEvent().
+   */
+  struct TrackLog {
+    bool debug1, debug2, debug4 ;                      // the levels that are written
+    std::vector< std::pair<int,std::string> > lines ;  // DEBUG level and text
+  } ;
+
+  /** Refit the track with the given track system and compute the residuals of all its hits, in
+   *  the order of the track's hits. The track is propagated once per layer. Does not modify the
+   *  processor - the track system and the decoders have to be owned by the calling thread.
+   *  The debug output is added to log, if not NULL.
+   */
+  void computeResiduals( Track* track, MarlinTrk::IMarlinTrkSystem* trksystem,
+			 UTIL::BitField64& decoder, UTIL::BitField64& encoder,
+			 std::vector<HitResidual>& residuals, TrackLog* log ) ;
   int FitInit2( Track*& track, MarlinTrk::IMarlinTrack*& _marlinTrk );
   int FitInitFromLCIOTrackState( Track*& track, MarlinTrk::IMarlinTrack*& _marlinTrk );
 
@@ -65,11 +99,13 @@ class HitResiduals : public Processor {
 
   std::string _outFileName;
   std::string _treeName;
+  std::string _compressionAlgorithm;
+  int _compressionLevel;
+  int _autoFlushEntries;
+  bool _arrayBranches;
+  bool _asyncWrite;
 
-  TFile* _out;
-  TTree* _tree;
-  TTree* _treenew;
-  TFile* _outnew;
+  OutputTree* _tree;
   TH1F *hresX ;
   //TH1F* histogramvector ;
   //TCanvas* residuals;
@@ -79,17 +115,41 @@ class HitResiduals : public Processor {
 
   std::vector<double > _resX;
   std::vector<double > _resY;
+  std::vector<double > _resU;
+  std::vector<double > _resV;
   std::vector<int > _subdet;
   std::vector<int > _layer;
   
   MarlinTrk::IMarlinTrkSystem* _trksystem;
-  SurfaceMap _surfMap;
+  const SurfaceMap* _surfMap;
   bool _MSOn;
   bool _ElossOn;
   bool _SmoothOn;
   double _Max_Chi2_Incr;
   double _bField;
 
+  int _nThreads;
+  UTIL::BitField64* _cellIDDecoder;
+  UTIL::BitField64* _layerEncoder;
+
+  /** Main loop of a refit worker - refits the tracks of every event posted by processEvent(). */
+  void workerLoop( MarlinTrk::IMarlinTrkSystem* trksystem ) ;
+
+  // ---- refit workers, started in init() if NumberOfThreads > 1 - every worker has its own track system
+  std::vector<std::thread> _workers;
+  std::vector<MarlinTrk::IMarlinTrkSystem*> _workerTrkSystems;
+  std::mutex _workerMutex;
+  std::condition_variable _workerCond;
+  unsigned _jobID;                 // incremented for every event posted to the workers
+  int _nBusy;                      // workers that have not finished the current event
+  bool _stopWorkers;
+  LCCollection* _jobCol;
+  int _jobNTrk;
+  std::atomic<int> _nextTrk;
+  std::vector< std::vector<HitResidual> >* _jobResults;
+  std::vector<TrackLog>* _jobLogs;   // NULL if there is no debug output
+  std::exception_ptr _jobError;
+
 };
 
 #endif
@@ -0,0 +1,69 @@
+#ifndef TrackingCache_h
+#define TrackingCache_h 1
+
+#include "DDRec/SurfaceManager.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace MarlinTrk{
+  class IMarlinTrkSystem ;
+}
+
+namespace marlin{
+  class FieldMap ;
+}
+
+/** Tracking geometry shared by all tracking processors of a job.<br>
+ *  The MarlinTrkSystem of a given type and configuration, the DD4hep surface map and the
+ *  magnetic field are created once, by the first processor asking for them in init(),
+ *  and then handed out to every other processor. Creation is thread safe. The surface map and
+ *  the field map are read only. The field map is always created from the DD4hep field, like the
+ *  geometry, and is owned by the cache - it is independent of Global::FIELDMAP, which Marlin
+ *  creates from GEAR, and a warning is printed if the two disagree.
+ *
+ *  @version $Id:$
+ */
+class TrackingCache {
+
+ public:
+
+  /** The unique instance.
+   */
+  static TrackingCache* instance() ;
+
+  /** The initialized track system of the given type and fit options - shared by all processors
+   *  using the same configuration.
+   */
+  MarlinTrk::IMarlinTrkSystem* trkSystem( const std::string& type, bool useQMS, bool usedEdx, bool useSmoothing ) ;
+
+  /** A new initialized track system of the given type and fit options that is not shared - owned
+   *  by the caller, e.g. for a thread that must not share its track system with other threads.
+   */
+  MarlinTrk::IMarlinTrkSystem* createTrkSystem( const std::string& type, bool useQMS, bool usedEdx, bool useSmoothing ) ;
+
+  /** The surfaces of the DD4hep world volume.
+   */
+  const DD4hep::DDRec::SurfaceMap* surfaceMap() ;
+
+  /** The magnetic field of DD4hep - owned by the cache, which lives until the end of the program.
+   */
+  const marlin::FieldMap* fieldMap() ;
+
+ protected:
+
+  TrackingCache() ;
+  TrackingCache( const TrackingCache& ) ;
+  TrackingCache& operator=( const TrackingCache& ) ;
+
+  /** Create and initialize a track system - called with _mutex locked. */
+  MarlinTrk::IMarlinTrkSystem* create( const std::string& type, bool useQMS, bool usedEdx, bool useSmoothing ) ;
+
+  std::mutex _mutex ;
+  std::map< std::string, MarlinTrk::IMarlinTrkSystem* > _trkSystems ;
+  const DD4hep::DDRec::SurfaceMap* _surfMap ;
+  const marlin::FieldMap* _fieldMap ;
+};
+
+#endif
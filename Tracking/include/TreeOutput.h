@@ -0,0 +1,208 @@
+#ifndef TreeOutput_h
+#define TreeOutput_h 1
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+class TFile ;
+class TTree ;
+class TBranch ;
+class AsyncWriter ;
+
+/** Options for an OutputTree - typically set from processor parameters.
+ */
+struct TreeOptions {
+
+  TreeOptions() : autoFlush(1000), arrayBranches(false), asyncWrite(false), maxQueuedEntries(1000) {}
+
+  /** Flush the baskets every autoFlush entries (< 0: every -autoFlush bytes). ROOT optimizes
+   *  the basket sizes of all branches at the first flush. */
+  long long autoFlush ;
+
+  /** Write vector columns as variable length arrays "name[n_name]/D" instead of std::vector. */
+  bool arrayBranches ;
+
+  /** Fill the tree from the I/O thread of its file - either all or none of the trees of a file
+   *  have to use it. */
+  bool asyncWrite ;
+
+  /** Maximum number of entries waiting for the I/O thread before fill() blocks - the value of
+   *  the first tree of the file is used. */
+  unsigned maxQueuedEntries ;
+} ;
+
+
+/** A TTree with int, double and vector columns written to the file managed by TreeOutput.<br>
+ *  The columns are declared with addColumn() from variables of the processor, before the
+ *  first entry. fill() writes their current values to the tree, either directly or - with
+ *  TreeOptions::asyncWrite - as a copy handed to the I/O thread of the file, so the processor
+ *  can reuse its variables right after fill().
+ *
+ *  @see TreeOutput
+ *  @version $Id:$
+ */
+class OutputTree {
+
+  friend class TreeOutput ;
+  friend class AsyncWriter ;
+
+ public:
+
+  void addColumn( const std::string& name, const int* value ) ;
+  void addColumn( const std::string& name, const double* value ) ;
+  void addColumn( const std::string& name, const std::vector<int>* values ) ;
+  void addColumn( const std::string& name, const std::vector<double>* values ) ;
+
+  /** Write an entry with the current values of all columns.
+   */
+  void fill() ;
+
+  /** The underlying tree - owned by the file and deleted with this object in TreeOutput::close(). */
+  TTree* tree() { return _tree ; }
+
+  /** The number of entries written or queued so far. */
+  long long entries() const { return _nEntries ; }
+
+ protected:
+
+  /** The values of one entry. */
+  struct Entry {
+    std::vector<int> ints ;
+    std::vector<double> doubles ;
+    std::vector< std::vector<int> > intVecs ;
+    std::vector< std::vector<double> > doubleVecs ;
+  } ;
+
+  OutputTree( TTree* tree, const TreeOptions& options, AsyncWriter* writer ) ;
+  OutputTree( const OutputTree& ) ;
+  OutputTree& operator=( const OutputTree& ) ;
+  ~OutputTree() {}
+
+  /** Create the branches - at the first fill(). */
+  void createBranches() ;
+
+  /** Copy the current values of the columns to the entry. */
+  void copyValues( Entry& e ) const ;
+
+  /** Fill the tree with the given entry - swaps the vectors with the entry. */
+  void write( Entry& e ) ;
+
+  /** Fill the tree with the values in _current. */
+  void fillTree() ;
+
+  TTree* _tree ;
+  TreeOptions _options ;
+  AsyncWriter* _writer ;
+  long long _nEntries ;
+  bool _branchesCreated ;
+
+  // ---- columns
+  std::vector<std::string> _intNames, _doubleNames, _intVecNames, _doubleVecNames ;
+  std::vector<const int*> _ints ;
+  std::vector<const double*> _doubles ;
+  std::vector<const std::vector<int>*> _intVecs ;
+  std::vector<const std::vector<double>*> _doubleVecs ;
+
+  // ---- values the branches point to
+  Entry _current ;
+  std::vector<std::vector<int>*> _intVecPtrs ;
+  std::vector<std::vector<double>*> _doubleVecPtrs ;
+  std::vector<int> _intVecCounts ;
+  std::vector<int> _doubleVecCounts ;
+  std::vector<TBranch*> _intArrayBranches ;
+  std::vector<TBranch*> _doubleArrayBranches ;
+} ;
+
+
+/** The I/O thread of a file written with TreeOptions::asyncWrite - fills the trees of the file
+ *  with the queued entries in the order of OutputTree::fill(), so that only one thread writes
+ *  to the file.
+ *
+ *  @see TreeOutput
+ *  @version $Id:$
+ */
+class AsyncWriter {
+
+  friend class OutputTree ;
+  friend class TreeOutput ;
+
+ protected:
+
+  AsyncWriter( unsigned maxQueuedEntries ) ;
+  AsyncWriter( const AsyncWriter& ) ;
+  AsyncWriter& operator=( const AsyncWriter& ) ;
+  ~AsyncWriter() ;
+
+  /** Queue an entry of the tree - blocks while the queue is full, rethrows an exception of the I/O thread. */
+  void push( OutputTree* tree, OutputTree::Entry& e ) ;
+
+  /** Main loop of the I/O thread. */
+  void ioLoop() ;
+
+  /** Write all queued entries and stop the I/O thread - rethrows an exception of the I/O thread. */
+  void finish() ;
+
+  unsigned _maxQueuedEntries ;
+  std::deque< std::pair< OutputTree*, OutputTree::Entry > > _queue ;
+  std::mutex _mutex ;
+  std::condition_variable _cond ;
+  std::thread _thread ;
+  bool _stop ;
+  std::exception_ptr _exception ;
+} ;
+
+
+/** Manages one ROOT output file shared by all processors that write trees.<br>
+ *  The file is opened by the first processor calling open() - with its compression algorithm
+ *  ("zlib", "lzma" or "default" for the ROOT default) and level - and written and closed when
+ *  the last processor has called close(). Processors opening a different file name get their
+ *  own file.
+ *
+ *  @version $Id:$
+ */
+class TreeOutput {
+
+ public:
+
+  /** The unique instance.
+   */
+  static TreeOutput* instance() ;
+
+  /** Open the file for writing or share it if it is already open.
+   */
+  void open( const std::string& fileName, const std::string& compressionAlgorithm="default", int compressionLevel=1 ) ;
+
+  /** Create a tree in the given file.
+   */
+  OutputTree* createTree( const std::string& fileName, const std::string& name, const std::string& title,
+			  const TreeOptions& options=TreeOptions() ) ;
+
+  /** Release the file - the trees are written and the file closed for the last user.
+   */
+  void close( const std::string& fileName ) ;
+
+ protected:
+
+  /** An open file, its trees and - if they are written asynchronously - its I/O thread. */
+  struct OutputFile {
+    TFile* file ;
+    int nUsers ;
+    std::vector<OutputTree*> trees ;
+    AsyncWriter* writer ;
+  } ;
+
+  TreeOutput() ;
+  TreeOutput( const TreeOutput& ) ;
+  TreeOutput& operator=( const TreeOutput& ) ;
+
+  std::mutex _mutex ;
+  std::map< std::string, OutputFile > _files ;
+} ;
+
+#endif
@@ -1,7 +1,10 @@
 
 #include "HitResiduals.h"
+#include "TrackingCache.h"
+#include "TreeOutput.h"
 
 #include <iostream>
+#include <sstream>
 #include <algorithm>    // std::sort
 
 #include <EVENT/LCCollection.h>
@@ -14,8 +17,12 @@
 #include <UTIL/BitField64.h>
 #include <UTIL/ILDConf.h>
 
-#include "DD4hep/LCDD.h"
+#include "marlin/FieldMap.h"
+#include "marlin/ProcessorScheduler.h"
+
 #include "DD4hep/DD4hepUnits.h"
+#include "DDSurfaces/ISurface.h"
+#include "DDSurfaces/Vector3D.h"
 
 
 // ----- include for verbosity dependend logging ---------
@@ -26,11 +33,14 @@
 #include "fpcompare.h"
 
 #include "LinkDef.h"
-#include "TFile.h"
-#include "TTree.h"
 #include "TVector3.h"
 #include "TLorentzVector.h"
 #include <cmath>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
 
 //
 
@@ -45,6 +55,8 @@ TCanvas* totalenergy = new TCanvas("total energy","total energy",800,800);
  
 SPAnalysis aSPAnalysis ;
 
+MARLIN_PROCESSOR_ONLY_LIBRARY
+
 
 SPAnalysis::SPAnalysi() : Processor("HitResiduals") {
 
@@ -70,6 +82,42 @@ SPAnalysis::SPAnalysi() : Processor("HitResiduals") {
 				_treeName,
 				std::string("tree")
 				);
+
+    registerProcessorParameter( "CompressionAlgorithm",
+				"Compression algorithm of the output file: zlib, lzma or default - shared with the other processors writing to the same file",
+				_compressionAlgorithm,
+				std::string("default")
+				);
+
+    registerProcessorParameter( "CompressionLevel",
+				"Compression level of the output file",
+				_compressionLevel,
+				int(1)
+				);
+
+    registerProcessorParameter( "AutoFlushEntries",
+				"Number of entries after which the baskets are flushed - the basket sizes are optimized at the first flush",
+				_autoFlushEntries,
+				int(1000)
+				);
+
+    registerProcessorParameter( "ArrayBranches",
+				"Write the residuals as variable length arrays instead of std::vector",
+				_arrayBranches,
+				bool(false)
+				);
+
+    registerProcessorParameter( "AsynchronousWrite",
+				"Fill the tree on the I/O thread of the output file - all processors writing to the file have to use the same setting",
+				_asyncWrite,
+				bool(false)
+				);
+
+    registerProcessorParameter( "NumberOfThreads",
+				"Number of threads the tracks of an event are refitted on - every thread uses its own MarlinTrkSystem",
+				_nThreads,
+				int(1)
+				);
 /* Commenting out for development test - Ross
     registerProcessorParameter("MultipleScatteringOn",
 			       "Use MultipleScattering in Fit",
@@ -91,6 +139,23 @@ SPAnalysis::SPAnalysi() : Processor("HitResiduals") {
 			       _Max_Chi2_Incr,
 			       double(1000.));
 */
+    _tree = 0 ;
+    _trksystem = 0 ;
+    _surfMap = 0 ;
+    _cellIDDecoder = 0 ;
+    _layerEncoder = 0 ;
+    _jobID = 0 ;
+    _nBusy = 0 ;
+    _stopWorkers = false ;
+    _jobCol = 0 ;
+    _jobNTrk = 0 ;
+    _nextTrk = 0 ;
+    _jobResults = 0 ;
+    _jobLogs = 0 ;
+    _MSOn = true ;
+    _ElossOn = true ;
+    _SmoothOn = false ;
+    _Max_Chi2_Incr = 1000. ;
 }
 
 
@@ -102,35 +167,47 @@ void HitResiduals::init() {
   _nRun = 0 ;
   _nEvt = 0 ;
 
-  _out  = new TFile(_outFileName.c_str(), "RECREATE");
-  _tree = new TTree(_treeName.c_str(), _treeName.c_str());
+  // output file - shared with the other processors writing to the same file
+  TreeOutput* output = TreeOutput::instance() ;
 
-  int bufsize = 32000; //default buffer size 32KB
+  output->open( _outFileName, _compressionAlgorithm, _compressionLevel ) ;
 
-  _tree->Branch("nRun", &_nRun,"nRun/I");
-  _tree->Branch("nEvt", &_nEvt,"nEvt/I");
-  _tree->Branch("resX", "std::vector<double >",&_resX,bufsize,0);
-  _tree->Branch("resY", "std::vector<double >",&_resY,bufsize,0);
-  _tree->Branch("subdet", "std::vector<int >",&_subdet,bufsize,0);
-  _tree->Branch("layer", "std::vector<int >",&_layer,bufsize,0);
+  TreeOptions options ;
+  options.autoFlush = _autoFlushEntries ;
+  options.arrayBranches = _arrayBranches ;
+  options.asyncWrite = _asyncWrite ;
 
-  DD4hep::Geometry::LCDD& lcdd = DD4hep::Geometry::LCDD::getInstance();
+  _tree = output->createTree( _outFileName, _treeName, _treeName, options ) ;
 
-  const double pos[3]={0,0,0}; 
-  double bFieldVec[3]={0,0,0}; 
-  lcdd.field().magneticField(pos,bFieldVec); // get the magnetic field vector from DD4hep
-  _bField = bFieldVec[2]/dd4hep::tesla; // z component at (0,0,0)
+  _tree->addColumn( "nRun", &_nRun );
+  _tree->addColumn( "nEvt", &_nEvt );
+  _tree->addColumn( "resX", &_resX );
+  _tree->addColumn( "resY", &_resY );
+  _tree->addColumn( "resU", &_resU );
+  _tree->addColumn( "resV", &_resV );
+  _tree->addColumn( "subdet", &_subdet );
+  _tree->addColumn( "layer", &_layer );
 
-  // trksystem for marlin track
-  _trksystem =  MarlinTrk::Factory::createMarlinTrkSystem( "DDKalTest" , marlin::Global::GEAR , "" ) ;
-  
-  if( _trksystem == 0 ) 
-    throw EVENT::Exception( std::string("  Cannot initialize MarlinTrkSystem of Type: ") + std::string("DDKalTest") );
-  
-  _trksystem->setOption( IMarlinTrkSystem::CFG::useQMS,        _MSOn ) ;
-  _trksystem->setOption( IMarlinTrkSystem::CFG::usedEdx,       _ElossOn) ;
-  _trksystem->setOption( IMarlinTrkSystem::CFG::useSmoothing,  _SmoothOn) ;
-  _trksystem->init() ;  
+  // geometry, field and trksystem for marlin track - shared with the other tracking processors
+  TrackingCache* cache = TrackingCache::instance() ;
+
+  _bField = cache->fieldMap()->bzAtOrigin() ; // z component at (0,0,0)
+
+  _surfMap = cache->surfaceMap() ;
+
+  _trksystem = cache->trkSystem( "DDKalTest" , _MSOn , _ElossOn , _SmoothOn ) ;
+
+  // decoders for the sequential refit - the workers create their own
+  _cellIDDecoder = new UTIL::BitField64( SiDecoderString ) ;
+  _layerEncoder = new UTIL::BitField64( SiDecoderString ) ;
+
+  // the track systems are not thread safe - every worker gets its own
+  for( int t = 0 ; _nThreads > 1 && t < _nThreads ; ++t ){
+
+    _workerTrkSystems.push_back( cache->createTrkSystem( "DDKalTest" , _MSOn , _ElossOn , _SmoothOn ) ) ;
+
+    _workers.push_back( std::thread( &HitResiduals::workerLoop , this , _workerTrkSystems.back() ) ) ;
+  }
   
  } 
 
@@ -145,103 +222,98 @@ void HitResiduals::processRunHeader( LCRunHeader* run) {
 void HitResiduals::processEvent( LCEvent * evt ) { 
 
   // this gets called for every event 
-  std:cout << "Processing event " << _nEvt << std::endl;
-  
-  //streamlog_out(DEBUG2) << "----- _nEvt = " << _nEvt << std::endl;
+  streamlog_out(DEBUG2) << "----- _nEvt = " << _nEvt << std::endl;
 
   //clear vectors
   _resX.clear();
   _resY.clear();
+  _resU.clear();
+  _resV.clear();
   _subdet.clear();
   _layer.clear();
 
-  UTIL::BitField64 cellid_decoder( SiDecoderString ) ; 	    
-  UTIL::BitField64 encoder(SiDecoderString) ; 	    
-  encoder.reset() ;  // reset to 0
-  int layerID = encoder.lowWord() ;  
-  int elementID = 0 ;    
-
   LCCollection* inputTrkCol = this->GetCollection( evt, _inputTrkColName );
 
   if (inputTrkCol!=0) {
 
-    for( int i= 0; i < inputTrkCol->getNumberOfElements(); i++ ) {
-      
-      // std::cout << "Processing track " << i << std::endl;
+    int nTrk = inputTrkCol->getNumberOfElements() ;
 
-      Track* track = dynamic_cast<Track*>( inputTrkCol->getElementAt(i) );
-      MarlinTrk::IMarlinTrack* marlin_trk = _trksystem->createTrack();
-      
-      EVENT::TrackerHitVec trkHits = track->getTrackerHits() ;
-      // sort(trkHits.begin(), trkHits.end(), RSort() );
-      // reverse(trkHits.begin(), trkHits.end());
-	
-      for( EVENT::TrackerHitVec::iterator it = trkHits.begin() ; it != trkHits.end() ; ++it ){
-      	marlin_trk->addHit(*it);	
+    std::vector< std::vector<HitResidual> > results( nTrk ) ;
+
+    // the debug output of the refit is only collected if it is written
+    TrackLog log ;
+    {
+      std::lock_guard<ProcessorScheduler::LogMutex> lock( ProcessorScheduler::logMutex() ) ;
+      log.debug1 = streamlog::out.write<streamlog::DEBUG1>() ;
+      log.debug2 = streamlog::out.write<streamlog::DEBUG2>() ;
+      log.debug4 = streamlog::out.write<streamlog::DEBUG4>() ;
+    }
+    std::vector<TrackLog> logs ;
+    if( log.debug1 || log.debug2 || log.debug4 )
+      logs.assign( nTrk , log ) ;
+    std::vector<TrackLog>* jobLogs = ( logs.empty() ? 0 : &logs ) ;
+
+    if( ! _workers.empty() && nTrk > 1 ) {
+
+      // post the event to the workers and wait until all of them are done with it
+      std::unique_lock<std::mutex> lock( _workerMutex ) ;
+
+      _jobCol = inputTrkCol ;
+      _jobNTrk = nTrk ;
+      _jobResults = &results ;
+      _jobLogs = jobLogs ;
+      _jobError = std::exception_ptr() ;
+      _nextTrk = 0 ;
+      _nBusy = _workers.size() ;
+      ++_jobID ;
+
+      _workerCond.notify_all() ;
+      _workerCond.wait( lock , [this]{ return _nBusy == 0 ; } ) ;
+
+      if( _jobError ) std::rethrow_exception( _jobError ) ;
+
+    } else {
+
+      for( int i= 0; i < nTrk; i++ ) {
+	Track* track = dynamic_cast<Track*>( inputTrkCol->getElementAt(i) );
+	computeResiduals( track, _trksystem, *_cellIDDecoder, *_layerEncoder, results[i],
+			  jobLogs ? &logs[i] : 0 ) ;
       }
-    
-      int init_status = FitInitFromLCIOTrackState(track, marlin_trk);          
-      
-      double resX = 0.;
-      double resY = 0.;
-      
-      for( EVENT::TrackerHitVec::iterator it = trkHits.begin(); it != trkHits.end(); ++it ){
-	
-	encoder.reset() ;  // reset to 0
-	int layerID = encoder.lowWord() ;  	   
-	int elementID = 0;
-	DD4hep::long64 id = (*it)->getCellID0() ;
-	cellid_decoder.setValue( id ) ;
-	streamlog_out(DEBUG1) << "id = " << id << std::endl;
-
-	int layer = cellid_decoder["layer"].value();
-	int subdet = cellid_decoder["subdet"].value();
-	streamlog_out(DEBUG1) << "layer = " << layer << std::endl;
-	streamlog_out(DEBUG1) << "subdet = " << subdet << std::endl;
-
-	//note: SiDecoderString="subdet:6,side:3,layer:4,module:12,sensor:1";
-	encoder[lcio::ILDCellID0::subdet] = subdet;  
-	
-	encoder[lcio::ILDCellID0::layer]  = layer;   
-	layerID = encoder.lowWord();  
+    }
+
+    // write the debug output in track order
+    if( jobLogs ) {
+      std::lock_guard<ProcessorScheduler::LogMutex> lock( ProcessorScheduler::logMutex() ) ;
+      for( int i= 0; i < nTrk; i++ ) {
+	for( unsigned k = 0 ; k < logs[i].lines.size() ; ++k ){
+	  const std::string& text = logs[i].lines[k].second ;
+	  switch( logs[i].lines[k].first ){
+	  case 1:  streamlog_out(DEBUG1) << text ; break ;
+	  case 2:  streamlog_out(DEBUG2) << text ; break ;
+	  default: streamlog_out(DEBUG4) << text ; break ;
+	  }
+	}
+      }
+    }
 
-	streamlog_out(DEBUG1) << "layerID = " << layerID << std::endl;
+    // fill the tree in track and hit order
+    for( int i= 0; i < nTrk; i++ ) {
+      for( std::vector<HitResidual>::const_iterator r = results[i].begin() ; r != results[i].end() ; ++r ){
 
-	TrackStateImpl trkState;
-	double chi2 = 0 ;
-	int ndf = 0 ;
-	
-	if ( marlin_trk->propagateToLayer( layerID, trkState, chi2, ndf, elementID, IMarlinTrack::modeClosest) == MarlinTrk::IMarlinTrack::success) {
-
-	  // cout << "This is subdet number " << subdet << endl;
-	  const float* pivot = trkState.getReferencePoint();
-	  double fitX  = pivot[0];
-	  double fitY  = pivot[1];
-	  streamlog_out(DEBUG2) << " ----- fit x[mm], y[mm], r[mm] = " << fitX <<"   "<< fitY <<"   "<< sqrt(pow(fitX,2)+pow(fitY,2)) <<std::endl;
-	  const double* hit_pos = (*it)->getPosition();
-	  double hitX = hit_pos[0];
-	  double hitY = hit_pos[1];
-	  streamlog_out(DEBUG2) << " ----- hit x[mm], y[mm], r[mm] and layerID  =  " << hitX <<"   "<< hitY <<"   "<< sqrt(pow(hitX,2)+pow(hitY,2))<<"  "<<layerID<<std::endl;
-	  
-	  double resX = hitX - fitX ;
-	  double resY = hitY -fitY ;
-
-	  // cout<<"layerID  "<<layerID<<endl;
-	  
-    	  _resX.push_back(resX);
-	  _resY.push_back(resY);
-	  _subdet.push_back(subdet);
-	  _layer.push_back(layer);
-
- 	} else streamlog_out(DEBUG4) << "FAIL" << std::endl;
-
-      }//end loop on hits
-
-    }//end loop on tracks
+	if( ! r->ok ) continue ;
+
+	_resX.push_back( r->resX );
+	_resY.push_back( r->resY );
+	_resU.push_back( r->resU );
+	_resV.push_back( r->resV );
+	_subdet.push_back( r->subdet );
+	_layer.push_back( r->layer );
+      }
+    }
 
   }
 
-  _tree->Fill();
+  _tree->fill();
  
   streamlog_out(DEBUG) << "   processing event: " << evt->getEventNumber() 
 		       << "   in run:  " << evt->getRunNumber() << std::endl;
@@ -252,6 +324,158 @@ void HitResiduals::processEvent( LCEvent * evt ) {
 
 
 
+void HitResiduals::workerLoop( MarlinTrk::IMarlinTrkSystem* trksystem ) {
+
+  UTIL::BitField64 decoder( SiDecoderString ) ;
+  UTIL::BitField64 encoder( SiDecoderString ) ;
+
+  unsigned jobID = 0 ;
+
+  while( true ){
+
+    {
+      std::unique_lock<std::mutex> lock( _workerMutex ) ;
+
+      _workerCond.wait( lock , [&]{ return _stopWorkers || _jobID != jobID ; } ) ;
+
+      if( _stopWorkers ) return ;
+
+      jobID = _jobID ;
+    }
+
+    // tracks are taken one by one from the shared counter
+    try{
+      for( int i = _nextTrk++ ; i < _jobNTrk ; i = _nextTrk++ ){
+	Track* track = dynamic_cast<Track*>( _jobCol->getElementAt(i) );
+	computeResiduals( track, trksystem, decoder, encoder, (*_jobResults)[i],
+			  _jobLogs ? &(*_jobLogs)[i] : 0 ) ;
+      }
+    } catch(...) {
+      std::lock_guard<std::mutex> lock( _workerMutex ) ;
+      if( ! _jobError ) _jobError = std::current_exception() ;
+      _nextTrk = _jobNTrk ;
+    }
+
+    std::lock_guard<std::mutex> lock( _workerMutex ) ;
+
+    if( --_nBusy == 0 )
+      _workerCond.notify_all() ;
+  }
+}
+
+
+
+void HitResiduals::computeResiduals( Track* track, MarlinTrk::IMarlinTrkSystem* trksystem,
+				     UTIL::BitField64& decoder, UTIL::BitField64& encoder,
+				     std::vector<HitResidual>& residuals, TrackLog* log ) {
+
+  const EVENT::TrackerHitVec& trkHits = track->getTrackerHits() ;
+
+  int nHits = trkHits.size() ;
+
+  residuals.resize( nHits ) ;
+
+  std::unique_ptr<MarlinTrk::IMarlinTrack> marlin_trk( trksystem->createTrack() ) ;
+
+  for( EVENT::TrackerHitVec::const_iterator it = trkHits.begin() ; it != trkHits.end() ; ++it ){
+    marlin_trk->addHit(*it);
+  }
+
+  MarlinTrk::IMarlinTrack* trk = marlin_trk.get() ;
+  FitInitFromLCIOTrackState( track, trk ) ;
+
+  // decode subdetector and layer of every hit and sort the hits by layer,
+  // so that the track is propagated only once to every layer
+  std::vector< std::pair<int,int> > order( nHits ) ; // layerID, hit index
+
+  for( int i = 0 ; i < nHits ; ++i ){
+
+    //note: SiDecoderString="subdet:6,side:3,layer:4,module:12,sensor:1";
+    decoder.setValue( trkHits[i]->getCellID0() ) ;
+
+    HitResidual& r = residuals[i] ;
+    r.ok = false ;
+    r.subdet = decoder[lcio::ILDCellID0::subdet].value() ;
+    r.layer = decoder[lcio::ILDCellID0::layer].value() ;
+
+    encoder.reset() ;  // reset to 0
+    encoder[lcio::ILDCellID0::subdet] = r.subdet ;
+    encoder[lcio::ILDCellID0::layer]  = r.layer ;
+
+    order[i] = std::make_pair( int( encoder.lowWord() ) , i ) ;
+
+    if( log && log->debug1 ) {
+      std::stringstream line ;
+      line << "id = " << trkHits[i]->getCellID0() << " subdet = " << r.subdet
+	   << " layer = " << r.layer << " layerID = " << order[i].first << std::endl;
+      log->lines.push_back( std::make_pair( 1 , line.str() ) ) ;
+    }
+  }
+
+  std::sort( order.begin() , order.end() ) ;
+
+  TrackStateImpl trkState;
+  bool propagated = false ;
+
+  for( int k = 0 ; k < nHits ; ++k ){
+
+    int layerID = order[k].first ;
+    HitResidual& r = residuals[ order[k].second ] ;
+    EVENT::TrackerHit* hit = trkHits[ order[k].second ] ;
+
+    if( k == 0 || layerID != order[k-1].first ) {
+
+      double chi2 = 0 ;
+      int ndf = 0 ;
+      int elementID = 0 ;
+
+      propagated = ( trk->propagateToLayer( layerID, trkState, chi2, ndf, elementID, IMarlinTrack::modeClosest) == MarlinTrk::IMarlinTrack::success ) ;
+    }
+
+    if( ! propagated ) {
+      if( log && log->debug4 )
+	log->lines.push_back( std::make_pair( 4 , std::string( "FAIL\n" ) ) ) ;
+      continue ;
+    }
+
+    const float* pivot = trkState.getReferencePoint();
+    const double* hit_pos = hit->getPosition();
+
+    r.resX = hit_pos[0] - pivot[0] ;
+    r.resY = hit_pos[1] - pivot[1] ;
+
+    if( log && log->debug2 ) {
+      std::stringstream line ;
+      line << " ----- fit x[mm], y[mm] = " << pivot[0] <<"   "<< pivot[1]
+	   << " hit x[mm], y[mm] = " << hit_pos[0] <<"   "<< hit_pos[1] << " layerID = " << layerID << std::endl;
+      log->lines.push_back( std::make_pair( 2 , line.str() ) ) ;
+    }
+
+    // residuals in the local coordinates of the sensor surface (DD4hep uses cm)
+    r.resU = 0. ;
+    r.resV = 0. ;
+
+    SurfaceMap::const_iterator si = _surfMap->find( hit->getCellID0() ) ;
+
+    if( si != _surfMap->end() ) {
+
+      const DDSurfaces::ISurface* surf = si->second ;
+
+      DDSurfaces::Vector3D hitPos( hit_pos[0] * dd4hep::mm , hit_pos[1] * dd4hep::mm , hit_pos[2] * dd4hep::mm ) ;
+      DDSurfaces::Vector3D fitPos( pivot[0] * dd4hep::mm , pivot[1] * dd4hep::mm , pivot[2] * dd4hep::mm ) ;
+
+      DDSurfaces::Vector2D hitUV = surf->globalToLocal( hitPos ) ;
+      DDSurfaces::Vector2D fitUV = surf->globalToLocal( fitPos ) ;
+
+      r.resU = ( hitUV.u() - fitUV.u() ) / dd4hep::mm ;
+      r.resV = ( hitUV.v() - fitUV.v() ) / dd4hep::mm ;
+    }
+
+    r.ok = true ;
+  }
+}
+
+
 void HitResiduals::check( LCEvent * evt ) { 
     // nothing to check here 
 }
@@ -259,11 +483,27 @@ void HitResiduals::check( LCEvent * evt ) {
 
 void HitResiduals::end(){ 
 
-  _tree->Write();
-  _out->Write();
-  _out->Close();
+  // the tree is written when the last processor using the file has finished
+  _tree = 0 ;
+  TreeOutput::instance()->close( _outFileName ) ;
+
+  delete _cellIDDecoder ;
+  delete _layerEncoder ;
+
+  {
+    std::lock_guard<std::mutex> lock( _workerMutex ) ;
+    _stopWorkers = true ;
+  }
+  _workerCond.notify_all() ;
+
+  for( unsigned t = 0 ; t < _workers.size() ; ++t ){
+    _workers[t].join() ;
+    delete _workerTrkSystems[t] ;
+  }
+  _workers.clear() ;
+  _workerTrkSystems.clear() ;
   
-  std::cout << "HitResiduals::end()  " << name() 
+  streamlog_out(MESSAGE) << "HitResiduals::end()  " << name() 
     	    << " processed " << _nEvt << " events in " << _nRun << " runs "
     	    << std::endl ;
 }
@@ -0,0 +1,126 @@
+#include "TrackingCache.h"
+
+#include "MarlinTrk/Factory.h"
+#include "MarlinTrk/IMarlinTrkSystem.h"
+
+#include "marlin/Global.h"
+#include "marlin/FieldMap.h"
+#include "marlin/VerbosityLevels.h"
+
+#include "DD4hep/LCDD.h"
+#include "DD4hep/DD4hepUnits.h"
+
+#include <sstream>
+#include <cmath>
+
+using namespace MarlinTrk ;
+
+
+TrackingCache* TrackingCache::instance(){
+
+  static TrackingCache* me = new TrackingCache ;
+  return me ;
+}
+
+
+TrackingCache::TrackingCache() :
+  _mutex(),
+  _trkSystems(),
+  _surfMap(0),
+  _fieldMap(0) {
+}
+
+
+IMarlinTrkSystem* TrackingCache::trkSystem( const std::string& type, bool useQMS, bool usedEdx, bool useSmoothing ){
+
+  std::stringstream key ;
+  key << type << ":" << useQMS << usedEdx << useSmoothing ;
+
+  std::lock_guard<std::mutex> lock( _mutex ) ;
+
+  IMarlinTrkSystem*& trkSystem = _trkSystems[ key.str() ] ;
+
+  if( trkSystem == 0 ){
+
+    trkSystem = create( type , useQMS , usedEdx , useSmoothing ) ;
+
+    streamlog_out( MESSAGE ) << " TrackingCache: created MarlinTrkSystem " << key.str() << std::endl ;
+  }
+
+  return trkSystem ;
+}
+
+
+IMarlinTrkSystem* TrackingCache::createTrkSystem( const std::string& type, bool useQMS, bool usedEdx, bool useSmoothing ){
+
+  std::lock_guard<std::mutex> lock( _mutex ) ;
+
+  return create( type , useQMS , usedEdx , useSmoothing ) ;
+}
+
+
+IMarlinTrkSystem* TrackingCache::create( const std::string& type, bool useQMS, bool usedEdx, bool useSmoothing ){
+
+  IMarlinTrkSystem* sys = MarlinTrk::Factory::createMarlinTrkSystem( type , marlin::Global::GEAR , "" ) ;
+
+  if( sys == 0 )
+    throw EVENT::Exception( std::string("  Cannot initialize MarlinTrkSystem of Type: ") + type );
+
+  sys->setOption( IMarlinTrkSystem::CFG::useQMS,        useQMS ) ;
+  sys->setOption( IMarlinTrkSystem::CFG::usedEdx,       usedEdx ) ;
+  sys->setOption( IMarlinTrkSystem::CFG::useSmoothing,  useSmoothing ) ;
+  sys->init() ;
+
+  return sys ;
+}
+
+
+const DD4hep::DDRec::SurfaceMap* TrackingCache::surfaceMap(){
+
+  std::lock_guard<std::mutex> lock( _mutex ) ;
+
+  if( _surfMap == 0 ){
+
+    DD4hep::Geometry::LCDD& lcdd = DD4hep::Geometry::LCDD::getInstance() ;
+
+    DD4hep::DDRec::SurfaceManager& surfMan = *lcdd.extension< DD4hep::DDRec::SurfaceManager >() ;
+
+    _surfMap = surfMan.map( "world" ) ;
+  }
+
+  return _surfMap ;
+}
+
+
+const marlin::FieldMap* TrackingCache::fieldMap(){
+
+  std::lock_guard<std::mutex> lock( _mutex ) ;
+
+  if( _fieldMap == 0 ){
+
+    DD4hep::Geometry::LCDD& lcdd = DD4hep::Geometry::LCDD::getInstance() ;
+
+    DD4hep::Geometry::OverlayedField field = lcdd.field() ;
+
+    // DD4hep uses cm - the field map mm
+    _fieldMap = marlin::FieldMap::create( [field]( const double* pos, double* b ){
+	const double p[3] = { pos[0] * dd4hep::mm , pos[1] * dd4hep::mm , pos[2] * dd4hep::mm } ;
+	field.magneticField( p , b ) ;
+	for( int i=0 ; i<3 ; ++i ) b[i] /= dd4hep::tesla ;
+      } ) ;
+
+    streamlog_out( MESSAGE ) << " TrackingCache: created field map from DD4hep - Bz(0,0,0) = "
+			     << _fieldMap->bzAtOrigin() << " T" << std::endl ;
+
+    // the map is owned by the cache - Global::FIELDMAP is owned (and deleted) by Marlin
+    if( marlin::Global::FIELDMAP != 0 &&
+	std::fabs( marlin::Global::FIELDMAP->bzAtOrigin() - _fieldMap->bzAtOrigin() ) > 1e-4 * std::fabs( _fieldMap->bzAtOrigin() ) ) {
+
+      streamlog_out( WARNING ) << " TrackingCache: the field of GEAR (Global::FIELDMAP) differs from the one of DD4hep - Bz(0,0,0) = "
+			       << marlin::Global::FIELDMAP->bzAtOrigin() << " T in GEAR, " << _fieldMap->bzAtOrigin()
+			       << " T in DD4hep - the tracking processors use the one of DD4hep" << std::endl ;
+    }
+  }
+
+  return _fieldMap ;
+}
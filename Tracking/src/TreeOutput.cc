@@ -0,0 +1,444 @@
+#include "TreeOutput.h"
+
+#include "marlin/VerbosityLevels.h"
+
+#include "Exceptions.h"
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TROOT.h"
+#include "Compression.h"
+
+#include <algorithm>
+
+namespace {
+
+  // branch address of empty variable length arrays - nothing is read from it
+  int emptyInts[1] = { 0 } ;
+  double emptyDoubles[1] = { 0. } ;
+
+  const int BUFSIZE = 32000 ; // default buffer size 32KB
+}
+
+
+// ---------------------------------------------------------------------------------------------
+
+OutputTree::OutputTree( TTree* tree, const TreeOptions& options, AsyncWriter* writer ) :
+  _tree( tree ),
+  _options( options ),
+  _writer( writer ),
+  _nEntries( 0 ),
+  _branchesCreated( false ) {
+}
+
+
+void OutputTree::addColumn( const std::string& name, const int* value ){
+
+  if( _branchesCreated )
+    throw EVENT::Exception( std::string(" OutputTree: column added after the first entry: ") + name ) ;
+
+  _intNames.push_back( name ) ;
+  _ints.push_back( value ) ;
+}
+
+
+void OutputTree::addColumn( const std::string& name, const double* value ){
+
+  if( _branchesCreated )
+    throw EVENT::Exception( std::string(" OutputTree: column added after the first entry: ") + name ) ;
+
+  _doubleNames.push_back( name ) ;
+  _doubles.push_back( value ) ;
+}
+
+
+void OutputTree::addColumn( const std::string& name, const std::vector<int>* values ){
+
+  if( _branchesCreated )
+    throw EVENT::Exception( std::string(" OutputTree: column added after the first entry: ") + name ) ;
+
+  _intVecNames.push_back( name ) ;
+  _intVecs.push_back( values ) ;
+}
+
+
+void OutputTree::addColumn( const std::string& name, const std::vector<double>* values ){
+
+  if( _branchesCreated )
+    throw EVENT::Exception( std::string(" OutputTree: column added after the first entry: ") + name ) ;
+
+  _doubleVecNames.push_back( name ) ;
+  _doubleVecs.push_back( values ) ;
+}
+
+
+void OutputTree::createBranches(){
+
+  // sized once - the branches point into these vectors
+  _current.ints.resize( _ints.size() ) ;
+  _current.doubles.resize( _doubles.size() ) ;
+  _current.intVecs.resize( _intVecs.size() ) ;
+  _current.doubleVecs.resize( _doubleVecs.size() ) ;
+  _intVecCounts.resize( _intVecs.size() ) ;
+  _doubleVecCounts.resize( _doubleVecs.size() ) ;
+
+  for( unsigned i=0 ; i < _ints.size() ; ++i )
+    _tree->Branch( _intNames[i].c_str() , &_current.ints[i] , ( _intNames[i] + "/I" ).c_str() ) ;
+
+  for( unsigned i=0 ; i < _doubles.size() ; ++i )
+    _tree->Branch( _doubleNames[i].c_str() , &_current.doubles[i] , ( _doubleNames[i] + "/D" ).c_str() ) ;
+
+  if( _options.arrayBranches ){
+
+    // variable length arrays with a counter branch n_<name> - the address is set for every entry
+    for( unsigned i=0 ; i < _intVecs.size() ; ++i ){
+
+      const std::string& name = _intVecNames[i] ;
+
+      _tree->Branch( ( "n_" + name ).c_str() , &_intVecCounts[i] , ( "n_" + name + "/I" ).c_str() ) ;
+      _intArrayBranches.push_back( _tree->Branch( name.c_str() , emptyInts , ( name + "[n_" + name + "]/I" ).c_str() , BUFSIZE ) ) ;
+    }
+
+    for( unsigned i=0 ; i < _doubleVecs.size() ; ++i ){
+
+      const std::string& name = _doubleVecNames[i] ;
+
+      _tree->Branch( ( "n_" + name ).c_str() , &_doubleVecCounts[i] , ( "n_" + name + "/I" ).c_str() ) ;
+      _doubleArrayBranches.push_back( _tree->Branch( name.c_str() , emptyDoubles , ( name + "[n_" + name + "]/D" ).c_str() , BUFSIZE ) ) ;
+    }
+
+  } else {
+
+    for( unsigned i=0 ; i < _intVecs.size() ; ++i )
+      _intVecPtrs.push_back( &_current.intVecs[i] ) ;
+
+    for( unsigned i=0 ; i < _doubleVecs.size() ; ++i )
+      _doubleVecPtrs.push_back( &_current.doubleVecs[i] ) ;
+
+    for( unsigned i=0 ; i < _intVecs.size() ; ++i )
+      _tree->Branch( _intVecNames[i].c_str() , &_intVecPtrs[i] , BUFSIZE , 0 ) ;
+
+    for( unsigned i=0 ; i < _doubleVecs.size() ; ++i )
+      _tree->Branch( _doubleVecNames[i].c_str() , &_doubleVecPtrs[i] , BUFSIZE , 0 ) ;
+  }
+
+  _branchesCreated = true ;
+}
+
+
+void OutputTree::fill(){
+
+  if( ! _branchesCreated )
+    createBranches() ;
+
+  if( _writer != 0 ){
+
+    Entry e ;
+    copyValues( e ) ;
+
+    _writer->push( this , e ) ;
+
+  } else {
+
+    // the branches point into _current
+    copyValues( _current ) ;
+    fillTree() ;
+  }
+
+  ++_nEntries ;
+}
+
+
+void OutputTree::copyValues( Entry& e ) const {
+
+  e.ints.resize( _ints.size() ) ;
+  for( unsigned i=0 ; i < _ints.size() ; ++i )
+    e.ints[i] = *_ints[i] ;
+
+  e.doubles.resize( _doubles.size() ) ;
+  for( unsigned i=0 ; i < _doubles.size() ; ++i )
+    e.doubles[i] = *_doubles[i] ;
+
+  e.intVecs.resize( _intVecs.size() ) ;
+  for( unsigned i=0 ; i < _intVecs.size() ; ++i )
+    e.intVecs[i] = *_intVecs[i] ;
+
+  e.doubleVecs.resize( _doubleVecs.size() ) ;
+  for( unsigned i=0 ; i < _doubleVecs.size() ; ++i )
+    e.doubleVecs[i] = *_doubleVecs[i] ;
+}
+
+
+void OutputTree::write( Entry& e ){
+
+  std::copy( e.ints.begin() , e.ints.end() , _current.ints.begin() ) ;
+  std::copy( e.doubles.begin() , e.doubles.end() , _current.doubles.begin() ) ;
+
+  for( unsigned i=0 ; i < e.intVecs.size() ; ++i )
+    _current.intVecs[i].swap( e.intVecs[i] ) ;
+
+  for( unsigned i=0 ; i < e.doubleVecs.size() ; ++i )
+    _current.doubleVecs[i].swap( e.doubleVecs[i] ) ;
+
+  fillTree() ;
+}
+
+
+void OutputTree::fillTree(){
+
+  if( _options.arrayBranches ){
+
+    for( unsigned i=0 ; i < _intArrayBranches.size() ; ++i ){
+      std::vector<int>& v = _current.intVecs[i] ;
+      _intVecCounts[i] = v.size() ;
+      _intArrayBranches[i]->SetAddress( v.empty() ? emptyInts : &v[0] ) ;
+    }
+
+    for( unsigned i=0 ; i < _doubleArrayBranches.size() ; ++i ){
+      std::vector<double>& v = _current.doubleVecs[i] ;
+      _doubleVecCounts[i] = v.size() ;
+      _doubleArrayBranches[i]->SetAddress( v.empty() ? emptyDoubles : &v[0] ) ;
+    }
+  }
+
+  if( _tree->Fill() < 0 )
+    throw EVENT::Exception( std::string(" OutputTree: cannot write entry of tree ") + _tree->GetName() ) ;
+}
+
+
+// ---------------------------------------------------------------------------------------------
+
+AsyncWriter::AsyncWriter( unsigned maxQueuedEntries ) :
+  _maxQueuedEntries( maxQueuedEntries ),
+  _stop( false ) {
+
+  // other processors may use ROOT while the I/O thread fills the trees
+  ROOT::EnableThreadSafety() ;
+
+  _thread = std::thread( &AsyncWriter::ioLoop , this ) ;
+}
+
+
+AsyncWriter::~AsyncWriter(){
+
+  try{
+    finish() ;
+  } catch(...) {
+  }
+}
+
+
+void AsyncWriter::push( OutputTree* tree, OutputTree::Entry& e ){
+
+  std::unique_lock<std::mutex> lock( _mutex ) ;
+
+  _cond.wait( lock , [this]{ return _queue.size() < _maxQueuedEntries || _exception ; } ) ;
+
+  if( _exception )
+    std::rethrow_exception( _exception ) ;
+
+  _queue.push_back( std::make_pair( tree , OutputTree::Entry() ) ) ;
+  _queue.back().second = std::move( e ) ;
+
+  lock.unlock() ;
+  _cond.notify_all() ;
+}
+
+
+void AsyncWriter::ioLoop(){
+
+  while( true ){
+
+    std::unique_lock<std::mutex> lock( _mutex ) ;
+
+    _cond.wait( lock , [this]{ return ! _queue.empty() || _stop ; } ) ;
+
+    if( _queue.empty() ) break ;
+
+    std::pair< OutputTree*, OutputTree::Entry > e = std::move( _queue.front() ) ;
+    _queue.pop_front() ;
+
+    lock.unlock() ;
+    _cond.notify_all() ;
+
+    try{
+
+      e.first->write( e.second ) ;
+
+    } catch(...) {
+
+      lock.lock() ;
+      _exception = std::current_exception() ;
+      _queue.clear() ;
+      lock.unlock() ;
+      _cond.notify_all() ;
+      break ;
+    }
+  }
+}
+
+
+void AsyncWriter::finish(){
+
+  if( _thread.joinable() ){
+
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      _stop = true ;
+    }
+    _cond.notify_all() ;
+
+    _thread.join() ;
+  }
+
+  if( _exception ){
+    std::exception_ptr e = _exception ;
+    _exception = std::exception_ptr() ;
+    std::rethrow_exception( e ) ;
+  }
+}
+
+
+// ---------------------------------------------------------------------------------------------
+
+TreeOutput* TreeOutput::instance(){
+
+  static TreeOutput* me = new TreeOutput ;
+  return me ;
+}
+
+
+TreeOutput::TreeOutput() :
+  _mutex(),
+  _files() {
+}
+
+
+void TreeOutput::open( const std::string& fileName, const std::string& compressionAlgorithm, int compressionLevel ){
+
+  std::lock_guard<std::mutex> lock( _mutex ) ;
+
+  std::map< std::string, OutputFile >::iterator it = _files.find( fileName ) ;
+
+  if( it != _files.end() ){
+
+    ++it->second.nUsers ;
+
+    streamlog_out( DEBUG4 ) << " TreeOutput: sharing file " << fileName << " - "
+			    << it->second.nUsers << " users " << std::endl ;
+    return ;
+  }
+
+  int algorithm ;
+
+  if( compressionAlgorithm == "zlib" )
+    algorithm = ROOT::kZLIB ;
+  else if( compressionAlgorithm == "lzma" )
+    algorithm = ROOT::kLZMA ;
+  else if( compressionAlgorithm == "default" || compressionAlgorithm.empty() )
+    algorithm = ROOT::kUseGlobalSetting ;
+  else
+    throw EVENT::Exception( std::string(" TreeOutput: unknown compression algorithm: ") + compressionAlgorithm
+			    + " - use zlib, lzma or default" ) ;
+
+  TDirectory::TContext context( gDirectory , gDirectory ) ; // restore the current directory
+
+  TFile* file = new TFile( fileName.c_str() , "RECREATE" ) ;
+
+  if( file->IsZombie() ){
+    delete file ;
+    throw EVENT::Exception( std::string(" TreeOutput: cannot open file ") + fileName ) ;
+  }
+
+  file->SetCompressionAlgorithm( algorithm ) ;
+  file->SetCompressionLevel( compressionLevel ) ;
+
+  OutputFile& out = _files[ fileName ] ;
+  out.file = file ;
+  out.nUsers = 1 ;
+  out.writer = 0 ;
+
+  streamlog_out( MESSAGE ) << " TreeOutput: opened file " << fileName << " - compression " << compressionAlgorithm
+			   << " level " << compressionLevel << std::endl ;
+}
+
+
+OutputTree* TreeOutput::createTree( const std::string& fileName, const std::string& name, const std::string& title,
+				    const TreeOptions& options ){
+
+  std::lock_guard<std::mutex> lock( _mutex ) ;
+
+  std::map< std::string, OutputFile >::iterator it = _files.find( fileName ) ;
+
+  if( it == _files.end() )
+    throw EVENT::Exception( std::string(" TreeOutput: file not open: ") + fileName ) ;
+
+  OutputFile& file = it->second ;
+
+  // only one thread may write to the file
+  if( ! file.trees.empty() && options.asyncWrite != ( file.writer != 0 ) )
+    throw EVENT::Exception( std::string(" TreeOutput: all or none of the trees in file ") + fileName
+			    + " have to be written asynchronously - tree " + name ) ;
+
+  if( options.asyncWrite && file.writer == 0 )
+    file.writer = new AsyncWriter( options.maxQueuedEntries ) ;
+
+  TDirectory::TContext context( gDirectory , file.file ) ;
+
+  TTree* tree = new TTree( name.c_str() , title.c_str() ) ;
+
+  // with a number of entries ROOT optimizes the basket sizes at the first flush
+  tree->SetAutoFlush( options.autoFlush ) ;
+
+  OutputTree* out = new OutputTree( tree , options , file.writer ) ;
+
+  file.trees.push_back( out ) ;
+
+  return out ;
+}
+
+
+void TreeOutput::close( const std::string& fileName ){
+
+  std::lock_guard<std::mutex> lock( _mutex ) ;
+
+  std::map< std::string, OutputFile >::iterator it = _files.find( fileName ) ;
+
+  if( it == _files.end() || --it->second.nUsers > 0 )
+    return ;
+
+  OutputFile out = it->second ;
+  _files.erase( it ) ;
+
+  try{
+
+    if( out.writer != 0 )
+      out.writer->finish() ;
+
+  } catch(...) {
+
+    delete out.writer ;
+    for( unsigned i=0 ; i < out.trees.size() ; ++i )
+      delete out.trees[i] ;
+    out.file->Close() ;
+    delete out.file ;
+    throw ;
+  }
+
+  for( unsigned i=0 ; i < out.trees.size() ; ++i ){
+
+    streamlog_out( MESSAGE ) << " TreeOutput: writing tree " << out.trees[i]->tree()->GetName() << " with "
+			     << out.trees[i]->entries() << " entries to " << fileName << std::endl ;
+
+    out.trees[i]->tree()->Write() ;
+  }
+
+  out.file->Close() ;
+
+  delete out.writer ;
+  for( unsigned i=0 ; i < out.trees.size() ; ++i )
+    delete out.trees[i] ;
+
+  delete out.file ;
+}
@@ -0,0 +1,13 @@
+# Generated by CMake
+
+if("${CMAKE_MAJOR_VERSION}.${CMAKE_MINOR_VERSION}" GREATER 2.4)
+  # Information for CMake 2.6 and above.
+  set("lcioF77_LIB_DEPENDS" "general;lcio;")
+  set("lcio_LIB_DEPENDS" "general;sio;")
+  set("sio_LIB_DEPENDS" "general;/usr/lib/x86_64-linux-gnu/libz.so;")
+else()
+  # Information for CMake 2.4 and lower.
+  set("lcioF77_LIB_DEPENDS" "lcio;")
+  set("lcio_LIB_DEPENDS" "sio;")
+  set("sio_LIB_DEPENDS" "/usr/lib/x86_64-linux-gnu/libz.so;")
+endif()
@@ -4,6 +4,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include "EVENT/LCEvent.h"
 #include "EVENT/LCCollection.h"
 // #include "EVENT/LCRelation.h"
@@ -154,6 +155,25 @@ namespace IMPL{
     /** Set the event weight.
      */
     void setWeight(double w) ;
+
+    /** Freezes the event once it is fully built: the collection lookup table and the list of
+     *  collection names are computed once, after which all const methods of the event are
+     *  free of side effects and can be called concurrently from several threads.
+     *  While frozen the event is read only - adding, removing and taking collections throws
+     *  an exception.
+     *
+     *@see unfreeze
+     */
+    void freeze() ;
+
+    /** Leaves the frozen state entered with freeze(), e.g. to add further collections.
+     *  Must not be called while other threads still read the event.
+     */
+    void unfreeze() ;
+
+    /** True if the event is in the frozen, read only state.
+     */
+    bool isFrozen() const { return _frozen ; }
      
   protected:
     void setAccessMode( int accessMode ) ;
@@ -180,6 +200,19 @@ namespace IMPL{
     
     // set of collections that are not owned by the event anymore
     mutable LCCollectionSet _notOwned ;
+
+    /** Entry of the open addressing hash table used for collection lookup in frozen events -
+     *  the name points to the key in _colMap.
+     */
+    struct FrozenEntry{
+      size_t hash ;
+      const std::string* name ;
+      EVENT::LCCollection* col ;
+    } ;
+
+    bool _frozen ;
+    bool _readOnlyBeforeFreeze ;
+    std::vector<FrozenEntry> _frozenTable ;
     
 
   }; // class
@@ -5,8 +5,13 @@
 #include "EVENT/LCParameters.h"
 #include "IMPL/AccessChecked.h"
 
-#include <map>
+#include <string>
 #include <vector>
+#include <utility>
+
+namespace SIO{
+  class SIOLCParameters ;
+}
 
 namespace IMPL {
 
@@ -15,9 +20,73 @@ namespace IMPL {
   class LCEventImpl ;
   class LCCollectionVec ;
 
-  typedef std::map< std::string, EVENT::IntVec >    IntMap ;
-  typedef std::map< std::string, EVENT::FloatVec >  FloatMap ;
-  typedef std::map< std::string, EVENT::StringVec > StringMap ;
+
+  /** Small flat map from parameter keys to values, used for the typically few parameters
+   *  of a run, event or collection: entries are kept in one vector sorted by key (the order
+   *  of the std::map used before, so keys are listed and written in the same order) and
+   *  found by binary search.
+   */
+  template <class V>
+  class ParameterMap {
+
+  public:
+    typedef std::pair< std::string , V > value_type ;
+    typedef typename std::vector< value_type >::iterator iterator ;
+    typedef typename std::vector< value_type >::const_iterator const_iterator ;
+
+    ParameterMap() : _entries() {}
+
+    iterator begin() { return _entries.begin() ; }
+    iterator end() { return _entries.end() ; }
+    const_iterator begin() const { return _entries.begin() ; }
+    const_iterator end() const { return _entries.end() ; }
+
+    unsigned size() const { return _entries.size() ; }
+    void clear() { _entries.clear() ; }
+
+    /** Find the entry for the given key. */
+    const_iterator find( const std::string& key ) const {
+      const_iterator it = lowerBound( _entries.begin() , _entries.end() , key ) ;
+      return ( it != _entries.end() && it->first == key ) ? it : _entries.end() ;
+    }
+
+    /** The values for the given key - adds an empty entry if it does not exist. */
+    V& operator[]( const std::string& key ) {
+      // keys are mostly added in sorted order, e.g. when read from a file
+      if( _entries.empty() || _entries.back().first < key ){
+	_entries.push_back( value_type( key , V() ) ) ;
+	return _entries.back().second ;
+      }
+      iterator it = lowerBound( _entries.begin() , _entries.end() , key ) ;
+      if( it == _entries.end() || it->first != key )
+	it = _entries.insert( it , value_type( key , V() ) ) ;
+      return it->second ;
+    }
+
+  protected:
+
+    template <class It>
+    static It lowerBound( It first , It last , const std::string& key ) {
+      unsigned n = last - first ;
+      while( n > 0 ){
+	unsigned half = n / 2 ;
+	It mid = first + half ;
+	if( mid->first < key ){
+	  first = mid + 1 ;
+	  n -= half + 1 ;
+	} else {
+	  n = half ;
+	}
+      }
+      return first ;
+    }
+
+    std::vector< value_type > _entries ;
+  } ;
+
+  typedef ParameterMap< EVENT::IntVec >    IntMap ;
+  typedef ParameterMap< EVENT::FloatVec >  FloatMap ;
+  typedef ParameterMap< EVENT::StringVec > StringMap ;
   
 
   /** Implementation of Simple interface to store generic named parameters of type
@@ -30,6 +99,7 @@ namespace IMPL {
    * @see LCRunHeader.parameters()
    * @see LCEvent.parameters()
    * @see LCCollection.parameters()
+   * @see ParameterMap
    */
   
   class LCParametersImpl : public EVENT::LCParameters , public AccessChecked{
@@ -37,6 +107,7 @@ namespace IMPL {
     friend class LCRunHeaderImpl ;
     friend class LCEventImpl ;
     friend class LCCollectionVec ;
+    friend class SIO::SIOLCParameters ;
     
   public: 
     
@@ -120,12 +191,11 @@ namespace IMPL {
      */
     virtual void setValues(const std::string & key, const EVENT::StringVec & values);
 
-
   protected:
 
-    mutable IntMap _intMap ;
-    mutable FloatMap _floatMap ;
-    mutable StringMap _stringMap ;
+    IntMap _intMap ;
+    FloatMap _floatMap ;
+    StringMap _stringMap ;
     
   }; // class
 } // namespace IMPL
@@ -17,12 +17,23 @@ namespace SIO {
 	
   public:
 	
-    /** Reads objects from an SIO stream.
+    /** Reads objects from an SIO stream - parameters of an LCParametersImpl are read
+     *  in place without temporary copies of the keys and values.
      */
     static unsigned int read(SIO_stream* stream, 
 			     LCParameters& params,  
 			     unsigned int vers)  ;
     
+  protected:
+
+    /** Reads the parameters with the setValues() methods of the LCParameters interface.
+     */
+    static unsigned int readGeneric(SIO_stream* stream, 
+				    LCParameters& params,  
+				    unsigned int vers)  ;
+
+  public:
+
     /** Writes lcio objects to an SIO stream.
      */
     static unsigned int write(SIO_stream* stream, 
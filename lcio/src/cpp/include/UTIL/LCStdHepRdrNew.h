@@ -1,11 +1,17 @@
-#ifndef UTIL_LCStdHepRdr_H
-#define UTIL_LCStdHepRdr_H 1
+#ifndef UTIL_LCStdHepRdrNew_H
+#define UTIL_LCStdHepRdrNew_H 1
 
 #include "IMPL/LCCollectionVec.h"
 #include "UTIL/lStdHep.hh"
 #include "EVENT/LCIO.h"
 #include "Exceptions.h"
 
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
 namespace IMPL{
 
 class LCEventImpl ;
@@ -17,6 +23,8 @@ namespace UTIL{
   /**Basic utility for reading a binary stdhep file and filling
    * a LCCollectionVec with MCParticles containing the stdhep
    * file information.
+   * Optionally the events can be read and converted ahead of the caller on a separate 
+   * thread, see setReadAhead().
    * 
    * @author cassell
    * @version $Id: LCStdHepRdr.h,v 1.4 2007-11-12 16:39:04 gaede Exp $
@@ -29,7 +37,7 @@ namespace UTIL{
 	 */
     LCStdHepRdrNew(const char* evfile) ;
 
-	/** noop
+	/** Stops the read ahead thread and deletes the events that have not been read.
 	 */
 	~LCStdHepRdrNew() ;
 
@@ -74,14 +82,50 @@ namespace UTIL{
         _writeEventNumber = writeEventNumber;
     }
 
+    /** Read and convert up to nEvents events ahead of the caller on a separate thread, so that
+     *  reading and decoding the stdhep file and creating the MCParticles overlap with the
+     *  processing of the previous events. 0 (default) reads every event when requested.
+     *  Has to be called before the first event is read.
+     */
+    void setReadAhead( unsigned nEvents ) ;
+
   private:
+
+    /** Read the next event from the stdhep file and convert it - NULL at the end of the file.
+     *  Sets evtNum to the stdhep event number.
+     */
+    IMPL::LCCollectionVec* convertEvent( long& evtNum ) ;
+
+    /** Main loop of the read ahead thread.
+     */
+    void readAheadLoop() ;
+
+    /** A converted event waiting to be read. */
+    struct ConvertedEvent {
+      IMPL::LCCollectionVec* col ;
+      long evtNum ;
+    } ;
+
+    LCStdHepRdrNew( const LCStdHepRdrNew& ) ;
+    LCStdHepRdrNew& operator=( const LCStdHepRdrNew& ) ;
     
 	lStdHep* _reader;
 	bool _writeEventNumber;
+	long _evtNum ;  // stdhep event number of the last event returned
+
+	// ---- read ahead
+	unsigned _readAhead ;
+	std::deque< ConvertedEvent > _queue ;
+	std::thread _thread ;
+	std::mutex _mutex ;
+	std::condition_variable _cond ;
+	bool _stop ;
+	bool _endOfFile ;
+	std::exception_ptr _exception ;
     
 
   }; // class
 
 } // namespace UTIL
 
-#endif /* ifndef UTIL_LCStdHepRdr_H */
+#endif /* ifndef UTIL_LCStdHepRdrNew_H */
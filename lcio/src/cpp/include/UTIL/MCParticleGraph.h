@@ -0,0 +1,153 @@
+// -*- C++ -*-
+#ifndef UTIL_MCPARTICLEGRAPH_H
+#define UTIL_MCPARTICLEGRAPH_H 1
+
+#include <vector>
+#include <unordered_map>
+
+#include "EVENT/LCCollection.h"
+#include "EVENT/MCParticle.h"
+#include "LCIOSTLTypes.h"
+
+
+namespace UTIL {
+
+  /** Flattened, read-only view of the parent/daughter graph of an MCParticle collection
+   *  that makes repeated ancestry queries cheap.
+   *  The graph is built lazily on the first query from the parents of the particles
+   *  in the collection (relations to particles outside the collection are ignored):
+   *  particles are numbered by their index in the collection, the parents and daughters
+   *  are stored as compressed (CSR) index arrays and a topological order (parents before
+   *  daughters) is computed.<br>
+   *  The first parent of every particle defines a spanning forest, for which the pre-order
+   *  intervals of a depth first (Euler) tour are precomputed. isAncestor() is thus a
+   *  constant time interval check for the common case of single parent particles; additional
+   *  parents (e.g. strings, clusters) are followed explicitly only where they exist.<br>
+   *  The collection must not be modified while the graph is in use.
+   *
+   *  Example:
+   *  <pre>
+   *   MCParticleGraph graph( evt->getCollection( "MCParticle" ) ) ;
+   *   if( graph.isAncestor( bHadron, mcp ) ) { ... }
+   *   MCParticle* primary = graph.getPrimaryAncestor( mcp ) ;
+   *  </pre>
+   *
+   *  @see MCParticle
+   */
+  class MCParticleGraph {
+
+    typedef std::unordered_map< const EVENT::MCParticle* , int > IndexMap ;
+
+  public:
+
+    /** Create the graph for the given MCParticle collection - nothing is computed
+     *  before the first query.
+     */
+    MCParticleGraph( const EVENT::LCCollection* col ) ;
+
+    /// Destructor.
+    virtual ~MCParticleGraph() { /* nop */; }
+
+    /// The graph holds a pointer to the collection - no copies.
+    MCParticleGraph( const MCParticleGraph& ) = delete ;
+    MCParticleGraph& operator=( const MCParticleGraph& ) = delete ;
+
+    /** Number of particles (nodes) in the graph.
+     */
+    int size() const ;
+
+    /** The index of the particle in the collection - -1 if it is not part of the collection.
+     */
+    int index( const EVENT::MCParticle* p ) const ;
+
+    /** The particle with the given index in the collection.
+     */
+    EVENT::MCParticle* particle( int i ) const ;
+
+    /** Particle indices in topological order, i.e. parents are always listed before their daughters.
+     */
+    const EVENT::IntVec& topologicalOrder() const ;
+
+    /** Number of daughters of the i-th particle in the collection.
+     */
+    int getNumberOfDaughters( int i ) const ;
+
+    /** Pointer to the contiguous indices of the daughters of the i-th particle -
+     *  there are getNumberOfDaughters( i ) entries.
+     */
+    const int* getDaughterIndices( int i ) const ;
+
+    /** Number of parents of the i-th particle in the collection.
+     */
+    int getNumberOfParents( int i ) const ;
+
+    /** Pointer to the contiguous indices of the parents of the i-th particle -
+     *  there are getNumberOfParents( i ) entries.
+     */
+    const int* getParentIndices( int i ) const ;
+
+    /** True if the particle with index anc is a (direct or indirect) parent of the
+     *  particle with index desc - a particle is not its own ancestor.
+     */
+    bool isAncestor( int anc, int desc ) const ;
+
+    /** True if anc is a (direct or indirect) parent of desc - false if either particle is not
+     *  part of the collection.
+     */
+    bool isAncestor( const EVENT::MCParticle* anc, const EVENT::MCParticle* desc ) const ;
+
+    /** True if desc is a (direct or indirect) daughter of anc.
+     */
+    bool isDescendant( const EVENT::MCParticle* desc, const EVENT::MCParticle* anc ) const {
+      return isAncestor( anc, desc ) ;
+    }
+
+    /** Index of the primary ancestor, i.e. the particle without parents that is reached by
+     *  following the first parent - returns i if the particle has no parents.
+     */
+    int getPrimaryAncestor( int i ) const ;
+
+    /** The primary ancestor of the particle, following the first parent - returns p if the
+     *  particle has no parents and NULL if it is not part of the collection.
+     */
+    EVENT::MCParticle* getPrimaryAncestor( const EVENT::MCParticle* p ) const ;
+
+  protected:
+
+    MCParticleGraph() ;
+
+    /** Builds the flattened graph - called on the first query.
+     */
+    void initialize() const ;
+
+    /** Checks the additional (non-first) parents of all particles on the first-parent path
+     *  of desc - only needed if the graph has particles with more than one parent.
+     */
+    bool isAncestorMultiParent( int anc, int desc ) const ;
+
+    const EVENT::LCCollection* _col ;
+
+    mutable bool _isInitialized ;
+    mutable bool _hasMultiParents ;
+    mutable EVENT::MCParticleVec _particles ;
+    mutable IndexMap _index ;
+    mutable EVENT::IntVec _topoOrder ;
+
+    // CSR arrays: the daughters/parents of node i are
+    // _daughterIdx[ _daughterOff[i] ... _daughterOff[i+1] )
+    mutable EVENT::IntVec _daughterOff ;
+    mutable EVENT::IntVec _daughterIdx ;
+    mutable EVENT::IntVec _parentOff ;
+    mutable EVENT::IntVec _parentIdx ;
+
+    // pre-order interval [_first[i],_last[i]] of node i in the first-parent forest
+    mutable EVENT::IntVec _first ;
+    mutable EVENT::IntVec _last ;
+    mutable EVENT::IntVec _root ;
+    // closest node on the first-parent path (including i) that has more than one parent
+    mutable EVENT::IntVec _multiParentUp ;
+
+  }; // class
+
+} // namespace UTIL
+#endif /* ifndef UTIL_MCPARTICLEGRAPH_H */
@@ -12,6 +12,7 @@
 #include <lcio.h>
 
 #include <string>
+#include <vector>
 
 using namespace lcio ;
 
@@ -27,6 +28,18 @@ namespace UTIL{
    *  when the PIDHandler object goes out of scope.
    *  Reads (and updates) the collection parameters PIDAlgorithmTypeName, PIDAlgorithmTypeID 
    *  and the corresponding ParameterNames_PIDAlgorithmTypeName for every algorithm used. 
+   *  <br>
+   *  The algorithms are held in a table with one slot per algorithm that is indexed directly by
+   *  the algorithm id. For looping over all particles (clusters) of the collection the 
+   *  batch accessors getPDGArray(), getLikelihoodArray() and getParameterArray() return the
+   *  PID information of one algorithm for all elements as contiguous arrays, e.g.<br>
+   *  <pre>
+   *   PIDHandler pidh( col ) ;
+   *   int algo = pidh.getAlgorithmID( "LikelihoodPID" ) ;
+   *   const float* like = pidh.getLikelihoodArray( algo ) ;
+   *   const float* dEdx = pidh.getParameterArray( algo , pidh.getParameterIndex( algo , "dEdx" ) ) ;
+   *   for(int i=0 ; i < col->getNumberOfElements() ; ++i ) { ... like[i] ... dEdx[i] ... }
+   *  </pre>
    * 
    *  @see ReconstructedParticle
    *  @see ParticleID
@@ -36,8 +49,20 @@ namespace UTIL{
   class PIDHandler {
 
     typedef CollectionParameterMap CPM ;
-    typedef std::map< int, StringVec > PNM ;
-    typedef  std::map< CPM::map_type::mapped_type , CPM::map_type::key_type > CPMINV ;
+
+    /** Slot of one algorithm - the arrays of the PID information of all elements in 
+     *  the collection are filled on first use.
+     */
+    struct Algorithm {
+      int id ;
+      std::string name ;
+      StringVec pNames ;
+      bool isFilled ;
+      ParticleIDVec pids ;
+      IntVec pdg ;
+      FloatVec likelihood ;
+      FloatVec params ;     // parameter major: params[ iParam * nElements + iElement ]
+    } ;
 
 
   public:  
@@ -113,19 +138,62 @@ namespace UTIL{
 			const FloatVec& params
 			) ;
 
+    /** The (first) ParticleID object of the algorithm for every element of the collection,
+     *  NULL for elements without PID information from this algorithm - throws UnknownAlgorithm.
+     *  The array has getNumberOfElements() entries and is valid until the next call to 
+     *  setParticleID() or addAlgorithm().
+     */
+    ParticleID* const* getParticleIDArray( int algorithmID ) ;
+
+    /** The PDG of the (first) ParticleID object of the algorithm for every element of the 
+     *  collection, 0 for elements without PID information - see getParticleIDArray().
+     */
+    const int* getPDGArray( int algorithmID ) ;
+
+    /** The likelihood of the (first) ParticleID object of the algorithm for every element of the 
+     *  collection, 0 for elements without PID information - see getParticleIDArray().
+     */
+    const float* getLikelihoodArray( int algorithmID ) ;
+
+    /** The value of parameter parameterIndex (see getParameterIndex()) of the (first) 
+     *  ParticleID object of the algorithm for every element of the collection,
+     *  0 for elements without PID information - see getParticleIDArray().
+     */
+    const float* getParameterArray( int algorithmID , int parameterIndex ) ;
+
   protected:
 
     int nextID() { return ++_maxID ; }
     void init( const LCCollection* col ) ;
 
+    /** Add a slot for the algorithm and index it by its id. */
+    Algorithm& addSlot( int id , const std::string& algoName , const StringVec& pNames ) ;
+
+    /** The index of the slot of the algorithm with id in _algos, -1 if unknown. */
+    int findSlot( int id ) const ;
+
+    /** The slot of the algorithm with id - throws UnknownAlgorithm. */
+    Algorithm& slot( int id ) ;
+
+    /** The slot of the algorithm with id with the arrays filled for all elements of the 
+     *  collection - throws UnknownAlgorithm. */
+    Algorithm& filledSlot( int id ) ;
+
+    /** The ParticleID objects of the particle or cluster. */
+    const ParticleIDVec& particleIDs( LCObject* p ) ;
+
+    /** Mark the arrays of all algorithms as outdated. */
+    void invalidateArrays() ;
+
     PIDHandler();
  
     LCCollection* _col ;
+    const LCCollection* _constCol ;
     CPM _cpm ;
     int _type ; 
     int _maxID ;
-    PNM _pNames ; 
-    CPMINV _cpmInv ;
+    std::vector< Algorithm > _algos ;
+    IntVec _slotIndex ;   // index into _algos for algorithm ids 0..._maxID, -1 if unused
     IntVec _ids ;
 
   } ; 
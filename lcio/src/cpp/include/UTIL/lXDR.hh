@@ -11,6 +11,8 @@
 //
 // Release notes:
 // - Version 1.0 (23-Oct-2003)
+// - Version 1.1: reads go through a reusable buffer (or a memory
+//   mapped file) and arrays are decoded in bulk.
 //
 ////
 #ifndef LXDR__HH
@@ -30,7 +32,7 @@ private:
 //
 // The current version/revision is:
 //
-   enum { MAJOR = 1, MINOR = 0, DAY = 23, MONTH = 10, YEAR = 2003 };
+   enum { MAJOR = 1, MINOR = 1, DAY = 23, MONTH = 10, YEAR = 2003 };
 //       ========================================================
 public:
    static int         getMajor(void) { return(MAJOR); };
@@ -61,6 +63,15 @@ public:
    void        setFileName(const char *filename, bool open_for_write = false);
    const char *getFileName(void) const { return(_fileName); };
 //
+// Map the file that is being read into memory, so that all further reads
+// are served from the mapping without stdio calls. The file position is
+// kept. Returns false if the file cannot be mapped (e.g. not a regular
+// file, or not supported on this platform), in which case reading
+// continues through the read buffer.
+//
+   bool        mapFile(void);
+   bool        isMapped(void) const { return(_isMapped); };
+//
 // Prevent assignment:
 //
 private:
@@ -81,8 +92,8 @@ public:
    double      readDouble(void);
 //
 // The following routines read the length of an array of char, long or double
-// from the file, allocate a suitably large array, and read the data from the
-// file. Character strings are null terminated.
+// from the file, allocate a suitably large array, and decode the data from the
+// read buffer in one pass. Character strings are null terminated.
 // Check getError() for succes or failure.
 //
    const char *readString(long &length);
@@ -122,6 +133,21 @@ private:
    bool       _hasNetworkOrder;
    double     ntohd(double d) const;
    double     htond(double d) const { return(ntohd(d)); };
+//
+// Read buffer: file data is read in large chunks into _buffer (or _buffer
+// points to the mapped file). _bufferStart is the file position of
+// _buffer[0], valid data ends at _bufferEnd.
+//
+   enum { BUFFERSIZE = 65536 };
+   char      *_buffer;
+   long       _bufferSize;
+   long       _bufferPos;
+   long       _bufferEnd;
+   long       _bufferStart;
+   bool       _isMapped;
+
+   void        resetBuffer(void);
+   const char *nextBytes(long n);
 
    long       checkRead(long *);
    long       checkRead(float *);
@@ -1,12 +1,14 @@
 #include "IMPL/AccessChecked.h"
 #include <iostream>
+#include <atomic>
 
 
 namespace IMPL {
   
   AccessChecked::AccessChecked() : _readOnly(false) {
-    // provide a simple unique id for LCObjects
-    static int lCObjectId(0) ;
+    // provide a simple unique id for LCObjects - atomic, as objects might be
+    // created concurrently by processors sharing a frozen event
+    static std::atomic<int> lCObjectId(0) ;
     _id = lCObjectId++ ;
   }
   
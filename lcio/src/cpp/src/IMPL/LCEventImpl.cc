@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <functional>
 
 
 using namespace EVENT ;
@@ -18,7 +19,9 @@ LCEventImpl::LCEventImpl() :
   _runNumber(0),
   _eventNumber(0),
   _timeStamp(0),
-  _detectorName("unknown") {
+  _detectorName("unknown"),
+  _frozen(false),
+  _readOnlyBeforeFreeze(false) {
 }
   
 // LCEventImpl::LCEventImpl(const LCEvent& evt) : 
@@ -84,6 +87,10 @@ double LCEventImpl::getWeight() const {
    
 const std::vector<std::string>* LCEventImpl::getCollectionNames() const {
 
+  // the names of a frozen event have been filled in freeze()
+  if( _frozen )
+    return &_colNames ;
+
   // return pointer to updated vector _colNames 
   typedef LCCollectionMap::const_iterator LCI ;
   
@@ -100,6 +107,26 @@ const std::vector<std::string>* LCEventImpl::getCollectionNames() const {
 LCCollection * LCEventImpl::getCollection(const std::string & name) const 
   throw (DataNotAvailableException, std::exception) {
 
+  if( _frozen ){
+
+    // read only lookup in the precomputed hash table
+    size_t mask = _frozenTable.size() - 1 ;
+    size_t h = std::hash<std::string>()( name ) ;
+
+    for( size_t i = h & mask ; _frozenTable[i].col != 0 ; i = ( i + 1 ) & mask ){
+
+      const FrozenEntry& e = _frozenTable[i] ;
+
+      if( e.hash == h && *e.name == name )
+	return e.col ;
+    }
+
+    std::stringstream ss ;
+    ss << "LCEventImpl::getCollection: collection not in event:" << name ;
+
+    throw( DataNotAvailableException( ss.str() ) ) ; 
+  }
+
   LCCollectionMap::iterator it = _colMap.find( name )  ;
 
   if( it == _colMap.end() ) {
@@ -121,6 +148,9 @@ LCCollection * LCEventImpl::getCollection(const std::string & name) const
 LCCollection * LCEventImpl::takeCollection(const std::string & name) const 
   throw (DataNotAvailableException, std::exception) {
 
+  if( _frozen )
+    throw ReadOnlyException( std::string("LCEventImpl::takeCollection() event is frozen: " + name ) ) ;
+
   LCCollectionVec* col = dynamic_cast<LCCollectionVec*> ( getCollection( name ) ) ;
 
   col->setTransient( true ) ;
@@ -136,6 +166,9 @@ LCCollection * LCEventImpl::takeCollection(const std::string & name) const
 void  LCEventImpl::addCollection(LCCollection * col, const std::string & name) 
   throw (EventException, std::exception)  {
 
+  if( _frozen )
+    throw EventException( std::string("LCEventImpl::addCollection() event is frozen: "
+				      +name) ) ; 
   
   if( ! validateCollectionName(name.c_str()) ){
 
@@ -200,6 +233,57 @@ void LCEventImpl::setWeight(double w) {
 }
 
      
+void LCEventImpl::freeze() {
+
+  if( _frozen )
+    return ;
+
+  // list of names in the order of the collection map
+  getCollectionNames() ;
+
+  size_t n = 8 ;
+  while( n < 2 * _colMap.size() )
+    n <<= 1 ;
+
+  FrozenEntry empty = { 0 , 0 , 0 } ;
+  _frozenTable.assign( n , empty ) ;
+
+  size_t mask = n - 1 ;
+
+  typedef LCCollectionMap::const_iterator LCI ;
+
+  for ( LCI it=_colMap.begin() ; it != _colMap.end() ; it++ ){
+
+    size_t h = std::hash<std::string>()( it->first ) ;
+    size_t i = h & mask ;
+
+    while( _frozenTable[i].col != 0 )
+      i = ( i + 1 ) & mask ;
+
+    _frozenTable[i].hash = h ;
+    _frozenTable[i].name = &it->first ;
+    _frozenTable[i].col  = it->second ;
+  }
+
+  _readOnlyBeforeFreeze = _readOnly ;
+  setReadOnly( true ) ;
+
+  _frozen = true ;
+}
+
+
+void LCEventImpl::unfreeze() {
+
+  if( ! _frozen )
+    return ;
+
+  _frozen = false ;
+  _frozenTable.clear() ;
+
+  setReadOnly( _readOnlyBeforeFreeze ) ;
+}
+
+     
 void LCEventImpl::setAccessMode( int accessMode ) {
 
   // loop over all collections and set the access mode
@@ -7,28 +7,31 @@ using namespace EVENT ;
 
 namespace IMPL{
 
-  LCParametersImpl::LCParametersImpl(){
+  LCParametersImpl::LCParametersImpl() :
+    _intMap() ,
+    _floatMap() ,
+    _stringMap() {
     
   }
 
   int LCParametersImpl::getIntVal(const std::string & key) const {
     
-    IntMap::iterator it = _intMap.find( key ) ;
+    IntMap::const_iterator it = _intMap.find( key ) ;
 
     if( it == _intMap.end() )  return 0 ;
 
-    IntVec &  iv =  it->second ;
+    const IntVec &  iv =  it->second ;
 
     return iv[0] ;
   }
 
   float LCParametersImpl::getFloatVal(const std::string & key) const {
 
-    FloatMap::iterator it = _floatMap.find( key ) ;
+    FloatMap::const_iterator it = _floatMap.find( key ) ;
 
     if( it == _floatMap.end() )  return 0 ;
 
-    FloatVec &  fv =  it->second ;
+    const FloatVec &  fv =  it->second ;
 
     return fv[0] ;
   }
@@ -37,18 +40,18 @@ namespace IMPL{
 
     static std::string empty("") ;
     
-    StringMap::iterator it = _stringMap.find( key ) ;
+    StringMap::const_iterator it = _stringMap.find( key ) ;
     
     if( it == _stringMap.end() )  return empty ;
     
-    StringVec &  sv =  it->second ;
+    const StringVec &  sv =  it->second ;
     
     return sv[0] ;
   }
 
   IntVec & LCParametersImpl::getIntVals(const std::string & key, IntVec & values) const {
 
-    IntMap::iterator it = _intMap.find( key ) ;
+    IntMap::const_iterator it = _intMap.find( key ) ;
 
     if( it != _intMap.end() ) {
       values.insert( values.end() , it->second.begin() , it->second.end() ) ;
@@ -59,7 +62,7 @@ namespace IMPL{
 
   FloatVec & LCParametersImpl::getFloatVals(const std::string & key, FloatVec & values) const {
 
-    FloatMap::iterator it = _floatMap.find( key ) ;
+    FloatMap::const_iterator it = _floatMap.find( key ) ;
 
     if( it != _floatMap.end() ) {
       values.insert( values.end() , it->second.begin() , it->second.end() ) ;
@@ -69,7 +72,7 @@ namespace IMPL{
 
   StringVec & LCParametersImpl::getStringVals(const std::string & key, StringVec & values) const {
 
-    StringMap::iterator it = _stringMap.find( key ) ;
+    StringMap::const_iterator it = _stringMap.find( key ) ;
 
     if( it != _stringMap.end() ) {
       values.insert( values.end() , it->second.begin() , it->second.end() ) ;
@@ -80,7 +83,7 @@ namespace IMPL{
 
   const StringVec & LCParametersImpl::getIntKeys(StringVec & keys) const  {
 
-     for( IntMap::iterator iter = _intMap.begin() ; iter !=  _intMap.end() ; iter++ ){
+     for( IntMap::const_iterator iter = _intMap.begin() ; iter !=  _intMap.end() ; iter++ ){
        keys.push_back( iter->first ) ; 
      }
 // fg: select1st is non-standard 
@@ -91,7 +94,7 @@ namespace IMPL{
 
   const StringVec & LCParametersImpl::getFloatKeys(StringVec & keys) const  {
     
-     for( FloatMap::iterator iter = _floatMap.begin() ; iter !=  _floatMap.end() ; iter++ ){
+     for( FloatMap::const_iterator iter = _floatMap.begin() ; iter !=  _floatMap.end() ; iter++ ){
        keys.push_back( iter->first ) ; 
      }
 // fg: select1st is non-standard
@@ -101,7 +104,7 @@ namespace IMPL{
 
   const StringVec & LCParametersImpl::getStringKeys(StringVec & keys) const  {
 
-    for( StringMap::iterator iter = _stringMap.begin() ; iter !=  _stringMap.end() ; iter++ ){
+    for( StringMap::const_iterator iter = _stringMap.begin() ; iter !=  _stringMap.end() ; iter++ ){
       keys.push_back( iter->first ) ; 
     }
 // fg: select1st is non-standard
@@ -111,7 +114,7 @@ namespace IMPL{
   
   int LCParametersImpl::getNInt(const std::string & key) const {
 
-    IntMap::iterator it = _intMap.find( key ) ;
+    IntMap::const_iterator it = _intMap.find( key ) ;
 
     if( it == _intMap.end() )
       return 0 ;
@@ -121,7 +124,7 @@ namespace IMPL{
 
   int LCParametersImpl::getNFloat(const std::string & key) const {
 
-    FloatMap::iterator it = _floatMap.find( key ) ;
+    FloatMap::const_iterator it = _floatMap.find( key ) ;
 
     if( it == _floatMap.end() )  
       return 0 ;
@@ -131,7 +134,7 @@ namespace IMPL{
 
   int LCParametersImpl::getNString(const std::string & key) const {
 
-    StringMap::iterator it = _stringMap.find( key ) ;
+    StringMap::const_iterator it = _stringMap.find( key ) ;
 
     if( it == _stringMap.end() )  
       return 0 ;
@@ -142,22 +145,19 @@ namespace IMPL{
   void LCParametersImpl::setValue(const std::string & key, int value){
     checkAccess("LCParametersImpl::setValue") ;
 //     if(  _intMap[ key ].size() > 0 ) 
-    _intMap[ key ].clear() ;
-    _intMap[ key ].push_back( value ) ;
+    _intMap[ key ].assign( 1 , value ) ;
   }
 
   void LCParametersImpl::setValue(const std::string & key, float value){
     checkAccess("LCParametersImpl::setValue") ;
 //     if(  _floatMap[ key ].size() > 0 ) 
-    _floatMap[ key ].clear() ;
-    _floatMap[ key ].push_back( value ) ;
+    _floatMap[ key ].assign( 1 , value ) ;
   }
 
   void LCParametersImpl::setValue(const std::string & key, const std::string & value) {
     checkAccess("LCParametersImpl::setValue") ;
 //     if(  _stringMap[ key ].size() > 0 ) 
-    _stringMap[ key ].clear() ;
-    _stringMap[ key ].push_back( value ) ;
+    _stringMap[ key ].assign( 1 , value ) ;
 
   }
 
@@ -14,6 +14,86 @@ namespace SIO{
 				     LCParameters& params,  
 				     unsigned int vers) {
 
+    // fill the maps of LCParametersImpl in place: the values are read into the final
+    // vectors with one call per key
+    IMPL::LCParametersImpl* impl = dynamic_cast<IMPL::LCParametersImpl*>( &params ) ;
+
+    if( impl == 0 ) 
+      return readGeneric( stream, params, vers ) ;
+
+    unsigned int status ; 
+	
+    int nIntParameters ;
+    SIO_DATA( stream , &nIntParameters , 1 ) ;
+
+    for(int i=0; i< nIntParameters ; i++ ){
+
+      char* keyTmp ; 
+      int keyLen ;
+      LCSIO_READ_LEN( stream,  &keyTmp , &keyLen ) ; 
+
+      IntVec& intVec = impl->_intMap[ std::string( keyTmp , keyLen ) ] ;
+
+      int nInt  ;
+      SIO_DATA( stream , &nInt , 1 ) ;
+      intVec.resize( nInt ) ;
+
+      if( nInt > 0 ){
+	SIO_DATA( stream , &intVec[0]  , nInt ) ;
+      }
+    }
+
+    int nFloatParameters ;
+    SIO_DATA( stream , &nFloatParameters , 1 ) ;
+
+    for(int i=0; i< nFloatParameters ; i++ ){
+
+      char* keyTmp ; 
+      int keyLen ;
+      LCSIO_READ_LEN( stream,  &keyTmp , &keyLen ) ; 
+
+      FloatVec& floatVec = impl->_floatMap[ std::string( keyTmp , keyLen ) ] ;
+
+      int nFloat  ;
+      SIO_DATA( stream , &nFloat , 1 ) ;
+      floatVec.resize( nFloat ) ;
+
+      if( nFloat > 0 ){
+	SIO_DATA( stream , &floatVec[0]  , nFloat ) ;
+      }
+    }
+
+    int nStringParameters ;
+    SIO_DATA( stream , &nStringParameters , 1 ) ;
+
+    for(int i=0; i< nStringParameters ; i++ ){
+
+      char* keyTmp ; 
+      int keyLen ;
+      LCSIO_READ_LEN( stream,  &keyTmp , &keyLen ) ; 
+
+      StringVec& stringVec = impl->_stringMap[ std::string( keyTmp , keyLen ) ] ;
+
+      int nString  ;
+      SIO_DATA( stream , &nString , 1 ) ;
+      stringVec.resize( nString ) ;
+
+      for(int j=0; j< nString ; j++ ){
+	char* valTmp ; 
+	int valLen ;
+	LCSIO_READ_LEN( stream,  &valTmp , &valLen ) ; 
+	stringVec[j].assign( valTmp , valLen ) ;
+      }
+    }
+
+    return ( SIO_BLOCK_SUCCESS ) ;
+  }
+
+
+  unsigned int SIOLCParameters::readGeneric(SIO_stream* stream, 
+					    LCParameters& params,  
+					    unsigned int /*vers*/) {
+
     unsigned int status ; 
 	
 	
@@ -0,0 +1,133 @@
+////////////////////////////////////////
+//  test IMPL::LCEventImpl::freeze()
+////////////////////////////////////////
+
+#include "tutil.h"
+#include "lcio.h"
+
+#include "EVENT/LCIO.h"
+#include "IMPL/LCEventImpl.h"
+#include "IMPL/LCCollectionVec.h"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std ;
+using namespace lcio ;
+
+static const int NCOL = 20 ;     // collections
+static const int NTHREAD = 4 ;   // concurrent readers
+static const int NLOOKUP = 2000 ; // lookups per reader
+
+// replace mytest with the name of your test
+const static string testname="test_frozenevent";
+
+static string colName( int i ){
+  stringstream ss ;
+  ss << "Collection_" << i ;
+  return ss.str() ;
+}
+
+// look up all collections of the frozen event - returns the number of wrong results
+static int readEvent( const LCEventImpl* evt , const vector<LCCollection*>& cols ){
+
+  int nError = 0 ;
+
+  for( int n=0 ; n<NLOOKUP ; ++n ){
+
+    int i = n % NCOL ;
+
+    if( evt->getCollection( colName( i ) ) != cols[i] )
+      ++nError ;
+
+    const StringVec* names = evt->getCollectionNames() ;
+    if( (int) names->size() != NCOL )
+      ++nError ;
+
+    try{
+      evt->getCollection( "NotThere" ) ;
+      ++nError ;
+    }
+    catch( DataNotAvailableException& ){ }
+  }
+  return nError ;
+}
+
+//=============================================================================
+
+int main(int /*argc*/, char** /*argv*/ ){
+
+  // this should be the first line in your test
+  TEST MYTEST=TEST( testname, std::cout );
+
+  try{
+
+    MYTEST.LOG( " building the event " );
+
+    LCEventImpl* evt = new LCEventImpl() ;
+    vector<LCCollection*> cols ;
+
+    for( int i=0 ; i<NCOL ; ++i ){
+      LCCollectionVec* col = new LCCollectionVec( LCIO::CALORIMETERHIT ) ;
+      evt->addCollection( col , colName( i ) ) ;
+      cols.push_back( col ) ;
+    }
+
+    evt->freeze() ;
+
+    MYTEST( evt->isFrozen() , true , "event is frozen" ) ;
+
+    MYTEST.LOG( " frozen event is read only " );
+
+    bool thrown = false ;
+    try{ evt->addCollection( new LCCollectionVec( LCIO::CALORIMETERHIT ) , "Extra" ) ; }
+    catch( EventException& ){ thrown = true ; }
+    MYTEST( thrown , true , "addCollection throws" ) ;
+
+    thrown = false ;
+    try{ evt->takeCollection( colName( 0 ) ) ; }
+    catch( ReadOnlyException& ){ thrown = true ; }
+    MYTEST( thrown , true , "takeCollection throws" ) ;
+
+    thrown = false ;
+    try{ evt->setRunNumber( 42 ) ; }
+    catch( ReadOnlyException& ){ thrown = true ; }
+    MYTEST( thrown , true , "setRunNumber throws" ) ;
+
+    MYTEST.LOG( " reading the frozen event from several threads " );
+
+    atomic<int> nError( 0 ) ;
+    vector<thread> readers ;
+
+    for( int t=0 ; t<NTHREAD ; ++t )
+      readers.push_back( thread( [&](){ nError += readEvent( evt , cols ) ; } ) ) ;
+
+    for( unsigned t=0 ; t<readers.size() ; ++t )
+      readers[t].join() ;
+
+    MYTEST( nError.load() , 0 , "wrong results of concurrent lookups" ) ;
+
+    MYTEST.LOG( " unfrozen event can be modified again " );
+
+    evt->unfreeze() ;
+
+    MYTEST( evt->isFrozen() , false , "event is not frozen" ) ;
+
+    evt->addCollection( new LCCollectionVec( LCIO::CALORIMETERHIT ) , "Extra" ) ;
+    evt->setRunNumber( 42 ) ;
+
+    MYTEST( (int) evt->getCollectionNames()->size() , NCOL + 1 , "number of collections" ) ;
+    MYTEST( evt->getRunNumber() , 42 , "run number" ) ;
+
+    delete evt ;
+
+  } catch( Exception &e ){
+    MYTEST.FAILED( e.what() );
+  }
+
+  return 0;
+}
+
+//=============================================================================
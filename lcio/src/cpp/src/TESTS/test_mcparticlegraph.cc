@@ -0,0 +1,135 @@
+////////////////////////////////////////
+//  test UTIL::MCParticleGraph
+////////////////////////////////////////
+
+#include "tutil.h"
+#include "lcio.h"
+
+#include "EVENT/LCIO.h"
+#include "IMPL/LCCollectionVec.h"
+#include "IMPL/MCParticleImpl.h"
+#include "UTIL/MCParticleGraph.h"
+
+#include <sstream>
+
+using namespace std ;
+using namespace lcio ;
+
+// replace mytest with the name of your test
+const static string testname="test_mcparticlegraph";
+
+//=============================================================================
+
+int main(int /*argc*/, char** /*argv*/ ){
+
+    // this should be the first line in your test
+    TEST MYTEST=TEST( testname, std::cout );
+
+    try{
+
+        MYTEST.LOG( "building MCParticle graph" );
+
+        //      0       1
+        //     / \     /
+        //    2   3   /
+        //   / \   \ /
+        //  4   5   6      (6 has the two parents 3 and 1)
+        //          |
+        //          7
+        LCCollectionVec* col = new LCCollectionVec( LCIO::MCPARTICLE ) ;
+
+        const int N = 8 ;
+        MCParticleImpl* mcp[N] ;
+
+        for( int i=0 ; i<N ; ++i ){
+            mcp[i] = new MCParticleImpl ;
+            mcp[i]->setPDG( i ) ;
+        }
+        // add the particles in non topological order
+        for( int i=N-1 ; i>=0 ; --i )
+            col->addElement( mcp[i] ) ;
+
+        mcp[2]->addParent( mcp[0] ) ;
+        mcp[3]->addParent( mcp[0] ) ;
+        mcp[4]->addParent( mcp[2] ) ;
+        mcp[5]->addParent( mcp[2] ) ;
+        mcp[6]->addParent( mcp[3] ) ;
+        mcp[6]->addParent( mcp[1] ) ;
+        mcp[7]->addParent( mcp[6] ) ;
+
+        MCParticleGraph graph( col ) ;
+
+        MYTEST( graph.size() , N , "size" ) ;
+
+        for( int i=0 ; i<N ; ++i ){
+            stringstream ss ;
+            ss << " index of particle " << i ;
+            MYTEST( graph.particle( graph.index( mcp[i] ) ) , (MCParticle*) mcp[i] , ss.str() ) ;
+        }
+
+        MYTEST.LOG( "testing topological order" );
+
+        const IntVec& topo = graph.topologicalOrder() ;
+        MYTEST( topo.size() , unsigned(N) , "topologicalOrder().size()" ) ;
+
+        IntVec pos( N ) ;
+        for( int k=0 ; k<N ; ++k )
+            pos[ topo[k] ] = k ;
+
+        for( int i=0 ; i<N ; ++i ){
+            int n = graph.getNumberOfParents( i ) ;
+            const int* par = graph.getParentIndices( i ) ;
+            for( int j=0 ; j<n ; ++j ){
+                stringstream ss ;
+                ss << " parent " << par[j] << " before daughter " << i ;
+                MYTEST( pos[ par[j] ] < pos[i] , true , ss.str() ) ;
+            }
+        }
+
+        MYTEST( graph.getNumberOfDaughters( graph.index( mcp[2] ) ) , 2 , "daughters of 2" ) ;
+        MYTEST( graph.getNumberOfParents( graph.index( mcp[6] ) ) , 2 , "parents of 6" ) ;
+
+        MYTEST.LOG( "testing ancestry queries" );
+
+        // expected ancestry from brute force recursion over the parents
+        bool anc[N][N] = {} ;
+        for( int d=0 ; d<N ; ++d ){
+            IntVec stack( 1 , d ) ;
+            while( ! stack.empty() ){
+                MCParticle* p = mcp[ stack.back() ] ;
+                stack.pop_back() ;
+                for( unsigned k=0 ; k<p->getParents().size() ; ++k ){
+                    int a = p->getParents()[k]->getPDG() ;
+                    anc[a][d] = true ;
+                    stack.push_back( a ) ;
+                }
+            }
+        }
+
+        for( int a=0 ; a<N ; ++a ){
+            for( int d=0 ; d<N ; ++d ){
+                stringstream ss ;
+                ss << " isAncestor( " << a << " , " << d << " ) " ;
+                MYTEST( graph.isAncestor( mcp[a] , mcp[d] ) , anc[a][d] , ss.str() ) ;
+                MYTEST( graph.isDescendant( mcp[d] , mcp[a] ) , anc[a][d] , ss.str() ) ;
+            }
+        }
+
+        MYTEST( graph.getPrimaryAncestor( mcp[5] ) , (MCParticle*) mcp[0] , "primary ancestor of 5" ) ;
+        MYTEST( graph.getPrimaryAncestor( mcp[7] ) , (MCParticle*) mcp[0] , "primary ancestor of 7" ) ;
+        MYTEST( graph.getPrimaryAncestor( mcp[1] ) , (MCParticle*) mcp[1] , "primary ancestor of 1" ) ;
+
+        MCParticleImpl other ;
+        MYTEST( graph.index( &other ) , -1 , "index of particle not in collection" ) ;
+        MYTEST( graph.isAncestor( mcp[0] , &other ) , false , "isAncestor of particle not in collection" ) ;
+
+        delete col ;
+
+    } catch( Exception &e ){
+        MYTEST.FAILED( e.what() );
+    }
+
+    return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,141 @@
+////////////////////////////////////////
+//  test IMPL::LCParametersImpl
+////////////////////////////////////////
+
+#include "tutil.h"
+#include "lcio.h"
+
+#include "EVENT/LCIO.h"
+#include "IO/LCReader.h"
+#include "IO/LCWriter.h"
+#include "IMPL/LCEventImpl.h"
+#include "IMPL/LCParametersImpl.h"
+
+#include <sstream>
+
+using namespace std ;
+using namespace lcio ;
+
+static const int NEVENT = 3 ; // events
+
+static string FILEN = "parameters.slcio" ;
+
+// replace mytest with the name of your test
+const static string testname="test_parameters";
+
+// keys in the order they are set - not sorted
+static const char* KEYS[] = { "zeta" , "alpha" , "Mu" , "beta" , "alpha2" } ;
+static const int NKEYS = 5 ;
+
+// keys in sorted order
+static string sortedKeys(){
+  return "Mu alpha alpha2 beta zeta " ;
+}
+
+static string join( const StringVec& v ){
+  stringstream ss ;
+  for( unsigned i=0 ; i<v.size() ; ++i ) ss << v[i] << " " ;
+  return ss.str() ;
+}
+
+static void checkParameters( TEST& MYTEST , const LCParameters& p , int n ){
+
+  for( int k=0 ; k<NKEYS ; ++k ){
+
+    MYTEST( p.getIntVal( KEYS[k] ) , n + k , string("int value of ") + KEYS[k] ) ;
+    MYTEST( p.getFloatVal( KEYS[k] ) , float( n + 0.5 * k ) , string("float value of ") + KEYS[k] ) ;
+    MYTEST( p.getNString( KEYS[k] ) , 2 , string("number of strings of ") + KEYS[k] ) ;
+
+    StringVec sv ;
+    p.getStringVals( KEYS[k] , sv ) ;
+    MYTEST( sv.size() , 2u , string("string values of ") + KEYS[k] ) ;
+    MYTEST( sv[1] , string( KEYS[k] ) , string("second string value of ") + KEYS[k] ) ;
+  }
+
+  MYTEST( p.getIntVal( "unknown" ) , 0 , "int value of unknown key" ) ;
+  MYTEST( p.getNFloat( "unknown" ) , 0 , "number of floats of unknown key" ) ;
+  MYTEST( p.getStringVal( "unknown" ) , string("") , "string value of unknown key" ) ;
+
+  StringVec keys ;
+  MYTEST( join( p.getIntKeys( keys ) ) , sortedKeys() , "int keys" ) ;
+  keys.clear() ;
+  MYTEST( join( p.getFloatKeys( keys ) ) , sortedKeys() , "float keys" ) ;
+  keys.clear() ;
+  MYTEST( join( p.getStringKeys( keys ) ) , sortedKeys() , "string keys" ) ;
+}
+
+//=============================================================================
+
+int main(int /*argc*/, char** /*argv*/ ){
+
+  // this should be the first line in your test
+  TEST MYTEST=TEST( testname, std::cout );
+
+  try{
+
+    MYTEST.LOG( " writing event parameters " );
+
+    LCWriter* lcWrt = LCFactory::getInstance()->createLCWriter() ;
+
+    lcWrt->open( FILEN , LCIO::WRITE_NEW ) ;
+
+    for( int i=0 ; i<NEVENT ; ++i ){
+
+      LCEventImpl* evt = new LCEventImpl() ;
+      evt->setEventNumber( i ) ;
+
+      LCParameters& p = evt->parameters() ;
+
+      for( int k=0 ; k<NKEYS ; ++k ){
+
+	// overwritten below
+	p.setValue( KEYS[k] , -1 ) ;
+
+	p.setValue( KEYS[k] , i + k ) ;
+	p.setValue( KEYS[k] , float( i + 0.5 * k ) ) ;
+
+	StringVec sv ;
+	sv.push_back( "value" ) ;
+	sv.push_back( KEYS[k] ) ;
+	p.setValues( KEYS[k] , sv ) ;
+      }
+
+      checkParameters( MYTEST , p , i ) ;
+
+      lcWrt->writeEvent( evt ) ;
+
+      delete evt ;
+    }
+
+    lcWrt->close() ;
+    delete lcWrt ;
+
+    MYTEST.LOG( " reading event parameters " );
+
+    LCReader* lcRdr = LCFactory::getInstance()->createLCReader() ;
+
+    lcRdr->open( FILEN ) ;
+
+    LCEvent* evt = 0 ;
+    int nEvents = 0 ;
+
+    while( ( evt = lcRdr->readNextEvent() ) != 0 ){
+
+      checkParameters( MYTEST , evt->getParameters() , nEvents ) ;
+
+      ++nEvents ;
+    }
+
+    MYTEST( nEvents , NEVENT , "number of events read" ) ;
+
+    lcRdr->close() ;
+    delete lcRdr ;
+
+  } catch( Exception &e ){
+    MYTEST.FAILED( e.what() );
+  }
+
+  return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,108 @@
+////////////////////////////////////////
+//  test UTIL::PIDHandler
+////////////////////////////////////////
+
+#include "tutil.h"
+#include "lcio.h"
+
+#include "EVENT/LCIO.h"
+#include "IMPL/LCCollectionVec.h"
+#include "IMPL/ReconstructedParticleImpl.h"
+#include "UTIL/PIDHandler.h"
+
+#include <sstream>
+
+using namespace std ;
+using namespace lcio ;
+
+// replace mytest with the name of your test
+const static string testname="test_pidhandler";
+
+//=============================================================================
+
+int main(int /*argc*/, char** /*argv*/ ){
+
+    // this should be the first line in your test
+    TEST MYTEST=TEST( testname, std::cout );
+
+    try{
+
+        MYTEST.LOG( "setting PID information" );
+
+        LCCollectionVec* col = new LCCollectionVec( LCIO::RECONSTRUCTEDPARTICLE ) ;
+
+        const int N = 10 ;
+
+        int algoA = -1 , algoB = -1 ;
+        {
+            PIDHandler pidh( col ) ;
+
+            StringVec pNames ;
+            pNames.push_back( "p0" ) ;
+            pNames.push_back( "p1" ) ;
+
+            algoA = pidh.addAlgorithm( "algoA" , pNames ) ;
+            algoB = pidh.addAlgorithm( "algoB" , StringVec() ) ;
+
+            for( int i=0 ; i<N ; ++i ){
+
+                ReconstructedParticleImpl* p = new ReconstructedParticleImpl ;
+                col->addElement( p ) ;
+
+                FloatVec params( 2 ) ;
+                params[0] = i ;
+                params[1] = 10. * i ;
+
+                pidh.setParticleID( p , 0 , 11 , 0.5 * i , algoA , params ) ;
+
+                // only every other particle has a PID from algoB
+                if( i % 2 == 0 )
+                    pidh.setParticleID( p , 0 , 211 , 1. , algoB , FloatVec() ) ;
+            }
+        }
+
+        MYTEST.LOG( "reading PID information" );
+
+        const LCCollection* constCol = col ;
+        PIDHandler pidh( constCol ) ;
+
+        MYTEST( pidh.getAlgorithmID( "algoA" ) , algoA , "algorithm id of algoA" ) ;
+        MYTEST( pidh.getAlgorithmName( algoB ) , string( "algoB" ) , "algorithm name of algoB" ) ;
+        MYTEST( pidh.getParameterIndex( algoA , "p1" ) , 1 , "parameter index of p1" ) ;
+
+        const int* pdgA = pidh.getPDGArray( algoA ) ;
+        const float* likeA = pidh.getLikelihoodArray( algoA ) ;
+        const float* p1A = pidh.getParameterArray( algoA , pidh.getParameterIndex( algoA , "p1" ) ) ;
+        const int* pdgB = pidh.getPDGArray( algoB ) ;
+        ParticleID* const* pidsB = pidh.getParticleIDArray( algoB ) ;
+
+        for( int i=0 ; i<N ; ++i ){
+
+            stringstream ss ;
+            ss << " particle " << i ;
+
+            MYTEST( pdgA[i] , 11 , "PDG algoA" + ss.str() ) ;
+            MYTEST( likeA[i] , float( 0.5 * i ) , "likelihood algoA" + ss.str() ) ;
+            MYTEST( p1A[i] , float( 10. * i ) , "parameter p1 algoA" + ss.str() ) ;
+            MYTEST( pdgB[i] , ( i % 2 == 0 ? 211 : 0 ) , "PDG algoB" + ss.str() ) ;
+            MYTEST( pidsB[i] == 0 , i % 2 != 0 , "ParticleID algoB" + ss.str() ) ;
+
+            const ParticleID& pid = pidh.getParticleID( col->getElementAt( i ) , algoA ) ;
+            MYTEST( pid.getLikelihood() , likeA[i] , "getParticleID algoA" + ss.str() ) ;
+        }
+
+        try{
+            pidh.getPDGArray( 42 ) ;
+            MYTEST.FAILED( "no exception for unknown algorithm" ) ;
+        } catch( UnknownAlgorithm& ) {}
+
+        delete col ;
+
+    } catch( Exception &e ){
+        MYTEST.FAILED( e.what() );
+    }
+
+    return 0;
+}
+
+//=============================================================================
@@ -29,6 +29,9 @@ namespace UTIL{
       throw IO::IOException( description.str() );
     }
 
+    // read local files through a memory mapping - falls back to buffered reads
+    _reader->mapFile() ;
+
     //    _reader->printFileHeader() ;
 
   }
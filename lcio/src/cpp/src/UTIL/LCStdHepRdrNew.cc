@@ -8,6 +8,7 @@
 //#include <stdlib.h>
 #include <cmath>	// for pow()
 #include <algorithm>
+#include <vector>
 #include "Exceptions.h"
 
 using namespace EVENT;
@@ -18,7 +19,30 @@ using namespace IMPL;
 
 namespace UTIL {
 
-LCStdHepRdrNew::LCStdHepRdrNew(const char* evfile) {
+namespace {
+
+    // add mcp as parent of d unless it is already listed
+    void addParentOnce(MCParticleImpl* d, MCParticleImpl* mcp) {
+
+        const EVENT::MCParticleVec& parents = d->getParents();
+
+        if (std::find(parents.begin(), parents.end(), mcp) == parents.end())
+            d->addParent(mcp);
+    }
+}
+
+LCStdHepRdrNew::LCStdHepRdrNew(const char* evfile) :
+    _reader(0),
+    _writeEventNumber(false),
+    _evtNum(0),
+    _readAhead(0),
+    _queue(),
+    _thread(),
+    _mutex(),
+    _cond(),
+    _stop(false),
+    _endOfFile(false),
+    _exception() {
     //
     //   Use Willie's reader from LELAPS, and open the input file
     //
@@ -29,14 +53,76 @@ LCStdHepRdrNew::LCStdHepRdrNew(const char* evfile) {
         throw IO::IOException(description.str());
     }
 
+    // read local files through a memory mapping - falls back to buffered reads
+    _reader->mapFile();
+
     //    _reader->printFileHeader() ;
 
 }
 LCStdHepRdrNew::~LCStdHepRdrNew() {
 
+    if (_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cond.notify_all();
+        _thread.join();
+    }
+
+    for (auto& c : _queue)
+        delete c.col;
+
     delete _reader;
 }
 
+void LCStdHepRdrNew::setReadAhead(unsigned nEvents) {
+
+    if (_thread.joinable()) {
+        throw EVENT::Exception(" LCStdHepRdrNew::setReadAhead - called after the first event has been read ");
+    }
+
+    _readAhead = nEvents;
+}
+
+void LCStdHepRdrNew::readAheadLoop() {
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stop) {
+
+        if (_queue.size() >= _readAhead) {
+            _cond.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+
+        ConvertedEvent c = { 0, 0 };
+        std::exception_ptr ex;
+        try {
+            c.col = convertEvent(c.evtNum);
+        } catch (...) {
+            ex = std::current_exception();
+        }
+
+        lock.lock();
+
+        if (ex) {
+            _exception = ex;
+            _endOfFile = true;
+        } else if (c.col == 0) {
+            _endOfFile = true;
+        } else {
+            _queue.push_back(c);
+        }
+        _cond.notify_all();
+
+        if (_endOfFile)
+            break;
+    }
+}
+
 void LCStdHepRdrNew::printHeader(std::ostream& os) {
 
     if (&os == &std::cout) {
@@ -75,9 +161,9 @@ void LCStdHepRdrNew::updateNextEvent(IMPL::LCEventImpl* evt, const char* colName
     evt->addCollection(mcpCol, colName);
 
     if (_writeEventNumber) {
-        std::cout << "LCStdHepRdrNew: setting event number " << _reader->evtNum() 
+        std::cout << "LCStdHepRdrNew: setting event number " << _evtNum 
             << " from StdHep event" << std::endl;
-        evt->setEventNumber(_reader->evtNum());
+        evt->setEventNumber(_evtNum);
     }
 }
 
@@ -85,6 +171,41 @@ void LCStdHepRdrNew::updateNextEvent(IMPL::LCEventImpl* evt, const char* colName
 // Read an event and return a LCCollectionVec of MCParticles
 //
 IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
+
+    if (_readAhead == 0)
+        return convertEvent(_evtNum);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_thread.joinable() && !_endOfFile)
+        _thread = std::thread(&LCStdHepRdrNew::readAheadLoop, this);
+
+    _cond.wait(lock, [this] {return !_queue.empty() || _endOfFile;});
+
+    if (_queue.empty()) {
+
+        if (_exception) {
+            std::exception_ptr ex = _exception;
+            _exception = nullptr;
+            std::rethrow_exception(ex);
+        }
+        return 0;
+    }
+
+    ConvertedEvent c = _queue.front();
+    _queue.pop_front();
+    _evtNum = c.evtNum;
+
+    lock.unlock();
+    _cond.notify_all();
+
+    return c.col;
+}
+
+//
+// Read the next event from the file and convert it to a LCCollectionVec of MCParticles
+//
+IMPL::LCCollectionVec * LCStdHepRdrNew::convertEvent(long& evtNum) {
     IMPL::LCCollectionVec * mcVec = 0;
     double c_light = 299.792;  // mm/ns
     //
@@ -122,14 +243,17 @@ IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
     //
     //  Create a Collection Vector
     //
+    evtNum = _reader->evtNum();
+
     mcVec = new IMPL::LCCollectionVec(LCIO::MCPARTICLE);
-    MCParticleImpl* p;
-    MCParticleImpl* d;
     //
     //  Loop over particles
     //
     int NHEP = _reader->nTracks();
 
+    // the particles in hepevt order - avoids casting the collection elements back for every relation
+    std::vector<MCParticleImpl*> particles(NHEP);
+
     // user defined process  id
     long idrup = _reader->idrup();
 
@@ -167,6 +291,7 @@ IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
 
         // and add it to the collection (preserving the order of the hepevt block)
         mcVec->at(IHEP) = mcp;
+        particles[IHEP] = mcp;
 
         //
         //  PDGID
@@ -294,7 +419,7 @@ IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
         //
         //  Get the MCParticle
         //
-        MCParticleImpl* mcp = dynamic_cast<MCParticleImpl*>(mcVec->getElementAt(IHEP));
+        MCParticleImpl* mcp = particles[IHEP];
         //
         //  Get the daughter information, discarding extra information
         //  sometimes stored in daughter variables.
@@ -308,68 +433,28 @@ IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
 
         //
         //  As with the parents, look for range, 2 discreet or 1 discreet
-        //  daughter.
+        //  daughter. If not already listed, add this particle as a parent
+        //  of the daughter.
         //
         if ((fd > -1) && (ld > -1)) {
             if (ld >= fd) {
-                for (int id = fd; id < ld + 1; id++) {
-                    //
-                    //  Get the daughter, and see if it already lists this particle as
-                    //    a parent.
-                    //
-                    d = dynamic_cast<MCParticleImpl*>(mcVec->getElementAt(id));
-                    int np = d->getParents().size();
-                    bool gotit = false;
-                    for (int ip = 0; ip < np; ip++) {
-                        p = dynamic_cast<MCParticleImpl*>(d->getParents()[ip]);
-                        if (p == mcp)
-                            gotit = true;
-                    }
-                    //
-                    //  If not already listed, add this particle as a parent
-                    //
-                    if (!gotit)
-                        d->addParent(mcp);
+                for (int id = fd; id < ld + 1 && id < NHEP; id++) {
+                    addParentOnce(particles[id], mcp);
                 }
             }
             //
             //  Same logic, discreet cases
             //
             else {
-                d = dynamic_cast<MCParticleImpl*>(mcVec->getElementAt(fd));
-                int np = d->getParents().size();
-                bool gotit = false;
-                for (int ip = 0; ip < np; ip++) {
-                    p = dynamic_cast<MCParticleImpl*>(d->getParents()[ip]);
-                    if (p == mcp)
-                        gotit = true;
-                }
-                if (!gotit)
-                    d->addParent(mcp);
-                d = dynamic_cast<MCParticleImpl*>(mcVec->getElementAt(ld));
-                np = d->getParents().size();
-                gotit = false;
-                for (int ip = 0; ip < np; ip++) {
-                    p = dynamic_cast<MCParticleImpl*>(d->getParents()[ip]);
-                    if (p == mcp)
-                        gotit = true;
-                }
-                if (!gotit)
-                    d->addParent(mcp);
+                if (fd < NHEP)
+                    addParentOnce(particles[fd], mcp);
+                if (ld < NHEP)
+                    addParentOnce(particles[ld], mcp);
             }
         } else if (fd > -1) {
 
             if (fd < NHEP) {
-                d = dynamic_cast<MCParticleImpl*>(mcVec->getElementAt(fd));
-                int np = d->getParents().size();
-                bool gotit = false;
-                for (int ip = 0; ip < np; ip++) {
-                    p = dynamic_cast<MCParticleImpl*>(d->getParents()[ip]);
-                    if (p == mcp)
-                        gotit = true;
-                }
-                if (!gotit)
-                    d->addParent(mcp);
+                addParentOnce(particles[fd], mcp);
 
             } else {
                 //FIXME: whizdata has lots of of illegal daughter indices 21 < NHEP
@@ -413,7 +498,7 @@ IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
     int nic = 0;
     for (int IHEP = 0; IHEP < NHEP; IHEP++) {
 
-        MCParticleImpl* mcp = dynamic_cast<MCParticleImpl*>(mcVec->getElementAt(IHEP));
+        MCParticleImpl* mcp = particles[IHEP];
 
         // find inconsistencies
         if ((mcp->getGeneratorStatus() == 2) && (mcp->getDaughters().size() == 0)) {
@@ -436,7 +521,7 @@ IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
             //if yes, fix relation!
             for (unsigned int nextparentid = parentid; IHEP - nextparentid > 0; nextparentid++) {
                 //printf("     check line %i ", nextparentid);
-                parent = dynamic_cast<MCParticleImpl*>(mcVec->getElementAt(nextparentid));
+                parent = particles[nextparentid];
                 if ((parent->getGeneratorStatus() == 2) && (parent->getDaughters().size() == 0)
                         && mcp->getParents().size() < outn) {
                     mcp->addParent(parent);
@@ -463,18 +548,18 @@ IMPL::LCCollectionVec * LCStdHepRdrNew::readEvent() {
         int mom2 = _reader->mother2(IHEP) - 1;
         // int dau1 = _reader->daughter1(IHEP) - 1;
         // int dau2 = _reader->daughter1(IHEP) - 1;
-        MCParticleImpl* mcDau = (MCParticleImpl*) mcVec->getElementAt(IHEP);
+        MCParticleImpl* mcDau = particles[IHEP];
         if (mom1 > 0 && mom2 == -1) {
-            MCParticleImpl* mcPar = (MCParticleImpl*) mcVec->getElementAt(mom1);
-            EVENT::MCParticleVec dauVec = mcPar->getDaughters();
+            MCParticleImpl* mcPar = particles[mom1];
+            const EVENT::MCParticleVec& dauVec = mcPar->getDaughters();
             bool hasDau = (std::find(dauVec.begin(), dauVec.end(), mcDau) != dauVec.end());
             if (!hasDau) {
                 mcDau->addParent(mcPar);
             }
         } else if (mom1 > -1 && mom2 > -1) {
             for (int i = mom1; i <= mom2; i++) {
-                MCParticleImpl* mcPar = (MCParticleImpl*) mcVec->getElementAt(i);
-                EVENT::MCParticleVec dauVec = mcPar->getDaughters();
+                MCParticleImpl* mcPar = particles[i];
+                const EVENT::MCParticleVec& dauVec = mcPar->getDaughters();
                 bool hasDau = (std::find(dauVec.begin(), dauVec.end(), mcDau) != dauVec.end());
                 if (!hasDau) {
                     mcDau->addParent(mcPar);
@@ -0,0 +1,324 @@
+#include "UTIL/MCParticleGraph.h"
+
+#include "EVENT/LCIO.h"
+#include "Exceptions.h"
+
+#include <set>
+#include <sstream>
+
+using namespace EVENT ;
+
+namespace UTIL{
+
+
+  MCParticleGraph::MCParticleGraph( const LCCollection* col ) :
+    _col( col ) ,
+    _isInitialized( false ) ,
+    _hasMultiParents( false ) ,
+    _particles() ,
+    _index() ,
+    _topoOrder() ,
+    _daughterOff() ,
+    _daughterIdx() ,
+    _parentOff() ,
+    _parentIdx() ,
+    _first() ,
+    _last() ,
+    _root() ,
+    _multiParentUp() {
+  }
+
+
+  void MCParticleGraph::initialize() const {
+
+    if( _isInitialized )
+      return ;
+
+    if( _col == 0 || _col->getTypeName() != LCIO::MCPARTICLE ) {
+
+      throw Exception( "MCParticleGraph::initialize() - collection is not of type MCParticle" ) ;
+    }
+
+    int n = _col->getNumberOfElements() ;
+
+    _particles.resize( n ) ;
+    _index.reserve( n ) ;
+
+    for(int i=0 ; i < n ; ++i){
+
+      MCParticle* p = dynamic_cast<MCParticle*>( _col->getElementAt( i ) ) ;
+
+      _particles[i] = p ;
+      _index[ p ] = i ;
+    }
+
+    // ---- parents: CSR from MCParticle::getParents() - ignore particles outside the collection
+    _parentOff.assign( n + 1 , 0 ) ;
+    _parentIdx.clear() ;
+
+    EVENT::IntVec nDaughters( n , 0 ) ;
+
+    for(int i=0 ; i < n ; ++i){
+
+      const MCParticleVec& parents = _particles[i]->getParents() ;
+
+      int nPar = 0 ;
+
+      for(unsigned j=0 ; j < parents.size() ; ++j){
+
+	IndexMap::const_iterator it = _index.find( parents[j] ) ;
+
+	if( it == _index.end() )
+	  continue ;
+
+	_parentIdx.push_back( it->second ) ;
+	++nDaughters[ it->second ] ;
+	++nPar ;
+      }
+
+      if( nPar > 1 )
+	_hasMultiParents = true ;
+
+      _parentOff[i+1] = _parentIdx.size() ;
+    }
+
+    // ---- daughters: inverse of the parent relation, so both directions are consistent
+    _daughterOff.assign( n + 1 , 0 ) ;
+
+    for(int i=0 ; i < n ; ++i)
+      _daughterOff[i+1] = _daughterOff[i] + nDaughters[i] ;
+
+    _daughterIdx.resize( _daughterOff[n] ) ;
+
+    EVENT::IntVec fill( _daughterOff.begin() , _daughterOff.end() - 1 ) ;
+
+    for(int i=0 ; i < n ; ++i){
+      for(int k = _parentOff[i] ; k < _parentOff[i+1] ; ++k){
+
+	_daughterIdx[ fill[ _parentIdx[k] ]++ ] = i ;
+      }
+    }
+
+    // ---- topological order (Kahn) - parents before daughters
+    _topoOrder.clear() ;
+    _topoOrder.reserve( n ) ;
+
+    EVENT::IntVec nOpen( n ) ;
+
+    for(int i=0 ; i < n ; ++i){
+
+      nOpen[i] = _parentOff[i+1] - _parentOff[i] ;
+
+      if( nOpen[i] == 0 )
+	_topoOrder.push_back( i ) ;
+    }
+
+    for(unsigned k=0 ; k < _topoOrder.size() ; ++k){
+
+      int i = _topoOrder[k] ;
+
+      for(int d = _daughterOff[i] ; d < _daughterOff[i+1] ; ++d){
+
+	if( --nOpen[ _daughterIdx[d] ] == 0 )
+	  _topoOrder.push_back( _daughterIdx[d] ) ;
+      }
+    }
+
+    if( (int) _topoOrder.size() != n ){
+
+      std::stringstream sstr ;
+      sstr << "MCParticleGraph::initialize() - parent/daughter relations are not acyclic: "
+	   << n - _topoOrder.size() << " particles are part of a cycle" ;
+
+      throw Exception( sstr.str() ) ;
+    }
+
+    // ---- pre-order intervals of the first-parent forest:
+    //      subtree sizes bottom up, interval starts top down
+    EVENT::IntVec subSize( n , 1 ) ;
+
+    for(int k = n-1 ; k >= 0 ; --k){
+
+      int i = _topoOrder[k] ;
+
+      if( _parentOff[i+1] > _parentOff[i] )
+	subSize[ _parentIdx[ _parentOff[i] ] ] += subSize[i] ;
+    }
+
+    _first.assign( n , 0 ) ;
+    _last.assign( n , 0 ) ;
+    _root.assign( n , 0 ) ;
+    _multiParentUp.assign( n , -1 ) ;
+
+    // next free pre-order position below each node
+    EVENT::IntVec next( n , 0 ) ;
+    int nextRoot = 0 ;
+
+    for(int k=0 ; k < n ; ++k){
+
+      int i = _topoOrder[k] ;
+
+      int nPar = _parentOff[i+1] - _parentOff[i] ;
+
+      if( nPar == 0 ){
+
+	_first[i] = nextRoot ;
+	nextRoot += subSize[i] ;
+
+	_root[i] = i ;
+
+      } else {
+
+	int tp = _parentIdx[ _parentOff[i] ] ;
+
+	_first[i] = next[tp] ;
+	next[tp] += subSize[i] ;
+
+	_root[i] = _root[tp] ;
+	_multiParentUp[i] = _multiParentUp[tp] ;
+      }
+
+      if( nPar > 1 )
+	_multiParentUp[i] = i ;
+
+      next[i] = _first[i] + 1 ;
+      _last[i] = _first[i] + subSize[i] - 1 ;
+    }
+
+    _isInitialized = true ;
+  }
+
+
+  int MCParticleGraph::size() const {
+
+    initialize() ;
+
+    return _particles.size() ;
+  }
+
+  int MCParticleGraph::index( const MCParticle* p ) const {
+
+    initialize() ;
+
+    IndexMap::const_iterator it = _index.find( p ) ;
+
+    return ( it != _index.end() ? it->second : -1 ) ;
+  }
+
+  MCParticle* MCParticleGraph::particle( int i ) const {
+
+    initialize() ;
+
+    return _particles[i] ;
+  }
+
+  const EVENT::IntVec& MCParticleGraph::topologicalOrder() const {
+
+    initialize() ;
+
+    return _topoOrder ;
+  }
+
+  int MCParticleGraph::getNumberOfDaughters( int i ) const {
+
+    initialize() ;
+
+    return _daughterOff[i+1] - _daughterOff[i] ;
+  }
+
+  const int* MCParticleGraph::getDaughterIndices( int i ) const {
+
+    initialize() ;
+
+    return _daughterIdx.data() + _daughterOff[i] ;
+  }
+
+  int MCParticleGraph::getNumberOfParents( int i ) const {
+
+    initialize() ;
+
+    return _parentOff[i+1] - _parentOff[i] ;
+  }
+
+  const int* MCParticleGraph::getParentIndices( int i ) const {
+
+    initialize() ;
+
+    return _parentIdx.data() + _parentOff[i] ;
+  }
+
+
+  bool MCParticleGraph::isAncestor( int anc, int desc ) const {
+
+    initialize() ;
+
+    if( anc == desc )
+      return false ;
+
+    if( _first[anc] < _first[desc] && _first[desc] <= _last[anc] )
+      return true ;
+
+    if( ! _hasMultiParents )
+      return false ;
+
+    return isAncestorMultiParent( anc, desc ) ;
+  }
+
+  bool MCParticleGraph::isAncestor( const MCParticle* anc, const MCParticle* desc ) const {
+
+    int a = index( anc ) ;
+    int d = index( desc ) ;
+
+    if( a < 0 || d < 0 )
+      return false ;
+
+    return isAncestor( a, d ) ;
+  }
+
+
+  bool MCParticleGraph::isAncestorMultiParent( int anc, int desc ) const {
+
+    // every node x on the stack is an ancestor of desc (or desc itself): anc is an
+    // ancestor of x on the first-parent path if x is inside anc's interval, otherwise
+    // only the additional parents of multi-parent nodes above x need to be followed
+    std::set<int> done ;
+    EVENT::IntVec stack( 1 , desc ) ;
+
+    while( ! stack.empty() ){
+
+      int x = stack.back() ;
+      stack.pop_back() ;
+
+      if( x != desc && _first[anc] <= _first[x] && _first[x] <= _last[anc] )
+	return true ;
+
+      int m = _multiParentUp[x] ;
+
+      while( m != -1 && done.insert( m ).second ){
+
+	for(int k = _parentOff[m] + 1 ; k < _parentOff[m+1] ; ++k)
+	  stack.push_back( _parentIdx[k] ) ;
+
+	m = _multiParentUp[ _parentIdx[ _parentOff[m] ] ] ;
+      }
+    }
+
+    return false ;
+  }
+
+
+  int MCParticleGraph::getPrimaryAncestor( int i ) const {
+
+    initialize() ;
+
+    return _root[i] ;
+  }
+
+  MCParticle* MCParticleGraph::getPrimaryAncestor( const MCParticle* p ) const {
+
+    int i = index( p ) ;
+
+    return ( i < 0 ? 0 : _particles[ _root[i] ] ) ;
+  }
+
+} // namespace UTIL
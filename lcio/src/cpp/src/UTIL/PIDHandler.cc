@@ -17,11 +17,19 @@ namespace UTIL{
   } ;
 
   
+  // algorithm ids up to this value are looked up directly in the slot index
+  static const int maxIndexedID = 1023 ;
+
+  
   PIDHandler::PIDHandler( LCCollection* col ) : 
     _col( col) , 
+    _constCol( col ) ,
     _cpm( "PIDAlgorithmTypeName",  "PIDAlgorithmTypeID" ,  col ),
     _type(-1) , 
-    _maxID(-1) {
+    _maxID(-1) ,
+    _algos() ,
+    _slotIndex() ,
+    _ids() {
     
     init( col ) ;
   }
@@ -29,9 +37,13 @@ namespace UTIL{
   
   PIDHandler::PIDHandler(  const LCCollection* col ) : 
     _col( 0 ) , // not needed 
+    _constCol( col ) ,
     _cpm( "PIDAlgorithmTypeName",  "PIDAlgorithmTypeID" ,  col ),
     _type(-1) , 
-    _maxID(-1) {
+    _maxID(-1) ,
+    _algos() ,
+    _slotIndex() ,
+    _ids() {
     
     init( col ) ;
   }
@@ -42,6 +54,7 @@ namespace UTIL{
 
     // ---- get the information on existing ParticleID objects ----------
 
+    _algos.reserve( _cpm.map().size() ) ;
 
     for( CPM::map_type::iterator it = _cpm.map().begin() ; it != _cpm.map().end() ; ++it) {
       
@@ -53,9 +66,7 @@ namespace UTIL{
 	_maxID = id ;
 
       // ensure id is unique for collection
-      PNM::iterator nit = _pNames.find( id ) ;
-
-      if( nit != _pNames.end() ){
+      if( findSlot( id ) >= 0 ){
 
 	std::stringstream sstr ;
 
@@ -72,14 +83,7 @@ namespace UTIL{
 
       col->getParameters().getStringVals( std::string( "ParameterNames_" + aName   ) , pNames ) ;
 
-      _pNames[ id ] = pNames ;  // save a copy of parameter names for algorithm with id
-
-      _ids.push_back( id ) ;
-
-      //   save inverse map for lookup algoName from algoID
-
-      _cpmInv.insert( std::make_pair( id  , aName )  ) ;
-
+      addSlot( id , aName , pNames ) ;  // save a copy of parameter names for algorithm with id
     } 
 
     //------------------------------------------------
@@ -112,16 +116,137 @@ namespace UTIL{
     if (_col != 0 ) {
       // save the collection parameters
       
-      for( PNM::iterator pnm = _pNames.begin() ; pnm != _pNames.end() ; ++pnm) {
-	
-	int id = pnm->first ;
-	
+      for( unsigned i=0 ; i < _algos.size() ; ++i ) {
 	
-	_col->parameters().setValues( std::string( "ParameterNames_" + _cpmInv[id]  ) , 
-				      pnm->second ) ;
+	_col->parameters().setValues( std::string( "ParameterNames_" + _algos[i].name  ) , 
+				      _algos[i].pNames ) ;
+      }
+    }
+  }
+
+
+  PIDHandler::Algorithm& PIDHandler::addSlot( int id , const std::string& algoName , const StringVec& pNames ) {
+
+    Algorithm a ;
+    a.id = id ;
+    a.name = algoName ;
+    a.pNames = pNames ;
+    a.isFilled = false ;
+
+    _algos.push_back( a ) ;
+
+    if( id >= 0 && id <= maxIndexedID ) {
+
+      if( (int) _slotIndex.size() <= id ) 
+	_slotIndex.resize( id + 1 , -1 ) ;
+      
+      _slotIndex[ id ] = _algos.size() - 1 ;
+    }
+
+    _ids.push_back( id ) ;
+
+    return _algos.back() ;
+  }
+
+
+  int PIDHandler::findSlot( int id ) const {
+
+    if( id >= 0 && id <= maxIndexedID ) 
+      return ( id < (int) _slotIndex.size() ? _slotIndex[ id ] : -1 ) ;
+
+    for( unsigned i=0 ; i < _algos.size() ; ++i ) {
+      if( _algos[i].id == id ) 
+	return i ;
+    }
+    return -1 ;
+  }
+
+
+  PIDHandler::Algorithm& PIDHandler::slot( int id ) {
+
+    int i = findSlot( id ) ;
+
+    if( i < 0 ) {
+
+      std::stringstream ss ; ss << id ; 
+      throw UnknownAlgorithm( ss.str().c_str()  ) ;
+    }
+
+    return _algos[ i ] ;
+  }
+
+
+  const ParticleIDVec& PIDHandler::particleIDs( LCObject* p ) {
+
+    if( _type == ReconstructedParticle  ){
+      
+      return static_cast< ReconstructedParticleImpl* >(p)->getParticleIDs() ;
+    }
+    else if( _type == Cluster  ){
+      
+      return static_cast< ClusterImpl* >(p)->getParticleIDs() ;
+    }
+      
+    throw Exception("PIDHandler::particleIDs LCObject is neither  ReconstructedParticleImpl nor ClusterImpl !") ;
+  }
+
+
+  void PIDHandler::invalidateArrays() {
+
+    for( unsigned i=0 ; i < _algos.size() ; ++i ) 
+      _algos[i].isFilled = false ;
+  }
+
+
+  PIDHandler::Algorithm& PIDHandler::filledSlot( int id ) {
+
+    Algorithm& a = slot( id ) ;
+
+    unsigned nElements = _constCol->getNumberOfElements() ;
+
+    if( a.isFilled && a.pids.size() == nElements )
+      return a ;
+
+    unsigned nParam = a.pNames.size() ;
+
+    a.pids.assign( nElements , 0 ) ;
+    a.pdg.assign( nElements , 0 ) ;
+    a.likelihood.assign( nElements , 0. ) ;
+    a.params.assign( nParam * nElements , 0. ) ;
+
+    for( unsigned i=0 ; i < nElements ; ++i ) {
+
+      const ParticleIDVec& pidV = particleIDs( _constCol->getElementAt( i ) ) ;
+
+      unsigned nPid = pidV.size() ;
+
+      for( unsigned k=0 ; k < nPid ; ++k ) {
+
+	if( pidV[k]->getAlgorithmType() != id ) 
+	  continue ;
+
+	ParticleID* pid = pidV[k] ;
+
+	a.pids[i] = pid ;
+	a.pdg[i] = pid->getPDG() ;
+	a.likelihood[i] = pid->getLikelihood() ;
+
+	const FloatVec& ps = pid->getParameters() ;
+
+	unsigned n = ( ps.size() < nParam ? ps.size() : nParam ) ;
+
+	for( unsigned j=0 ; j < n ; ++j ) 
+	  a.params[ j * nElements + i ] = ps[j] ;
+
+	break ;
       }
     }
+
+    a.isFilled = true ;
+
+    return a ;
   }
+
   
   int PIDHandler::addAlgorithm( const std::string& algoName, const StringVec& pNames ) {
     
@@ -143,13 +268,10 @@ namespace UTIL{
 
     map.insert( std::make_pair( algoName , id ) ) ;
     
-    // inverse map:
-    _cpmInv.insert( std::make_pair( id  , algoName )  ) ;
+    // previously returned arrays are not guaranteed to survive adding a slot
+    invalidateArrays() ;
 
-    // save parameter names
-    _pNames[ id ] = pNames ;      
-
-    _ids.push_back( id ) ;
+    addSlot( id , algoName , pNames ) ;
 
     return id ;
   }
@@ -168,32 +290,16 @@ namespace UTIL{
   
   const std::string& PIDHandler::getAlgorithmName(  int algoID ) {
     
-    CPMINV::iterator it = _cpmInv.find( algoID ) ; 
-
-    if( it == _cpmInv.end() ){
-      
-      std::stringstream ss ; ss << algoID ; 
-      throw UnknownAlgorithm( ss.str().c_str()  ) ;
-    }
-    
-    return it->second ;
+    return slot( algoID ).name ;
   }
   
 
 
   int PIDHandler::getParameterIndex( int algorithmID, const std::string& name ) {
     
-    
-    PNM::iterator nit = _pNames.find( algorithmID ) ;
-    
-    if( nit == _pNames.end() ){
-
-      std::stringstream ss ; ss << algorithmID ;
-      throw UnknownAlgorithm( ss.str().c_str()  ) ;
-    }
     // brute force search:
     
-    const StringVec& names =  nit->second ;
+    const StringVec& names =  slot( algorithmID ).pNames ;
 
     unsigned n = names.size() ;
 
@@ -210,15 +316,7 @@ namespace UTIL{
   
   const StringVec&  PIDHandler::getParameterNames( int id  ) {
 
-    PNM::iterator nit = _pNames.find( id ) ;
-    
-    if( nit == _pNames.end() ){
-
-      std::stringstream ss ; ss << id ; 
-      throw UnknownAlgorithm( ss.str().c_str()  ) ;
-    }
-
-    return nit->second ;
+    return slot( id ).pNames ;
   }
     
   const IntVec& PIDHandler::getAlgorithmIDs() {
@@ -230,13 +328,7 @@ namespace UTIL{
 
   void PIDHandler::setParticleIDUsed(  ReconstructedParticleImpl* p , int id  ) {
 
-    PNM::iterator nit = _pNames.find( id ) ;
-    
-    if( nit == _pNames.end() ){
-
-      std::stringstream ss ; ss << id ; 
-      throw UnknownAlgorithm( ss.str().c_str()  ) ;
-    }
+    slot( id ) ;  // throws UnknownAlgorithm
 
     ParticleID* pid = 0 ;
     
@@ -278,31 +370,9 @@ namespace UTIL{
 
   ParticleIDVec PIDHandler::getParticleIDs( LCObject* p , int id ) {
 
-    PNM::iterator nit = _pNames.find( id ) ;
-    
-    if( nit == _pNames.end() ){
-      
-      std::stringstream ss ; ss << id ; 
-      throw UnknownAlgorithm( ss.str().c_str()  ) ;
-    }
+    slot( id ) ;  // throws UnknownAlgorithm
 
-    
-    const ParticleIDVec* idv = 0 ;	 
-
-    if( _type == ReconstructedParticle  ){
-      
-      idv = &( static_cast< ReconstructedParticleImpl* >(p)->getParticleIDs()  ) ; 
-    }
-    else if( _type == Cluster  ){
-      
-      idv = &( static_cast< ClusterImpl* >(p)->getParticleIDs()  ) ; 
-    }
-    else{
-      
-      throw Exception("PIDHandler::getParticleID LCObject is neither  ReconstructedParticleImpl nor ClusterImpl !") ;
-    }
-
-    const ParticleIDVec& pidV = *idv ;	 
+    const ParticleIDVec& pidV = particleIDs( p ) ;
 
     ParticleIDVec pidVID ;
 
@@ -321,31 +391,9 @@ namespace UTIL{
 
   const ParticleID& PIDHandler::getParticleID( LCObject* p , int id ) {
 
-    PNM::iterator nit = _pNames.find( id ) ;
-    
-    if( nit == _pNames.end() ){
+    slot( id ) ;  // throws UnknownAlgorithm
 
-      std::stringstream ss ; ss << id ; 
-      throw UnknownAlgorithm( ss.str().c_str()  ) ;
-    }
-
-    
-    const ParticleIDVec* idv = 0 ;	 
-
-    if( _type == ReconstructedParticle  ){
-      
-      idv = &( static_cast< ReconstructedParticleImpl* >(p)->getParticleIDs()  ) ; 
-    }
-    else if( _type == Cluster  ){
-      
-      idv = &( static_cast< ClusterImpl* >(p)->getParticleIDs()  ) ; 
-    }
-    else{
-      
-      throw Exception("PIDHandler::getParticleID LCObject is neither  ReconstructedParticleImpl nor ClusterImpl !") ;
-    }
-
-    const ParticleIDVec& pidV = *idv ;	 
+    const ParticleIDVec& pidV = particleIDs( p ) ;
 
     unsigned nPid = pidV.size() ;
     
@@ -361,6 +409,7 @@ namespace UTIL{
 
     ParticleIDImpl* pid = new ParticleIDImpl ;
 
+    invalidateArrays() ;
 
     if( _type == ReconstructedParticle  ){
       
@@ -383,47 +432,27 @@ namespace UTIL{
 				  const FloatVec& params ) {
     
 
-    PNM::iterator nit = _pNames.find( id ) ;
-    
-    if( nit == _pNames.end() ){
-      
-      std::stringstream ss ; ss << id ; 
-      throw UnknownAlgorithm( ss.str().c_str()  ) ;
-    }
-    
+    const Algorithm& a = slot( id ) ;  // throws UnknownAlgorithm
 
     // ---- check paramaters size -----
     unsigned nParam =  params.size()  ;
 
-    if( nParam != _pNames[ id ].size() ) {
+    if( nParam != a.pNames.size() ) {
       
       std::stringstream sstr ;
       
       sstr << " PIDHandler::setParticleID() - wrong parmeter size specified: "
-	   <<  nParam << " - expected " << _pNames[ id ].size()  ; 
+	   <<  nParam << " - expected " << a.pNames.size()  ; 
       
       throw Exception( sstr.str() ) ;
 
     }
 
+    invalidateArrays() ;
+
     ParticleIDImpl* pid = 0 ;
     
-    const ParticleIDVec* idv = 0 ;	 
-    
-    if( _type == ReconstructedParticle  ){
-      
-      idv = &( static_cast< ReconstructedParticleImpl* >(p)->getParticleIDs()  ) ; 
-    }
-    else if( _type == Cluster  ){
-      
-      idv = &( static_cast< ClusterImpl* >(p)->getParticleIDs()  ) ; 
-    }
-    else{
-      
-      throw Exception("PIDHandler::setParticleID LCObject is neither  ReconstructedParticleImpl nor ClusterImpl !") ;
-    }
- 
-    const ParticleIDVec& pidV = *idv ;	 
+    const ParticleIDVec& pidV = particleIDs( p ) ;
     
     unsigned nPid = pidV.size() ;
     
@@ -484,4 +513,37 @@ namespace UTIL{
     }
     
   }
+
+
+  ParticleID* const* PIDHandler::getParticleIDArray( int algorithmID ) {
+
+    return filledSlot( algorithmID ).pids.data() ;
+  }
+
+  const int* PIDHandler::getPDGArray( int algorithmID ) {
+
+    return filledSlot( algorithmID ).pdg.data() ;
+  }
+
+  const float* PIDHandler::getLikelihoodArray( int algorithmID ) {
+
+    return filledSlot( algorithmID ).likelihood.data() ;
+  }
+
+  const float* PIDHandler::getParameterArray( int algorithmID , int parameterIndex ) {
+
+    Algorithm& a = filledSlot( algorithmID ) ;
+
+    if( parameterIndex < 0 || parameterIndex >= (int) a.pNames.size() ) {
+
+      std::stringstream sstr ;
+      
+      sstr << " PIDHandler::getParameterArray() - invalid parameter index " << parameterIndex 
+	   << " for algorithm " << a.name << " with " << a.pNames.size() << " parameters" ; 
+      
+      throw Exception( sstr.str() ) ;
+    }
+
+    return a.params.data() + parameterIndex * a.pids.size() ;
+  }
 }
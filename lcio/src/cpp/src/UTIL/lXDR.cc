@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 #if defined(__APPLE_CC__)
 #include "/usr/include/sys/types.h"
@@ -23,7 +24,71 @@
 #include <sys/socket.h>
 #endif
 
+#if defined(__linux) || defined(__APPLE_CC__)
+#define LXDR_HAVE_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace UTIL{
+
+////
+//
+// Byte order helpers: load big endian (XDR) values from unaligned memory.
+// The loops over arrays using them are simple enough to be vectorized.
+//
+////
+namespace {
+
+inline uint32_t swap32(uint32_t v)
+{
+#if defined(__GNUC__)
+   return(__builtin_bswap32(v));
+#else
+   return(((v & 0xFF) << 24) | ((v & 0xFF00) << 8) | ((v >> 8) & 0xFF00) | (v >> 24));
+#endif
+}
+
+inline uint64_t swap64(uint64_t v)
+{
+#if defined(__GNUC__)
+   return(__builtin_bswap64(v));
+#else
+   return(((uint64_t) swap32((uint32_t) v) << 32) | swap32((uint32_t) (v >> 32)));
+#endif
+}
+
+inline int32_t load32(const char *p, bool swap)
+{
+   uint32_t v;
+   memcpy(&v, p, 4);
+   if (swap) v = swap32(v);
+   return((int32_t) v);
+}
+
+inline float loadFloat(const char *p, bool swap)
+{
+   uint32_t v;
+   memcpy(&v, p, 4);
+   if (swap) v = swap32(v);
+   float f;
+   memcpy(&f, &v, 4);
+   return(f);
+}
+
+inline double loadDouble(const char *p, bool swap)
+{
+   uint64_t v;
+   memcpy(&v, p, 8);
+   if (swap) v = swap64(v);
+   double d;
+   memcpy(&d, &v, 8);
+   return(d);
+}
+
+}
+
 ////
 //
 // Constructor, destructor
@@ -31,6 +96,7 @@ namespace UTIL{
 ////
 lXDR::~lXDR()
 {
+   resetBuffer();
    if (_fp) {
       fclose(_fp);
       _fp = 0;
@@ -42,7 +108,9 @@ lXDR::~lXDR()
    return;
 }
 
-lXDR::lXDR(const char *filename, bool open_for_write) : _fileName(0), _fp(0) 
+lXDR::lXDR(const char *filename, bool open_for_write) : _fileName(0), _fp(0), _error(LXDR_SUCCESS),
+   _openForWrite(false), _hasNetworkOrder(false),
+   _buffer(0), _bufferSize(0), _bufferPos(0), _bufferEnd(0), _bufferStart(0), _isMapped(false)
 {
    setFileName(filename, open_for_write);
    if (htonl(1L) == 1L) _hasNetworkOrder = true;
@@ -69,6 +137,7 @@ void lXDR::setFileName(const char *filename, bool open_for_write)
       return;
    }
 
+   resetBuffer();
    if (_fp) fclose(_fp);
    _fp = fp;
 
@@ -111,19 +180,104 @@ double lXDR::ntohd(double d) const
    return(d);
 }
 
+void lXDR::resetBuffer(void)
+{
+   if (_isMapped) {
+#ifdef LXDR_HAVE_MMAP
+      munmap(_buffer, _bufferEnd);
+#endif
+   }
+   else {
+      delete [] _buffer;
+   }
+   _buffer      = 0;
+   _bufferSize  = 0;
+   _bufferPos   = 0;
+   _bufferEnd   = 0;
+   _bufferStart = 0;
+   _isMapped    = false;
+   return;
+}
+
+bool lXDR::mapFile(void)
+{
+#ifdef LXDR_HAVE_MMAP
+   if (_fp == 0 || _openForWrite) return(false);
+   if (_isMapped) return(true);
+
+   struct stat st;
+   if (fstat(fileno(_fp), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) return(false);
+
+   void *p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fileno(_fp), 0);
+   if (p == MAP_FAILED) return(false);
+#ifdef MADV_SEQUENTIAL
+   madvise(p, st.st_size, MADV_SEQUENTIAL);
+#endif
+//
+// Continue at the current (logical) file position
+//
+   long pos = _bufferStart + _bufferPos;
+   delete [] _buffer;
+
+   _buffer      = (char *) p;
+   _bufferSize  = st.st_size;
+   _bufferStart = 0;
+   _bufferEnd   = st.st_size;
+   _bufferPos   = (pos < _bufferEnd) ? pos : _bufferEnd;
+   _isMapped    = true;
+   return(true);
+#else
+   return(false);
+#endif
+}
+
+const char *lXDR::nextBytes(long n)
+{
+//
+// Return a pointer to the next n bytes of the file and advance, 0 if there
+// are less than n bytes left.
+//
+   static const char empty[1] = { 0 };
+   if (n < 0) return(0);
+   if (n == 0) return(empty);
+   if (_bufferPos + n > _bufferEnd) {
+      if (_isMapped) return(0);
+//
+// Refill: keep the unread bytes, grow the buffer if needed and read
+// as much as fits with one fread.
+//
+      long left = _bufferEnd - _bufferPos;
+      if (n > _bufferSize || _buffer == 0) {
+         long size = (n > BUFFERSIZE) ? n : (long) BUFFERSIZE;
+         char *b = new char[size];
+         if (left > 0) memcpy(b, _buffer + _bufferPos, left);
+         delete [] _buffer;
+         _buffer     = b;
+         _bufferSize = size;
+      }
+      else if (left > 0) {
+         memmove(_buffer, _buffer + _bufferPos, left);
+      }
+      _bufferStart += _bufferPos;
+      _bufferPos    = 0;
+      _bufferEnd    = left + fread(_buffer + left, 1, _bufferSize - left, _fp);
+      if (n > _bufferEnd) return(0);
+   }
+   const char *p = _buffer + _bufferPos;
+   _bufferPos += n;
+   return(p);
+}
+
 long lXDR::checkRead(long *l)
 {
    if (_openForWrite) return(_error = LXDR_READONLY);
    if (_fp == 0)      return(_error = LXDR_NOFILE);
    if (l) {
       // je: in architectures where long isn't 4 byte long this code crashes
-      //long nr;
-      //if ((nr = fread(l, 4, 1, _fp)) != 1) return(_error = LXDR_READERROR);
-      //*l = ntohl(*l);
-
-      int32_t buf;
-      if (fread(&buf, 4, 1, _fp) != 1) return(_error = LXDR_READERROR);
-      *l = ((int32_t)ntohl(buf));
+      //     -> XDR longs are always decoded from 4 bytes
+      const char *p = nextBytes(4);
+      if (p == 0) return(_error = LXDR_READERROR);
+      *l = load32(p, !_hasNetworkOrder);
    }
    return(LXDR_SUCCESS);
 }
@@ -133,8 +287,9 @@ long lXDR::checkRead(double *d)
    if (_openForWrite) return(_error = LXDR_READONLY);
    if (_fp == 0)      return(_error = LXDR_NOFILE);
    if (d) {
-      if (fread(d, 8, 1, _fp) != 1) return(_error = LXDR_READERROR);
-      *d = ntohd(*d);
+      const char *p = nextBytes(8);
+      if (p == 0) return(_error = LXDR_READERROR);
+      *d = loadDouble(p, !_hasNetworkOrder);
    }
    return(LXDR_SUCCESS);
 }
@@ -144,11 +299,9 @@ long lXDR::checkRead(float *f)
    if (_openForWrite) return(_error = LXDR_READONLY);
    if (_fp == 0)      return(_error = LXDR_NOFILE);
    if (f) {
-      if (fread(f, 4, 1, _fp) != 1) return(_error = LXDR_READERROR);
-      // je: in architectures where long isn't 4 byte long this code crashes
-      //*((long *) f) = ntohl(*((long *) f));
-
-      *((int32_t *) f) = ntohl(*((int32_t *) f));
+      const char *p = nextBytes(4);
+      if (p == 0) return(_error = LXDR_READERROR);
+      *f = loadFloat(p, !_hasNetworkOrder);
    }
    return(LXDR_SUCCESS);
 }
@@ -178,12 +331,13 @@ const char *lXDR::readString(long &length)
 {
    if (checkRead(&length)) return(0);
    long rl = (length + 3) & 0xFFFFFFFC;
-   char *s = new char[rl + 1];
-   if (fread(s, 1, rl, _fp) != (unsigned long) rl) {
+   const char *p = nextBytes(rl);
+   if (p == 0) {
       _error = LXDR_READERROR;
-      delete [] s;
       return(0);
    }
+   char *s = new char[rl + 1];
+   memcpy(s, p, rl);
    s[rl] = '\0';
    _error = LXDR_SUCCESS;
    return(s);
@@ -192,31 +346,14 @@ const char *lXDR::readString(long &length)
 long *lXDR::readLongArray(long &length)
 {
    if (checkRead(&length)) return(0);
-   long *s = new long[length];
-   // je: in architectures where long isn't 4 byte long this code crashes
-   //if (fread(s, 4, length, _fp) != (unsigned long) length) {
-   //   _error = LXDR_READERROR;
-   //   delete [] s;
-   //   return(0);
-   //}
-   //if (_hasNetworkOrder == false) for (long i = 0; i < length; i++) s[i] = ntohl(s[i]);
-
-   int32_t *buf = new int32_t[length];
-   if (fread(buf, 4, length, _fp) != (unsigned long) length) {
-       _error = LXDR_READERROR;
-       delete [] buf;
-       delete [] s;
-       return(0);
-   }
-   for (long i = 0; i < length; i++){
-       if (_hasNetworkOrder == false){
-           s[i] = ((int32_t)ntohl(buf[i]));
-       }
-       else{
-            s[i] = (long)buf[i];
-       }
+   const char *p = nextBytes(4 * length);
+   if (p == 0) {
+      _error = LXDR_READERROR;
+      return(0);
    }
-   delete [] buf;
+   long *s = new long[length];
+   bool swap = !_hasNetworkOrder;
+   for (long i = 0; i < length; i++) s[i] = load32(p + 4 * i, swap);
    _error = LXDR_SUCCESS;
    return(s);
 }
@@ -224,13 +361,14 @@ long *lXDR::readLongArray(long &length)
 double *lXDR::readDoubleArray(long &length)
 {
    if (checkRead(&length)) return(0);
-   double *s = new double[length];
-   if (fread(s, 8, length, _fp) != (unsigned long) length) {
+   const char *p = nextBytes(8 * length);
+   if (p == 0) {
       _error = LXDR_READERROR;
-      delete [] s;
       return(0);
    }
-   if (_hasNetworkOrder == false) for (long i = 0; i < length; i++) s[i] = ntohd(s[i]);
+   double *s = new double[length];
+   bool swap = !_hasNetworkOrder;
+   for (long i = 0; i < length; i++) s[i] = loadDouble(p + 8 * i, swap);
    _error = LXDR_SUCCESS;
    return(s);
 }
@@ -238,23 +376,15 @@ double *lXDR::readDoubleArray(long &length)
 double *lXDR::readFloatArray(long &length)
 {
    if (checkRead(&length)) return(0);
-   long *st = new long[length];
-   // je: FIXME this will cause problems in architectures where long isn't 4 byte long
-   if (fread(st, 4, length, _fp) != (unsigned long) length) {
+   const char *p = nextBytes(4 * length);
+   if (p == 0) {
       _error = LXDR_READERROR;
-      delete [] st;
       return(0);
    }
    double *s = new double[length];
-   // je: FIXME what happens if _hasNetworkOrder == true?!
-   if (_hasNetworkOrder == false) {
-      for (long i = 0; i < length; i++) {
-         long l = ntohl(st[i]);
-         s[i] = (double) (*((float *) &l));
-      }
-   }
+   bool swap = !_hasNetworkOrder;
+   for (long i = 0; i < length; i++) s[i] = (double) loadFloat(p + 4 * i, swap);
    _error = LXDR_SUCCESS;
-   delete [] st;
    return(s);
 }
 
@@ -341,11 +471,30 @@ long lXDR::filePosition(long pos)
       _error = LXDR_NOFILE;
       return(-1);
    }
-   if (pos == -1) return(ftell(_fp));
-   if (fseek(_fp, pos, SEEK_SET)) {
+   if (_openForWrite) {
+      if (pos == -1) return(ftell(_fp));
+      if (fseek(_fp, pos, SEEK_SET)) {
+         _error = LXDR_SEEKERROR;
+         return(-1);
+      }
+      return(pos);
+   }
+//
+// Reading: the logical position is the position in the read buffer.
+// Seeks within the buffered (or mapped) data need no I/O.
+//
+   if (pos == -1) return(_bufferStart + _bufferPos);
+   if (pos >= _bufferStart && pos <= _bufferStart + _bufferEnd) {
+      _bufferPos = pos - _bufferStart;
+      return(pos);
+   }
+   if (_isMapped || fseek(_fp, pos, SEEK_SET)) {
       _error = LXDR_SEEKERROR;
       return(-1);
    }
+   _bufferStart = pos;
+   _bufferPos   = 0;
+   _bufferEnd   = 0;
    return(pos);
 }
 
@@ -135,6 +135,35 @@ if(builtin_lzma)
   endif()
 endif()
 
+#---Check for LZ4 and ZSTD, without them ROOT::kLZ4 and ROOT::kZSTD fall back to ZLIB-
+if(lz4)
+  message(STATUS "Looking for LZ4")
+  find_package(LZ4)
+  if(NOT LZ4_FOUND)
+    if(fail-on-missing)
+      message(FATAL_ERROR "LZ4 library not found and is required (lz4 option enabled)")
+    else()
+      message(STATUS "LZ4 library not found. Set variable LZ4_DIR to point to your LZ4 installation")
+      message(STATUS "For the time being switching OFF 'lz4' option")
+      set(lz4 OFF CACHE BOOL "" FORCE)
+      set(LZ4_LIBRARIES)   # not linked to Core and rootcling
+    endif()
+  endif()
+endif()
+if(zstd)
+  message(STATUS "Looking for ZSTD")
+  find_package(ZSTD)
+  if(NOT ZSTD_FOUND)
+    if(fail-on-missing)
+      message(FATAL_ERROR "ZSTD library not found and is required (zstd option enabled)")
+    else()
+      message(STATUS "ZSTD library not found. Set variable ZSTD_DIR to point to your ZSTD installation")
+      message(STATUS "For the time being switching OFF 'zstd' option")
+      set(zstd OFF CACHE BOOL "" FORCE)
+      set(ZSTD_LIBRARIES)   # not linked to Core and rootcling
+    endif()
+  endif()
+endif()
 
 #---Check for X11 which is mandatory lib on Unix--------------------------------------
 if(x11)
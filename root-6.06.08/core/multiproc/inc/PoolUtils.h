@@ -13,8 +13,12 @@
 #define ROOT_PoolUtils
 
 #include "TObject.h"
+#include <string>
 #include <vector>
 
+class TFile;
+class TTree;
+
 namespace PoolCode {
 
    //////////////////////////////////////////////////////////////////////////
@@ -33,12 +37,11 @@ namespace PoolCode {
       kIdling,          ///< We are ready for the next task
       kSendResult,      ///< Ask for a kFuncResult/kProcResult
       /* TPool::Process */
-      kProcFile,        ///< Tell a TPoolProcessor which tree to process. The object sent is a TreeInfo
-      kProcRange,       ///< Tell a TPoolProcessor which tree and entries range to process. The object sent is a TreeRangeInfo
-      kProcTree,        ///< Tell a TPoolProcessor to process the tree that was passed to it at construction time
+      kProcRange,       ///< Tell a TPoolProcessor which range of entries to process. The object sent is the index of a PoolUtils::TreeRange
       kProcResult,      ///< The message contains the result of the processing of a TTree
       kProcEnded,       ///< Tell the client we are done processing (i.e. we have reached the target number of entries to process)
       kProcError,       ///< Tell the client there was an error while processing
+      kMergeResult,     ///< The message contains the result of another TPoolProcessor, to be merged with ours
    };
 
 }
@@ -51,6 +54,20 @@ namespace PoolCode {
 //////////////////////////////////////////////////////////////////////////
 namespace PoolUtils {
    TObject* ReduceObjects(const std::vector<TObject *>& objs);
+
+   /// A range of entries made of whole clusters of a tree: the unit of work
+   /// handed out to the workers by TProcPool::ProcTree.
+   struct TreeRange {
+      unsigned fFileN;  ///< index of the file in the list of files to process
+      Long64_t fStart;  ///< first entry of the range, or the part of the file if fEnd is -1
+      Long64_t fEnd;    ///< end of the range (exclusive), -1 for part fStart of fNParts of the file
+      unsigned fNParts; ///< number of parts the file is split in by the workers if fEnd is -1
+   };
+
+   TTree* FindTree(TFile *fp, const std::string& treeName);
+   void GetTreePart(TTree *tree, unsigned part, unsigned nParts, Long64_t& start, Long64_t& end);
+   std::vector<TreeRange> MakeTreeRanges(const std::vector<std::string>& fileNames, const std::string& treeName, unsigned nWorkers, ULong64_t nToProcess);
+   std::vector<TreeRange> MakeTreeRanges(TTree *tree, unsigned nWorkers, ULong64_t nToProcess);
 }
 
 #endif
@@ -70,45 +70,46 @@ void DetachRes(T res)
 template<class F>
 class TPoolProcessor : public TMPWorker {
 public:
-   TPoolProcessor(F procFunc, const std::vector<std::string>& fileNames, const std::string& treeName, unsigned nWorkers, ULong64_t maxEntries);
-   TPoolProcessor(F procFunc, TTree *tree, unsigned nWorkers, ULong64_t maxEntries);
+   TPoolProcessor(F procFunc, const std::vector<std::string>& fileNames, const std::string& treeName, const std::vector<PoolUtils::TreeRange>& ranges);
+   TPoolProcessor(F procFunc, TTree *tree, const std::vector<PoolUtils::TreeRange>& ranges);
    ~TPoolProcessor() {}
 
    void HandleInput(MPCodeBufPair& msg); ///< Execute instructions received from a TPool client
-   void Init(int fd, unsigned workerN);
 
 private:
-   void Process(unsigned code, MPCodeBufPair& msg);
+   using retType = typename std::result_of<F(std::reference_wrapper<TTreeReader>)>::type;
+
+   void Process(unsigned rangeN);
+   void Reduce(retType res);
    TFile *OpenFile(const std::string& fileName);
    TTree *RetrieveTree(TFile *fp);
-   ULong64_t EvalMaxEntries(ULong64_t maxEntries);
 
    F fProcFunc; ///< the function to be executed
    std::vector<std::string> fFileNames; ///< the files to be processed by all workers
    std::string fTreeName; ///< the name of the tree to be processed
    TTree *fTree; ///< pointer to the tree to be processed. It is only used if the tree is directly passed to TProcPool::Process as argument
-   unsigned fNWorkers; ///< the number of workers spawned
-   ULong64_t fMaxNEntries; ///< the maximum number of entries to be processed by this worker
-   ULong64_t fProcessedEntries; ///< the number of entries processed by this worker so far
-   typename std::result_of<F(std::reference_wrapper<TTreeReader>)>::type fReducedResult; ///< the results of the executions of fProcFunc merged together
+   std::vector<PoolUtils::TreeRange> fRanges; ///< the ranges of entries to be processed by all workers, indexed by the kProcRange messages
+   std::unique_ptr<TFile> fFile; ///< the file currently opened by this worker, kept open for the next range
+   unsigned fFileN; ///< the index of fFile in fFileNames
+   TTree *fFileTree; ///< the tree read from fFile, owned by fFile
+   retType fReducedResult; ///< the results of the executions of fProcFunc merged together
    bool fCanReduce; ///< true if fReducedResult can be reduced with a new result, false until we have produced one result
 };
 
 
 template<class F>
-TPoolProcessor<F>::TPoolProcessor(F procFunc, const std::vector<std::string>& fileNames, const std::string& treeName, unsigned nWorkers, ULong64_t maxEntries) : TMPWorker(), fProcFunc(procFunc),
-   fFileNames(fileNames), fTreeName(treeName), fTree(nullptr),
-   fNWorkers(nWorkers), fMaxNEntries(maxEntries),
-   fProcessedEntries(0), fReducedResult(), fCanReduce(false)
+TPoolProcessor<F>::TPoolProcessor(F procFunc, const std::vector<std::string>& fileNames, const std::string& treeName, const std::vector<PoolUtils::TreeRange>& ranges) :
+   TMPWorker(), fProcFunc(procFunc),
+   fFileNames(fileNames), fTreeName(treeName), fTree(nullptr), fRanges(ranges),
+   fFile(), fFileN(0), fFileTree(nullptr), fReducedResult(), fCanReduce(false)
 {}
 
 
 template<class F>
-TPoolProcessor<F>::TPoolProcessor(F procFunc, TTree *tree, unsigned nWorkers, ULong64_t maxEntries) :
+TPoolProcessor<F>::TPoolProcessor(F procFunc, TTree *tree, const std::vector<PoolUtils::TreeRange>& ranges) :
    TMPWorker(), fProcFunc(procFunc),
-   fFileNames(), fTreeName(), fTree(tree),
-   fNWorkers(nWorkers), fMaxNEntries(maxEntries),
-   fProcessedEntries(0), fReducedResult(), fCanReduce(false)
+   fFileNames(), fTreeName(), fTree(tree), fRanges(ranges),
+   fFile(), fFileN(0), fFileTree(nullptr), fReducedResult(), fCanReduce(false)
 {}
 
 
@@ -117,11 +118,13 @@ void TPoolProcessor<F>::HandleInput(MPCodeBufPair& msg)
 {
    unsigned code = msg.first;
 
-   if (code == PoolCode::kProcRange
-         || code == PoolCode::kProcFile
-         || code == PoolCode::kProcTree) {
-      //execute fProcFunc on a file or a range of entries in a file
-      Process(code, msg);
+   if (code == PoolCode::kProcRange) {
+      //execute fProcFunc on a range of entries
+      Process(ReadBuffer<unsigned>(msg.second.get()));
+   } else if (code == PoolCode::kMergeResult) {
+      //merge the result of another worker into ours, so that the client does not have to
+      Reduce(ReadBuffer<retType>(msg.second.get()));
+      MPSend(GetSocket(), PoolCode::kIdling);
    } else if (code == PoolCode::kSendResult) {
       //send back result
       MPSend(GetSocket(), PoolCode::kProcResult, fReducedResult);
@@ -135,88 +138,60 @@ void TPoolProcessor<F>::HandleInput(MPCodeBufPair& msg)
 
 
 template<class F>
-void TPoolProcessor<F>::Init(int fd, unsigned workerN) {
-   TMPWorker::Init(fd, workerN);
-
-   fMaxNEntries = EvalMaxEntries(fMaxNEntries);
-}
-
-
-template<class F>
-void TPoolProcessor<F>::Process(unsigned code, MPCodeBufPair& msg)
+void TPoolProcessor<F>::Process(unsigned rangeN)
 {
-   //evaluate the index of the file to process in fFileNames
-   //(we actually don't need the parameter if code == kProcTree)
-   unsigned fileN = 0;
-   unsigned nProcessed = 0;
-   if (code == PoolCode::kProcRange || code == PoolCode::kProcTree) {
-      if (code == PoolCode::kProcTree && !fTree) {
-         // This must be defined
-         std::cerr << "[S]: Process:kProcTree fTree undefined!\n";
-         return;
-      }
-      //retrieve the total number of entries ranges processed so far by TPool
-      nProcessed = ReadBuffer<unsigned>(msg.second.get());
-      //evaluate the file and the entries range to process
-      fileN = nProcessed / fNWorkers;
-   } else {
-      //evaluate the file and the entries range to process
-      fileN = ReadBuffer<unsigned>(msg.second.get());
+   if (rangeN >= fRanges.size()) {
+      std::string reply = "S" + std::to_string(GetNWorker());
+      reply += ": invalid range of entries " + std::to_string(rangeN);
+      MPSend(GetSocket(), PoolCode::kProcError, reply.data());
+      return;
    }
+   const PoolUtils::TreeRange &range = fRanges[rangeN];
 
-   std::unique_ptr<TFile> fp;
    TTree *tree = nullptr;
-   if (code != PoolCode::kProcTree ||
-      (code == PoolCode::kProcTree && fTree->GetCurrentFile())) {
-      //open file
-     if (code == PoolCode::kProcTree && fTree->GetCurrentFile()) {
-         // Single tree from file: we need to reopen, because file descriptor gets invalidated across Fork
-         fp.reset(OpenFile(fTree->GetCurrentFile()->GetName()));
-      } else {
-         fp.reset(OpenFile(fFileNames[fileN]));
-      }
-      if (fp == nullptr) {
-         //errors are handled inside OpenFile
-         return;
-      }
-
-      //retrieve the TTree with the specified name from file
-      //we are not the owner of the TTree object, the file is!
-      tree = RetrieveTree(fp.get());
-      if(tree == nullptr) {
-         //errors are handled inside RetrieveTree
-         return;
+   if (!fTree || fTree->GetCurrentFile()) {
+      //consecutive ranges usually belong to the same file: only (re)open it when it changes
+      if (fFile == nullptr || range.fFileN != fFileN) {
+         fFileTree = nullptr;
+         fFile.reset();
+         if (fTree) {
+            // Single tree from file: we need to reopen, because file descriptor gets invalidated across Fork
+            fFile.reset(OpenFile(fTree->GetCurrentFile()->GetName()));
+         } else {
+            fFile.reset(OpenFile(fFileNames[range.fFileN]));
+         }
+         if (fFile == nullptr) {
+            //errors are handled inside OpenFile
+            return;
+         }
+         fFileN = range.fFileN;
+
+         //retrieve the TTree with the specified name from file
+         //we are not the owner of the TTree object, the file is!
+         fFileTree = RetrieveTree(fFile.get());
+         if (fFileTree == nullptr) {
+            //errors are handled inside RetrieveTree
+            fFile.reset();
+            return;
+         }
       }
+      tree = fFileTree;
    } else {
       // Tree in memory: OK
       tree = fTree;
    }
 
-   //create entries range
-   Long64_t start = 0;
-   Long64_t finish = 0;
-   if (code == PoolCode::kProcRange || code == PoolCode::kProcTree) {
-      //example: for 21 entries, 4 workers we want ranges 0-5, 5-10, 10-15, 15-21
-      //and this worker must take the rangeN-th range
-      unsigned nEntries = tree->GetEntries();
-      unsigned nBunch = nEntries / fNWorkers;
-      unsigned rangeN = nProcessed % fNWorkers;
-      start = rangeN*nBunch;
-      if(rangeN < (fNWorkers-1))
-         finish = (rangeN+1)*nBunch;
-      else
-         finish = nEntries;
-   } else {
-      start = 0;
-      finish = tree->GetEntries();
+   Long64_t start = range.fStart;
+   Long64_t finish = range.fEnd;
+   if (finish == -1) {
+      // a part of the file, see PoolUtils::MakeTreeRanges
+      PoolUtils::GetTreePart(tree, range.fStart, range.fNParts, start, finish);
+      if (start == finish) {
+         MPSend(GetSocket(), PoolCode::kIdling);
+         return;
+      }
    }
 
-   //check if we are going to reach the max of entries
-   //change finish accordingly
-   if (fMaxNEntries)
-      if (fProcessedEntries + finish - start > fMaxNEntries)
-         finish = start + fMaxNEntries - fProcessedEntries;
-
    // create a TTreeReader that reads this range of entries
    TTreeReader reader(tree);
    //Set first entry to start-1 so that the next call to TTreeReader::Next() sets the entry to the right value
@@ -227,29 +202,31 @@ void TPoolProcessor<F>::Process(unsigned code, MPCodeBufPair& msg)
       MPSend(GetSocket(), PoolCode::kProcError, reply.data());
       return;
    }
-   
+
    //execute function
    auto res = fProcFunc(reader);
 
    //detach result from file if needed (currently needed for TH1, TTree, TEventList)
    DetachRes(res);
 
-   //update the number of processed entries
-   fProcessedEntries += finish - start;
+   Reduce(res);
 
+   //we are done for now, the client decides what comes next
+   MPSend(GetSocket(), PoolCode::kIdling);
+}
+
+
+template<class F>
+void TPoolProcessor<F>::Reduce(retType res)
+{
+   if (res == nullptr)
+      return;
    if(fCanReduce) {
-      fReducedResult = static_cast<decltype(fReducedResult)>(PoolUtils::ReduceObjects({res, fReducedResult})); //TODO try not to copy these into a vector, do everything by ref. std::vector<T&>?
+      fReducedResult = static_cast<retType>(PoolUtils::ReduceObjects({fReducedResult, res})); //TODO try not to copy these into a vector, do everything by ref. std::vector<T&>?
    } else {
       fCanReduce = true;
       fReducedResult = res;
    }
-      
-   if(fMaxNEntries == fProcessedEntries)
-      //we are done forever
-      MPSend(GetSocket(), PoolCode::kProcResult, fReducedResult);
-   else
-      //we are done for now
-      MPSend(GetSocket(), PoolCode::kIdling);
 }
 
 
@@ -263,6 +240,7 @@ TFile *TPoolProcessor<F>::OpenFile(const std::string& fileName)
       reply.append(": could not open file ");
       reply.append(fileName);
       MPSend(GetSocket(), PoolCode::kProcError, reply.data());
+      delete fp;
       return nullptr;
    }
 
@@ -275,20 +253,7 @@ TTree *TPoolProcessor<F>::RetrieveTree(TFile *fp)
 {
    //retrieve the TTree with the specified name from file
    //we are not the owner of the TTree object, the file is!
-   TTree *tree = nullptr;
-   if(fTreeName == "") {
-      // retrieve the first TTree
-      // (re-adapted from TEventIter.cxx)
-      if (fp->GetListOfKeys()) {
-         for(auto k : *fp->GetListOfKeys()) {
-            TKey *key = static_cast<TKey*>(k);
-            if (!strcmp(key->GetClassName(), "TTree") || !strcmp(key->GetClassName(), "TNtuple"))
-               tree = static_cast<TTree*>(fp->Get(key->GetName()));
-         }
-      }    
-   } else {
-      tree = static_cast<TTree*>(fp->Get(fTreeName.c_str()));
-   }
+   TTree *tree = PoolUtils::FindTree(fp, fTreeName);
    if (tree == nullptr) {
       std::string reply = "S" + std::to_string(GetNWorker());
       std::stringstream ss;
@@ -301,17 +266,4 @@ TTree *TPoolProcessor<F>::RetrieveTree(TFile *fp)
    return tree;
 }
 
-
-template<class F>
-ULong64_t TPoolProcessor<F>::EvalMaxEntries(ULong64_t maxEntries)
-{
-   //e.g.: when dividing 10 entries between 3 workers, the first
-   //two will process 10/3 == 3 entries, the last one will process
-   //10 - 2*(10/3) == 4 entries.
-   if(GetNWorker() < fNWorkers-1)
-      return maxEntries/fNWorkers;
-   else
-      return maxEntries - (fNWorkers-1)*(maxEntries/fNWorkers);
-}
-
 #endif
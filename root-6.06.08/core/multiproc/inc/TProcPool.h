@@ -80,7 +80,10 @@ public:
 private:
    template<class T> void Collect(std::vector<T> &reslist);
    template<class T> void HandlePoolCode(MPCodeBufPair &msg, TSocket *sender, std::vector<T> &reslist);
+   template<class T> bool MergeInWorker(TSocket *, std::vector<T> &) { return false; }
+   bool MergeInWorker(TSocket *s, std::vector<TObject*> &reslist);
 
+   TObject *ProcRanges(unsigned nRanges);
    void Reset();
    template<class T, class R> T Reduce(const std::vector<T> &objs, R redfunc);
    void ReplyToFuncResult(TSocket *s);
@@ -98,8 +101,7 @@ private:
       kMapWithArg,   ///< a Map method with arguments is being executed
       kMapRed,       ///< a MapReduce method with no arguments is being executed
       kMapRedWithArg, ///< a MapReduce method with arguments is being executed
-      kProcByRange,   ///< a ProcTree method is being executed and each worker will process a certain range of each file
-      kProcByFile,    ///< a ProcTree method is being executed and each worker will process a different file
+      kProcByRange,   ///< a ProcTree method is being executed and the workers request ranges of clusters one at a time
    } fTask; ///< the kind of task that is being executed, if any
 };
 
@@ -373,6 +375,20 @@ auto TProcPool::MapReduce(F func, std::vector<T> &args, R redfunc) -> decltype(f
 /// \endcond
 
 
+//////////////////////////////////////////////////////////////////////////
+/// Process the trees called treeName (by default the first tree found) of
+/// the files fileNames in parallel, calling procFunc on a TTreeReader set to
+/// each range of entries.
+///
+/// The entries are split in ranges made of whole TTree clusters - found by
+/// the workers if there are at least as many files as workers, so that the
+/// client does not open the files (see PoolUtils::MakeTreeRanges) - and each
+/// worker asks for the next range as soon
+/// as it is done with the previous one, so that the load balances even when
+/// the files have very different sizes. Each worker merges the results of its
+/// ranges. When there are no more ranges left, the results of the workers are
+/// merged pairwise by the workers that become idle, and the client only
+/// receives the final result.
 template<class F>
 auto TProcPool::ProcTree(const std::vector<std::string>& fileNames, F procFunc, const std::string& treeName, ULong64_t nToProcess) -> typename std::result_of<F(std::reference_wrapper<TTreeReader>)>::type
 {
@@ -383,46 +399,25 @@ auto TProcPool::ProcTree(const std::vector<std::string>& fileNames, F procFunc,
    Reset();
    unsigned nWorkers = GetNWorkers();
 
-   //fork
-   TPoolProcessor<F> worker(procFunc, fileNames, treeName, nWorkers, nToProcess);
+   //split the entries in ranges of clusters
+   std::vector<PoolUtils::TreeRange> ranges = PoolUtils::MakeTreeRanges(fileNames, treeName, nWorkers, nToProcess);
+   if (ranges.empty()) {
+      std::cerr << "[E][C] No entries to process. Aborting operation\n";
+      return nullptr;
+   }
+
+   //fork max(ranges.size(), fNWorkers) times
+   if (ranges.size() < nWorkers)
+      SetNWorkers(ranges.size());
+   TPoolProcessor<F> worker(procFunc, fileNames, treeName, ranges);
    bool ok = Fork(worker);
+   SetNWorkers(nWorkers);
    if(!ok) {
       std::cerr << "[E][C] Could not fork. Aborting operation\n";
       return nullptr;
    }
 
-   if(fileNames.size() < nWorkers) {
-      //TTree entry granularity. For each file, we divide entries equally between workers
-      fTask = ETask::kProcByRange;
-      //Tell workers to start processing entries
-      fNToProcess = nWorkers*fileNames.size(); //this is the total number of ranges that will be processed by all workers cumulatively
-      std::vector<unsigned> args(nWorkers);
-      std::iota(args.begin(), args.end(), 0);
-      fNProcessed = Broadcast(PoolCode::kProcRange, args);
-      if(fNProcessed < nWorkers)
-         std::cerr << "[E][C] There was an error while sending tasks to workers. Some entries might not be processed.\n";
-   } else {
-      //file granularity. each worker processes one whole file as a single task
-      fTask = ETask::kProcByFile;
-      fNToProcess = fileNames.size();
-      std::vector<unsigned> args(nWorkers);
-      std::iota(args.begin(), args.end(), 0);
-      fNProcessed = Broadcast(PoolCode::kProcFile, args);
-      if(fNProcessed < nWorkers)
-         std::cerr << "[E][C] There was an error while sending tasks to workers. Some entries might not be processed.\n";
-   }
-
-   //collect results, distribute new tasks
-   std::vector<TObject*> reslist;
-   Collect(reslist);
-
-   //merge
-   TObject* res = PoolUtils::ReduceObjects(reslist);
-
-   //clean-up and return
-   ReapWorkers();
-   fTask = ETask::kNoTask;
-   return static_cast<retType>(res);
+   return static_cast<retType>(ProcRanges(ranges.size()));
 }
 
 
@@ -459,6 +454,9 @@ auto TProcPool::ProcTree(TChain& files, F procFunc, const std::string& treeName,
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// Process tree in parallel, calling procFunc on a TTreeReader set to each
+/// range of entries. See the ProcTree method taking a list of files.
 template<class F>
 auto TProcPool::ProcTree(TTree& tree, F procFunc, ULong64_t nToProcess) -> typename std::result_of<F(std::reference_wrapper<TTreeReader>)>::type
 {
@@ -469,36 +467,25 @@ auto TProcPool::ProcTree(TTree& tree, F procFunc, ULong64_t nToProcess) -> typen
    Reset();
    unsigned nWorkers = GetNWorkers();
 
-   //fork
-   TPoolProcessor<F> worker(procFunc, &tree, nWorkers, nToProcess);
+   //split the entries in ranges of clusters
+   std::vector<PoolUtils::TreeRange> ranges = PoolUtils::MakeTreeRanges(&tree, nWorkers, nToProcess);
+   if (ranges.empty()) {
+      std::cerr << "[E][C] No entries to process. Aborting operation\n";
+      return nullptr;
+   }
+
+   //fork max(ranges.size(), fNWorkers) times
+   if (ranges.size() < nWorkers)
+      SetNWorkers(ranges.size());
+   TPoolProcessor<F> worker(procFunc, &tree, ranges);
    bool ok = Fork(worker);
+   SetNWorkers(nWorkers);
    if(!ok) {
       std::cerr << "[E][C] Could not fork. Aborting operation\n";
       return nullptr;
    }
 
-   //divide entries equally between workers
-   fTask = ETask::kProcByRange;
-
-   //tell workers to start processing entries
-   fNToProcess = nWorkers; //this is the total number of ranges that will be processed by all workers cumulatively
-   std::vector<unsigned> args(nWorkers);
-   std::iota(args.begin(), args.end(), 0);
-   fNProcessed = Broadcast(PoolCode::kProcTree, args);
-   if(fNProcessed < nWorkers)
-      std::cerr << "[E][C] There was an error while sending tasks to workers. Some entries might not be processed.\n";
-
-   //collect results, distribute new tasks
-   std::vector<TObject*> reslist;
-   Collect(reslist);
-
-   //merge
-   TObject* res = PoolUtils::ReduceObjects(reslist);
-
-   //clean-up and return
-   ReapWorkers();
-   fTask = ETask::kNoTask;
-   return static_cast<retType>(res);
+   return static_cast<retType>(ProcRanges(ranges.size()));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -534,7 +521,8 @@ void TProcPool::HandlePoolCode(MPCodeBufPair &msg, TSocket *s, std::vector<T> &r
       reslist.push_back(std::move(ReadBuffer<T>(msg.second.get())));
       ReplyToFuncResult(s);
    } else if (code == PoolCode::kIdling) {
-      ReplyToIdle(s);
+      if (!MergeInWorker(s, reslist))
+         ReplyToIdle(s);
    } else if(code == PoolCode::kProcResult) {
       if(msg.second != nullptr)
          reslist.push_back(std::move(ReadBuffer<T>(msg.second.get())));
@@ -543,7 +531,8 @@ void TProcPool::HandlePoolCode(MPCodeBufPair &msg, TSocket *s, std::vector<T> &r
       const char *str = ReadBuffer<const char*>(msg.second.get());
       std::cerr << "[E][C] a worker encountered an error: " << str << "\n"
                 << "Continuing execution ignoring these entries.\n";
-      ReplyToIdle(s);
+      if (!MergeInWorker(s, reslist))
+         ReplyToIdle(s);
       delete [] str;
    } else {
       // UNKNOWN CODE
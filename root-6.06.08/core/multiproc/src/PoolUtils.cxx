@@ -1,7 +1,62 @@
 #include "PoolUtils.h"
 #include "TClass.h"
+#include "TFile.h"
+#include "TKey.h"
 #include "TList.h"
+#include "TTree.h"
+#include <cstring>
 #include <iostream>
+#include <memory>
+
+namespace {
+   // Number of ranges of entries to aim for per worker: enough for the load
+   // to balance between files and workers of different speed, few enough to
+   // keep the cost of the messages with the workers negligible.
+   const unsigned kRangesPerWorker = 8;
+
+   // Append the clusters of the first nEntries entries of tree to clusters.
+   void AddClusters(TTree *tree, unsigned fileN, Long64_t nEntries, std::vector<PoolUtils::TreeRange>& clusters)
+   {
+      TTree::TClusterIterator clusterIter = tree->GetClusterIterator(0);
+      Long64_t start = 0;
+      while (start < nEntries) {
+         clusterIter.Next();
+         Long64_t end = clusterIter.GetNextEntry();
+         if (end <= start || end > nEntries)
+            end = nEntries;
+         clusters.push_back({fileN, start, end, 0});
+         start = end;
+      }
+   }
+
+   // Group consecutive clusters of the same file in ranges of about
+   // total/(nWorkers*kRangesPerWorker) entries, after dropping the entries
+   // beyond the first nToProcess ones (if not 0).
+   std::vector<PoolUtils::TreeRange> GroupClusters(const std::vector<PoolUtils::TreeRange>& clusters, unsigned nWorkers, ULong64_t nToProcess)
+   {
+      Long64_t total = 0;
+      for (auto &c : clusters)
+         total += c.fEnd - c.fStart;
+      if (nToProcess && (ULong64_t)total > nToProcess)
+         total = nToProcess;
+      Long64_t minSize = total / ((nWorkers ? nWorkers : 1) * kRangesPerWorker);
+
+      std::vector<PoolUtils::TreeRange> ranges;
+      Long64_t left = total;
+      for (auto &c : clusters) {
+         if (left <= 0)
+            break;
+         Long64_t end = c.fEnd - c.fStart > left ? c.fStart + left : c.fEnd;
+         left -= end - c.fStart;
+         if (!ranges.empty() && ranges.back().fFileN == c.fFileN && ranges.back().fEnd == c.fStart
+             && ranges.back().fEnd - ranges.back().fStart < minSize)
+            ranges.back().fEnd = end;
+         else
+            ranges.push_back({c.fFileN, c.fStart, end, 0});
+      }
+      return ranges;
+   }
+}
 
 //////////////////////////////////////////////////////////////////////////
 /// Merge collection of TObjects.
@@ -38,3 +93,123 @@ TObject* PoolUtils::ReduceObjects(const std::vector<TObject *>& objs)
    //return result
    return obj;
 }
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Retrieve the TTree called treeName from fp, or the first TTree in the
+/// file if treeName is empty. The TTree is owned by the file.
+/// Returns nullptr if no such TTree exists.
+TTree* PoolUtils::FindTree(TFile *fp, const std::string& treeName)
+{
+   TTree *tree = nullptr;
+   if(treeName == "") {
+      // retrieve the first TTree
+      // (re-adapted from TEventIter.cxx)
+      if (fp->GetListOfKeys()) {
+         for(auto k : *fp->GetListOfKeys()) {
+            TKey *key = static_cast<TKey*>(k);
+            if (!strcmp(key->GetClassName(), "TTree") || !strcmp(key->GetClassName(), "TNtuple")) {
+               tree = static_cast<TTree*>(fp->Get(key->GetName()));
+               break;
+            }
+         }
+      }
+   } else {
+      tree = dynamic_cast<TTree*>(fp->Get(treeName.c_str()));
+   }
+   return tree;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Find the entries [start, end) of the part part of nParts parts of about
+/// the same size, made of whole clusters, of tree. A part starts at the first
+/// cluster boundary at or after part/nParts of the entries, so the parts
+/// computed independently by the workers cover each entry exactly once. A
+/// part within a single cluster is empty (start == end).
+void PoolUtils::GetTreePart(TTree *tree, unsigned part, unsigned nParts, Long64_t& start, Long64_t& end)
+{
+   Long64_t nEntries = tree->GetEntries();
+   Long64_t first = nEntries / nParts * part + nEntries % nParts * part / nParts;
+   Long64_t last = nEntries / nParts * (part + 1) + nEntries % nParts * (part + 1) / nParts;
+
+   TTree::TClusterIterator clusterIter = tree->GetClusterIterator(0);
+   Long64_t cluster = 0; // first entry of the current cluster
+   start = -1;
+   while (cluster < nEntries) {
+      if (start < 0 && cluster >= first)
+         start = cluster;
+      if (cluster >= last)
+         break;
+      clusterIter.Next();
+      Long64_t next = clusterIter.GetNextEntry();
+      cluster = (next <= cluster || next > nEntries) ? nEntries : next;
+   }
+   end = cluster < nEntries ? cluster : nEntries;
+   if (start < 0)
+      start = end;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Split the entries of the trees called treeName in fileNames in ranges made
+/// of whole clusters, to be processed by nWorkers workers.
+/// Only the first nToProcess entries are considered, unless nToProcess is 0.
+///
+/// If all entries are processed and there are at least as many files as
+/// workers, no file is opened here: each file is split in parts with
+/// fEnd == -1 (see GetTreePart) that the workers turn into entries when they
+/// open it. There are enough parts for about kRangesPerWorker ranges per
+/// worker, and the last nWorkers files are split in at least kRangesPerWorker
+/// parts each, so that no worker is left with a large file at the end.
+/// Otherwise each file is opened to read the cluster boundaries of its tree,
+/// until nToProcess entries are found; files that cannot be opened or that do
+/// not contain the tree are skipped.
+std::vector<PoolUtils::TreeRange> PoolUtils::MakeTreeRanges(const std::vector<std::string>& fileNames, const std::string& treeName, unsigned nWorkers, ULong64_t nToProcess)
+{
+   if (nToProcess == 0 && !fileNames.empty() && fileNames.size() >= nWorkers) {
+      if (nWorkers == 0)
+         nWorkers = 1;
+      unsigned nFiles = fileNames.size();
+      unsigned nParts = (nWorkers * kRangesPerWorker + nFiles - 1) / nFiles;
+      std::vector<TreeRange> parts;
+      for (unsigned fileN = 0; fileN < nFiles; ++fileN) {
+         unsigned n = (fileN + nWorkers >= nFiles && nParts < kRangesPerWorker) ? kRangesPerWorker : nParts;
+         for (unsigned part = 0; part < n; ++part)
+            parts.push_back({fileN, part, -1, n});
+      }
+      return parts;
+   }
+
+   std::vector<TreeRange> clusters;
+   ULong64_t nEntries = 0;
+   for (unsigned fileN = 0; fileN < fileNames.size(); ++fileN) {
+      if (nToProcess && nEntries >= nToProcess)
+         break;
+      std::unique_ptr<TFile> fp(TFile::Open(fileNames[fileN].c_str()));
+      if (fp == nullptr || fp->IsZombie()) {
+         std::cerr << "[E][C] could not open file " << fileNames[fileN] << "\n";
+         continue;
+      }
+      TTree *tree = FindTree(fp.get(), treeName);
+      if (tree == nullptr) {
+         std::cerr << "[E][C] cannot find tree with name " << treeName << " in file " << fileNames[fileN] << "\n";
+         continue;
+      }
+      AddClusters(tree, fileN, tree->GetEntries(), clusters);
+      nEntries += tree->GetEntries();
+   }
+   return GroupClusters(clusters, nWorkers, nToProcess);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Split the entries of tree in ranges made of whole clusters, to be
+/// processed by nWorkers workers.
+/// Only the first nToProcess entries are considered, unless nToProcess is 0.
+std::vector<PoolUtils::TreeRange> PoolUtils::MakeTreeRanges(TTree *tree, unsigned nWorkers, ULong64_t nToProcess)
+{
+   std::vector<TreeRange> clusters;
+   AddClusters(tree, 0, tree->GetEntries(), clusters);
+   return GroupClusters(clusters, nWorkers, nToProcess);
+}
@@ -124,9 +124,56 @@ void TProcPool::ReplyToIdle(TSocket *s)
          MPSend(s, PoolCode::kExecFunc);
       else if (fTask == ETask::kProcByRange)
          MPSend(s, PoolCode::kProcRange, fNProcessed);
-      else if (fTask == ETask::kProcByFile)
-         MPSend(s, PoolCode::kProcFile, fNProcessed);
       ++fNProcessed;
    } else
       MPSend(s, PoolCode::kSendResult);
 }
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Hand out nRanges ranges of entries to the TPoolProcessors forked by a
+/// ProcTree method, one range per idle worker, and collect the result.
+TObject *TProcPool::ProcRanges(unsigned nRanges)
+{
+   fTask = ETask::kProcByRange;
+   fNToProcess = nRanges;
+
+   //tell workers to start processing entries
+   unsigned nWorkers = nRanges < GetNWorkers() ? nRanges : GetNWorkers();
+   std::vector<unsigned> args(nWorkers);
+   std::iota(args.begin(), args.end(), 0);
+   fNProcessed = Broadcast(PoolCode::kProcRange, args);
+   if(fNProcessed < nWorkers)
+      std::cerr << "[E][C] There was an error while sending tasks to workers. Some entries might not be processed.\n";
+
+   //collect results, distribute new tasks
+   std::vector<TObject*> reslist;
+   Collect(reslist);
+
+   //merge what the workers did not merge themselves
+   TObject* res = PoolUtils::ReduceObjects(reslist);
+
+   //clean-up and return
+   ReapWorkers();
+   fTask = ETask::kNoTask;
+   return res;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// Once all the ranges of a ProcTree are handed out, send one of the results
+/// already received to the idle worker s, which merges it into its own.
+/// The results are thus merged pairwise by the workers, in parallel, as they
+/// become idle, instead of all at once by the client.
+/// Returns false if there is nothing to merge.
+bool TProcPool::MergeInWorker(TSocket *s, std::vector<TObject*> &reslist)
+{
+   if (fTask != ETask::kProcByRange || fNProcessed < fNToProcess || reslist.empty())
+      return false;
+
+   TObject *res = reslist.back();
+   reslist.pop_back();
+   MPSend(s, PoolCode::kMergeResult, res);
+   delete res;
+   return true;
+}
@@ -0,0 +1,83 @@
+// @(#)root/thread:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TTaskPool
+#define ROOT_TTaskPool
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTaskPool                                                            //
+//                                                                      //
+// A pool of worker threads executing small independent tasks.          //
+// Every worker has its own queue; tasks submitted from a worker go to  //
+// its own queue, others are distributed round robin. An idle worker    //
+// steals from the other queues. A thread waiting for the result of a  //
+// task can help with RunOne() instead of blocking.                     //
+//                                                                      //
+// The pool returned by GetGlobal() is shared by all ROOT components    //
+// running work in the background (e.g. the parallel compression of     //
+// TTree baskets), so that they do not oversubscribe the machine.       //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class TTaskPool {
+
+public:
+   typedef std::function<void()> Task_t;
+
+private:
+   struct TQueue {
+      std::mutex          fMutex;   // protects fTasks
+      std::deque<Task_t>  fTasks;   // tasks of one worker
+   };
+
+   std::vector<TQueue*>       fQueues;    // one queue per worker
+   std::vector<std::thread>   fThreads;   // the workers
+   std::mutex                 fMutex;     // protects fStop, used with fCond
+   std::condition_variable    fCond;      // signals new tasks or stop to idle workers
+   std::atomic<Int_t>         fQueued;    // number of tasks waiting in the queues
+   std::atomic<UInt_t>        fNext;      // next queue for tasks submitted from outside
+   Bool_t                     fStop;      // set by the destructor
+
+   static UInt_t              fgGlobalThreads;  // size of the global pool, 0 for the default
+
+   TTaskPool(const TTaskPool &);            // not implemented
+   TTaskPool &operator=(const TTaskPool &); // not implemented
+
+   Bool_t Pop(Int_t self, Task_t &task);
+   void   Run(Int_t self);
+
+public:
+   TTaskPool(UInt_t nthreads = 0);
+   ~TTaskPool();
+
+   UInt_t GetNThreads() const { return fThreads.size(); }
+   Bool_t RunOne();
+   void   Submit(const Task_t &task);
+
+   static TTaskPool *GetGlobal();
+   static void       SetGlobalNThreads(UInt_t nthreads);
+};
+
+#endif
@@ -0,0 +1,170 @@
+// @(#)root/thread:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTaskPool                                                            //
+//                                                                      //
+// A pool of worker threads with one task queue per worker and work     //
+// stealing between the queues.                                         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TTaskPool.h"
+#include "TThread.h"
+#include "TEnv.h"
+#include "ThreadLocalStorage.h"
+
+UInt_t TTaskPool::fgGlobalThreads = 0;
+
+namespace {
+   // The pool and the queue index of the calling thread, if it is a worker.
+   TTaskPool *&CurrentPool() { TTHREAD_TLS(TTaskPool*) pool = 0; return pool; }
+   Int_t &CurrentWorker() { TTHREAD_TLS(Int_t) worker = -1; return worker; }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Start nthreads workers, by default one per core.
+
+TTaskPool::TTaskPool(UInt_t nthreads) : fQueued(0), fNext(0), fStop(kFALSE)
+{
+   if (nthreads == 0) nthreads = std::thread::hardware_concurrency();
+   if (nthreads == 0) nthreads = 1;
+
+   // the tasks use ROOT from several threads
+   TThread::Initialize();
+
+   for (UInt_t i = 0; i < nthreads; ++i) fQueues.push_back(new TQueue);
+   for (UInt_t i = 0; i < nthreads; ++i) fThreads.push_back(std::thread(&TTaskPool::Run, this, Int_t(i)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Execute the tasks still queued and stop the workers.
+
+TTaskPool::~TTaskPool()
+{
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fStop = kTRUE;
+   }
+   fCond.notify_all();
+
+   for (UInt_t i = 0; i < fThreads.size(); ++i) fThreads[i].join();
+   for (UInt_t i = 0; i < fQueues.size(); ++i) delete fQueues[i];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Take a task: the newest of the own queue (self >= 0), otherwise the
+/// oldest of another queue.
+
+Bool_t TTaskPool::Pop(Int_t self, Task_t &task)
+{
+   Int_t n = fQueues.size();
+
+   if (self >= 0) {
+      TQueue *q = fQueues[self];
+      std::lock_guard<std::mutex> lock(q->fMutex);
+      if (!q->fTasks.empty()) {
+         task = q->fTasks.back();
+         q->fTasks.pop_back();
+         --fQueued;
+         return kTRUE;
+      }
+   }
+
+   Int_t first = (self >= 0 ? self + 1 : 0);
+   for (Int_t i = 0; i < n; ++i) {
+      TQueue *q = fQueues[(first + i) % n];
+      std::lock_guard<std::mutex> lock(q->fMutex);
+      if (!q->fTasks.empty()) {
+         task = q->fTasks.front();
+         q->fTasks.pop_front();
+         --fQueued;
+         return kTRUE;
+      }
+   }
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Worker loop.
+
+void TTaskPool::Run(Int_t self)
+{
+   CurrentPool() = this;
+   CurrentWorker() = self;
+
+   Task_t task;
+   while (kTRUE) {
+      if (Pop(self, task)) {
+         task();
+         task = nullptr;
+         continue;
+      }
+      std::unique_lock<std::mutex> lock(fMutex);
+      fCond.wait(lock, [this] { return fStop || fQueued > 0; });
+      if (fStop && fQueued == 0) break;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Execute one queued task on the calling thread. Returns kFALSE if there
+/// was none. Used by threads waiting for the result of a task.
+
+Bool_t TTaskPool::RunOne()
+{
+   Task_t task;
+   if (!Pop(CurrentPool() == this ? CurrentWorker() : -1, task)) return kFALSE;
+   task();
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Queue a task for execution by one of the workers. The task must not throw.
+
+void TTaskPool::Submit(const Task_t &task)
+{
+   Int_t self = (CurrentPool() == this ? CurrentWorker() : -1);
+   TQueue *q = fQueues[self >= 0 ? UInt_t(self) : fNext++ % fQueues.size()];
+   {
+      std::lock_guard<std::mutex> lock(q->fMutex);
+      q->fTasks.push_back(task);
+   }
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      ++fQueued;
+   }
+   fCond.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// The pool shared by all components, created on first use. Its size is set
+/// with SetGlobalNThreads() or the resource Root.TaskPool.NThreads and
+/// defaults to one thread per core.
+
+TTaskPool *TTaskPool::GetGlobal()
+{
+   static TTaskPool *pool = 0;
+   static std::once_flag created;
+   std::call_once(created, [] {
+      Int_t n = fgGlobalThreads ? Int_t(fgGlobalThreads) : gEnv->GetValue("Root.TaskPool.NThreads", 0);
+      pool = new TTaskPool(n > 0 ? UInt_t(n) : 0);
+   });
+   return pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set the number of threads of the global pool - only effective before its
+/// first use.
+
+void TTaskPool::SetGlobalNThreads(UInt_t nthreads)
+{
+   fgGlobalThreads = nthreads;
+}
@@ -25,6 +25,12 @@ namespace ROOT {
    // in greater compression factors, but takes more CPU time
    // and memory when compressing.  LZMA memory usage is particularly
    // high for compression levels 8 and 9.
+   // The LZ4 and ZSTD algorithms are meant for data read
+   // many times: they decompress several times faster than
+   // ZLIB. LZ4 compresses less than ZLIB, ZSTD about as much
+   // or better. They require ROOT to be built with liblz4 and
+   // libzstd, otherwise ZLIB is used to compress and the
+   // buffers they compressed cannot be read.
    //
    // The current algorithms support level 1 to 9. The higher
    // the level the greater the compression and more CPU time
@@ -34,6 +40,8 @@ namespace ROOT {
                                 kZLIB,
                                 kLZMA,
                                 kOldCompressionAlgo,
+                                kLZ4,
+                                kZSTD,
                                 // if adding new algorithm types,
                                 // keep this enum value last
                                 kUndefinedCompressionAlgorithm
@@ -0,0 +1,54 @@
+# Module.mk for zstd module
+# Copyright (c) 2016 Rene Brun and Fons Rademakers
+
+MODNAME      := zstd
+MODDIR       := $(ROOT_SRCDIR)/core/$(MODNAME)
+MODDIRS      := $(MODDIR)/src
+MODDIRI      := $(MODDIR)/inc
+
+ZSTDDIR       := $(MODDIR)
+ZSTDDIRS      := $(ZSTDDIR)/src
+ZSTDDIRI      := $(ZSTDDIR)/inc
+
+# libzstd is not searched for by configure: to use it, set in MyConfig.mk
+# BUILDZSTD := yes and, if needed, ZSTDINCDIR, ZSTDLIBDIR (-L...) and ZSTDCLILIB (-lzstd).
+# Otherwise ROOT::kZSTD compresses with ZLIB.
+ifeq ($(BUILDZSTD),yes)
+ZSTDCLILIB    ?= -lzstd
+ZSTDLIBDIRI   := $(ZSTDINCDIR:%=-I%)
+ZSTDFLAGS     := -DR__HAS_ZSTD $(ZSTDLIBDIRI)
+endif
+
+##### ZipZSTD, part of libCore #####
+ZSTDH         := $(MODDIRI)/ZipZSTD.h
+ZSTDS         := $(MODDIRS)/ZipZSTD.c
+ZSTDO         := $(call stripsrc,$(ZSTDS:.c=.o))
+
+ZSTDDEP       := $(ZSTDO:.o=.d)
+
+# used in the main Makefile
+ALLHDRS      += $(patsubst $(MODDIRI)/%.h,include/%.h,$(ZSTDH))
+
+# include all dependency files
+INCLUDEFILES += $(ZSTDDEP)
+
+##### local rules #####
+.PHONY:         all-$(MODNAME) clean-$(MODNAME) distclean-$(MODNAME)
+
+include/%.h:    $(ZSTDDIRI)/%.h
+		cp $< $@
+
+all-$(MODNAME): $(ZSTDO)
+
+clean-$(MODNAME):
+		@rm -f $(ZSTDO)
+
+clean::         clean-$(MODNAME)
+
+distclean-$(MODNAME): clean-$(MODNAME)
+		@rm -f $(ZSTDDEP)
+
+distclean::     distclean-$(MODNAME)
+
+##### extra rules ######
+$(ZSTDO): CFLAGS += $(ZSTDFLAGS)
@@ -0,0 +1,101 @@
+// @(#)root/zstd:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/* Zstandard compression of ROOT buffers. ZSTD compresses about as well as
+   zlib at level 1 to 3 and better at higher levels, and decompresses much
+   faster at all levels. The compression level is passed through to ZSTD.
+
+   The buffer is preceded by the usual 9 bytes header: 'Z' 'S', the version
+   of the format (1), the compressed and the decompressed sizes.
+
+   Without libzstd (R__HAS_ZSTD not defined) the buffers are compressed with
+   zlib instead, and ZSTD buffers cannot be decompressed.
+*/
+
+#include "ZipZSTD.h"
+#include <stdio.h>
+
+#ifdef R__HAS_ZSTD
+#include "zstd.h"
+
+static const int kHeaderSize = 9;
+#else
+/* From ZDeflate.c, to compress with zlib instead. */
+void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep, int compressionAlgorithm);
+#endif
+
+void R__zipZSTD(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep)
+{
+#ifdef R__HAS_ZSTD
+   size_t out_size;
+   unsigned in_size = (unsigned) (*srcsize);
+
+   *irep = 0;
+
+   if (*tgtsize <= kHeaderSize) {
+      return;
+   }
+
+   if (*srcsize > 0xffffff || *srcsize < 0) {
+      return;
+   }
+
+   if (cxlevel > 9) cxlevel = 9;
+
+   out_size = ZSTD_compress(&tgt[kHeaderSize], (size_t)(*tgtsize - kHeaderSize),
+                            src, (size_t)(*srcsize), cxlevel);
+   if (ZSTD_isError(out_size)) {
+      /* No need to print an error message. We simply abandon the compression
+         the buffer cannot be compressed or compressed buffer would be larger than original buffer
+      */
+      return;
+   }
+
+   tgt[0] = 'Z';  /* Signature of ZSTD */
+   tgt[1] = 'S';
+   tgt[2] = 1;
+
+   tgt[3] = (char)(out_size & 0xff);        /* compressed size */
+   tgt[4] = (char)((out_size >> 8) & 0xff);
+   tgt[5] = (char)((out_size >> 16) & 0xff);
+
+   tgt[6] = (char)(in_size & 0xff);         /* decompressed size */
+   tgt[7] = (char)((in_size >> 8) & 0xff);
+   tgt[8] = (char)((in_size >> 16) & 0xff);
+
+   *irep = (int)out_size + kHeaderSize;
+#else
+   R__zipMultipleAlgorithm(cxlevel, srcsize, src, tgtsize, tgt, irep, 1);
+#endif
+}
+
+void R__unzipZSTD(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep)
+{
+#ifdef R__HAS_ZSTD
+   size_t out_size;
+
+   *irep = 0;
+
+   out_size = ZSTD_decompress(tgt, (size_t)(*tgtsize),
+                              &src[kHeaderSize], (size_t)(*srcsize - kHeaderSize));
+   if (ZSTD_isError(out_size)) {
+      fprintf(stderr,
+              "R__unzipZSTD: error in ZSTD_decompress: %s\n",
+              ZSTD_getErrorName(out_size));
+      return;
+   }
+
+   *irep = (int)out_size;
+#else
+   (void)srcsize; (void)src; (void)tgtsize; (void)tgt;
+   *irep = 0;
+   fprintf(stderr, "R__unzipZSTD: ROOT was built without ZSTD support\n");
+#endif
+}
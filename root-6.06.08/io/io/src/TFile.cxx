@@ -294,6 +294,9 @@ TFile::TFile() : TDirectoryFile(), fInfoCache(0)
 /// will build an integer which will set the compression to use
 /// the LZMA algorithm and compression level 1.  These are defined
 /// in the header file <em>Compression.h</em>.
+/// For files written once and read many times, ROOT::kLZ4 and
+/// ROOT::kZSTD trade some compression factor for a several times
+/// faster decompression.
 /// Note that the compression settings may be changed at any time.
 /// The new compression settings will only apply to branches created
 /// or attached after the setting is changed and other objects written
@@ -51,6 +51,15 @@
   If the option -cachedsize is used, hadd will resize (or disable if 0) the
   prefetching cache use to speed up I/O operations.
 
+  With the option -j, the source files are split in as many contiguous subsets
+  as requested processes (by default the number of cores), each subset is
+  merged in a separate process into a partial file and the partial files are
+  then merged into the target file. Since the partial files are written with
+  the compression settings of the target, the Trees of the partial files are
+  always merged with the "fast" method. The partial files are created in the
+  directory given with -d (by default the system temporary directory) and
+  removed at the end.
+
   For options that takes a size as argument, a decimal number of bytes is expected.
   If the number ends with a ``k'', ``m'', ``g'', etc., the number is multiplied
   by 1000 (1K), 1000000 (1MB), 1000000000 (1G), etc.
@@ -82,8 +91,36 @@
 #include "ROOT/StringConv.h"
 #include <stdlib.h>
 #include <climits>
+#include <vector>
 
 #include "TFileMerger.h"
+#include "TProcPool.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// Append the source files argv[first] ... argv[argc-1] to files, expanding the
+/// indirect files. Returns false if an indirect file cannot be opened.
+
+static bool ExpandSources(int first, int argc, char **argv, std::vector<std::string> &files)
+{
+   for ( int i = first; i < argc; i++ ) {
+      if (argv[i] && argv[i][0]=='@') {
+         std::ifstream indirect_file(argv[i]+1);
+         if( ! indirect_file.is_open() ) {
+            std::cerr<< "hadd could not open indirect file " << (argv[i]+1) << std::endl;
+            return false;
+         }
+         while( indirect_file ){
+            std::string line;
+            if( std::getline(indirect_file, line) && line.length() ) {
+               files.push_back(line);
+            }
+         }
+      } else {
+         files.push_back(argv[i]);
+      }
+   }
+   return true;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -92,6 +129,7 @@ int main( int argc, char **argv )
    if ( argc < 3 || "-h" == std::string(argv[1]) || "--help" == std::string(argv[1]) ) {
       std::cout << "Usage: " << argv[0] << " [-f[fk][0-9]] [-k] [-T] [-O] [-a] \n"
       "            [-n maxopenedfiles] [-cachesize size] [-v [verbosity]] \n"
+      "            [-j [nprocesses]] [-d tmpdir] \n"
       "            targetfile source1 [source2 source3 ...]\n" << std::endl;
       std::cout << "This program will add histograms from a list of root files and write them" << std::endl;
       std::cout << "   to a target root file. The target file is newly created and must not" << std::endl;
@@ -108,6 +146,10 @@ int main( int argc, char **argv )
                    "   to request to use the system maximum." << std::endl;
       std::cout << "If the option -cachedsize is used, hadd will resize (or disable if 0) the\n"
                    "   prefetching cache use to speed up I/O operations." << std::endl;
+      std::cout << "If the option -j is used, hadd will merge subsets of the input files in\n"
+                   "   'nprocesses' parallel processes (default: the number of cores) and then\n"
+                   "   merge the partial results, stored in the directory given with -d (default:\n"
+                   "   the system temporary directory)." << std::endl;
       std::cout << "When -the -f option is specified, one can also specify the compression level of\n"
                    "   the target file.  By default the compression level is 1." <<std::endl;
       std::cout << "If \"-fk\" is specified, the target file contain the baskets with the same\n"
@@ -141,7 +183,9 @@ int main( int argc, char **argv )
    Bool_t useFirstInputCompression = kFALSE;
    Int_t maxopenedfiles = 0;
    Int_t verbosity = 99;
+   Int_t nProcesses = 1;
    TString cacheSize;
+   TString workingDir = gSystem->TempDirectory();
 
    int outputPlace = 0;
    int ffirst = 2;
@@ -221,6 +265,41 @@ int main( int argc, char **argv )
             }
          }
          ++ffirst;
+      } else if ( strcmp(argv[a],"-j") == 0 ) {
+         // The number of processes is optional, default to the number of cores.
+         nProcesses = 0;
+         if (a+1 < argc && argv[a+1][0] != '\0' && strspn(argv[a+1], "0123456789") == strlen(argv[a+1])) {
+            Long_t request = strtol(argv[a+1], 0, 10);
+            if (request < kMaxInt && request >= 0) {
+               nProcesses = (Int_t)request;
+               ++a;
+               ++ffirst;
+            } else {
+               std::cerr << "Error: could not parse the number of processes passed after -j: " << argv[a+1] << ". We will use the number of cores.\n";
+            }
+         }
+         if (nProcesses == 0) {
+            SysInfo_t info;
+            if (gSystem->GetSysInfo(&info) == 0 && info.fCpus > 0) {
+               nProcesses = info.fCpus;
+            } else {
+               nProcesses = 1;
+            }
+         }
+         ++ffirst;
+      } else if ( strcmp(argv[a],"-d") == 0 ) {
+         if (a+1 >= argc) {
+            std::cerr << "Error: no directory was provided after -d.\n";
+         } else if (gSystem->AccessPathName(argv[a+1], kWritePermission)) {
+            std::cerr << "Error: the directory passed after -d is not writable: " << argv[a+1] << ". We will use " << workingDir << ".\n";
+            ++a;
+            ++ffirst;
+         } else {
+            workingDir = argv[a+1];
+            ++a;
+            ++ffirst;
+         }
+         ++ffirst;
       } else if ( strcmp(argv[a],"-v") == 0 ) {
          if (a+1 == argc || argv[a+1][0] == '-') {
             // Verbosity level was not specified use the default:
@@ -347,6 +426,71 @@ int main( int argc, char **argv )
       else
          std::cout << "hadd compression setting for all ouput: " << newcomp << '\n';
    }
+
+   // With -j, merge contiguous subsets of the sources in parallel processes
+   // into partial files, which then become the sources of the final merge.
+   // This has to happen before the target file is opened: the forked
+   // processes would otherwise close (and write) it when exiting.
+   std::vector<std::string> partialFiles;
+   if (nProcesses > 1) {
+      std::vector<std::string> sources;
+      if (!ExpandSources(ffirst, argc, argv, sources)) {
+         return 1;
+      }
+      Int_t nJobs = sources.size() < (size_t)nProcesses ? (Int_t)sources.size() : nProcesses;
+      if (nJobs > 1) {
+         if (verbosity > 1) {
+            std::cout << "hadd merging " << sources.size() << " input files in " << nJobs << " processes\n";
+         }
+         for (Int_t job = 0; job < nJobs; ++job) {
+            partialFiles.push_back(TString::Format("%s/hadd_%d_%d.root", workingDir.Data(), gSystem->GetPid(), job).Data());
+         }
+         auto mergeSubset = [&](Int_t job) -> Int_t {
+            TFileMerger partial(kFALSE,kFALSE);
+            partial.SetMsgPrefix(TString::Format("hadd[%d]", job));
+            partial.SetPrintLevel(verbosity - 1);
+            if (maxopenedfiles > 0) {
+               partial.SetMaxOpenedFiles(maxopenedfiles);
+            }
+            if (!partial.OutputFile(partialFiles[job].c_str(),kTRUE,newcomp)) {
+               std::cerr << "hadd error opening partial file " << partialFiles[job] << "." << std::endl;
+               return 1;
+            }
+            size_t first = job * sources.size() / nJobs;
+            size_t last = (job + 1) * sources.size() / nJobs;
+            for (size_t i = first; i < last; ++i) {
+               if ( ! partial.AddFile(sources[i].c_str()) ) {
+                  if ( skip_errors ) {
+                     std::cerr << "hadd skipping file with error: " << sources[i] << std::endl;
+                  } else {
+                     std::cerr << "hadd exiting due to error in " << sources[i] << std::endl;
+                     return 1;
+                  }
+               }
+            }
+            if (reoptimize) {
+               partial.SetFastMethod(kFALSE);
+            }
+            partial.SetNotrees(noTrees);
+            partial.SetMergeOptions(cacheSize);
+            return partial.Merge() ? 0 : 1;
+         };
+         std::vector<Int_t> jobs(nJobs);
+         for (Int_t job = 0; job < nJobs; ++job) jobs[job] = job;
+         TProcPool pool(nJobs);
+         std::vector<Int_t> results = pool.Map(mergeSubset, jobs);
+         Bool_t failed = results.size() != (size_t)nJobs;
+         for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i] != 0) failed = kTRUE;
+         }
+         if (failed) {
+            std::cerr << "hadd failure while merging the input files in parallel." << std::endl;
+            for (size_t i = 0; i < partialFiles.size(); ++i) gSystem->Unlink(partialFiles[i].c_str());
+            return 1;
+         }
+      }
+   }
+
    if (append) {
       if (!merger.OutputFile(targetname,"UPDATE",newcomp)) {
          std::cerr << "hadd error opening target file for update :" << argv[ffirst-1] << "." << std::endl;
@@ -358,8 +502,14 @@ int main( int argc, char **argv )
       exit(1);
    }
 
-
-   for ( int i = ffirst; i < argc; i++ ) {
+   for ( size_t i = 0; i < partialFiles.size(); i++ ) {
+      if ( ! merger.AddFile(partialFiles[i].c_str()) ) {
+         std::cerr << "hadd exiting due to error in partial file " << partialFiles[i] << std::endl;
+         for (size_t j = 0; j < partialFiles.size(); ++j) gSystem->Unlink(partialFiles[j].c_str());
+         return 1;
+      }
+   }
+   for ( int i = ffirst; partialFiles.empty() && i < argc; i++ ) {
       if (argv[i] && argv[i][0]=='@') {
          std::ifstream indirect_file(argv[i]+1);
          if( ! indirect_file.is_open() ) {
@@ -396,6 +546,10 @@ int main( int argc, char **argv )
    if (append) status = merger.PartialMerge(TFileMerger::kIncremental | TFileMerger::kAll);
    else status = merger.Merge();
 
+   for ( size_t i = 0; i < partialFiles.size(); i++ ) {
+      gSystem->Unlink(partialFiles[i].c_str());
+   }
+
    if (status) {
       if (verbosity == 1) {
          std::cout << "hadd merged " << merger.GetMergeList()->GetEntries() << " input files in " << targetname << ".\n";
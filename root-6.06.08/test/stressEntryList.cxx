@@ -12,6 +12,9 @@
 //               and using ">>+elist" in TTree::Draw
 //   - Test3() - transforming TEventList objects into TEntryList objects for a TChain
 //   - Test4() - same as Test3() but for a TTree
+//   - Test5(), Test6() - full and empty entry lists for chains
+//   - Test7() - intersecting and subtracting entry lists and entry list arrays
+//               stored as bits, arrays and runs (TEntryListBlock::SetUseRuns)
 //
 //   To run in batch mode, do
 //     stressEntryList
@@ -31,6 +34,9 @@
 // Test2: Adding and subtracting entry lists-------------------------- OK
 // Test3: TEntryList and TEventList for TChain------------------------ OK
 // Test4: TEntryList and TEventList for TTree------------------------- OK
+// Test5: Full and Empty TEntryList----------------------------------- OK
+// Test6: Full and Empty TEntryList w/ TTrees in TDirectories--------- OK
+// Test7: Intersecting and subtracting bits, arrays and runs---------- OK
 // **********************************************************************
 // *******************Deleting the data files****************************
 // **********************************************************************
@@ -38,9 +44,13 @@
 #include <map>
 #include <list>
 #include <array>
+#include <set>
 #include <stdlib.h>
 #include "TApplication.h"
 #include "TEntryList.h"
+#include "TEntryListArray.h"
+#include "TEntryListBlock.h"
+#include "TBufferFile.h"
 #include "TEventList.h"
 #include "TTree.h"
 #include "TChain.h"
@@ -532,6 +542,130 @@ Bool_t Test6()
                      "stressEntryListTrees*.root/Dir2/tree2"});
 }
 
+typedef std::set<Long64_t> EntrySet;
+
+Bool_t SameEntries(TEntryList *elist, const EntrySet &entries)
+{
+   //True if elist holds exactly the entries
+
+   if (elist->GetN() != (Long64_t)entries.size()) return kFALSE;
+   Long64_t i = 0;
+   for (auto entry : entries) {
+      if (elist->GetEntry(i++) != entry || !elist->Contains(entry)) return kFALSE;
+   }
+   return kTRUE;
+}
+
+Int_t StreamedSize(TEntryList *elist)
+{
+   TBufferFile b(TBuffer::kWrite);
+   elist->Streamer(b);
+   return b.Length();
+}
+
+TEntryList *StreamedCopy(TEntryList *elist)
+{
+   TBufferFile b(TBuffer::kWrite);
+   elist->Streamer(b);
+   TBufferFile r(TBuffer::kRead, b.Length(), b.Buffer(), kFALSE);
+   TEntryList *copy = (TEntryList*)elist->IsA()->New();
+   copy->Streamer(r);
+   return copy;
+}
+
+Bool_t Test7()
+{
+   //Intersect and Subtract lists of the same tree whose blocks are stored as
+   //runs (clustered entries), bits (dense entries) and arrays (sparse entries),
+   //and check that the runs are only used when asked for
+
+   const Long64_t nentries = 5*TEntryList::kBlockSize + 1234;
+   const char *treename = "tree1";
+   const char *filename = "stressEntryListTrees_0.root";
+   EntrySet clustered, dense, sparse;
+   TRandom rnd(4357);
+   for (Long64_t i=0; i<nentries; i++){
+      if (i%5000 < 3000) clustered.insert(i);
+      if (rnd.Rndm() < 0.4) dense.insert(i);
+      if (rnd.Rndm() < 0.01) sparse.insert(i);
+   }
+
+   Bool_t ok = kTRUE;
+   Int_t sizes[2];
+   for (Int_t useRuns=0; useRuns<2; useRuns++){
+      TEntryListBlock::SetUseRuns(useRuns);
+      TEntryList *elists[3] = {new TEntryList("clustered", "", treename, filename),
+                               new TEntryList("dense", "", treename, filename),
+                               new TEntryList("sparse", "", treename, filename)};
+      const EntrySet *sets[3] = {&clustered, &dense, &sparse};
+      for (Int_t k=0; k<3; k++){
+         for (auto entry : *sets[k]) elists[k]->Enter(entry);
+         elists[k]->OptimizeStorage();
+         ok = ok && SameEntries(elists[k], *sets[k]);
+      }
+      sizes[useRuns] = StreamedSize(elists[0]);
+
+      //the blocks read back must give the same entries
+      TEntryList *copy = StreamedCopy(elists[0]);
+      ok = ok && SameEntries(copy, clustered);
+      delete copy;
+
+      for (Int_t k1=0; k1<3; k1++){
+         for (Int_t k2=0; k2<3; k2++){
+            EntrySet and12, andnot12;
+            for (auto entry : *sets[k1]){
+               if (sets[k2]->count(entry)) and12.insert(entry);
+               else andnot12.insert(entry);
+            }
+            TEntryList intersected(*elists[k1]);
+            intersected.Intersect(elists[k2]);
+            TEntryList subtracted(*elists[k1]);
+            subtracted.Subtract(elists[k2]);
+            ok = ok && SameEntries(&intersected, and12) && SameEntries(&subtracted, andnot12);
+         }
+      }
+
+      //entry list arrays keep the sub-entries of the entries that remain
+      TEntryListArray *arrays[2] = {new TEntryListArray("arrayand", "", treename, filename),
+                                    new TEntryListArray("arrayandnot", "", treename, filename)};
+      for (Int_t k=0; k<2; k++){
+         for (auto entry : clustered){
+            if (entry%7 == 0) arrays[k]->Enter(entry, 0, entry%3);
+            else arrays[k]->Enter(entry);
+         }
+         arrays[k]->OptimizeStorage();
+      }
+      arrays[0]->Intersect(elists[1]);
+      arrays[1]->Subtract(elists[1]);
+      EntrySet and01, andnot01;
+      for (auto entry : clustered){
+         if (dense.count(entry)) and01.insert(entry);
+         else andnot01.insert(entry);
+      }
+      ok = ok && SameEntries(arrays[0], and01) && SameEntries(arrays[1], andnot01);
+      for (Int_t k=0; k<2 && ok; k++){
+         for (auto entry : clustered){
+            if (entry%7) continue;
+            Bool_t kept = arrays[k]->Contains(entry);
+            TEntryListArray *sublist = arrays[k]->GetSubListForEntry(entry);
+            if (kept != (sublist != 0) || (kept && !arrays[k]->Contains(entry, 0, entry%3))){
+               ok = kFALSE;
+               break;
+            }
+         }
+      }
+      for (Int_t k=0; k<3; k++) delete elists[k];
+      for (Int_t k=0; k<2; k++) delete arrays[k];
+   }
+   TEntryListBlock::SetUseRuns(kFALSE);
+
+   //the runs must make the clustered list smaller
+   if (sizes[1] >= sizes[0]/4){
+      printf("size without runs=%d, with runs=%d\n", sizes[0], sizes[1]);
+      ok = kFALSE;
+   }
+   return ok;
+}
 
 void SetupTree(TTree* tree, Double_t x, Double_t y, Double_t z)
 {
@@ -618,7 +752,8 @@ Int_t stressEntryList(Int_t nentries, Int_t nfiles)
       {Test3, "Test3: TEntryList and TEventList for TChain------------------------ "},
       {Test4, "Test4: TEntryList and TEventList for TTree------------------------- "},
       {Test5, "Test5: Full and Empty TEntryList----------------------------------- "},
-      {Test6, "Test6: Full and Empty TEntryList w/ TTrees in TDirectories--------- "}
+      {Test6, "Test6: Full and Empty TEntryList w/ TTrees in TDirectories--------- "},
+      {Test7, "Test7: Intersecting and subtracting bits, arrays and runs---------- "}
    };
 
    for (auto const & testDescrPair : testDescrList) {
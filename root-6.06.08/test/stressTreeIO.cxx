@@ -0,0 +1,592 @@
+// @(#)root/test:$Id$
+
+/////////////////////////////////////////////////////////////////
+//
+//___A stress test for the TTree I/O options___
+//
+//   The functions below compare trees written or read with different
+//   I/O options to the ones written or read without them
+//   - TestParallelCompression() - the clusters, sizes and contents of a tree
+//               written with TTree::SetParallelCompression
+//   - TestParallelUnzip() - the entries of a tree with many clusters read
+//               with the baskets unzipped in advance by tasks (TTreeCacheUnzip)
+//               in sequential, backward and sparse order
+//   - TestCompressionAlgorithms() - the baskets of trees written with LZ4 and
+//               ZSTD carry their signatures and the same contents as with ZLIB
+//               (not tested for an algorithm ROOT was built without)
+//   - TestTreeIndex() - the same TTreeIndex built from branches read in bulk
+//               and from formulas, sorted in parallel, after a round trip
+//               through a memory mapped file and after an Append to it
+//   - TestFormulaJit() - the values selected by TTree::Draw with the formulas
+//               compiled (TTreeFormula::EnableJit) and interpreted
+//   - TestChainMetadata() - the number of entries of a TChain taken from its
+//               metadata cache (TChain::SetMetadataCache)
+//
+//   To run in batch mode, do
+//     stressTreeIO
+//     stressTreeIO 100000
+//   Here the parameter is the number of entries in each TTree.
+//   Default value is 100000
+//
+//   An example of output when all tests pass:
+// **********************************************************************
+// ***************Starting TTree I/O stress test*************************
+// **********************************************************************
+// Parallel compression: same clusters and contents------------------- OK
+// Parallel unzip: same entries in any order-------------------------- OK
+// LZ4 and ZSTD compression: signatures and contents------------------ OK
+// TTreeIndex: same lookups in bulk, from formulas and mapped--------- OK
+// TTree::Draw: same values with compiled and interpreted formulas---- OK
+// TChain metadata cache: entries known without opening the files----- OK
+// **********************************************************************
+
+#include <list>
+#include <functional>
+#include <vector>
+#include <stdlib.h>
+#include "TApplication.h"
+#include "TBranch.h"
+#include "Compression.h"
+#include "TEnv.h"
+#include "TTaskPool.h"
+#include "TTreeFormula.h"
+#include "TTreeIndex.h"
+#include "TTree.h"
+#include "TTreeCacheUnzip.h"
+#include "TChain.h"
+#include "TChainMetadata.h"
+#include "TFile.h"
+#include "TRandom3.h"
+#include "TMath.h"
+#include "TROOT.h"
+#include "TSystem.h"
+
+Int_t stressTreeIO(Int_t nentries = 100000);
+
+Int_t gEntries = 100000;
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write a tree with a few branches of different sizes and compressibility -
+/// the same for the same seed.
+
+void WriteTree(const char *filename, Bool_t parallelCompression, Long64_t autoflush,
+               Int_t compress = 1)
+{
+   TFile f(filename, "RECREATE", "", compress);
+   TTree *tree = new TTree("T", "stressTreeIO");
+   tree->SetAutoFlush(autoflush);
+   if (parallelCompression) tree->SetParallelCompression(kTRUE, 8);
+
+   Int_t n = 0;
+   Double_t x = 0;
+   Float_t v[20];
+   Int_t counter = 0;
+   tree->Branch("n", &n, "n/I");
+   tree->Branch("x", &x, "x/D");
+   tree->Branch("v", v, "v[n]/F");
+   tree->Branch("counter", &counter, "counter/I", 4000);
+
+   TRandom3 rnd(4357);
+   for (Int_t i = 0; i < gEntries; ++i) {
+      n = rnd.Integer(20);
+      x = rnd.Gaus();
+      for (Int_t j = 0; j < n; ++j) v[j] = rnd.Uniform();
+      counter = i;
+      tree->Fill();
+   }
+   tree->Write();
+   f.Close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// True if the trees in the two files have the same clusters, sizes and
+/// entries. The compressed sizes are only compared if sameCompression is
+/// true.
+
+Bool_t CompareTrees(const char *filename1, const char *filename2, Bool_t sameCompression = kTRUE)
+{
+   TFile f1(filename1);
+   TFile f2(filename2);
+   TTree *t1 = (TTree*)f1.Get("T");
+   TTree *t2 = (TTree*)f2.Get("T");
+   if (!t1 || !t2) return kFALSE;
+
+   if (t1->GetEntries() != t2->GetEntries() || t1->GetEntries() != gEntries) return kFALSE;
+   if (t1->GetAutoFlush() != t2->GetAutoFlush()) return kFALSE;
+   if (sameCompression && t1->GetZipBytes() != t2->GetZipBytes()) return kFALSE;
+   if (t1->GetTotBytes() != t2->GetTotBytes()) return kFALSE;
+
+   TTree::TClusterIterator c1 = t1->GetClusterIterator(0);
+   TTree::TClusterIterator c2 = t2->GetClusterIterator(0);
+   Long64_t start1, start2;
+   while ((start1 = c1()) < t1->GetEntries()) {
+      start2 = c2();
+      if (start1 != start2 || c1.GetNextEntry() != c2.GetNextEntry()) return kFALSE;
+   }
+
+   Int_t n1, n2, counter1, counter2;
+   Double_t x1, x2;
+   Float_t v1[20], v2[20];
+   t1->SetBranchAddress("n", &n1);
+   t1->SetBranchAddress("x", &x1);
+   t1->SetBranchAddress("v", v1);
+   t1->SetBranchAddress("counter", &counter1);
+   t2->SetBranchAddress("n", &n2);
+   t2->SetBranchAddress("x", &x2);
+   t2->SetBranchAddress("v", v2);
+   t2->SetBranchAddress("counter", &counter2);
+   for (Long64_t i = 0; i < t1->GetEntries(); ++i) {
+      if (t1->GetEntry(i) <= 0 || t2->GetEntry(i) <= 0) return kFALSE;
+      if (n1 != n2 || x1 != x2 || counter1 != counter2 || counter1 != i) return kFALSE;
+      for (Int_t j = 0; j < n1; ++j) {
+         if (v1[j] != v2[j]) return kFALSE;
+      }
+   }
+   return kTRUE;
+}
+
+Bool_t TestParallelCompression()
+{
+   // AutoFlush on bytes (the default), which depends on the compressed size of
+   // the baskets, and on entries.
+   Bool_t ok = kTRUE;
+   Long64_t autoflush[] = { -300000, 1000 };
+   for (Long64_t af : autoflush) {
+      WriteTree("stressTreeIO_serial.root", kFALSE, af);
+      WriteTree("stressTreeIO_parallel.root", kTRUE, af);
+      ok = ok && CompareTrees("stressTreeIO_serial.root", "stressTreeIO_parallel.root");
+   }
+   gSystem->Unlink("stressTreeIO_serial.root");
+   gSystem->Unlink("stressTreeIO_parallel.root");
+   return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the entries of the tree written by WriteTree in the given order, with
+/// the baskets unzipped in advance by tasks if parallel is true, and keep a
+/// checksum of each entry. False if an entry cannot be read or the cache is
+/// not the one asked for.
+
+Bool_t ReadEntries(const char *filename, Bool_t parallel, const std::vector<Long64_t> &order,
+                   std::vector<Double_t> &sums)
+{
+   TTreeCacheUnzip::EParUnzipMode mode = TTreeCacheUnzip::GetParallelUnzip();
+   TTreeCacheUnzip::SetParallelUnzip(parallel ? TTreeCacheUnzip::kEnable : TTreeCacheUnzip::kDisable);
+
+   Bool_t ok = kTRUE;
+   {
+      TFile f(filename);
+      TTree *tree = (TTree*)f.Get("T");
+      if (!tree) return kFALSE;
+      tree->SetCacheSize(1000000);
+      tree->AddBranchToCache("*", kTRUE);
+
+      Int_t n, counter;
+      Double_t x;
+      Float_t v[20];
+      tree->SetBranchAddress("n", &n);
+      tree->SetBranchAddress("x", &x);
+      tree->SetBranchAddress("v", v);
+      tree->SetBranchAddress("counter", &counter);
+
+      sums.clear();
+      for (Long64_t i : order) {
+         if (tree->GetEntry(i) <= 0 || counter != i) {
+            ok = kFALSE;
+            break;
+         }
+         Double_t sum = x + 1e-3 * n;
+         for (Int_t j = 0; j < n; ++j) sum += v[j] * (j + 1);
+         sums.push_back(sum);
+      }
+
+      TTreeCacheUnzip *cache = dynamic_cast<TTreeCacheUnzip*>(f.GetCacheRead(tree));
+      ok = ok && (parallel ? cache && cache->GetNUnzip() > 0 : !cache);
+   }
+
+   TTreeCacheUnzip::SetParallelUnzip(mode);
+   return ok;
+}
+
+Bool_t TestParallelUnzip()
+{
+   WriteTree("stressTreeIO_unzip.root", kFALSE, 1000);
+
+   // Sequential, backward - every cluster refills the cache while tasks of
+   // the previous one may still run - and sparse.
+   std::vector<Long64_t> orders[3];
+   for (Long64_t i = 0; i < gEntries; ++i) orders[0].push_back(i);
+   for (Long64_t i = gEntries - 1; i >= 0; --i) orders[1].push_back(i);
+   for (Long64_t i = 0; i < gEntries; i += 997) orders[2].push_back(i);
+
+   Bool_t ok = kTRUE;
+   for (const std::vector<Long64_t> &order : orders) {
+      std::vector<Double_t> serial, parallel;
+      ok = ok && ReadEntries("stressTreeIO_unzip.root", kFALSE, order, serial)
+              && ReadEntries("stressTreeIO_unzip.root", kTRUE, order, parallel)
+              && serial == parallel;
+   }
+   gSystem->Unlink("stressTreeIO_unzip.root");
+   return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Count the compressed baskets of the tree in filename whose buffer starts
+/// with the signature sig of a compression algorithm, and the other ones.
+/// Baskets stored uncompressed are not counted.
+
+void CountSignatures(const char *filename, const char *sig, Int_t &nsig, Int_t &nother)
+{
+   nsig = nother = 0;
+   TFile f(filename);
+   TTree *tree = (TTree*)f.Get("T");
+   if (!tree) return;
+   for (TObject *obj : *tree->GetListOfBranches()) {
+      TBranch *branch = (TBranch*)obj;
+      for (Int_t i = 0; i < branch->GetWriteBasket(); ++i) {
+         // The key header: Nbytes(4) Version(2) ObjLen(4) Datime(4) KeyLen(2)
+         Long64_t seek = branch->GetBasketSeek(i);
+         unsigned char key[16];
+         if (f.ReadBuffer((char*)key, seek, sizeof(key))) continue;
+         Int_t nbytes = (key[0] << 24) | (key[1] << 16) | (key[2] << 8) | key[3];
+         Int_t objlen = (key[6] << 24) | (key[7] << 16) | (key[8] << 8) | key[9];
+         Int_t keylen = (key[14] << 8) | key[15];
+         if (nbytes - keylen == objlen) continue;
+         char hdr[2];
+         if (f.ReadBuffer(hdr, seek + keylen, sizeof(hdr))) continue;
+         if (hdr[0] == sig[0] && hdr[1] == sig[1]) ++nsig;
+         else ++nother;
+      }
+   }
+}
+
+Bool_t TestCompressionAlgorithms()
+{
+   WriteTree("stressTreeIO_zlib.root", kFALSE, 1000, ROOT::CompressionSettings(ROOT::kZLIB, 1));
+
+   struct Algorithm {
+      ROOT::ECompressionAlgorithm fAlgorithm;
+      Int_t fLevel;
+      const char *fSignature;
+      const char *fName;
+   };
+   Algorithm algorithms[] = { { ROOT::kLZ4, 4, "L4", "lz4" }, { ROOT::kZSTD, 5, "ZS", "zstd" } };
+
+   Bool_t ok = kTRUE;
+   for (const Algorithm &alg : algorithms) {
+      WriteTree("stressTreeIO_alg.root", kFALSE, 1000, ROOT::CompressionSettings(alg.fAlgorithm, alg.fLevel));
+      Int_t nsig, nother, nzlib, nnotzlib;
+      CountSignatures("stressTreeIO_alg.root", alg.fSignature, nsig, nother);
+      // Built without the library, ROOT compresses with ZLIB instead
+      CountSignatures("stressTreeIO_alg.root", "ZL", nzlib, nnotzlib);
+      if (nsig == 0 && nzlib > 0 && nnotzlib == 0) {
+         printf("   ROOT built without lib%s: %s compression not tested\n", alg.fName, alg.fName);
+         continue;
+      }
+      ok = ok && nsig > 0 && nother == 0
+              && CompareTrees("stressTreeIO_zlib.root", "stressTreeIO_alg.root", kFALSE);
+   }
+   gSystem->Unlink("stressTreeIO_zlib.root");
+   gSystem->Unlink("stressTreeIO_alg.root");
+   return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write a tree with a unique (run, event) pair per entry, in no particular
+/// order: entry i has the key number (i * 7919) % nentries, split in
+/// run = key / 1000 + runOffset and event = key % 1000.
+
+void WriteIndexTree(const char *filename, Long64_t nentries, Int_t runOffset)
+{
+   TFile f(filename, "RECREATE");
+   TTree *tree = new TTree("T", "stressTreeIO");
+   Int_t run;
+   Long64_t event;
+   tree->Branch("run", &run, "run/I");
+   tree->Branch("event", &event, "event/L");
+   for (Long64_t i = 0; i < nentries; ++i) {
+      Long64_t key = i * 7919 % nentries;
+      run = key / 1000 + runOffset;
+      event = key % 1000;
+      tree->Fill();
+   }
+   tree->Write();
+   f.Close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// True if the two indices have the same sorted values and entries, and find
+/// every entry of the tree written by WriteIndexTree (the first n of index1,
+/// from entry offset on), and no missing key.
+
+Bool_t CheckIndex(const TTreeIndex &index1, const TTreeIndex &index2, Long64_t nentries,
+                  Int_t runOffset, Long64_t offset)
+{
+   Long64_t n = index1.GetN();
+   if (n != index2.GetN() || n < offset + nentries) return kFALSE;
+   for (Long64_t i = 0; i < n; ++i) {
+      if (index1.GetIndexValues()[i] != index2.GetIndexValues()[i]
+          || index1.GetIndexValuesMinor()[i] != index2.GetIndexValuesMinor()[i]
+          || index1.GetIndex()[i] != index2.GetIndex()[i]) return kFALSE;
+      if (i > 0 && (index1.GetIndexValues()[i] < index1.GetIndexValues()[i - 1]
+                    || (index1.GetIndexValues()[i] == index1.GetIndexValues()[i - 1]
+                        && index1.GetIndexValuesMinor()[i] <= index1.GetIndexValuesMinor()[i - 1])))
+         return kFALSE;
+   }
+   for (Long64_t i = 0; i < nentries; ++i) {
+      Long64_t key = i * 7919 % nentries;
+      Long64_t run = key / 1000 + runOffset;
+      if (index1.GetEntryNumberWithIndex(run, key % 1000) != offset + i
+          || index2.GetEntryNumberWithIndex(run, key % 1000) != offset + i) return kFALSE;
+   }
+   return index1.GetEntryNumberWithIndex(runOffset - 1, 0) < 0
+       && index2.GetEntryNumberWithIndex(runOffset + nentries / 1000 + 1, 999) < 0;
+}
+
+Bool_t TestTreeIndex()
+{
+   // More than two chunks of the parallel sort (32768 values each), so that
+   // sorted chunks are merged, with keys unique modulo nentries.
+   Long64_t nentries = TMath::Max(gEntries, 3 * 32768 + 1);
+   if (nentries % 7919 == 0) ++nentries;
+   const Long64_t nextra = 5000;
+   const Int_t extraRun = 1000000;
+   WriteIndexTree("stressTreeIO_index.root", nentries, 0);
+   WriteIndexTree("stressTreeIO_index2.root", nextra, extraRun);
+
+   Bool_t ok = kFALSE;
+   TFile f("stressTreeIO_index.root");
+   TFile f2("stressTreeIO_index2.root");
+   TTree *tree = (TTree*)f.Get("T");
+   TTree *tree2 = (TTree*)f2.Get("T");
+   if (tree && tree2) {
+      // Plain branches are read in bulk, expressions evaluated entry by entry
+      TTreeIndex bulk(tree, "run", "event");
+      TTreeIndex formula(tree, "run+0", "event*1");
+      ok = !bulk.IsZombie() && !formula.IsZombie()
+         && CheckIndex(bulk, formula, nentries, 0, 0);
+
+      TTreeIndex *mapped = 0;
+      if (ok) {
+         ok = bulk.WriteMapped("stressTreeIO_index.idx") > 0;
+         mapped = TTreeIndex::OpenMapped("stressTreeIO_index.idx", tree);
+         ok = ok && mapped && mapped->IsMapped() && CheckIndex(*mapped, bulk, nentries, 0, 0);
+      }
+
+      // Append copies the mapped index to memory: the entries of the second
+      // tree follow those of the first one
+      if (ok) {
+         TTreeIndex extra(tree2, "run", "event");
+         TTreeIndex appended(tree, "run", "event");
+         mapped->Append(&extra);
+         appended.Append(&extra);
+         ok = !mapped->IsMapped() && mapped->GetN() == nentries + nextra
+            && CheckIndex(*mapped, appended, nentries, 0, 0)
+            && CheckIndex(*mapped, appended, nextra, extraRun, nentries);
+      }
+      delete mapped;
+   }
+   f.Close();
+   f2.Close();
+   gSystem->Unlink("stressTreeIO_index.root");
+   gSystem->Unlink("stressTreeIO_index2.root");
+   gSystem->Unlink("stressTreeIO_index.idx");
+   return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Draw varexp (two variables) with selection, with the formulas compiled if
+/// jit is true, and keep the selected values.
+
+Bool_t DrawValues(TTree *tree, const char *varexp, const char *selection, Bool_t jit,
+                  std::vector<Double_t> &v1, std::vector<Double_t> &v2)
+{
+   gEnv->SetValue("TTreeFormula.Jit", jit ? 1 : 0);
+   tree->SetEstimate(tree->GetEntries() + 1);
+   Long64_t n = tree->Draw(varexp, selection, "goff");
+   gEnv->SetValue("TTreeFormula.Jit", 0);
+   if (n < 0) return kFALSE;
+
+   // The formulas must really be compiled, or interpreted.
+   if (tree->GetVar1()->IsJit() != jit || tree->GetVar2()->IsJit() != jit) return kFALSE;
+   if (selection[0] && tree->GetSelect()->IsJit() != jit) return kFALSE;
+
+   v1.assign(tree->GetV1(), tree->GetV1() + n);
+   v2.assign(tree->GetV2(), tree->GetV2() + n);
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// True if the values are the same up to rounding - the compiled code may
+/// evaluate the math functions slightly differently.
+
+Bool_t SameValues(const std::vector<Double_t> &a, const std::vector<Double_t> &b)
+{
+   if (a.size() != b.size()) return kFALSE;
+   for (size_t i = 0; i < a.size(); ++i) {
+      if (TMath::Abs(a[i] - b[i]) > 1e-12 * TMath::Max(1., TMath::Abs(a[i]))) return kFALSE;
+   }
+   return kTRUE;
+}
+
+Bool_t TestFormulaJit()
+{
+   {
+      TFile f("stressTreeIO_jit.root", "RECREATE");
+      TTree *tree = new TTree("T", "stressTreeIO");
+      Double_t x, y;
+      Float_t z;
+      Int_t i;
+      tree->Branch("x", &x, "x/D");
+      tree->Branch("y", &y, "y/D");
+      tree->Branch("z", &z, "z/F");
+      tree->Branch("i", &i, "i/I");
+      TRandom3 rnd(4357);
+      for (i = 0; i < gEntries; ++i) {
+         x = rnd.Gaus();
+         y = rnd.Uniform();
+         z = rnd.Uniform(-10, 10);
+         tree->Fill();
+      }
+      tree->Write();
+   }
+
+   const char *varexps[] = { "x*y+sqrt(abs(z)):i%7", "sin(x)*cos(y):z/(1+x*x)", "x+1:pow(y,2)-z" };
+   const char *selections[] = { "", "x>0 && y<0.5", "z*z>25 || i%3==0" };
+
+   TFile f("stressTreeIO_jit.root");
+   TTree *tree = (TTree*)f.Get("T");
+   Bool_t ok = (tree != 0);
+   for (const char *varexp : varexps) {
+      for (const char *selection : selections) {
+         if (!ok) break;
+         std::vector<Double_t> i1, i2, j1, j2;
+         ok = DrawValues(tree, varexp, selection, kFALSE, i1, i2)
+            && DrawValues(tree, varexp, selection, kTRUE, j1, j2)
+            && !i1.empty() && SameValues(i1, j1) && SameValues(i2, j2);
+      }
+   }
+   f.Close();
+   gSystem->Unlink("stressTreeIO_jit.root");
+   return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write a tree with nentries entries in the subdirectory "dir" of filename.
+
+void WriteTreeInDir(const char *filename, Int_t nentries)
+{
+   TFile f(filename, "RECREATE");
+   f.mkdir("dir")->cd();
+   TTree *tree = new TTree("T", "stressTreeIO");
+   Int_t i;
+   tree->Branch("i", &i, "i/I");
+   for (i = 0; i < nentries; ++i) tree->Fill();
+   tree->Write();
+   f.Close();
+}
+
+Bool_t TestChainMetadata()
+{
+   const Int_t nfiles = 3;
+   const char *cachefile = "stressTreeIO_meta.root";
+   TString filenames[nfiles];
+   Int_t nentries[nfiles];
+   Long64_t total = 0;
+   for (Int_t i = 0; i < nfiles; ++i) {
+      filenames[i].Form("stressTreeIO_meta%d.root", i);
+      nentries[i] = gEntries / 10 * (i + 1) + i;
+      total += nentries[i];
+      WriteTreeInDir(filenames[i], nentries[i]);
+   }
+   gSystem->Unlink(cachefile);
+
+   // The entries are recorded under the name of the tree in the file, and
+   // the cache is only written when asked for.
+   Bool_t ok = kTRUE;
+   {
+      TChain chain("T");
+      chain.SetMetadataCache(cachefile);
+      for (Int_t i = 0; i < nfiles; ++i) chain.AddFile(filenames[i], TTree::kMaxEntries, "dir/T");
+      ok = ok && chain.GetEntries() == total;
+      ok = ok && gSystem->AccessPathName(cachefile);
+      for (Int_t i = 0; i < nfiles && ok; ++i) {
+         TChainMetadata::TFileEntry *cached = chain.GetMetadataCache()->Find(filenames[i], "dir/T");
+         ok = cached && cached->GetEntries() == nentries[i];
+      }
+      ok = ok && chain.SaveMetadataCache() > 0 && !gSystem->AccessPathName(cachefile);
+   }
+
+   // A new chain knows its entries from the cache without opening any file,
+   // and can still read them.
+   {
+      TChain chain("T");
+      chain.SetMetadataCache(cachefile);
+      for (Int_t i = 0; i < nfiles; ++i) chain.AddFile(filenames[i], TTree::kMaxEntries, "dir/T");
+      ok = ok && chain.GetEntries() == total && chain.GetTree() == 0;
+      Int_t value = -1;
+      chain.SetBranchAddress("i", &value);
+      ok = ok && chain.GetEntry(total - 1) > 0 && value == nentries[nfiles - 1] - 1;
+   }
+
+   // A file that changed is opened again.
+   WriteTreeInDir(filenames[0], nentries[0] / 2);
+   {
+      TChain chain("T");
+      chain.SetMetadataCache(cachefile);
+      for (Int_t i = 0; i < nfiles; ++i) chain.AddFile(filenames[i], TTree::kMaxEntries, "dir/T");
+      ok = ok && chain.GetEntries() == total - nentries[0] + nentries[0] / 2;
+   }
+
+   for (Int_t i = 0; i < nfiles; ++i) gSystem->Unlink(filenames[i]);
+   gSystem->Unlink(cachefile);
+   return ok;
+}
+
+Int_t stressTreeIO(Int_t nentries)
+{
+   gEntries = nentries;
+
+   // Several threads for the parallel unzipping and index sorting, whatever
+   // the number of cores
+   TTaskPool::SetGlobalNThreads(4);
+
+   printf("**********************************************************************\n");
+   printf("***************Starting TTree I/O stress test*************************\n");
+   printf("**********************************************************************\n");
+
+   Int_t retval = 0;
+   using fcnCharPtrPair = std::pair<std::function<bool()>,const char*>;
+   std::list<fcnCharPtrPair> testDescrList = {
+      {TestParallelCompression,   "Parallel compression: same clusters and contents------------------- "},
+      {TestParallelUnzip,         "Parallel unzip: same entries in any order-------------------------- "},
+      {TestCompressionAlgorithms, "LZ4 and ZSTD compression: signatures and contents------------------ "},
+      {TestTreeIndex,             "TTreeIndex: same lookups in bulk, from formulas and mapped--------- "},
+      {TestFormulaJit,            "TTree::Draw: same values with compiled and interpreted formulas---- "},
+      {TestChainMetadata,         "TChain metadata cache: entries known without opening the files----- "}
+   };
+
+   for (auto const & testDescrPair : testDescrList) {
+      auto test = testDescrPair.first;
+      auto descr = testDescrPair.second;
+      Bool_t testRes = test();
+      retval += !testRes; // increment by one upon failure
+      printf("%s %s\n", descr, testRes ? "OK" : "FAILED" );
+   }
+
+   printf("**********************************************************************\n");
+   return retval;
+}
+//_____________________________batch only_____________________
+#ifndef __CINT__
+
+int main(int argc, char *argv[])
+{
+   gROOT->SetBatch();
+   TApplication theApp("App", &argc, argv);
+   Int_t nentries = 100000;
+   if (argc > 1) nentries = atoi(argv[1]);
+   return stressTreeIO(nentries);
+}
+
+#endif
@@ -25,6 +25,8 @@
 #pragma link C++ class TBasketSQL+;
 #pragma link C++ class TChain-;
 #pragma link C++ class TChainElement;
+#pragma link C++ class TChainMetadata+;
+#pragma link C++ class TChainMetadata::TFileEntry+;
 #pragma link C++ class TCut+;
 #pragma link C++ class TEntryList-;
 #pragma link C++ class TEntryListArray+;
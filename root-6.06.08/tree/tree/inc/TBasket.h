@@ -96,6 +96,11 @@ public:
    virtual void    Update(Int_t newlast, Int_t skipped);
    virtual Int_t   WriteBuffer();
 
+   // The steps of WriteBuffer, used separately for the parallel compression.
+           void    PrepareWrite(TFile *file, Bool_t ownCompressedBuffer);
+           Int_t   CompressBuffer(Int_t cxlevel, Int_t cxAlgorithm, TFile *file);
+           Int_t   WriteCompressedBuffer(Int_t nout, TFile *file);
+
    ClassDef(TBasket,2);  //the TBranch buffers
 };
 
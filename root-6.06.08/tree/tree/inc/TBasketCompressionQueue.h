@@ -0,0 +1,76 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TBasketCompressionQueue
+#define ROOT_TBasketCompressionQueue
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TBasketCompressionQueue                                              //
+//                                                                      //
+// Full baskets of a TTree being compressed on the global TTaskPool.    //
+// The baskets are written to the file in the order they were queued,   //
+// on the thread filling the tree (see TTree::SetParallelCompression).  //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+class TBasket;
+class TBranch;
+class TFile;
+
+class TBasketCompressionQueue {
+
+private:
+   struct TItem {
+      TBranch  *fBranch;   // branch of the basket
+      TBasket  *fBasket;   // basket being compressed, owned by the queue
+      TFile    *fFile;     // file to write to
+      Int_t     fWhere;    // basket number in the branch
+      Int_t     fNout;     // result of TBasket::CompressBuffer
+      Int_t     fMaxNout;  // upper bound of fNout
+      Bool_t    fDone;     // compression finished, protected by fMutex
+   };
+
+   std::deque<TItem*>       fItems;        // queued baskets, oldest first
+   Int_t                    fMaxInFlight;  // maximum number of queued baskets
+   Int_t                    fNerrors;      // baskets that failed to be written since the last Flush()
+   Long64_t                 fMaxZipBytes;  // upper bound of the bytes the queued baskets will write
+   std::mutex               fMutex;        // protects TItem::fDone
+   std::condition_variable  fCond;         // signals a finished compression
+
+   TBasketCompressionQueue(const TBasketCompressionQueue &);            // not implemented
+   TBasketCompressionQueue &operator=(const TBasketCompressionQueue &); // not implemented
+
+   Bool_t IsDone(TItem *item);
+   void   Wait(TItem *item);
+   Int_t  WriteOldest();
+
+public:
+   TBasketCompressionQueue(Int_t maxInFlight);
+   ~TBasketCompressionQueue();
+
+   void   Discard();
+   Int_t  Flush();
+   Int_t  GetMaxInFlight() const { return fMaxInFlight; }
+   Long64_t GetMaxZipBytes() const { return fMaxZipBytes; }
+   Int_t  GetNQueued() const { return fItems.size(); }
+   Bool_t Submit(TBranch *branch, TBasket *basket, Int_t where);
+   Int_t  WriteFinished();
+};
+
+#endif
@@ -59,6 +59,7 @@ class TBranch : public TNamed , public TAttFill {
 
 protected:
    friend class TTreeCloner;
+   friend class TBasketCompressionQueue;
    // TBranch status bits
    enum EStatusBits {
       kAutoDelete = BIT(15),
@@ -150,6 +151,7 @@ public:
    virtual Long64_t  GetBasketSeek(Int_t basket) const;
    virtual Int_t     GetBasketSize() const {return fBasketSize;}
    virtual TList    *GetBrowsables();
+           Int_t     GetBulkEntries(Long64_t entry, const char *&data, Long64_t &first);
    virtual const char* GetClassName() const;
            Int_t     GetCompressionAlgorithm() const;
            Int_t     GetCompressionLevel() const;
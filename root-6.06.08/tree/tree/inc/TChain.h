@@ -31,6 +31,7 @@ class TCut;
 class TEntryList;
 class TEventList;
 class TCollection;
+class TChainMetadata;
 
 class TChain : public TTree {
 
@@ -45,6 +46,7 @@ protected:
    TObjArray   *fFiles;            //-> List of file names containing the trees (TChainElement, owned)
    TList       *fStatus;           //-> List of active/inactive branches (TChainElement, owned)
    TChain      *fProofChain;       //! chain proxy when going to be processed by PROOF
+   TChainMetadata *fMetadata;      //! Cache of the description of the trees, kept in a sidecar file (owned)
 
 private:
    TChain(const TChain&);            // not implemented
@@ -110,6 +112,7 @@ public:
    virtual TObjArray *GetListOfLeaves();
    virtual const char *GetAlias(const char *aliasName) const;
    virtual Double_t  GetMaximum(const char *columname);
+   TChainMetadata   *GetMetadataCache() const { return fMetadata; }
    virtual Double_t  GetMinimum(const char *columname);
    virtual Int_t     GetNbranches();
    virtual Long64_t  GetReadEntry() const;
@@ -137,6 +140,7 @@ public:
    virtual void      ResetAfterMerge(TFileMergeInfo *);
    virtual void      ResetBranchAddress(TBranch *);
    virtual void      ResetBranchAddresses();
+           Int_t     SaveMetadataCache();
    virtual Long64_t  Scan(const char *varexp="", const char *selection="", Option_t *option="", Long64_t nentries=kMaxEntries, Long64_t firstentry=0); // *MENU*
    virtual void      SetAutoDelete(Bool_t autodel=kTRUE);
    virtual Int_t     SetBranchAddress(const char *bname,void *add, TBranch **ptr = 0);
@@ -160,6 +164,7 @@ public:
    virtual void      SetEntryListFile(const char *filename="", Option_t *opt="");
    virtual void      SetEventList(TEventList *evlist);
    virtual void      SetMakeClass(Int_t make) { TTree::SetMakeClass(make); if (fTree) fTree->SetMakeClass(make);}
+           void      SetMetadataCache(const char *cachefile);
    virtual void      SetPacketSize(Int_t size = 100);
    virtual void      SetProof(Bool_t on = kTRUE, Bool_t refresh = kFALSE, Bool_t gettreeheader = kFALSE);
    virtual void      SetWeight(Double_t w=1, Option_t *option="");
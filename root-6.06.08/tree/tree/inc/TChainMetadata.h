@@ -0,0 +1,95 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TChainMetadata
+#define ROOT_TChainMetadata
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TChainMetadata                                                       //
+//                                                                      //
+// Cache of the description of the trees of a TChain (entries, index   //
+// range), kept in a sidecar file so that the files of the chain do not //
+// need to be opened to know it.                                        //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TNamed
+#include "TNamed.h"
+#endif
+
+class THashList;
+class TTree;
+
+class TChainMetadata : public TNamed {
+
+public:
+   class TFileEntry : public TNamed {
+      // Describes the tree called GetTitle() in the file GetName().
+   protected:
+      Long64_t    fEntries;          //Number of entries in the tree
+      Long64_t    fFileSize;         //Size of the file when the entry was recorded, -1 if not a local file
+      Long_t      fModTime;          //Modification time of the file when the entry was recorded
+      TString     fIndexMajor;       //Major name of the persistent tree index, empty if none
+      TString     fIndexMinor;       //Minor name of the persistent tree index
+      Long64_t    fMinIndexValue;    //Smallest major value of the index
+      Long64_t    fMinIndexValMinor; //Minor value going with fMinIndexValue
+      Long64_t    fMaxIndexValue;    //Largest major value of the index
+      Long64_t    fMaxIndexValMinor; //Minor value going with fMaxIndexValue
+
+   public:
+      TFileEntry();
+      TFileEntry(const char *filename, const char *treename);
+      virtual ~TFileEntry() {}
+
+      Long64_t    GetEntries() const { return fEntries; }
+      const char *GetIndexMajorName() const { return fIndexMajor; }
+      const char *GetIndexMinorName() const { return fIndexMinor; }
+      void        GetIndexRange(Long64_t &minMajor, Long64_t &minMinor, Long64_t &maxMajor, Long64_t &maxMinor) const;
+      Bool_t      HasIndex(const char *majorname, const char *minorname) const;
+      Bool_t      IsValid() const;
+      void        Fill(TTree *tree);
+      void        SetIndexRange(const char *majorname, const char *minorname, Long64_t minMajor, Long64_t minMinor, Long64_t maxMajor, Long64_t maxMinor);
+
+      ClassDef(TFileEntry,1)  //Description of one tree of a TChain
+   };
+
+protected:
+   THashList     *fFiles;            //->List of the TFileEntry, one per tree
+   TString        fCacheFile;        //!Name of the sidecar file
+   Bool_t         fModified;         //!True if the list changed since it was read or saved
+
+private:
+   TChainMetadata(const TChainMetadata&);            // not implemented
+   TChainMetadata& operator=(const TChainMetadata&); // not implemented
+
+public:
+   TChainMetadata();
+   TChainMetadata(const char *name, const char *cachefile);
+   virtual ~TChainMetadata();
+
+   virtual void        Clear(Option_t *option="");
+   TFileEntry         *Fill(const char *filename, const char *treename, TTree *tree);
+   TFileEntry         *Find(const char *filename, const char *treename = "");
+   const char         *GetCacheFile() const { return fCacheFile; }
+   THashList          *GetListOfFiles() const { return fFiles; }
+   Bool_t              IsModified() const { return fModified; }
+   virtual void        Print(Option_t *option="") const;
+   Int_t               Save();
+   void                SetIndexRange(const char *filename, const char *treename, const char *majorname, const char *minorname,
+                                     Long64_t minMajor, Long64_t minMinor, Long64_t maxMajor, Long64_t maxMinor);
+
+   static TChainMetadata *Open(const char *name, const char *cachefile);
+
+   ClassDef(TChainMetadata,1)  //Sidecar cache of the description of the trees of a TChain
+};
+
+#endif
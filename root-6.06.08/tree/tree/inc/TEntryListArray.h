@@ -68,6 +68,7 @@ public:
    };
 //    virtual Bool_t      Enter(Long64_t entry, TTree *tree, const TEntryList *e);
    virtual TEntryListArray* GetSubListForEntry(Long64_t entry, TTree *tree = 0);
+   virtual void        Intersect(const TEntryList *elist);
    virtual void        Print(const Option_t* option = "") const;
    virtual Bool_t      Remove(Long64_t entry, TTree *tree, Long64_t subentry);
    virtual Bool_t      Remove(Long64_t entry, TTree *tree = 0) {
@@ -157,6 +158,7 @@ public:
    };
 //    virtual Bool_t      Enter(Long64_t entry, TTree *tree, const TEntryList *e);
    virtual TEntryListArray* GetSubListForEntry(Long64_t entry, TTree *tree = 0);
+   virtual void        Intersect(const TEntryList *elist);
    virtual void        Print(const Option_t* option = "") const;
    virtual Bool_t      Remove(Long64_t entry, TTree *tree, Long64_t subentry);
    virtual Bool_t      Remove(Long64_t entry, TTree *tree = 0) {
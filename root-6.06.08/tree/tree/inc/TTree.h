@@ -85,6 +85,7 @@ class TCut;
 class TVirtualIndex;
 class TBranchRef;
 class TBasket;
+class TBasketCompressionQueue;
 class TStreamerInfo;
 class TTreeCache;
 class TTreeCloner;
@@ -143,6 +144,7 @@ protected:
    TBranchRef    *fBranchRef;         //  Branch supporting the TRefTable (if any)
    UInt_t         fFriendLockStatus;  //! Record which method is locking the friend recursion
    TBuffer       *fTransientBuffer;   //! Pointer to the current transient buffer.
+   TBasketCompressionQueue *fCompressionQueue; //! Baskets being compressed in parallel (see SetParallelCompression)
    Bool_t         fCacheDoAutoInit;   //! true if cache auto creation or resize check is needed
    Bool_t         fCacheUserSet;      //! true if the cache setting was explicitly given by user
 
@@ -374,6 +376,7 @@ public:
    virtual TClusterIterator GetClusterIterator(Long64_t firstentry);
    virtual Long64_t        GetChainEntryNumber(Long64_t entry) const { return entry; }
    virtual Long64_t        GetChainOffset() const { return fChainOffset; }
+   TBasketCompressionQueue *GetCompressionQueue() const { return fCompressionQueue; }
    TFile                  *GetCurrentFile() const;
            Int_t           GetDefaultEntryOffsetLen() const {return fDefaultEntryOffsetLen;}
            Long64_t        GetDebugMax()  const { return fDebugMax; }
@@ -542,6 +545,7 @@ public:
    virtual void            SetName(const char* name); // *MENU*
    virtual void            SetNotify(TObject* obj) { fNotify = obj; }
    virtual void            SetObject(const char* name, const char* title);
+   virtual void            SetParallelCompression(Bool_t enable = kTRUE, Int_t maxInFlight = 32);
    virtual void            SetParallelUnzip(Bool_t opt=kTRUE, Float_t RelSize=-1);
    virtual void            SetPerfStats(TVirtualPerfStats* perf);
    virtual void            SetScanField(Int_t n = 50) { fScanField = n; } // *MENU*
@@ -18,6 +18,8 @@
 // TTreeCacheUnzip                                                      //
 //                                                                      //
 // Specialization of TTreeCache for parallel Unzipping                  //
+// The baskets of the current cluster are unzipped in advance by tasks  //
+// on the global TTaskPool.                                             //
 //                                                                      //
 // Fabrizio Furano (CERN) Aug 2009                                      //
 // Core TTree-related code borrowed from the previous version           //
@@ -29,11 +31,10 @@
 #include "TTreeCache.h"
 #endif
 
-#include <queue>
+#include <vector>
 
 class TTree;
 class TBranch;
-class TThread;
 class TCondition;
 class TBasket;
 class TMutex;
@@ -47,40 +48,39 @@ public:
 protected:
 
    // Members for paral. managing
-   TThread    *fUnzipThread[10];
-   Bool_t      fActiveThread;          // Used to terminate gracefully the unzippers
-   TCondition *fUnzipStartCondition;   // Used to signal the threads to start.
-   TCondition *fUnzipDoneCondition;    // Used to wait for an unzip tour to finish. Gives the Async feel.
+   TCondition *fUnzipDoneCondition;    // Signals the end of an unzip task.
    Bool_t      fParallel;              // Indicate if we want to activate the parallelism (for this instance)
    Bool_t      fAsyncReading;
-   TMutex     *fMutexList;             // Mutex to protect the various lists. Used by the condvars.
+   TMutex     *fMutexList;             // Mutex to protect the various lists. Used by the condvar.
    TMutex     *fIOMutex;
 
-   Int_t       fCycle;
+   Int_t       fCycle;                 // Incremented by ResetCache, the tasks of an older cycle are dropped
    static TTreeCacheUnzip::EParUnzipMode fgParallel;  // Indicate if we want to activate the parallelism
 
-   Int_t       fLastReadPos;
-   Int_t       fBlocksToGo;
-
    // Unzipping related members
    Int_t      *fUnzipLen;         //! [fNseek] Length of the unzipped buffers
    char      **fUnzipChunks;      //! [fNseek] Individual unzipped chunks. Their summed size is kept under control.
    Byte_t     *fUnzipStatus;      //! [fNSeek] For each blk, tells us if it's unzipped or pending
    Long64_t    fTotalUnzipBytes;  //! The total sum of the currently unzipped blks
+   Long64_t    fPendingUnzipBytes;//! The zipped size of the blks being unzipped by the tasks
 
    Int_t       fNseekMax;         //!  fNseek can change so we need to know its max size
    Long64_t    fUnzipBufferSize;  //!  Max Size for the ready unzipped blocks (default is 2*fBufferSize)
 
    static Double_t fgRelBuffSize; // This is the percentage of the TTreeCacheUnzip that will be used
 
+   std::vector<Long64_t> fBlockEntry; //! First entry of the basket of each blk, in the order of the prefetch
+   std::vector<Int_t>    fUnzipOrder; //! The blks in the order they will be read, i.e. by first entry
+   Int_t       fNextToSchedule;   //! Next position in fUnzipOrder to give to the task pool
+   Int_t       fNTasks;           //! Number of unzip tasks queued or running, including dropped ones
+   Bool_t      fUnzipStarted;     //! The blks of this cycle have been transferred, the tasks can run
+
    // Members use to keep statistics
    Int_t       fNUnzip;           //! number of blocks that were unzipped
    Int_t       fNFound;           //! number of blocks that were found in the cache
    Int_t       fNStalls;          //! number of hits which caused a stall
    Int_t       fNMissed;          //! number of blocks that were not found in the cache and were unzipped
 
-   std::queue<Int_t>       fActiveBlks; // The blocks which are active now
-
 private:
    TTreeCacheUnzip(const TTreeCacheUnzip &);            //this class cannot be copied
    TTreeCacheUnzip& operator=(const TTreeCacheUnzip &);
@@ -89,9 +89,11 @@ private:
    Int_t fCompBufferSize;
 
    // Private methods
+   void  ExpandUnzipArrays();
    void  Init();
-   Int_t StartThreadUnzip(Int_t nthreads);
-   Int_t StopThreadUnzip();
+   void  ScheduleUnzip();
+   void  UnzipBlock(Int_t index, Int_t cycle);
+   void  WaitForTasks();
 
 public:
    TTreeCacheUnzip();
@@ -105,36 +107,29 @@ public:
    virtual void        StopLearningPhase();
    void                UpdateBranches(TTree *tree);
 
-   // Methods related to the thread
+   // Methods related to the parallelism
    static EParUnzipMode GetParallelUnzip();
    static Bool_t        IsParallelUnzip();
    static Int_t         SetParallelUnzip(TTreeCacheUnzip::EParUnzipMode option = TTreeCacheUnzip::kEnable);
 
-   Bool_t               IsActiveThread();
-   Bool_t               IsQueueEmpty();
-
-   void                 WaitUnzipStartSignal();
-   void                 SendUnzipStartSignal(Bool_t broadcast);
-
    // Unzipping related methods
    Int_t          GetRecordHeader(char *buf, Int_t maxbytes, Int_t &nbytes, Int_t &objlen, Int_t &keylen);
    virtual void   ResetCache();
    virtual Int_t  GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_t *free);
+   Long64_t       GetUnzipBufferSize() const { return fUnzipBufferSize; }
    virtual Int_t  SetBufferSize(Int_t buffersize);
    void           SetUnzipBufferSize(Long64_t bufferSize);
    static void    SetUnzipRelBufferSize(Float_t relbufferSize);
    Int_t          UnzipBuffer(char **dest, char *src);
-   Int_t          UnzipCache(Int_t &startindex, Int_t &locbuffsz, char *&locbuff);
 
    // Methods to get stats
    Int_t  GetNUnzip() { return fNUnzip; }
    Int_t  GetNFound() { return fNFound; }
    Int_t  GetNMissed(){ return fNMissed; }
+   Int_t  GetNStalls(){ return fNStalls; }
 
    void Print(Option_t* option = "") const;
 
-   // static members
-   static void* UnzipLoop(void *arg);
    ClassDef(TTreeCacheUnzip,0)  //Specialization of TTreeCache for parallel unzipping
 };
 
@@ -925,9 +925,10 @@ Int_t TBasket::WriteBuffer()
    if (!file->IsWritable()) {
       return -1;
    }
-   fMotherDir = file; // fBranch->GetDirectory();
 
    if (R__unlikely(fBufferRef->TestBit(TBufferFile::kNotDecompressed))) {
+      fMotherDir = file; // fBranch->GetDirectory();
+
       // Read the basket information that was saved inside the buffer.
       Bool_t writing = fBufferRef->IsWriting();
       fBufferRef->SetReadMode();
@@ -949,6 +950,24 @@ Int_t TBasket::WriteBuffer()
       return nBytes>0 ? fKeylen+nout : -1;
    }
 
+   PrepareWrite(file, kFALSE);
+
+   Int_t nout = CompressBuffer(fBranch->GetCompressionLevel(), fBranch->GetCompressionAlgorithm(), file);
+   if (nout < 0) return -1;
+
+   return WriteCompressedBuffer(nout, file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// First step of WriteBuffer: close the buffer for writing to file.
+/// If ownCompressedBuffer is true, the basket stops using the compressed
+/// buffer shared with the other baskets of the tree, so that it can be
+/// compressed in parallel to them.
+
+void TBasket::PrepareWrite(TFile *file, Bool_t ownCompressedBuffer)
+{
+   fMotherDir = file; // fBranch->GetDirectory();
+
    // Transfer fEntryOffset table at the end of fBuffer.
    fLast = fBufferRef->Length();
    if (fEntryOffset) {
@@ -966,59 +985,79 @@ Int_t TBasket::WriteBuffer()
       }
    }
 
-   Int_t lbuf, nout, noutot, bufmax, nzip;
-   lbuf       = fBufferRef->Length();
-   fObjlen    = lbuf - fKeylen;
+   fObjlen    = fBufferRef->Length() - fKeylen;
 
    fHeaderOnly = kTRUE;
    fCycle = fBranch->GetWriteBasket();
-   Int_t cxlevel = fBranch->GetCompressionLevel();
-   Int_t cxAlgorithm = fBranch->GetCompressionAlgorithm();
-   if (cxlevel > 0) {
-      Int_t nbuffers = 1 + (fObjlen - 1) / kMAXZIPBUF;
-      Int_t buflen = fKeylen + fObjlen + 9 * nbuffers + 28; //add 28 bytes in case object is placed in a deleted gap
-      InitializeCompressedBuffer(buflen, file);
-      if (!fCompressedBufferRef) {
-         Warning("WriteBuffer", "Unable to allocate the compressed buffer");
-         return -1;
-      }
-      fCompressedBufferRef->SetWriteMode();
-      fBuffer = fCompressedBufferRef->Buffer();
-      char *objbuf = fBufferRef->Buffer() + fKeylen;
-      char *bufcur = &fBuffer[fKeylen];
-      noutot = 0;
-      nzip   = 0;
-      for (Int_t i = 0; i < nbuffers; ++i) {
-         if (i == nbuffers - 1) bufmax = fObjlen - nzip;
-         else bufmax = kMAXZIPBUF;
-         //compress the buffer
-         R__zipMultipleAlgorithm(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm);
-
-         // test if buffer has really been compressed. In case of small buffers
-         // when the buffer contains random data, it may happen that the compressed
-         // buffer is larger than the input. In this case, we write the original uncompressed buffer
-         if (nout == 0 || nout >= fObjlen) {
-            nout = fObjlen;
-            // We used to delete fBuffer here, we no longer want to since
-            // the buffer (held by fCompressedBufferRef) might be re-used later.
-            fBuffer = fBufferRef->Buffer();
-            Create(fObjlen,file);
-            fBufferRef->SetBufferOffset(0);
-
-            Streamer(*fBufferRef);         //write key itself again
-            if ((nout+fKeylen)>buflen) {
-               Warning("WriteBuffer","Possible memory corruption due to compression algorithm, wrote %d bytes past the end of a block of %d bytes. fNbytes=%d, fObjLen=%d, fKeylen=%d",
-                  (nout+fKeylen-buflen),buflen,fNbytes,fObjlen,fKeylen);
-            }
-            goto WriteFile;
+
+   if (ownCompressedBuffer && !fOwnsCompressedBuffer) {
+      fCompressedBufferRef = 0; // InitializeCompressedBuffer allocates our own
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Second step of WriteBuffer: compress the buffer into the compressed buffer.
+/// Does not use the file (only as parent of a new buffer) nor the branch, so
+/// that it can run on a worker thread.
+///
+/// The function returns the size of the compressed data, 0 if the data are
+/// written uncompressed and -1 if the compressed buffer cannot be allocated.
+
+Int_t TBasket::CompressBuffer(Int_t cxlevel, Int_t cxAlgorithm, TFile *file)
+{
+   if (cxlevel <= 0) return 0;
+
+   Int_t nout, noutot, bufmax, nzip;
+   Int_t nbuffers = 1 + (fObjlen - 1) / kMAXZIPBUF;
+   Int_t buflen = fKeylen + fObjlen + 9 * nbuffers + 28; //add 28 bytes in case object is placed in a deleted gap
+   InitializeCompressedBuffer(buflen, file);
+   if (!fCompressedBufferRef) {
+      Warning("WriteBuffer", "Unable to allocate the compressed buffer");
+      return -1;
+   }
+   fCompressedBufferRef->SetWriteMode();
+   char *objbuf = fBufferRef->Buffer() + fKeylen;
+   char *bufcur = &fCompressedBufferRef->Buffer()[fKeylen];
+   noutot = 0;
+   nzip   = 0;
+   for (Int_t i = 0; i < nbuffers; ++i) {
+      if (i == nbuffers - 1) bufmax = fObjlen - nzip;
+      else bufmax = kMAXZIPBUF;
+      //compress the buffer
+      R__zipMultipleAlgorithm(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm);
+
+      // test if buffer has really been compressed. In case of small buffers
+      // when the buffer contains random data, it may happen that the compressed
+      // buffer is larger than the input. In this case, we write the original uncompressed buffer
+      if (nout == 0 || nout >= fObjlen) {
+         // We used to delete fBuffer here, we no longer want to since
+         // the buffer (held by fCompressedBufferRef) might be re-used later.
+         if ((fObjlen+fKeylen)>buflen) {
+            Warning("WriteBuffer","Possible memory corruption due to compression algorithm, wrote %d bytes past the end of a block of %d bytes. fNbytes=%d, fObjLen=%d, fKeylen=%d",
+               (fObjlen+fKeylen-buflen),buflen,fNbytes,fObjlen,fKeylen);
          }
-         bufcur += nout;
-         noutot += nout;
-         objbuf += kMAXZIPBUF;
-         nzip   += kMAXZIPBUF;
+         return 0;
       }
-      nout = noutot;
-      Create(noutot,file);
+      bufcur += nout;
+      noutot += nout;
+      objbuf += kMAXZIPBUF;
+      nzip   += kMAXZIPBUF;
+   }
+   return noutot;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Last step of WriteBuffer: reserve the space in the file and write the key
+/// with the compressed data (nout > 0) or the uncompressed data (nout == 0).
+///
+/// The function returns the number of bytes committed to the memory.
+/// If a write error occurs, the number of bytes returned is -1.
+
+Int_t TBasket::WriteCompressedBuffer(Int_t nout, TFile *file)
+{
+   if (nout > 0) {
+      fBuffer = fCompressedBufferRef->Buffer();
+      Create(nout,file);
       fBufferRef->SetBufferOffset(0);
 
       Streamer(*fBufferRef);         //write key itself again
@@ -1032,7 +1071,6 @@ Int_t TBasket::WriteBuffer()
       nout = fObjlen;
    }
 
-WriteFile:
    Int_t nBytes = WriteFileKeepBuffer();
    fHeaderOnly = kFALSE;
    return nBytes>0 ? fKeylen+nout : -1;
@@ -0,0 +1,215 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/** \class TBasketCompressionQueue
+Full baskets of a TTree being compressed in parallel.
+
+TBranch::WriteBasket hands a full basket to the queue instead of writing it.
+The basket is closed for writing (TBasket::PrepareWrite) and compressed by a
+task on the global TTaskPool (TBasket::CompressBuffer), while the branch goes
+on with a new basket. The compressed baskets are written to the file
+(TBasket::WriteCompressedBuffer) on the thread filling the tree - the TFile is
+not thread safe - strictly in the order they were queued, so that the file
+layout is the same as without parallel compression. This happens whenever the
+oldest basket is done (TTree::Fill), when the maximum number of queued baskets
+is reached, and for all baskets in TTree::FlushBaskets.
+*/
+
+#include "TBasketCompressionQueue.h"
+#include "TBasket.h"
+#include "TBranch.h"
+#include "TBufferFile.h"
+#include "TError.h"
+#include "TFile.h"
+#include "TTaskPool.h"
+#include "TTree.h"
+#include "Compression.h"
+#include "RZip.h"
+
+// The compression algorithm used for ROOT::kUseGlobalSetting - see core/zip
+extern "C" int R__ZipMode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// Queue holding at most maxInFlight baskets.
+
+TBasketCompressionQueue::TBasketCompressionQueue(Int_t maxInFlight) :
+   fMaxInFlight(maxInFlight > 0 ? maxInFlight : 1), fNerrors(0), fMaxZipBytes(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor - the baskets not yet written are lost, call Flush() before.
+
+TBasketCompressionQueue::~TBasketCompressionQueue()
+{
+   Discard();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait for the compression of all baskets and delete them without writing.
+
+void TBasketCompressionQueue::Discard()
+{
+   while (!fItems.empty()) {
+      TItem *item = fItems.front();
+      Wait(item);
+      fItems.pop_front();
+      fMaxZipBytes -= item->fMaxNout;
+      item->fBasket->DropBuffers();
+      delete item->fBasket;
+      delete item;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait for and write all baskets. Returns the number of bytes written or -1
+/// if writing any basket failed since the last Flush().
+
+Int_t TBasketCompressionQueue::Flush()
+{
+   Int_t nbytes = 0;
+   while (!fItems.empty()) {
+      Int_t nout = WriteOldest();
+      if (nout > 0) nbytes += nout;
+   }
+   if (fNerrors) {
+      fNerrors = 0;
+      return -1;
+   }
+   return nbytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// True if the compression of the basket is finished.
+
+Bool_t TBasketCompressionQueue::IsDone(TItem *item)
+{
+   std::lock_guard<std::mutex> lock(fMutex);
+   return item->fDone;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Queue the basket number where of the branch for compression. Returns kFALSE
+/// if the basket has to be written directly: not a plain TBasket, not
+/// compressed, no writable file or compressed with the old algorithm, which is
+/// not thread safe.
+///
+/// Writes the oldest baskets first if the queue is full.
+
+Bool_t TBasketCompressionQueue::Submit(TBranch *branch, TBasket *basket, Int_t where)
+{
+   if (basket->IsA() != TBasket::Class()) return kFALSE;
+   if (basket->GetBufferRef()->TestBit(TBufferFile::kNotDecompressed)) return kFALSE;
+
+   Int_t cxlevel = branch->GetCompressionLevel();
+   Int_t cxAlgorithm = branch->GetCompressionAlgorithm();
+   if (cxlevel <= 0) return kFALSE;
+   if (cxAlgorithm == ROOT::kOldCompressionAlgo ||
+       (cxAlgorithm == ROOT::kUseGlobalSetting && (R__ZipMode == 0 || R__ZipMode == 3))) {
+      return kFALSE;
+   }
+
+   const Int_t kWrite = 1;
+   TFile *file = branch->GetFile(kWrite);
+   if (!file || !file->IsWritable()) return kFALSE;
+
+   while ((Int_t)fItems.size() >= fMaxInFlight) WriteOldest();
+
+   basket->PrepareWrite(file, kTRUE);
+
+   TItem *item = new TItem;
+   item->fBranch = branch;
+   item->fBasket = basket;
+   item->fFile   = file;
+   item->fWhere  = where;
+   item->fNout   = -1;
+   item->fDone   = kFALSE;
+   // The key and the data, uncompressed if compressing does not pay, plus
+   // the headers of the compressed blocks (see TBasket::CompressBuffer).
+   Int_t objlen = basket->GetObjlen();
+   item->fMaxNout = basket->GetKeylen() + objlen + 9 * (1 + (objlen - 1) / kMAXZIPBUF);
+   fMaxZipBytes += item->fMaxNout;
+   fItems.push_back(item);
+
+   TTaskPool::GetGlobal()->Submit([this, item, cxlevel, cxAlgorithm]() {
+      Int_t nout = item->fBasket->CompressBuffer(cxlevel, cxAlgorithm, item->fFile);
+      {
+         std::lock_guard<std::mutex> lock(fMutex);
+         item->fNout = nout;
+         item->fDone = kTRUE;
+      }
+      fCond.notify_all();
+   });
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait for the compression of the basket, helping the pool meanwhile.
+
+void TBasketCompressionQueue::Wait(TItem *item)
+{
+   TTaskPool *pool = TTaskPool::GetGlobal();
+   while (!IsDone(item)) {
+      if (pool->RunOne()) continue;
+      std::unique_lock<std::mutex> lock(fMutex);
+      fCond.wait(lock, [item] { return item->fDone; });
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write the baskets at the head of the queue whose compression is finished.
+/// Returns the number of bytes written.
+
+Int_t TBasketCompressionQueue::WriteFinished()
+{
+   Int_t nbytes = 0;
+   while (!fItems.empty() && IsDone(fItems.front())) {
+      Int_t nout = WriteOldest();
+      if (nout > 0) nbytes += nout;
+   }
+   return nbytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait for the oldest basket and write it, with the bookkeeping done by
+/// TBranch::WriteBasket for a basket written directly. Returns the number of
+/// bytes written or -1 in case of error.
+
+Int_t TBasketCompressionQueue::WriteOldest()
+{
+   TItem *item = fItems.front();
+   Wait(item);
+   fItems.pop_front();
+   fMaxZipBytes -= item->fMaxNout;
+
+   TBranch *branch = item->fBranch;
+   TBasket *basket = item->fBasket;
+   Int_t where = item->fWhere;
+
+   Int_t nout = item->fNout < 0 ? -1 : basket->WriteCompressedBuffer(item->fNout, item->fFile);
+   branch->fBasketBytes[where] = basket->GetNbytes();
+   branch->fBasketSeek[where]  = basket->GetSeekKey();
+   if (nout > 0) {
+      Int_t addbytes = basket->GetObjlen() + basket->GetKeylen();
+      branch->fZipBytes += nout;
+      branch->fTotBytes += addbytes;
+      branch->GetTree()->AddTotBytes(addbytes);
+      branch->GetTree()->AddZipBytes(nout);
+   } else {
+      ::Error("TBasketCompressionQueue::WriteOldest", "Failed writing basket %d of branch %s, nbytes=%d",
+              where, branch->GetName(), nout);
+      ++fNerrors;
+   }
+
+   basket->DropBuffers();
+   delete basket;
+   delete item;
+   return nout;
+}
@@ -13,6 +13,7 @@
 
 #include "Compression.h"
 #include "TBasket.h"
+#include "TBasketCompressionQueue.h"
 #include "TBranchBrowsable.h"
 #include "TBrowser.h"
 #include "TClass.h"
@@ -1092,6 +1093,11 @@ TBasket* TBranch::GetBasket(Int_t basketnumber)
    if (basket) return basket;
    if (basketnumber == fWriteBasket) return 0;
 
+   // a basket still being compressed in parallel must be written first
+   if (fBasketSeek[basketnumber] == 0 && fTree && fTree->GetCompressionQueue()) {
+      fTree->GetCompressionQueue()->Flush();
+   }
+
    // create/decode basket parameters from buffer
    TFile *file = GetFile(0);
    if (file == 0) {
@@ -1157,6 +1163,73 @@ TList* TBranch::GetBrowsables() {
    return fBrowsables;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Give direct access to the content of the basket holding entry, for bulk
+/// reading of a branch with a single leaf of fixed size (a basic type or a
+/// fixed size array of it, see TTreeReaderBulk).
+///
+/// On success, data points to the first entry of the basket, stored in the
+/// ROOT file format (big endian, TLeaf::GetLenType() * TLeaf::GetLen() bytes
+/// per entry), first is set to the number of the first entry of the basket
+/// and the number of entries in the basket is returned. The data stays valid
+/// until the next basket of the branch is read.
+///
+/// The leaves are not filled, hence GetReadEntry() is left unchanged: code
+/// skipping TBranch::GetEntry for the entry last read (e.g. TTreeFormula)
+/// still reads it when it is mixed with bulk reading.
+///
+/// Returns 0 if entry does not exist and -1 if the branch cannot be read this
+/// way or in case of I/O error; TBranch::GetEntry must be used instead.
+
+Int_t TBranch::GetBulkEntries(Long64_t entry, const char *&data, Long64_t &first)
+{
+   if (IsA() != TBranch::Class() || fLeaves.GetEntriesFast() != 1) {
+      return -1;
+   }
+   TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(0);
+   if (leaf->GetLeafCount() || leaf->IsA() == TLeafC::Class()) {
+      return -1;
+   }
+   if ((entry < fFirstEntry) || (entry >= fEntryNumber)) {
+      return 0;
+   }
+
+   // Same basket bookkeeping as TBranch::GetEntry, so that both can be mixed.
+   // fReadEntry is left unchanged since the leaves are not filled.
+   if (entry < fFirstBasketEntry || entry >= fNextBasketEntry || !fCurrentBasket) {
+      fReadBasket = TMath::BinarySearch(fWriteBasket + 1, fBasketEntry, entry);
+      if (fReadBasket < 0) {
+         fNextBasketEntry = -1;
+         Error("GetBulkEntries", "In the branch %s, no basket contains the entry %lld\n", GetName(), entry);
+         return -1;
+      }
+      if (fReadBasket == fWriteBasket) {
+         fNextBasketEntry = fEntryNumber;
+      } else {
+         fNextBasketEntry = fBasketEntry[fReadBasket+1];
+      }
+      fFirstBasketEntry = fBasketEntry[fReadBasket];
+      fCurrentBasket = GetBasket(fReadBasket);
+      if (!fCurrentBasket) {
+         fFirstBasketEntry = -1;
+         fNextBasketEntry = -1;
+         return -1;
+      }
+   }
+   TBasket *basket = fCurrentBasket;
+   TBuffer *buf = basket->GetBufferRef();
+   if (!buf || basket->GetEntryOffset()) {
+      // Very old file or entries of varying size.
+      return -1;
+   }
+   if (R__unlikely(!buf->IsReading())) {
+      basket->SetReadMode();
+   }
+   first = fFirstBasketEntry;
+   data = buf->Buffer() + basket->GetKeylen();
+   return fNextBasketEntry - fFirstBasketEntry;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return the name of the user class whose content is stored in this branch,
 /// if any.  If this branch was created using the 'leaflist' technique, this
@@ -2565,6 +2638,26 @@ Int_t TBranch::WriteBasket(TBasket* basket, Int_t where)
       fEntryOffsetLen = 2*nevbuf; // assume some fluctuations.
    }
 
+   TBasketCompressionQueue *queue = fTree->GetCompressionQueue();
+   if (queue && where==fWriteBasket && queue->Submit(this, basket, where)) {
+      // The basket now belongs to the queue, which writes it and updates
+      // fBasketBytes, fBasketSeek and the byte counts once it is compressed.
+      // The next Fill() starts a new basket.
+      fBaskets[where] = 0;
+      --fNBaskets;
+      if (basket == fCurrentBasket) {
+         fCurrentBasket    = 0;
+         fFirstBasketEntry = -1;
+         fNextBasketEntry  = -1;
+      }
+      ++fWriteBasket;
+      if (fWriteBasket >= fMaxBaskets) {
+         ExpandBasketArrays();
+      }
+      fBasketEntry[fWriteBasket] = fEntryNumber;
+      return 0;
+   }
+
    Int_t nout  = basket->WriteBuffer();    //  Write buffer
    fBasketBytes[where]  = basket->GetNbytes();
    fBasketSeek[where]   = basket->GetSeekKey();
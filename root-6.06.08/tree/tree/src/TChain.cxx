@@ -27,6 +27,7 @@ the trees in the chain.
 #include "TBranch.h"
 #include "TBrowser.h"
 #include "TChainElement.h"
+#include "TChainMetadata.h"
 #include "TClass.h"
 #include "TCut.h"
 #include "TError.h"
@@ -69,6 +70,7 @@ TChain::TChain()
 , fFiles(0)
 , fStatus(0)
 , fProofChain(0)
+, fMetadata(0)
 {
    fTreeOffset = new Long64_t[fTreeOffsetLen];
    fFiles = new TObjArray(fTreeOffsetLen);
@@ -142,6 +144,7 @@ TChain::TChain(const char* name, const char* title)
 , fFiles(0)
 , fStatus(0)
 , fProofChain(0)
+, fMetadata(0)
 {
    //
    //*-*
@@ -174,6 +177,7 @@ TChain::~TChain()
    gROOT->GetListOfCleanups()->Remove(this);
 
    SafeDelete(fProofChain);
+   SafeDelete(fMetadata);
    fStatus->Delete();
    delete fStatus;
    fStatus = 0;
@@ -494,10 +498,17 @@ Int_t TChain::AddFile(const char* name, Long64_t nentries /* = TTree::kMaxEntrie
       // Note: This deletes the tree we fetched.
       delete file;
       file = 0;
+   } else if (nentries == TTree::kMaxEntries && fMetadata) {
+      // The number of entries may be known from the metadata cache.
+      TChainMetadata::TFileEntry *cached = fMetadata->Find(filename, treename);
+      if (cached) {
+         nentries = cached->GetEntries();
+      }
    }
 
    if (nentries > 0) {
-      if (nentries != TTree::kMaxEntries) {
+      // The offset is unknown as soon as one of the previous trees is.
+      if (nentries != TTree::kMaxEntries && fTreeOffset[fNtrees] != TTree::kMaxEntries) {
          fTreeOffset[fNtrees+1] = fTreeOffset[fNtrees] + nentries;
          fEntries += nentries;
       } else {
@@ -1507,15 +1518,27 @@ Long64_t TChain::LoadTree(Long64_t entry)
    Long64_t nentries = 0;
    if (fTree) {
       nentries = fTree->GetEntries();
+      if (fMetadata) {
+         fMetadata->Fill(element->GetTitle(), element->GetName(), fTree);
+      }
    }
 
    if (fTreeOffset[fTreeNumber+1] != (fTreeOffset[fTreeNumber] + nentries)) {
       fTreeOffset[fTreeNumber+1] = fTreeOffset[fTreeNumber] + nentries;
-      fEntries = fTreeOffset[fNtrees];
       element->SetNumberEntries(nentries);
+      // Propagate to the following trees whose number of entries is already
+      // known (given to AddFile or taken from the metadata cache), so that
+      // they do not have to be opened to compute the offsets.
+      Bool_t known = kTRUE;
+      for (Int_t i = fTreeNumber + 1; i < fNtrees; ++i) {
+         Long64_t n = ((TChainElement*) fFiles->UncheckedAt(i))->GetEntries();
+         known = known && n != TTree::kMaxEntries;
+         fTreeOffset[i+1] = known ? fTreeOffset[i] + n : TTree::kMaxEntries;
+      }
+      fEntries = fTreeOffset[fNtrees];
       // Below we must test >= in case the tree has no entries.
       if (entry >= fTreeOffset[fTreeNumber+1]) {
-         if ((fTreeNumber < (fNtrees - 1)) && (entry < fTreeOffset[fTreeNumber+2])) {
+         if ((fTreeNumber < (fNtrees - 1)) && (entry < fTreeOffset[fNtrees])) {
             return LoadTree(entry);
          } else {
             treeReadEntry = fReadEntry = -2;
@@ -2335,6 +2358,17 @@ void TChain::ResetBranchAddresses()
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Write the metadata cache to its sidecar file if it has changed since it
+/// was read. See SetMetadataCache().
+/// Returns the number of bytes written, 0 if there was nothing to write and
+/// -1 in case of error.
+
+Int_t TChain::SaveMetadataCache()
+{
+   return fMetadata ? fMetadata->Save() : 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set branch address.
 ///
@@ -2707,6 +2741,60 @@ void TChain::SetEventList(TEventList *evlist)
    SetEntryList(enlist);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Use the sidecar file cachefile to cache the description of the trees of
+/// the chain: number of entries and range of the persistent TTreeIndex (see
+/// TChainMetadata).
+///
+/// The number of entries of the files already in the chain, and of the files
+/// added later with the default number of entries, is taken from the cache,
+/// so that GetEntries() and TChainIndex only open the files the cache does
+/// not know about. The files are then opened lazily, when an entry is read.
+/// The description of each tree loaded is added to the cache in memory. It is
+/// only written to cachefile by SaveMetadataCache().
+///
+/// If cachefile does not exist it is created. Passing an empty name stops
+/// using the cache.
+///
+/// ~~~ {.cpp}
+///    TChain chain("T");
+///    chain.SetMetadataCache("mychain.meta.root");
+///    chain.Add("data/run*.root");
+///    chain.GetEntries();          // opens the files only the first time
+///    chain.SaveMetadataCache();
+/// ~~~
+
+void TChain::SetMetadataCache(const char *cachefile)
+{
+   SafeDelete(fMetadata);
+   if (!cachefile || !cachefile[0]) {
+      return;
+   }
+   fMetadata = TChainMetadata::Open(GetName(), cachefile);
+
+   // Take the entries of the trees not yet looked at from the cache and
+   // recompute the offsets.
+   Bool_t known = kTRUE;
+   for (Int_t i = 0; i < fNtrees; ++i) {
+      TChainElement *element = (TChainElement*) fFiles->UncheckedAt(i);
+      if (element->GetEntries() == TTree::kMaxEntries) {
+         TChainMetadata::TFileEntry *cached = fMetadata->Find(element->GetTitle(), element->GetName());
+         if (cached) {
+            element->SetNumberEntries(cached->GetEntries());
+         }
+      }
+      if (known && element->GetEntries() != TTree::kMaxEntries) {
+         fTreeOffset[i+1] = fTreeOffset[i] + element->GetEntries();
+      } else {
+         known = kFALSE;
+         fTreeOffset[i+1] = TTree::kMaxEntries;
+      }
+   }
+   fEntries = known ? fTreeOffset[fNtrees] : TTree::kMaxEntries;
+   if (fProofChain)
+      ResetBit(kProofUptodate);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set number of entries per packet for parallel root.
 
@@ -0,0 +1,352 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/** \class TChainMetadata
+Cache of the description of the trees of a TChain, kept in a sidecar ROOT
+file so that the files of the chain do not have to be opened to know how many
+entries they hold.
+
+For each tree of the chain (a TChainMetadata::TFileEntry named after the file
+and titled after the name of the tree in the file, as given to TChain::Add)
+it records the number of entries and, when the tree has a persistent
+TTreeIndex used by a TChainIndex, the range of the index values.
+
+The cache is normally used through TChain::SetMetadataCache():
+~~~ {.cpp}
+   TChain chain("T");
+   chain.SetMetadataCache("mychain.meta.root");
+   chain.Add("data/run*.root");
+   chain.GetEntries();          // only the files not in the cache are opened
+   chain.SaveMetadataCache();   // write what was learnt to the sidecar file
+~~~
+An entry of a local file is discarded when the size or the modification time
+of the file differ from the ones recorded. Entries of remote files are
+trusted as they are: the cache must be cleared (see Clear()) when remote
+files are replaced.
+
+The sidecar file is only written by Save(), never implicitly. It is opened in
+UPDATE mode and may hold the caches of
+several chains, one per chain name. It is not meant to be written by several
+processes at the same time.
+*/
+
+#include "TChainMetadata.h"
+
+#include "TDirectory.h"
+#include "TError.h"
+#include "TFile.h"
+#include "THashList.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TTree.h"
+#include "TUrl.h"
+#include "Riostream.h"
+
+namespace {
+   // Get the size and modification time of filename if it is a local file.
+   Bool_t GetLocalFileInfo(const char *filename, Long64_t &size, Long_t &modtime)
+   {
+      TUrl url(filename, kTRUE);
+      if (strcmp(url.GetProtocol(), "file")) {
+         return kFALSE;
+      }
+      FileStat_t st;
+      if (gSystem->GetPathInfo(url.GetFile(), st)) {
+         return kFALSE;
+      }
+      size = st.fSize;
+      modtime = st.fMtime;
+      return kTRUE;
+   }
+}
+
+ClassImp(TChainMetadata)
+ClassImp(TChainMetadata::TFileEntry)
+
+////////////////////////////////////////////////////////////////////////////////
+/// Default constructor, for I/O.
+
+TChainMetadata::TFileEntry::TFileEntry() : TNamed(), fEntries(0), fFileSize(-1), fModTime(0),
+   fMinIndexValue(0), fMinIndexValMinor(0), fMaxIndexValue(0), fMaxIndexValMinor(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create the description of the tree treename in the file filename.
+
+TChainMetadata::TFileEntry::TFileEntry(const char *filename, const char *treename) :
+   TNamed(filename, treename), fEntries(0), fFileSize(-1), fModTime(0),
+   fMinIndexValue(0), fMinIndexValMinor(0), fMaxIndexValue(0), fMaxIndexValMinor(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Record the description of tree, which must be the tree this entry is
+/// about. The range of the index is reset.
+
+void TChainMetadata::TFileEntry::Fill(TTree *tree)
+{
+   fEntries = tree->GetEntries();
+
+   if (!GetLocalFileInfo(GetName(), fFileSize, fModTime)) {
+      fFileSize = -1;
+      fModTime = 0;
+   }
+
+   fIndexMajor = "";
+   fIndexMinor = "";
+   fMinIndexValue = fMinIndexValMinor = fMaxIndexValue = fMaxIndexValMinor = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Get the smallest and largest (major, minor) pairs of the index.
+
+void TChainMetadata::TFileEntry::GetIndexRange(Long64_t &minMajor, Long64_t &minMinor,
+                                               Long64_t &maxMajor, Long64_t &maxMinor) const
+{
+   minMajor = fMinIndexValue;
+   minMinor = fMinIndexValMinor;
+   maxMajor = fMaxIndexValue;
+   maxMinor = fMaxIndexValMinor;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the range of a persistent index with the given major and
+/// minor names has been recorded.
+
+Bool_t TChainMetadata::TFileEntry::HasIndex(const char *majorname, const char *minorname) const
+{
+   return !fIndexMajor.IsNull() && fIndexMajor == majorname && fIndexMinor == minorname;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return false if the file is local and has changed since the entry was
+/// recorded.
+
+Bool_t TChainMetadata::TFileEntry::IsValid() const
+{
+   if (fFileSize < 0) {
+      return kTRUE;
+   }
+   Long64_t size;
+   Long_t modtime;
+   if (!GetLocalFileInfo(GetName(), size, modtime)) {
+      return kFALSE;
+   }
+   return size == fFileSize && modtime == fModTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Record the range of the persistent index (majorname, minorname) of the tree.
+
+void TChainMetadata::TFileEntry::SetIndexRange(const char *majorname, const char *minorname,
+                                               Long64_t minMajor, Long64_t minMinor,
+                                               Long64_t maxMajor, Long64_t maxMinor)
+{
+   fIndexMajor = majorname;
+   fIndexMinor = minorname;
+   fMinIndexValue = minMajor;
+   fMinIndexValMinor = minMinor;
+   fMaxIndexValue = maxMajor;
+   fMaxIndexValMinor = maxMinor;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Default constructor, for I/O.
+
+TChainMetadata::TChainMetadata() : TNamed(), fModified(kFALSE)
+{
+   fFiles = new THashList();
+   fFiles->SetOwner();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create an empty cache for the chain called name, to be saved in the file
+/// cachefile.
+
+TChainMetadata::TChainMetadata(const char *name, const char *cachefile) :
+   TNamed(name, "TChain metadata"), fCacheFile(cachefile), fModified(kFALSE)
+{
+   fFiles = new THashList();
+   fFiles->SetOwner();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor. The cache is not saved, see Save().
+
+TChainMetadata::~TChainMetadata()
+{
+   delete fFiles;
+   fFiles = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Forget all the entries.
+
+void TChainMetadata::Clear(Option_t *)
+{
+   if (fFiles->GetSize()) {
+      fFiles->Delete();
+      fModified = kTRUE;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Record the description of tree, read as treename (which may include the
+/// path of the tree in the file, e.g. "dir/T") from the file filename.
+/// Nothing is done if a valid entry with the same number of entries exists.
+
+TChainMetadata::TFileEntry *TChainMetadata::Fill(const char *filename, const char *treename, TTree *tree)
+{
+   if (!filename || !treename || !tree) {
+      return 0;
+   }
+   TFileEntry *entry = Find(filename, treename);
+   if (entry && entry->GetEntries() == tree->GetEntries()) {
+      return entry;
+   }
+   if (!entry) {
+      entry = new TFileEntry(filename, treename);
+      fFiles->Add(entry);
+   }
+   entry->Fill(tree);
+   fModified = kTRUE;
+   return entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the entry of the tree treename in the file filename, or of the
+/// first tree of the file if treename is empty, 0 if there is none.
+/// An entry whose file has changed since it was recorded is deleted and 0 is
+/// returned.
+
+TChainMetadata::TFileEntry *TChainMetadata::Find(const char *filename, const char *treename)
+{
+   if (!filename) {
+      return 0;
+   }
+   const TList *bucket = fFiles->GetListForObject(filename);
+   if (!bucket) {
+      return 0;
+   }
+   TFileEntry *entry = 0;
+   TIter next(bucket);
+   while (TFileEntry *candidate = (TFileEntry*)next()) {
+      if (!strcmp(candidate->GetName(), filename) &&
+          (!treename || !treename[0] || !strcmp(candidate->GetTitle(), treename))) {
+         entry = candidate;
+         break;
+      }
+   }
+   if (entry && !entry->IsValid()) {
+      fFiles->Remove(entry);
+      delete entry;
+      entry = 0;
+      fModified = kTRUE;
+   }
+   return entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Print the entries.
+
+void TChainMetadata::Print(Option_t *) const
+{
+   std::cout << "TChainMetadata of " << GetName() << " (" << fCacheFile << "): "
+             << fFiles->GetSize() << " trees" << std::endl;
+   TIter next(fFiles);
+   while (TFileEntry *entry = (TFileEntry*)next()) {
+      TROOT::IndentLevel();
+      std::cout << "  " << entry->GetName() << " tree:" << entry->GetTitle()
+                << " entries=" << entry->GetEntries();
+      if (entry->GetIndexMajorName()[0]) {
+         std::cout << " index=" << entry->GetIndexMajorName() << "," << entry->GetIndexMinorName();
+      }
+      std::cout << std::endl;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write the cache to the sidecar file if it has been modified, replacing the
+/// previous version of the cache of this chain.
+/// Returns the number of bytes written, 0 if there was nothing to write or -1
+/// in case of error.
+
+Int_t TChainMetadata::Save()
+{
+   if (!fModified) {
+      return 0;
+   }
+   if (fCacheFile.IsNull()) {
+      Error("Save", "No sidecar file set for the metadata of %s", GetName());
+      return -1;
+   }
+   TDirectory::TContext ctxt;
+   TFile *file = TFile::Open(fCacheFile, "UPDATE");
+   if (!file || file->IsZombie()) {
+      Error("Save", "Cannot open the sidecar file %s", fCacheFile.Data());
+      delete file;
+      return -1;
+   }
+   Int_t nbytes = file->WriteTObject(this, GetName(), "WriteDelete");
+   delete file;
+   if (nbytes > 0) {
+      fModified = kFALSE;
+   }
+   return nbytes > 0 ? nbytes : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Record the range of the persistent index (majorname, minorname) of the tree
+/// treename in the file filename, which must already have an entry.
+
+void TChainMetadata::SetIndexRange(const char *filename, const char *treename,
+                                   const char *majorname, const char *minorname,
+                                   Long64_t minMajor, Long64_t minMinor,
+                                   Long64_t maxMajor, Long64_t maxMinor)
+{
+   TFileEntry *entry = Find(filename, treename);
+   if (!entry) {
+      return;
+   }
+   if (entry->HasIndex(majorname, minorname)) {
+      Long64_t m0, m1, m2, m3;
+      entry->GetIndexRange(m0, m1, m2, m3);
+      if (m0 == minMajor && m1 == minMinor && m2 == maxMajor && m3 == maxMinor) {
+         return;
+      }
+   }
+   entry->SetIndexRange(majorname, minorname, minMajor, minMinor, maxMajor, maxMinor);
+   fModified = kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the cache of the chain called name from the sidecar file cachefile.
+/// Returns an empty cache if the file does not exist or does not hold it.
+/// The caller owns the returned object.
+
+TChainMetadata *TChainMetadata::Open(const char *name, const char *cachefile)
+{
+   TChainMetadata *metadata = 0;
+   if (!gSystem->AccessPathName(cachefile)) {
+      TDirectory::TContext ctxt;
+      TFile *file = TFile::Open(cachefile, "READ");
+      if (file && !file->IsZombie()) {
+         file->GetObject(name, metadata);
+      }
+      delete file;
+   }
+   if (!metadata) {
+      return new TChainMetadata(name, cachefile);
+   }
+   metadata->fCacheFile = cachefile;
+   metadata->fModified = kFALSE;
+   return metadata;
+}
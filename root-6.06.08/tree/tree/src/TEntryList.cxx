@@ -25,7 +25,11 @@ There are two types of entry lists:
     numbers in the blocks is described in the TEntryListBlock class description, and
     this representation might be changed by calling OptimizeStorage() function
     (when the list is filled via the Enter() function, this is done automatically,
-    except for the last block).
+    except for the last block). The runs representation, compact for clustered
+    selections but not readable by older ROOT versions, is only used after
+    TEntryListBlock::SetUseRuns(kTRUE).
+    Add(), Subtract() and Intersect() combine the blocks of two lists for the same
+    TTree directly, without looping over the entries.
     Individual entry lists can be merged (functions Merge() and Add())
     to make an entry list for a TChain of corresponding TTrees.
 Begin_Macro(source)
@@ -53,6 +57,9 @@ End_Macro
 - __Subtract__() - if the lists are for the same TTree, removes the entries of the second
                list from the first list. If the lists are for TChains, loops over all
                sub-lists
+- __Intersect__() - keeps only the entries of the first list that are also in the
+               second list. The sub-lists of the first list for TTrees that are not
+               in the second list become empty.
 - __GetEntry(n)__ - returns the n-th entry number
 - __Next__()      - returns next entry number. Note, that this function is
                 much faster than GetEntry, and it's called when GetEntry() is called
@@ -1225,13 +1232,20 @@ void TEntryList::Subtract(const TEntryList *elist)
          //second list is also only for 1 tree
          if (!strcmp(elist->fTreeName.Data(),fTreeName.Data()) &&
              !strcmp(elist->fFileName.Data(),fFileName.Data())){
-            //same tree
-            Long64_t n2 = elist->GetN();
-            Long64_t entry;
-            for (Int_t i=0; i<n2; i++){
-               entry = (const_cast<TEntryList*>(elist))->GetEntry(i);
-               Remove(entry);
+            //same tree, subtract block by block
+            if (!elist->fBlocks) return;
+            TEntryListBlock *block1 = 0;
+            TEntryListBlock *block2 = 0;
+            Int_t nmin = TMath::Min(fNBlocks, elist->fNBlocks);
+            for (Int_t i=0; i<nmin; i++){
+               block1 = (TEntryListBlock*)fBlocks->UncheckedAt(i);
+               block2 = (TEntryListBlock*)elist->fBlocks->UncheckedAt(i);
+               Long64_t nold = block1->GetNPassed();
+               Long64_t nnew = block1->Subtract(block2);
+               fN = fN - nold + nnew;
             }
+            fLastIndexQueried = -1;
+            fLastIndexReturned = 0;
          } else {
             //different trees
             return;
@@ -1266,6 +1280,57 @@ void TEntryList::Subtract(const TEntryList *elist)
    return;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Keep only the entries of this entry list that are also contained in elist.
+/// The blocks of the two lists are combined a 16 bit word at a time, without
+/// looping over the entries.
+
+void TEntryList::Intersect(const TEntryList *elist)
+{
+   if (!elist) return;
+   if (!fLists){
+      if (!fBlocks) return;
+      if (elist->fLists){
+         //second list has sublists, try to find one for the same tree as this list
+         TIter next1(elist->GetLists());
+         TEntryList *templist = 0;
+         while ((templist = (TEntryList*)next1())){
+            if (!strcmp(templist->fTreeName.Data(),fTreeName.Data()) &&
+                !strcmp(templist->fFileName.Data(),fFileName.Data())){
+               Intersect(templist);
+               return;
+            }
+         }
+      }
+      //an empty block for the entries elist does not have
+      TEntryListBlock empty;
+      TEntryListBlock *block1 = 0;
+      TEntryListBlock *block2 = 0;
+      Bool_t same = !elist->fLists && elist->fBlocks &&
+                    !strcmp(elist->fTreeName.Data(),fTreeName.Data()) &&
+                    !strcmp(elist->fFileName.Data(),fFileName.Data());
+      for (Int_t i=0; i<fNBlocks; i++){
+         block1 = (TEntryListBlock*)fBlocks->UncheckedAt(i);
+         block2 = (same && i<elist->fNBlocks) ? (TEntryListBlock*)elist->fBlocks->UncheckedAt(i) : &empty;
+         Long64_t nold = block1->GetNPassed();
+         Long64_t nnew = block1->Intersect(block2);
+         fN = fN - nold + nnew;
+      }
+      fLastIndexQueried = -1;
+      fLastIndexReturned = 0;
+   } else {
+      //this list has sublists
+      TIter next2(fLists);
+      TEntryList *templist = 0;
+      Long64_t oldn=0;
+      while ((templist = (TEntryList*)next2())){
+         oldn = templist->GetN();
+         templist->Intersect(elist);
+         fN = fN - oldn + templist->GetN();
+      }
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 TEntryList operator||(TEntryList &elist1, TEntryList &elist2)
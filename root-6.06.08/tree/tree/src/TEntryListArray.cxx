@@ -617,6 +617,26 @@ TEntryListArray* TEntryListArray::SetEntry(Long64_t entry, TTree *tree)
    return newlist;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Keep only the entries that are also in elist (see TEntryList::Intersect).
+/// The sub-entries of the entries that are kept are not changed, the sub-lists
+/// of the entries that are removed are deleted.
+
+void TEntryListArray::Intersect(const TEntryList *elist)
+{
+   if (!elist) return;
+
+   TEntryList::Intersect(elist);
+   if (!fLists && fSubLists) {
+      TEntryListArray *e = 0;
+      TIter next(fSubLists);
+      while ((e = (TEntryListArray*) next())) {
+         if (!Contains(e->fEntry))
+            RemoveSubList(e);
+      }
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Remove all the entries (and subentries) of this entry list that are contained
 /// in elist.
@@ -12,16 +12,21 @@
 /** \class TEntryListBlock
 Used by TEntryList to store the entry numbers.
 
-There are 2 ways to represent entry numbers in a TEntryListBlock:
+There are 3 ways to represent entry numbers in a TEntryListBlock:
 
  1. as bits, where passing entry numbers are assigned 1, not passing - 0
  2. as a simple array of entry numbers
   - storing the numbers of entries that pass
   - storing the numbers of entries that don't pass
-
-In both cases, a UShort_t* is used. The second option is better in case
-less than 1/16 or more than 15/16 of entries pass the selection, and the representation can be
-changed by calling OptimizeStorage() function.
+ 3. as runs of consecutive passing entries, stored as the first and the last
+    entry of each run. This representation is only used after
+    SetUseRuns(kTRUE), see there for the compatibility of the files.
+
+In all cases, a UShort_t* is used. The second option is better in case
+less than 1/16 or more than 15/16 of entries pass the selection, the third one
+when the passing entries come in long runs (as for a selection on a sorted
+quantity or on time periods); OptimizeStorage() picks the smallest one
+allowed.
 When the block is being filled, it's always stored as bits, and the OptimizeStorage()
 function is called by TEntryList when it starts filling the next block. If
 Enter() or Remove() is called after OptimizeStorage(), representation is
@@ -36,16 +41,48 @@ End_Macro
  - __Merge__() - adds all entries from one block to the other. If the first block
              uses array representation, it's changed to bits representation only
              if the total number of passing entries is still less than kBlockSize
+ - __Intersect__(), __Subtract__() - keep only the entries that are also / are not
+             in the other block.
+             Like Merge(), they work on the bits representation, a 16 bit word at a time.
  - __GetEntry(n)__ - returns n-th non-zero entry.
  - __Next__()      - return next non-zero entry. In case of representation 1), Next()
                  is faster than GetEntry()
 */
 
 #include "TEntryListBlock.h"
+#include "TMath.h"
 #include "TString.h"
 
+namespace {
+   // Position of the lowest bit set in w, which must not be 0.
+   inline Int_t FirstBit(UInt_t w)
+   {
+#if defined(__GNUC__)
+      return __builtin_ctz(w);
+#else
+      Int_t n = 0;
+      while (!(w & 1)) { w >>= 1; n++; }
+      return n;
+#endif
+   }
+
+   // Number of bits set in w.
+   inline Int_t CountBits(UInt_t w)
+   {
+#if defined(__GNUC__)
+      return __builtin_popcount(w);
+#else
+      Int_t n = 0;
+      for (; w; w &= w - 1) n++;
+      return n;
+#endif
+   }
+}
+
 ClassImp(TEntryListBlock)
 
+Bool_t TEntryListBlock::fgUseRuns = kFALSE;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Default c-tor
 
@@ -204,6 +241,11 @@ Int_t TEntryListBlock::Contains(Int_t entry)
       Bool_t result = (fIndices[i] & (1<<j))!=0;
       return result;
    }
+   if (fType==2){
+      //runs
+      Int_t irun = FindRun(entry);
+      return irun >= 0 && entry <= fIndices[2*irun+1];
+   }
    //list
    if (entry < fCurrent) fCurrent = 0;
    if (fPassing && fIndices){
@@ -240,10 +282,12 @@ Int_t TEntryListBlock::Contains(Int_t entry)
 
 Int_t TEntryListBlock::Merge(TEntryListBlock *block)
 {
-   Int_t i, j;
+   Int_t i;
    if (block->GetNPassed() == 0) return GetNPassed();
    if (GetNPassed() == 0){
       //this block is empty
+      if (fIndices)
+         delete [] fIndices;
       fN = block->fN;
       fIndices = new UShort_t[fN];
       for (i=0; i<fN; i++)
@@ -254,107 +298,104 @@ Int_t TEntryListBlock::Merge(TEntryListBlock *block)
       fCurrent = block->fCurrent;
       fLastIndexReturned = -1;
       fLastIndexQueried = -1;
-      return fNPassed;
+      return GetNPassed();
    }
-   if (fType==0){
-      //stored as bits
-      if (block->fType == 0){
-         for (i=0; i<kBlockSize*16; i++){
-            if (block->Contains(i))
-               Enter(i);
-         }
-      } else {
-         if (block->fPassing){
-            //the other block stores entries that pass
-            for (i=0; i<block->fNPassed; i++){
-               Enter(block->fIndices[i]);
-            }
-         } else {
-            //the other block stores entries that don't pass
-            if (block->fNPassed==0){
-               for (i=0; i<kBlockSize*16; i++){
-                  Enter(i);
-               }
-            }
-            for (j=0; j<block->fIndices[0]; j++)
-               Enter(j);
-            for (i=0; i<block->fNPassed-1; i++){
-               for (j=block->fIndices[i]+1; j<block->fIndices[i+1]; j++){
-                  Enter(j);
-               }
-            }
-            for (j=block->fIndices[block->fNPassed-1]+1; j<kBlockSize*16; j++)
-               Enter(j);
-         }
-      }
-   } else {
-      //stored as a list
-      if (GetNPassed() + block->GetNPassed() > kBlockSize){
-         //change to bits
-         UShort_t *bits = new UShort_t[kBlockSize];
-         Transform(1, bits);
-         Merge(block);
-      } else {
-         //this is only possible if fPassing=1 in both blocks
-         if (block->fType==1){
-            //second block stored as a list
-            //make a bigger list
-            Int_t en = block->fNPassed;
-            Int_t newsize = fNPassed + en;
-            UShort_t *newlist = new UShort_t[newsize];
-            UShort_t *elst = block->fIndices;
-            Int_t newpos, elpos;
-            newpos = elpos = 0;
-            for (i=0; i<fNPassed; i++) {
-               while (elpos < en && fIndices[i] > elst[elpos]) {
-                  newlist[newpos] = elst[elpos];
-                  newpos++;
-                  elpos++;
-               }
-               if (fIndices[i] == elst[elpos]) elpos++;
-               newlist[newpos] = fIndices[i];
-               newpos++;
-            }
-            while (elpos < en) {
-               newlist[newpos] = elst[elpos];
-               newpos++;
-               elpos++;
-            }
-            delete [] fIndices;
-            fIndices = newlist;
-            fNPassed = newpos;
-            fN = fNPassed;
-         } else {
-            //second block is stored as bits
-
-            Int_t en = block->fNPassed;
-            Int_t newsize = fNPassed + en;
-            UShort_t *newlist = new UShort_t[newsize];
-            Int_t newpos, current;
-            newpos = current = 0;
-            for (i=0; i<kBlockSize*16; i++){
-               if (!block->Contains(i)) continue;
-               while(current < fNPassed && fIndices[current]<i){
-                  newlist[newpos] = fIndices[current];
-                  current++;
-                  newpos++;
-               }
-               if (fIndices[current]==i) current++;
-               newlist[newpos] = i;
-               newpos++;
-            }
-            while(current<fNPassed){
-               newlist[newpos] = fIndices[current];
-               newpos++;
-               current++;
-            }
-            delete [] fIndices;
-            fIndices = newlist;
-            fNPassed = newpos;
-            fN = fNPassed;
-         }
+   if (fType!=1 || !fPassing || block->fType!=1 || !block->fPassing ||
+       GetNPassed() + block->GetNPassed() > kBlockSize){
+      //work on the bits
+      return Combine(block, kOr);
+   }
+   //both blocks are stored as lists of passing entries, make a bigger list
+   Int_t en = block->fNPassed;
+   Int_t newsize = fNPassed + en;
+   UShort_t *newlist = new UShort_t[newsize];
+   UShort_t *elst = block->fIndices;
+   Int_t newpos, elpos;
+   newpos = elpos = 0;
+   for (i=0; i<fNPassed; i++) {
+      while (elpos < en && fIndices[i] > elst[elpos]) {
+         newlist[newpos] = elst[elpos];
+         newpos++;
+         elpos++;
       }
+      if (elpos < en && fIndices[i] == elst[elpos]) elpos++;
+      newlist[newpos] = fIndices[i];
+      newpos++;
+   }
+   while (elpos < en) {
+      newlist[newpos] = elst[elpos];
+      newpos++;
+      elpos++;
    }
+   delete [] fIndices;
+   fIndices = newlist;
+   fNPassed = newpos;
+   fN = fNPassed;
+   fLastIndexQueried = -1;
+   fLastIndexReturned = -1;
+   OptimizeStorage();
+   return GetNPassed();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Keep only the entries that are also in the other block
+/// Returns the resulting number of entries in the block
+
+Int_t TEntryListBlock::Intersect(TEntryListBlock *block)
+{
+   if (GetNPassed() == 0) return 0;
+   return Combine(block, kAnd);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove the entries that are in the other block
+/// Returns the resulting number of entries in the block
+
+Int_t TEntryListBlock::Subtract(TEntryListBlock *block)
+{
+   if (GetNPassed() == 0 || block->GetNPassed() == 0) return GetNPassed();
+   return Combine(block, kAndNot);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Combine the entries of the other block with ours, a 16 bit word at a time:
+/// - op = kOr     - add the entries of the other block
+/// - op = kAnd    - keep the entries that are also in the other block
+/// - op = kAndNot - remove the entries of the other block
+///
+/// This block is changed to bits representation for the operation and the
+/// storage is optimized afterwards.
+/// Returns the resulting number of entries in the block
+
+Int_t TEntryListBlock::Combine(TEntryListBlock *block, EOperation op)
+{
+   Int_t i;
+   if (fType!=0){
+      UShort_t *bits = new UShort_t[kBlockSize];
+      Transform(1, bits);
+   }
+   const UShort_t *other = block->fIndices;
+   UShort_t *temp = 0;
+   if (block->fType!=0 || !block->fIndices){
+      temp = new UShort_t[kBlockSize];
+      block->GetBits(temp);
+      other = temp;
+   }
+   switch (op) {
+      case kOr:
+         for (i=0; i<kBlockSize; i++) fIndices[i] |= other[i];
+         break;
+      case kAnd:
+         for (i=0; i<kBlockSize; i++) fIndices[i] &= other[i];
+         break;
+      case kAndNot:
+         for (i=0; i<kBlockSize; i++) fIndices[i] &= (UShort_t)~other[i];
+         break;
+   }
+   delete [] temp;
+
+   fNPassed = 0;
+   for (i=0; i<kBlockSize; i++) fNPassed += CountBits(fIndices[i]);
    fLastIndexQueried = -1;
    fLastIndexReturned = -1;
    OptimizeStorage();
@@ -380,23 +421,37 @@ Int_t TEntryListBlock::GetNPassed()
 Int_t TEntryListBlock::GetEntry(Int_t entry)
 {
    if (entry > kBlockSize*16) return -1;
-   if (entry > GetNPassed()) return -1;
+   if (entry >= GetNPassed()) return -1;
    if (entry == fLastIndexQueried+1) return Next();
    else {
       Int_t i=0; Int_t j=0; Int_t entries_found=0;
       if (fType==0){
-         if ((fIndices[i] & (1<<j))!=0)
-            entries_found++;
-         while (entries_found<entry+1){
-            if (j==15){i++; j=0;}
-            else j++;
-            if ((fIndices[i] & (1<<j))!=0)
-               entries_found++;
+         //skip the words before the one holding the entry
+         Int_t n;
+         while (entries_found + (n = CountBits(fIndices[i])) <= entry){
+            entries_found += n;
+            i++;
          }
+         UInt_t word = fIndices[i];
+         for (; entries_found<entry; entries_found++)
+            word &= word - 1;
          fLastIndexQueried = entry;
-         fLastIndexReturned = i*16+j;
+         fLastIndexReturned = i*16+FirstBit(word);
          return fLastIndexReturned;
       }
+      if (fType==2){
+         for (i=0; i<fN; i+=2){
+            Int_t len = fIndices[i+1] - fIndices[i] + 1;
+            if (entries_found + len > entry){
+               fCurrent = i/2;
+               fLastIndexQueried = entry;
+               fLastIndexReturned = fIndices[i] + entry - entries_found;
+               return fLastIndexReturned;
+            }
+            entries_found += len;
+         }
+         return -1;
+      }
       if (fType==1){
          if (fPassing){
             fLastIndexQueried = entry;
@@ -451,23 +506,42 @@ Int_t TEntryListBlock::Next()
    }
 
    if (fType==0) {
-      //bits
-      Int_t i=0;
-      Int_t j=0;
-      fLastIndexReturned++;
-      i = fLastIndexReturned>>4;
-      j = fLastIndexReturned & 15;
-      Bool_t result=(fIndices[i] & (1<<j))!=0;
-      while (result==0){
-         if (j==15) {j=0; i++;}
-         else j++;
-         result = (fIndices[i] & (1<<j))!=0;
+      //bits, look for the next word with a bit set
+      Int_t pos = fLastIndexReturned+1;
+      Int_t i = pos>>4;
+      UInt_t word = fIndices[i] & (0xFFFFu << (pos & 15));
+      while (!word){
+         i++;
+         //skip empty stretches four words at a time
+         while ((i & 3)==0 && i+4<=kBlockSize &&
+                !(fIndices[i] | fIndices[i+1] | fIndices[i+2] | fIndices[i+3]))
+            i += 4;
+         word = fIndices[i];
       }
-      fLastIndexReturned = i*16+j;
+      fLastIndexReturned = i*16+FirstBit(word);
       fLastIndexQueried++;
       return fLastIndexReturned;
 
    }
+   if (fType==2) {
+      //runs
+      Int_t pos;
+      if (fLastIndexQueried<0) {
+         fCurrent = 0;
+         pos = fIndices[0];
+      } else {
+         if (2*fCurrent>=fN || fLastIndexReturned<fIndices[2*fCurrent] || fLastIndexReturned>fIndices[2*fCurrent+1])
+            fCurrent = FindRun(fLastIndexReturned);
+         pos = fLastIndexReturned+1;
+         if (pos > fIndices[2*fCurrent+1]) {
+            fCurrent++;
+            pos = fIndices[2*fCurrent];
+         }
+      }
+      fLastIndexReturned = pos;
+      fLastIndexQueried++;
+      return fLastIndexReturned;
+   }
    if (fType==1) {
       fLastIndexQueried++;
       if (fPassing){
@@ -512,6 +586,11 @@ void TEntryListBlock::PrintWithShift(Int_t shift) const
          if (result)
             printf("%d\n", i+shift);
       }
+   } else if (fType==2){
+      for (i=0; i<fN; i+=2){
+         for (Int_t j=fIndices[i]; j<=fIndices[i+1]; j++)
+            printf("%d\n", j+shift);
+      }
    } else {
       if (fPassing){
          for (i=0; i<fNPassed; i++){
@@ -539,12 +618,69 @@ void TEntryListBlock::PrintWithShift(Int_t shift) const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// If there are < kBlockSize or >kBlockSize*15 entries, change to an array
-/// representation
+/// Return true if OptimizeStorage() may choose the runs representation,
+/// see SetUseRuns().
+
+Bool_t TEntryListBlock::GetUseRuns()
+{
+   return fgUseRuns;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Allow (use=kTRUE) or forbid (the default) OptimizeStorage() to store the
+/// entries of the blocks as runs of consecutive entries.
+///
+/// The runs take much less space when the selected entries are clustered,
+/// but a TEntryList written with runs blocks is read silently wrong by the
+/// ROOT versions that predate them (version 1 of TEntryListBlock): only
+/// enable them when the files are not read by older versions. Blocks
+/// already stored as runs are kept, and read correctly, whatever the setting.
+
+void TEntryListBlock::SetUseRuns(Bool_t use)
+{
+   fgUseRuns = use;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// If the runs representation is allowed (see SetUseRuns()) and the runs of
+/// passing entries take less space than the bits and than the array, change
+/// to the runs representation. Otherwise if there are
+/// < kBlockSize or >kBlockSize*15 entries, change to an array representation
 
 void TEntryListBlock::OptimizeStorage()
 {
    if (fType!=0) return;
+   Int_t nruns = fgUseRuns ? CountRuns() : kBlockSize;
+   if (2*nruns < kBlockSize && 2*nruns < TMath::Min(fNPassed, kBlockSize*16-fNPassed)){
+      UShort_t *runs = new UShort_t[2*nruns];
+      Int_t irun = 0;
+      Int_t start = -1;
+      for (Int_t i=0; i<kBlockSize; i++){
+         UShort_t word = fIndices[i];
+         //nothing changes in empty words outside a run and full words inside one
+         if ((start<0 && word==0) || (start>=0 && word==0xFFFF)) continue;
+         for (Int_t j=0; j<16; j++){
+            Bool_t set = (word>>j) & 1;
+            if (set && start<0){
+               start = i*16+j;
+            } else if (!set && start>=0){
+               runs[irun++] = start;
+               runs[irun++] = i*16+j-1;
+               start = -1;
+            }
+         }
+      }
+      if (start>=0){
+         runs[irun++] = start;
+         runs[irun++] = kBlockSize*16-1;
+      }
+      delete [] fIndices;
+      fIndices = runs;
+      fN = 2*nruns;
+      fType = 2;
+      fCurrent = 0;
+      return;
+   }
    if (fNPassed > kBlockSize*15)
       fPassing = 0;
    if (fNPassed<kBlockSize || !fPassing){
@@ -557,7 +693,7 @@ void TEntryListBlock::OptimizeStorage()
 ////////////////////////////////////////////////////////////////////////////////
 /// Transform the existing fIndices
 /// - dir=0 - transform from bits to a list
-/// - dir=1 - tranform from a list to bits
+/// - dir=1 - tranform from a list or runs to bits
 
 void TEntryListBlock::Transform(Bool_t dir, UShort_t *indexnew)
 {
@@ -590,29 +726,96 @@ void TEntryListBlock::Transform(Bool_t dir, UShort_t *indexnew)
       return;
    }
 
-   if (fPassing){
-      for (i=0; i<kBlockSize; i++)
-         indexnew[i] = 0;
-      for (i=0; i<fNPassed; i++){
-         ibite = fIndices[i]>>4;
-         ibit = fIndices[i] & 15;
-         indexnew[ibite] |= 1<<ibit;
-      }
-   } else {
-      for (i=0; i<kBlockSize; i++)
-         indexnew[i] = 65535;
-      for (i=0; i<fNPassed; i++){
-         ibite = fIndices[i]>>4;
-         ibit = fIndices[i] & 15;
-         indexnew[ibite] ^= 1<<ibit;
-      }
-      fNPassed = kBlockSize*16-fNPassed;
-   }
+   Int_t npassed = GetNPassed();
+   GetBits(indexnew);
    if (fIndices)
       delete [] fIndices;
    fIndices = indexnew;
    fType = 0;
    fN = kBlockSize;
+   fNPassed = npassed;
    fPassing = 1;
    return;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// Count the runs of consecutive passing entries, in bits representation
+
+Int_t TEntryListBlock::CountRuns() const
+{
+   Int_t nruns = 0;
+   UInt_t previous = 0; //last bit of the previous word
+   for (Int_t i=0; i<kBlockSize; i++){
+      UInt_t word = fIndices[i];
+      //a run starts at each bit set whose lower neighbour is not set
+      nruns += CountBits(word & ~((word<<1) | previous));
+      previous = word>>15;
+   }
+   return nruns;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the index of the last run starting at or before entry, -1 if none,
+/// in runs representation
+
+Int_t TEntryListBlock::FindRun(Int_t entry) const
+{
+   Int_t found = -1;
+   Int_t low = 0;
+   Int_t high = fN/2-1;
+   while (low <= high){
+      Int_t mid = (low+high)/2;
+      if (fIndices[2*mid] <= entry){
+         found = mid;
+         low = mid+1;
+      } else {
+         high = mid-1;
+      }
+   }
+   return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fill bits (kBlockSize words) with the bits representation of the block,
+/// whatever its current representation
+
+void TEntryListBlock::GetBits(UShort_t *bits) const
+{
+   Int_t i;
+   if (fType==0 && fIndices){
+      for (i=0; i<kBlockSize; i++)
+         bits[i] = fIndices[i];
+      return;
+   }
+   if (!fPassing){
+      //the list stores the entries that don't pass
+      for (i=0; i<kBlockSize; i++)
+         bits[i] = 65535;
+      if (fIndices){
+         for (i=0; i<fNPassed; i++)
+            bits[fIndices[i]>>4] &= (UShort_t)~(1<<(fIndices[i] & 15));
+      }
+      return;
+   }
+   for (i=0; i<kBlockSize; i++)
+      bits[i] = 0;
+   if (!fIndices) return;
+   if (fType==1){
+      for (i=0; i<fNPassed; i++)
+         bits[fIndices[i]>>4] |= 1<<(fIndices[i] & 15);
+   } else if (fType==2){
+      for (i=0; i<fN; i+=2){
+         Int_t j = fIndices[i];
+         Int_t last = fIndices[i+1];
+         while (j <= last){
+            if ((j & 15)==0 && j+15 <= last){
+               bits[j>>4] = 65535;
+               j += 16;
+            } else {
+               bits[j>>4] |= 1<<(j & 15);
+               j++;
+            }
+         }
+      }
+   }
+}
@@ -330,6 +330,7 @@ End_Macro
 #include "TBufferFile.h"
 #include "TBaseClass.h"
 #include "TBasket.h"
+#include "TBasketCompressionQueue.h"
 #include "TBranchClones.h"
 #include "TBranchElement.h"
 #include "TBranchObject.h"
@@ -676,6 +677,7 @@ TTree::TTree()
 , fBranchRef(0)
 , fFriendLockStatus(0)
 , fTransientBuffer(0)
+, fCompressionQueue(0)
 , fCacheDoAutoInit(kTRUE)
 , fCacheUserSet(kFALSE)
 {
@@ -752,6 +754,7 @@ TTree::TTree(const char* name, const char* title, Int_t splitlevel /* = 99 */)
 , fBranchRef(0)
 , fFriendLockStatus(0)
 , fTransientBuffer(0)
+, fCompressionQueue(0)
 , fCacheDoAutoInit(kTRUE)
 , fCacheUserSet(kFALSE)
 {
@@ -799,6 +802,14 @@ TTree::TTree(const char* name, const char* title, Int_t splitlevel /* = 99 */)
 
 TTree::~TTree()
 {
+   if (fCompressionQueue) {
+      // Write the full baskets still being compressed, as they would have
+      // been without parallel compression.
+      TFile *file = fDirectory ? fDirectory->GetFile() : 0;
+      if (file && file->IsWritable()) fCompressionQueue->Flush();
+      delete fCompressionQueue;
+      fCompressionQueue = 0;
+   }
    if (fDirectory) {
       // We are in a directory, which may possibly be a file.
       if (fDirectory->GetList()) {
@@ -4367,6 +4378,20 @@ Int_t TTree::Fill()
    if (fBranchRef) {
       fBranchRef->Fill();
    }
+   if (fCompressionQueue) {
+      // Write the baskets whose parallel compression is finished.
+      fCompressionQueue->WriteFinished();
+      if (fFlushedBytes == 0 && (fAutoFlush < 0 || fAutoSave < 0)) {
+         // The first AutoFlush or AutoSave based on bytes needs the size of
+         // the queued baskets: write them if they might reach the limit, so
+         // that the clusters are the same as without parallel compression.
+         Long64_t limit = fAutoFlush < 0 ? -fAutoFlush : -fAutoSave;
+         if (fAutoSave < 0 && -fAutoSave < limit) limit = -fAutoSave;
+         if (fZipBytes + fCompressionQueue->GetMaxZipBytes() > limit) {
+            fCompressionQueue->Flush();
+         }
+      }
+   }
    ++fEntries;
    if (fEntries > fMaxEntries) {
       KeepCircular();
@@ -4767,6 +4792,15 @@ Int_t TTree::FlushBaskets() const
          }
       }
    }
+   if (fCompressionQueue) {
+      // Including the baskets queued by the loop above.
+      Int_t nwrite = fCompressionQueue->Flush();
+      if (nwrite<0) {
+         ++nerror;
+      } else {
+         nbytes += nwrite;
+      }
+   }
    if (nerror) {
       return -1;
    } else {
@@ -7225,6 +7259,10 @@ void TTree::Reset(Option_t* option)
    delete fTreeIndex;
    fTreeIndex = 0;
 
+   if (fCompressionQueue) {
+      fCompressionQueue->Discard();
+   }
+
    Int_t nb = fBranches.GetEntriesFast();
    for (Int_t i = 0; i < nb; ++i)  {
       TBranch* branch = (TBranch*) fBranches.UncheckedAt(i);
@@ -8096,6 +8134,10 @@ void TTree::SetDirectory(TDirectory* dir)
    if (fDirectory == dir) {
       return;
    }
+   if (fCompressionQueue) {
+      // The queued baskets go to the current file.
+      fCompressionQueue->Flush();
+   }
    if (fDirectory) {
       fDirectory->Remove(this);
 
@@ -8353,8 +8395,47 @@ void TTree::SetObject(const char* name, const char* title)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Enable or disable the parallel compression of the baskets filled by
+/// TTree::Fill.
+///
+/// When enabled, a full basket is compressed by a task of the global
+/// TTaskPool (see TTaskPool::GetGlobal for its size) while the tree goes on
+/// filling a new basket. The compressed baskets are written on the calling
+/// thread in the order they were filled, so the file is the same as without
+/// parallel compression. At most maxInFlight baskets are kept in memory
+/// waiting to be written; all of them are written by FlushBaskets (hence at
+/// each AutoFlush and by Write).
+///
+/// Until the first AutoFlush, a byte based AutoFlush or AutoSave (negative
+/// value, see SetAutoFlush) needs the compressed size of the queued baskets:
+/// they are written as soon as they might reach the limit, which reduces the
+/// parallelism but keeps the cluster boundaries unchanged.
+///
+/// Baskets using the old compression algorithm (ROOT::kOldCompressionAlgo),
+/// which is not thread safe, and uncompressed baskets are written directly.
+///
+/// Disabling writes the baskets still queued.
+
+void TTree::SetParallelCompression(Bool_t enable, Int_t maxInFlight)
+{
+   if (fCompressionQueue) {
+      fCompressionQueue->Flush();
+      delete fCompressionQueue;
+      fCompressionQueue = 0;
+   }
+   if (enable) {
+      fCompressionQueue = new TBasketCompressionQueue(maxInFlight);
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Enable or disable parallel unzipping of Tree buffers.
+///
+/// The baskets of the current cluster are unzipped in advance by tasks on
+/// the global TTaskPool (see TTreeCacheUnzip). RelSize, if positive, sets
+/// the memory budget for the unzipped baskets waiting to be read, relative
+/// to the TTreeCache size.
 
 void TTree::SetParallelUnzip(Bool_t opt, Float_t RelSize)
 {
@@ -8685,6 +8766,10 @@ void TTree::Streamer(TBuffer& b)
       b.CheckByteCount(R__s, R__c, TTree::IsA());
       //====end of old versions
    } else {
+      if (fCompressionQueue) {
+         // The basket addresses must be known.
+         fCompressionQueue->Flush();
+      }
       if (fBranchRef) {
          fBranchRef->Clear();
       }
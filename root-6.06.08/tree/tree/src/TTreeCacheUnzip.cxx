@@ -19,25 +19,31 @@ Core TTree-related code borrowed from the previous version
 
 ## Parallel Unzipping
 
-TTreeCache has been specialised in order to let additional threads
-free to unzip in advance its content. In this implementation we
-support up to 10 threads, but right now it makes more sense to
-limit their number to 1-2
+TTreeCache has been specialised in order to unzip its content in advance.
+Once the baskets of a cluster have been transferred, each of them is
+unzipped by an independent task on the global TTaskPool (shared with the
+other users of the pool, see TTaskPool::GetGlobal for its size), in the
+order of the first entry of the baskets, i.e. the order in which they will
+be read.
 
 The application reading data is carefully synchronized, in order to:
  - if the block it wants is not unzipped, it self-unzips it without
    waiting
- - if the block is being unzipped in parallel, it waits only
-   for that unzip to finish
+ - if the block is being unzipped in parallel, it helps the pool
+   and waits only for that unzip to finish
  - if the block has already been unzipped, it takes it
 
 This is supposed to cancel a part of the unzipping latency, at the
 expenses of cpu time.
 
-The default parameters are the same of the prev version, i.e. 20%
-of the TTreeCache cache size. To change it use
-TTreeCache::SetUnzipBufferSize(Long64_t bufferSize)
-where bufferSize must be passed in bytes.
+The unzipped blocks waiting to be read are kept under a memory budget,
+by default 50% of the TTreeCache cache size. To change it use
+TTreeCacheUnzip::SetUnzipBufferSize(Long64_t bufferSize)
+where bufferSize must be passed in bytes, or TTree::SetParallelUnzip.
+
+The numbers of blocks found unzipped (hits), waited for (stalls) and
+unzipped by the reader (misses) are shown by Print() and collected by
+TTreePerfStats.
 */
 
 #include "TTreeCacheUnzip.h"
@@ -46,6 +52,7 @@ where bufferSize must be passed in bytes.
 #include "TFile.h"
 #include "TEventList.h"
 #include "TVirtualMutex.h"
+#include "TTaskPool.h"
 #include "TThread.h"
 #include "TCondition.h"
 #include "TMath.h"
@@ -53,7 +60,8 @@ where bufferSize must be passed in bytes.
 
 #include "TEnv.h"
 
-#define THREADCNT 2
+#include <algorithm>
+
 extern "C" void R__unzip(Int_t *nin, UChar_t *bufin, Int_t *lout, char *bufout, Int_t *nout);
 extern "C" int R__unzip_header(Int_t *nin, UChar_t *bufin, Int_t *lout);
 
@@ -70,17 +78,18 @@ ClassImp(TTreeCacheUnzip)
 
 TTreeCacheUnzip::TTreeCacheUnzip() : TTreeCache(),
 
-   fActiveThread(kFALSE),
    fAsyncReading(kFALSE),
    fCycle(0),
-   fLastReadPos(0),
-   fBlocksToGo(0),
    fUnzipLen(0),
    fUnzipChunks(0),
    fUnzipStatus(0),
    fTotalUnzipBytes(0),
+   fPendingUnzipBytes(0),
    fNseekMax(0),
    fUnzipBufferSize(0),
+   fNextToSchedule(0),
+   fNTasks(0),
+   fUnzipStarted(kFALSE),
    fNUnzip(0),
    fNFound(0),
    fNStalls(0),
@@ -96,17 +105,18 @@ TTreeCacheUnzip::TTreeCacheUnzip() : TTreeCache(),
 /// Constructor.
 
 TTreeCacheUnzip::TTreeCacheUnzip(TTree *tree, Int_t buffersize) : TTreeCache(tree,buffersize),
-   fActiveThread(kFALSE),
    fAsyncReading(kFALSE),
    fCycle(0),
-   fLastReadPos(0),
-   fBlocksToGo(0),
    fUnzipLen(0),
    fUnzipChunks(0),
    fUnzipStatus(0),
    fTotalUnzipBytes(0),
+   fPendingUnzipBytes(0),
    fNseekMax(0),
    fUnzipBufferSize(0),
+   fNextToSchedule(0),
+   fNTasks(0),
+   fUnzipStarted(kFALSE),
    fNUnzip(0),
    fNFound(0),
    fNStalls(0),
@@ -123,7 +133,6 @@ void TTreeCacheUnzip::Init()
    fMutexList        = new TMutex(kTRUE);
    fIOMutex          = new TMutex(kTRUE);
 
-   fUnzipStartCondition   = new TCondition(fMutexList);
    fUnzipDoneCondition   = new TCondition(fMutexList);
 
    fTotalUnzipBytes = 0;
@@ -135,9 +144,6 @@ void TTreeCacheUnzip::Init()
       fParallel = kFALSE;
    }
    else if(fgParallel == kEnable || fgParallel == kForce) {
-      SysInfo_t info;
-      gSystem->GetSysInfo(&info);
-
       fUnzipBufferSize = Long64_t(fgRelBuffSize * GetBufferSize());
 
       if(gDebug > 0)
@@ -145,10 +151,8 @@ void TTreeCacheUnzip::Init()
 
       fParallel = kTRUE;
 
-      for (Int_t i = 0; i < 10; i++) fUnzipThread[i] = 0;
-
-      StartThreadUnzip(THREADCNT);
-
+      // Start the pool now rather than while reading
+      TTaskPool::GetGlobal();
    }
    else {
       Warning("TTreeCacheUnzip", "Parallel Option unknown");
@@ -169,12 +173,11 @@ TTreeCacheUnzip::~TTreeCacheUnzip()
 {
    ResetCache();
 
-   if (IsActiveThread())
-      StopThreadUnzip();
+   // The tasks of the last cycle still refer to this object
+   WaitForTasks();
 
    delete [] fUnzipLen;
 
-   delete fUnzipStartCondition;
    delete fUnzipDoneCondition;
 
    delete fMutexList;
@@ -182,6 +185,7 @@ TTreeCacheUnzip::~TTreeCacheUnzip()
 
    delete [] fUnzipStatus;
    delete [] fUnzipChunks;
+   delete [] fCompBuffer;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -257,6 +261,7 @@ Bool_t TTreeCacheUnzip::FillBuffer()
 
       //clear cache buffer
       TFileCacheRead::Prefetch(0,0);
+      fBlockEntry.clear();
 
       //store baskets
       for (Int_t i=0;i<fNbranches;i++) {
@@ -288,6 +293,7 @@ Bool_t TTreeCacheUnzip::FillBuffer()
             fNReadPref++;
 
             TFileCacheRead::Prefetch(pos,len);
+            fBlockEntry.push_back(entries[j]);
          }
          if (gDebug > 0) printf("Entry: %lld, registering baskets branch %s, fEntryNext=%lld, fNseek=%d, fNtot=%d\n",entry,((TBranch*)fBranches->UncheckedAt(i))->GetName(),fEntryNext,fNseek,fNtot);
       }
@@ -358,13 +364,12 @@ void TTreeCacheUnzip::UpdateBranches(TTree *tree)
 
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
-// From now on we have the methods concerning the threading part of the cache //
+// From now on we have the methods concerning the parallel part of the cache  //
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Static function that returns the parallel option
-/// (to indicate an additional thread)
 
 TTreeCacheUnzip::EParUnzipMode TTreeCacheUnzip::GetParallelUnzip()
 {
@@ -382,63 +387,14 @@ Bool_t TTreeCacheUnzip::IsParallelUnzip()
    return kFALSE;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// This indicates if the thread is active in this moment...
-/// this variable is very important because if we change it from true to
-/// false the thread will stop... ( see StopThreadTreeCacheUnzip() )
-
-Bool_t TTreeCacheUnzip::IsActiveThread()
-{
-   R__LOCKGUARD(fMutexList);
-
-   return fActiveThread;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// It says if the queue is empty... useful to see if we have to process it.
-
-Bool_t TTreeCacheUnzip::IsQueueEmpty()
-{
-   R__LOCKGUARD(fMutexList);
-
-   if ( fIsLearning )
-      return kTRUE;
-
-   return kFALSE;
-}
-
-void TTreeCacheUnzip::WaitUnzipStartSignal()
-{
-   // Here the threads sleep waiting for some blocks to unzip
-
-   fUnzipStartCondition->TimedWaitRelative(2000);
-
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// This will send the signal corresponfing to the queue... normally used
-/// when we want to start processing the list of buffers.
-
-void TTreeCacheUnzip::SendUnzipStartSignal(Bool_t broadcast)
-{
-   if (gDebug > 0) Info("SendSignal", " fUnzipCondition->Signal()");
-
-   if (broadcast)
-      fUnzipStartCondition->Broadcast();
-   else
-      fUnzipStartCondition->Signal();
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 /// Static function that (de)activates multithreading unzipping
 ///
 /// The possible options are:
-///  - kEnable _Enable_ it, which causes an automatic detection and launches the
-///    additional thread if the number of cores in the machine is greater than
-///    one
-///  - kDisable _Disable_ will not activate the additional thread.
-///  - kForce _Force_ will start the additional thread even if there is only one
-///    core. the default will be taken as kEnable.
+///  - kEnable _Enable_ it: the caches created afterwards unzip in advance
+///    with tasks on the global TTaskPool
+///  - kDisable _Disable_ will not unzip in advance.
+///  - kForce _Force_ same as kEnable, kept for backward compatibility.
 ///
 /// Returns 0 if there was an error, 1 otherwise.
 
@@ -451,135 +407,142 @@ Int_t TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::EParUnzipMode option)
    return 0;
 }
 
-class TTreeCacheUnzipData {
-public:
-   TTreeCacheUnzip *fInstance;
-   Int_t            fCount;
-};
-
 ////////////////////////////////////////////////////////////////////////////////
-/// The Thread is only a part of the TTreeCache but it is the part that
-/// waits for info in the queue and process it... unfortunatly, a Thread is
-/// not an object an we have to deal with it in the old C-Style way
-/// Returns 0 if the thread was initialized or 1 if it was already running
+/// Give the next blocks to unzip to the task pool, as long as the unzipped
+/// blocks waiting to be read and the blocks being unzipped fit in
+/// fUnzipBufferSize. The number of running tasks is limited to twice the
+/// number of threads of the pool, so that the blocks are unzipped close to
+/// the order in which they are read.
+/// Must be called with fMutexList locked.
 
-Int_t TTreeCacheUnzip::StartThreadUnzip(Int_t nthreads)
+void TTreeCacheUnzip::ScheduleUnzip()
 {
-   Int_t nt = nthreads;
-   if (nt > 10) nt = 10;
+   if (!fParallel || fIsLearning || !fUnzipStarted) return;
 
-   if (gDebug > 0)
-      Info("StartThreadUnzip", "Going to start %d threads.", nt);
-
-   for (Int_t i = 0; i < nt; i++) {
-      if (!fUnzipThread[i]) {
-         TString nm("UnzipLoop");
-         nm += i;
-
-         if (gDebug > 0)
-            Info("StartThreadUnzip", "Going to start thread '%s'", nm.Data());
-
-         TTreeCacheUnzipData *d = new TTreeCacheUnzipData;
-         d->fInstance = this;
-         d->fCount = i;
+   TTaskPool *pool = TTaskPool::GetGlobal();
+   Int_t maxTasks = 2 * pool->GetNThreads();
 
-         fUnzipThread[i] = new TThread(nm.Data(), UnzipLoop, (void*)d);
-         if (!fUnzipThread[i])
-            Error("TTreeCacheUnzip::StartThreadUnzip", " Unable to create new thread.");
+   while (fNextToSchedule < (Int_t)fUnzipOrder.size() && fNTasks < maxTasks &&
+          fTotalUnzipBytes + fPendingUnzipBytes < fUnzipBufferSize) {
+      Int_t index = fUnzipOrder[fNextToSchedule++];
 
-         fUnzipThread[i]->Run();
+      // Already taken by the reader, or too small to be worth a task
+      if (fUnzipStatus[index] || fSeekLen[index] <= 256) continue;
 
-         // There is at least one active thread
-         fActiveThread=kTRUE;
+      fUnzipStatus[index] = 1; // Set it as pending
+      fPendingUnzipBytes += fSeekLen[index];
+      ++fNTasks;
 
-      }
+      Int_t cycle = fCycle;
+      pool->Submit([this, index, cycle]() { UnzipBlock(index, cycle); });
    }
-
-   return (fActiveThread == kTRUE);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// To stop the thread we only need to change the value of the variable
-/// fActiveThread to false and the loop will stop (of course, we will have)
-/// to do the cleaning after that.
-///
-/// Note: The syncronization part is important here or we will try to delete
-///       teh object while it's still processing the queue
+/// Task unzipping the block index of the given cycle into a new chunk.
+/// The result is dropped if the cache was reset in the meantime.
 
-Int_t TTreeCacheUnzip::StopThreadUnzip()
+void TTreeCacheUnzip::UnzipBlock(Int_t index, Int_t cycle)
 {
-   fActiveThread = kFALSE;
-
-   for (Int_t i = 0; i < 1; i++) {
-      if(fUnzipThread[i]){
+   const Int_t hlen=128;
+   Int_t objlen=0, keylen=0;
+   Int_t nbytes=0;
+   Int_t readbuf = 0;
+   Long64_t rdoffs = 0;
+   Int_t rdlen = 0;
+   char *locbuff = 0;
 
-         SendUnzipStartSignal(kTRUE);
+   {
+      R__LOCKGUARD(fMutexList);
 
-         if (fUnzipThread[i]->Exists()) {
-            fUnzipThread[i]->Join();
-            delete fUnzipThread[i];
-         }
+      if (cycle == fCycle) {
+         rdoffs = fSeek[index];
+         rdlen = fSeekLen[index];
       }
+   } // Scope of the lock
 
+   // The blocks are in memory, this is a copy. ReadBufferExt takes fIOMutex,
+   // which the reader holds while it calls FillBuffer (locking fMutexList):
+   // never read with fMutexList held.
+   if (rdlen > 0) {
+      locbuff = new char[rdlen];
+      Int_t loc = -1;
+      readbuf = ReadBufferExt(locbuff, rdoffs, rdlen, loc);
    }
 
-   return 1;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// This is a static function.
-///
-/// This is the call that will be executed in the Thread generated by
-/// StartThreadTreeCacheUnzip... what we want to do is to inflate the next
-/// series of buffers leaving them in the second cache.
-///
-/// Returns 0 when it finishes
-
-void* TTreeCacheUnzip::UnzipLoop(void *arg)
-{
-   TTreeCacheUnzipData *d = (TTreeCacheUnzipData *)arg;
-   TTreeCacheUnzip *unzipMng = d->fInstance;
+   Bool_t current;
+   {
+      R__LOCKGUARD(fMutexList);
+      // The cache may have been refilled while we were reading
+      current = (cycle == fCycle);
+   }
 
-   TThread::SetCancelOn();
-   TThread::SetCancelDeferred();
+   char *ptr = 0;
+   Int_t loclen = 0;
 
-   Int_t thrnum = d->fCount;
-   Int_t startindex = thrnum;
-   Int_t locbuffsz = 16384;
-   char *locbuff = new char[16384];
-   Int_t res = 0;
-   Int_t myCycle = 0;
+   if (current && readbuf > 0) {
+      GetRecordHeader(locbuff, hlen, nbytes, objlen, keylen);
 
-   while( unzipMng->IsActiveThread() ) {
-      res = 1;
+      Int_t len = (objlen > nbytes-keylen)? keylen+objlen : nbytes;
 
-      {
-         R__LOCKGUARD(unzipMng->fMutexList);
-         if (myCycle != unzipMng->fCycle) startindex = thrnum;
-         myCycle = unzipMng->fCycle;
-         if (unzipMng->fNseek) startindex = startindex % unzipMng->fNseek;
-         else startindex = -1;
+      // If the single unzipped chunk is really too big, leave it to the reader
+      if (len <= 4*fUnzipBufferSize) {
+         loclen = UnzipBuffer(&ptr, locbuff);
+      } else if (gDebug > 0) {
+         Info("UnzipBlock", "Block %d is too big, skipping.", index);
       }
+   }
+   delete [] locbuff;
 
-      if (startindex >= 0)
-         res = unzipMng->UnzipCache(startindex, locbuffsz, locbuff);
+   R__LOCKGUARD(fMutexList);
 
-      {
-         R__LOCKGUARD(unzipMng->fMutexList);
+   --fNTasks;
 
-         if(!unzipMng->IsActiveThread()) break;
+   if (cycle != fCycle) {
+      if (gDebug > 0)
+         Info("UnzipBlock", "Sudden paging Break!!! fNseek: %d, fIsLearning:%d", fNseek, fIsLearning);
+      delete [] ptr;
+   } else {
+      fPendingUnzipBytes -= rdlen;
+      fUnzipStatus[index] = 2; // Set it as done
 
-         if ((res == 1) || (!unzipMng->fIsTransferred)) {
-            unzipMng->WaitUnzipStartSignal();
-            startindex = unzipMng->fLastReadPos+3+thrnum;
-         }
+      if ((loclen > 0) && (loclen == objlen+keylen)) {
+         fUnzipChunks[index] = ptr;
+         fUnzipLen[index] = loclen;
+         fTotalUnzipBytes += loclen;
+         fNUnzip++;
+
+         if (gDebug > 0)
+            Info("UnzipBlock", "reqi:%d, rdlen: %d, loclen:%d", index, rdlen, loclen);
+      } else {
+         // The reader will unzip it
+         delete [] ptr;
+         fUnzipChunks[index] = 0;
+         fUnzipLen[index] = 0;
       }
 
+      ScheduleUnzip();
    }
 
-   delete d;
-   delete [] locbuff;
-   return (void *)0;
+   fUnzipDoneCondition->Broadcast();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait until no task refers to this cache any more, helping the pool
+/// meanwhile.
+
+void TTreeCacheUnzip::WaitForTasks()
+{
+   TTaskPool *pool = fParallel ? TTaskPool::GetGlobal() : 0;
+
+   fMutexList->Lock();
+   while (fNTasks > 0) {
+      fMutexList->UnLock();
+      Bool_t ran = pool->RunOne();
+      fMutexList->Lock();
+      if (!ran && fNTasks > 0) fUnzipDoneCondition->Wait();
+   }
+   fMutexList->UnLock();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -637,10 +600,11 @@ Int_t TTreeCacheUnzip::GetRecordHeader(char *buf, Int_t maxbytes, Int_t &nbytes,
 /// Note: This method is completely different from TTreeCache::ResetCache(),
 /// in that method we were cleaning the prefetching buffer while here we
 /// delete the information about the unzipped buffers
+///
+/// The tasks still running for the previous content drop their result.
 
 void TTreeCacheUnzip::ResetCache()
 {
-   {
    R__LOCKGUARD(fMutexList);
 
    if (gDebug > 0)
@@ -658,39 +622,58 @@ void TTreeCacheUnzip::ResetCache()
 
    }
 
-   while (fActiveBlks.size()) fActiveBlks.pop();
+   ExpandUnzipArrays();
 
-   if(fNseekMax < fNseek){
-      if (gDebug > 0)
-         Info("ResetCache", "Changing fNseekMax from:%d to:%d", fNseekMax, fNseek);
+   // Unzip in the order of the reading: by first entry of the baskets
+   fUnzipOrder.resize(fNseek);
+   for (Int_t i = 0; i < fNseek; i++) fUnzipOrder[i] = i;
+   if ((Int_t)fBlockEntry.size() == fNseek) {
+      const std::vector<Long64_t> &entry = fBlockEntry;
+      std::stable_sort(fUnzipOrder.begin(), fUnzipOrder.end(),
+                       [&entry](Int_t a, Int_t b) { return entry[a] < entry[b]; });
+   }
+
+   fNextToSchedule = 0;
+   fUnzipStarted = kFALSE;
+   fTotalUnzipBytes = 0;
+   fPendingUnzipBytes = 0;
+}
 
-      Byte_t *aUnzipStatus = new Byte_t[fNseek];
-      memset(aUnzipStatus, 0, fNseek*sizeof(Byte_t));
+////////////////////////////////////////////////////////////////////////////////
+/// Make the arrays describing the unzipped blocks as large as fNseek,
+/// keeping their content. Must be called with fMutexList locked.
 
-      Int_t *aUnzipLen = new Int_t[fNseek];
-      memset(aUnzipLen, 0, fNseek*sizeof(Int_t));
+void TTreeCacheUnzip::ExpandUnzipArrays()
+{
+   if (fNseekMax >= fNseek) return;
 
-      char **aUnzipChunks = new char *[fNseek];
-      memset(aUnzipChunks, 0, fNseek*sizeof(char *));
+   if (gDebug > 0)
+      Info("ExpandUnzipArrays", "Changing fNseekMax from:%d to:%d", fNseekMax, fNseek);
 
-      if (fUnzipStatus) delete [] fUnzipStatus;
-      if (fUnzipLen) delete [] fUnzipLen;
-      if (fUnzipChunks) delete [] fUnzipChunks;
+   Byte_t *aUnzipStatus = new Byte_t[fNseek];
+   memset(aUnzipStatus, 0, fNseek*sizeof(Byte_t));
 
-      fUnzipStatus  = aUnzipStatus;
-      fUnzipLen  = aUnzipLen;
-      fUnzipChunks = aUnzipChunks;
+   Int_t *aUnzipLen = new Int_t[fNseek];
+   memset(aUnzipLen, 0, fNseek*sizeof(Int_t));
 
-      fNseekMax  = fNseek;
-   }
+   char **aUnzipChunks = new char *[fNseek];
+   memset(aUnzipChunks, 0, fNseek*sizeof(char *));
 
-   fLastReadPos = 0;
-   fTotalUnzipBytes = 0;
-   fBlocksToGo = fNseek;
+   for (Int_t i = 0; i < fNseekMax; i++) {
+      aUnzipStatus[i] = fUnzipStatus[i];
+      aUnzipLen[i] = fUnzipLen[i];
+      aUnzipChunks[i] = fUnzipChunks[i];
    }
 
-   SendUnzipStartSignal(kTRUE);
+   if (fUnzipStatus) delete [] fUnzipStatus;
+   if (fUnzipLen) delete [] fUnzipLen;
+   if (fUnzipChunks) delete [] fUnzipChunks;
 
+   fUnzipStatus  = aUnzipStatus;
+   fUnzipLen  = aUnzipLen;
+   fUnzipChunks = aUnzipChunks;
+
+   fNseekMax  = fNseek;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -708,8 +691,8 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
    Int_t res = 0;
    Int_t loc = -1;
 
-   {
-      R__LOCKGUARD(fMutexList);
+   if (fParallel && !fIsLearning) {
+      fMutexList->Lock();
 
       // We go straight to TTreeCache/TfileCacheRead, in order to get the info we need
       //  pointer to the original zipped chunk
@@ -720,158 +703,66 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
       // Also, here we prefer not to trigger the (re)population of the chunks in the TFileCacheRead. That is
       // better to be done in the main thread.
 
-      // And now loc is the position of the chunk in the array of the sorted chunks
-      Int_t myCycle = fCycle;
-
-      if (fParallel && !fIsLearning) {
-
-         if(fNseekMax < fNseek){
-            if (gDebug > 0)
-               Info("GetUnzipBuffer", "Changing fNseekMax from:%d to:%d", fNseekMax, fNseek);
+      ExpandUnzipArrays();
 
-            Byte_t *aUnzipStatus = new Byte_t[fNseek];
-            memset(aUnzipStatus, 0, fNseek*sizeof(Byte_t));
-
-            Int_t *aUnzipLen = new Int_t[fNseek];
-            memset(aUnzipLen, 0, fNseek*sizeof(Int_t));
-
-            char **aUnzipChunks = new char *[fNseek];
-            memset(aUnzipChunks, 0, fNseek*sizeof(char *));
-
-            for (Int_t i = 0; i < fNseekMax; i++) {
-               aUnzipStatus[i] = fUnzipStatus[i];
-               aUnzipLen[i] = fUnzipLen[i];
-               aUnzipChunks[i] = fUnzipChunks[i];
-            }
-
-            if (fUnzipStatus) delete [] fUnzipStatus;
-            if (fUnzipLen) delete [] fUnzipLen;
-            if (fUnzipChunks) delete [] fUnzipChunks;
-
-            fUnzipStatus  = aUnzipStatus;
-            fUnzipLen  = aUnzipLen;
-            fUnzipChunks = aUnzipChunks;
-
-            fNseekMax  = fNseek;
+      // And now loc is the position of the chunk in the array of the sorted chunks
+      loc = (Int_t)TMath::BinarySearch(fNseek,fSeekSort,pos);
+      if ( (loc >= 0) && (loc < fNseek) && (pos == fSeekSort[loc]) ) {
+
+         // The buffer is, at minimum, in the file cache. We must know its index in the requests list
+         // In order to get its info
+         Int_t seekidx = fSeekIndex[loc];
+
+         // If the status of the unzipped chunk is pending we help the pool
+         // until it is done, waiting only if the pool has nothing else to run.
+         Bool_t stalled = kFALSE;
+         while (fUnzipStatus[seekidx] == 1) {
+            stalled = kTRUE;
+            fMutexList->UnLock();
+            Bool_t ran = TTaskPool::GetGlobal()->RunOne();
+            fMutexList->Lock();
+            if (!ran && fUnzipStatus[seekidx] == 1) fUnzipDoneCondition->Wait();
          }
 
-         loc = (Int_t)TMath::BinarySearch(fNseek,fSeekSort,pos);
-         if ( (fCycle == myCycle) && (loc >= 0) && (loc < fNseek) && (pos == fSeekSort[loc]) ) {
-
-            // The buffer is, at minimum, in the file cache. We must know its index in the requests list
-            // In order to get its info
-            Int_t seekidx = fSeekIndex[loc];
-
-            fLastReadPos = seekidx;
-
-            do {
-
-               // If the block is ready we get it immediately.
-               // And also we don't have to alloc the blks. This is supposed to be
-               // the main thread of the app.
-               if ((fUnzipStatus[seekidx] == 2) && (fUnzipChunks[seekidx]) && (fUnzipLen[seekidx] > 0)) {
-
-                  //if (gDebug > 0)
-                  //   Info("GetUnzipBuffer", "++++++++++++++++++++ CacheHIT Block wanted: %d  len:%d req_len:%d fNseek:%d", seekidx, fUnzipLen[seekidx], len,  fNseek);
-
-                  if(!(*buf)) {
-                     *buf = fUnzipChunks[seekidx];
-                     fUnzipChunks[seekidx] = 0;
-                     fTotalUnzipBytes -= fUnzipLen[seekidx];
-                     SendUnzipStartSignal(kFALSE);
-                     *free = kTRUE;
-                  }
-                  else {
-                     memcpy(*buf, fUnzipChunks[seekidx], fUnzipLen[seekidx]);
-                     delete fUnzipChunks[seekidx];
-                     fTotalUnzipBytes -= fUnzipLen[seekidx];
-                     fUnzipChunks[seekidx] = 0;
-                     SendUnzipStartSignal(kFALSE);
-                     *free = kFALSE;
-                  }
-
-                  fNFound++;
-
-                  return fUnzipLen[seekidx];
-               }
-
-               // If the status of the unzipped chunk is pending
-               // we wait on the condvar, hoping that the next signal is the good one
-               if ( fUnzipStatus[seekidx] == 1 ) {
-                  //fMutexList->UnLock();
-                  fUnzipDoneCondition->TimedWaitRelative(200);
-                  //fMutexList->Lock();
-
-                  if ( myCycle != fCycle ) {
-                     if (gDebug > 0)
-                        Info("GetUnzipBuffer", "Sudden paging Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-                             IsActiveThread(), fNseek, fIsLearning);
-
-                     fLastReadPos = 0;
-
-                     seekidx = -1;
-                     break;
-                  }
-
-               }
-
-            } while ( fUnzipStatus[seekidx] == 1 );
-
-            //if (gDebug > 0)
-            //   Info("GetUnzipBuffer", "------- Block wanted: %d  status: %d len: %d chunk: %llx ", seekidx, fUnzipStatus[seekidx], fUnzipLen[seekidx], fUnzipChunks[seekidx]);
-
-            // Here the block is not pending. It could be done or aborted or not yet being processed.
-            if ( (seekidx >= 0) && (fUnzipStatus[seekidx] == 2) && (fUnzipChunks[seekidx]) && (fUnzipLen[seekidx] > 0) ) {
-
-               //if (gDebug > 0)
-               //   Info("GetUnzipBuffer", "++++++++++++++++++++ CacheLateHIT Block wanted: %d  len:%d fNseek:%d", seekidx, fUnzipLen[seekidx], fNseek);
-
-               if(!(*buf)) {
-                  *buf = fUnzipChunks[seekidx];
-                  fUnzipChunks[seekidx] = 0;
-                  fTotalUnzipBytes -= fUnzipLen[seekidx];
-                  SendUnzipStartSignal(kFALSE);
-                  *free = kTRUE;
-               }
-               else {
-                  memcpy(*buf, fUnzipChunks[seekidx], fUnzipLen[seekidx]);
-                  delete fUnzipChunks[seekidx];
-                  fTotalUnzipBytes -= fUnzipLen[seekidx];
-                  fUnzipChunks[seekidx] = 0;
-                  SendUnzipStartSignal(kFALSE);
-                  *free = kFALSE;
-               }
-
-               fNStalls++;
-
-               return fUnzipLen[seekidx];
+         // If the block is ready we get it immediately.
+         // And also we don't have to alloc the blks. This is supposed to be
+         // the main thread of the app.
+         if ((fUnzipStatus[seekidx] == 2) && (fUnzipChunks[seekidx]) && (fUnzipLen[seekidx] > 0)) {
+
+            if(!(*buf)) {
+               *buf = fUnzipChunks[seekidx];
+               *free = kTRUE;
             }
             else {
-               // This is a complete miss. We want to avoid the threads
-               // to try unzipping this block in the future.
-               fUnzipStatus[seekidx] = 2;
-               fUnzipChunks[seekidx] = 0;
+               memcpy(*buf, fUnzipChunks[seekidx], fUnzipLen[seekidx]);
+               delete [] fUnzipChunks[seekidx];
+               *free = kFALSE;
+            }
+            fUnzipChunks[seekidx] = 0;
+            fTotalUnzipBytes -= fUnzipLen[seekidx];
 
-               if ((fTotalUnzipBytes < fUnzipBufferSize) && fBlocksToGo)
-                  SendUnzipStartSignal(kFALSE);
+            if (stalled) fNStalls++;
+            else         fNFound++;
 
-               //if (gDebug > 0)
-               //   Info("GetUnzipBuffer", "++++++++++++++++++++ CacheMISS Block wanted: %d  len:%d fNseek:%d", seekidx, len, fNseek);
-            }
+            // Some memory was released
+            ScheduleUnzip();
 
-         } else {
-            loc = -1;
-            //fLastReadPos = 0;
-            fIsTransferred = kFALSE;
+            res = fUnzipLen[seekidx];
+            fMutexList->UnLock();
+            return res;
          }
 
+         // This is a complete miss. We want to avoid the tasks
+         // to try unzipping this block in the future.
+         fUnzipStatus[seekidx] = 2;
+         fUnzipChunks[seekidx] = 0;
+
       } else {
-         // We need to reset it for new transferences...
-         //ResetCache();
-         //TFileCacheRead::Prefetch(0,0);
+         loc = -1;
       }
 
-   } // scope of the lock!
+      fMutexList->UnLock();
+   }
 
    if (len > fCompBufferSize) {
       delete [] fCompBuffer;
@@ -901,6 +792,14 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
 
    } // scope of the lock!
 
+   if (fParallel && !fIsLearning) {
+      R__LOCKGUARD(fMutexList);
+
+      // The first read of a cluster transfers its blocks: the tasks can start
+      if (fIsTransferred) fUnzipStarted = kTRUE;
+      ScheduleUnzip();
+   }
+
    if (!res) {
       res = UnzipBuffer(buf, fCompBuffer);
       *free = kTRUE;
@@ -1034,217 +933,11 @@ Int_t TTreeCacheUnzip::UnzipBuffer(char **dest, char *src)
    return uzlen;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// This inflates all the buffers in the cache.. passing the data to a new
-/// buffer that will only wait there to be read...
-/// We can not inflate all the buffers in the cache so we will try to do
-/// it until the cache gets full... there is a member called fUnzipBufferSize which will
-/// tell us the max size we can allocate for this cache.
-///
-/// note that we will  unzip in the order they were put into the cache not
-/// the order of the transference so it has to be read in that order or the
-/// pre-unzipping will be useless.
-///
-/// startindex is used as start index to check for blks to be unzipped
-///
-/// returns 0 in normal conditions or -1 if error, 1 if it would like to sleep
-///
-/// This func is supposed to compete among an indefinite number of threads to get a chunk to inflate
-/// in order to accommodate multiple unzippers
-/// Since everything is so async, we cannot use a fixed buffer, we are forced to keep
-/// the individual chunks as separate blocks, whose summed size does not exceed the maximum
-/// allowed. The pointers are kept globally in the array fUnzipChunks
-
-Int_t TTreeCacheUnzip::UnzipCache(Int_t &startindex, Int_t &locbuffsz, char *&locbuff)
-{
-   Int_t myCycle;
-   const Int_t hlen=128;
-   Int_t objlen=0, keylen=0;
-   Int_t nbytes=0;
-   Int_t readbuf = 0;
-
-   Int_t idxtounzip = -1;
-   Long64_t rdoffs = 0;
-   Int_t rdlen = 0;
-   {
-      R__LOCKGUARD(fMutexList);
-
-      if (!IsActiveThread() || !fNseek || fIsLearning || !fIsTransferred) {
-         if (gDebug > 0)
-            Info("UnzipCache", "Sudden Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-                 IsActiveThread(), fNseek, fIsLearning);
-         return 1;
-      }
-
-      // To synchronize with the 'paging'
-      myCycle = fCycle;
-
-      // Try to look for a blk to unzip
-      idxtounzip = -1;
-      rdoffs = 0;
-      rdlen = 0;
-      if (fTotalUnzipBytes < fUnzipBufferSize) {
-
-         if (fBlocksToGo > 0) {
-            for (Int_t ii=0; ii < fNseek; ii++) {
-               Int_t reqi = (startindex+ii) % fNseek;
-               if (!fUnzipStatus[reqi] && (fSeekLen[reqi] > 256)   ) {
-                  // We found a chunk which is not unzipped nor pending
-                  fUnzipStatus[reqi] = 1; // Set it as pending
-                  idxtounzip = reqi;
-
-                  rdoffs = fSeek[idxtounzip];
-                  rdlen = fSeekLen[idxtounzip];
-                  break;
-               }
-            }
-            if (idxtounzip < 0) fBlocksToGo = 0;
-         }
-      }
-
-   } // lock scope
-
-   if (idxtounzip < 0) {
-      if (gDebug > 0)
-         Info("UnzipCache", "Nothing to do... startindex:%d fTotalUnzipBytes:%lld fUnzipBufferSize:%lld fNseek:%d",
-              startindex, fTotalUnzipBytes, fUnzipBufferSize, fNseek );
-      return 1;
-   }
-
-   // And here we have a new blk to unzip
-   startindex = idxtounzip+THREADCNT;
-
-   if (!IsActiveThread() || !fNseek || fIsLearning ) {
-      if (gDebug > 0)
-         Info("UnzipCache", "Sudden Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-              IsActiveThread(), fNseek, fIsLearning);
-      return 1;
-   }
-
-   Int_t loc = -1;
-
-   // Prepare a static tmp buf of adequate size
-   if(locbuffsz < rdlen) {
-      if (locbuff) delete [] locbuff;
-      locbuffsz = rdlen;
-      locbuff = new char[locbuffsz];
-      //memset(locbuff, 0, locbuffsz);
-   } else if(locbuffsz > rdlen*3) {
-      if (locbuff) delete [] locbuff;
-      locbuffsz = rdlen*2;
-      locbuff = new char[locbuffsz];
-      //memset(locbuff, 0, locbuffsz);
-   }
-   
-   if (gDebug > 0)
-     Info("UnzipCache", "Going to unzip block %d", idxtounzip);
-
-   readbuf = ReadBufferExt(locbuff, rdoffs, rdlen, loc);
-
-   {
-      R__LOCKGUARD(fMutexList);
-
-      if ( (myCycle != fCycle) || !fIsTransferred )  {
-         if (gDebug > 0)
-            Info("UnzipCache", "Sudden paging Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-                 IsActiveThread(), fNseek, fIsLearning);
-
-         fUnzipStatus[idxtounzip] = 2; // Set it as not done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
-         fUnzipDoneCondition->Signal();
-
-         startindex = 0;
-         return 1;
-      }
-
-      if (readbuf <= 0) {
-         fUnzipStatus[idxtounzip] = 2; // Set it as not done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
-         if (gDebug > 0)
-            Info("UnzipCache", "Block %d not done. rdoffs=%lld rdlen=%d readbuf=%d", idxtounzip, rdoffs, rdlen, readbuf);
-         return -1;
-      }
-
-      GetRecordHeader(locbuff, hlen, nbytes, objlen, keylen);
-
-      Int_t len = (objlen > nbytes-keylen)? keylen+objlen : nbytes;
-
-      // If the single unzipped chunk is really too big, reset it to not processable
-      // I.e. mark it as done but set the pointer to 0
-      // This block will be unzipped synchronously in the main thread
-      if (len > 4*fUnzipBufferSize) {
-
-         //if (gDebug > 0)
-            Info("UnzipCache", "Block %d is too big, skipping.", idxtounzip);
-
-         fUnzipStatus[idxtounzip] = 2; // Set it as done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
-
-         fUnzipDoneCondition->Signal();
-         return 0;
-      }
-
-   } // Scope of the lock
-
-   // Unzip it into a new blk
-   char *ptr = 0;
-   Int_t loclen = 0;
-
-   loclen = UnzipBuffer(&ptr, locbuff);
-
-   if ((loclen > 0) && (loclen == objlen+keylen)) {
-      R__LOCKGUARD(fMutexList);
-
-      if ( (myCycle != fCycle)  || !fIsTransferred) {
-         if (gDebug > 0)
-            Info("UnzipCache", "Sudden paging Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-                 IsActiveThread(), fNseek, fIsLearning);
-         delete [] ptr;
-
-         fUnzipStatus[idxtounzip] = 2; // Set it as not done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
-
-         startindex = 0;
-         fUnzipDoneCondition->Signal();
-         return 1;
-      }
-
-      fUnzipStatus[idxtounzip] = 2; // Set it as done
-      fUnzipChunks[idxtounzip] = ptr;
-      fUnzipLen[idxtounzip] = loclen;
-      fTotalUnzipBytes += loclen;
-
-      fActiveBlks.push(idxtounzip);
-
-      if (gDebug > 0)
-         Info("UnzipCache", "reqi:%d, rdoffs:%lld, rdlen: %d, loclen:%d",
-              idxtounzip, rdoffs, rdlen, loclen);
-
-      fNUnzip++;
-   }
-   else {
-      R__LOCKGUARD(fMutexList);
-      Info("argh", "loclen:%d objlen:%d loc:%d readbuf:%d", loclen, objlen, loc, readbuf);
-      fUnzipStatus[idxtounzip] = 2; // Set it as done
-      fUnzipChunks[idxtounzip] = 0;
-      fUnzipLen[idxtounzip] = 0;
-   }
-
-   fUnzipDoneCondition->Signal();
-
-   delete [] ptr;
-   return 0;
-}
-
 void  TTreeCacheUnzip::Print(Option_t* option) const {
 
    printf("******TreeCacheUnzip statistics for file: %s ******\n",fFile->GetName());
    printf("Max allowed mem for pending buffers: %lld\n", fUnzipBufferSize);
-   printf("Number of blocks unzipped by threads: %d\n", fNUnzip);
+   printf("Number of blocks unzipped by tasks: %d\n", fNUnzip);
    printf("Number of hits: %d\n", fNFound);
    printf("Number of stalls: %d\n", fNStalls);
    printf("Number of misses: %d\n", fNMissed);
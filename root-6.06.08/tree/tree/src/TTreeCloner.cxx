@@ -14,6 +14,7 @@ Class implementing or helping  the various TTree cloning method
 */
 
 #include "TBasket.h"
+#include "TBasketCompressionQueue.h"
 #include "TBranch.h"
 #include "TBranchClones.h"
 #include "TBranchElement.h"
@@ -233,6 +234,8 @@ void TTreeCloner::CloseOutWriteBaskets()
       TBranch *to = (TBranch*)fToBranches.UncheckedAt(i);
       to->FlushOneBasket(to->GetWriteBasket());
    }
+   // The baskets must be on file before the copied ones are added.
+   if (fToTree->GetCompressionQueue()) fToTree->GetCompressionQueue()->Flush();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -753,6 +756,7 @@ void TTreeCloner::WriteBaskets()
             tobasket->SetBranch(to);
             to->AddBasket(*tobasket, kFALSE, fToStartEntries+from->GetBasketEntry()[index]);
             to->FlushOneBasket(to->GetWriteBasket());
+            if (fToTree->GetCompressionQueue()) fToTree->GetCompressionQueue()->Flush();
          }
       }
    }
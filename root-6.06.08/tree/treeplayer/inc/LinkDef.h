@@ -99,6 +99,7 @@
 
 #pragma link C++ class ROOT::Internal::TTreeReaderValueBase+;
 #pragma link C++ class ROOT::Internal::TTreeReaderArrayBase+;
+#pragma link C++ class ROOT::Internal::TTreeReaderBulkBase+;
 #pragma link C++ class ROOT::Internal::TNamedBranchProxy+;
 
 #endif
@@ -127,6 +127,17 @@ protected:
 
    LongDouble_t*        fConstLD;   // local version of fConsts able to store bigger numbers
 
+   // Block evaluation with compiled code, see EnableJit()
+   typedef void (*JitFunc_t)(Long64_t n, const Double_t * const *columns, Double_t *result);
+   JitFunc_t                 fJitFunc;       //! compiled version of the formula, 0 if not used
+   std::vector<Int_t>        fJitColumns;    //! codes of the leaves read by fJitFunc, in order of its arguments
+   std::vector<Double_t>     fJitValues;     //! values of the leaves for the current block, one column after the other
+   std::vector<Double_t>     fJitResults;    //! values of the formula for the current block
+   Long64_t                  fJitFirst;      //! first entry of the current block (in the current tree)
+   Long64_t                  fJitEnd;        //! end of the current block
+   Long64_t                  fJitBlockSize;  //! number of entries to read for the next block
+   TTree                    *fJitTree;       //! tree the current block has been read from
+
    TTreeFormula(const char *name, const char *formula, TTree *tree, const std::vector<std::string>& aliases);
    void Init(const char *name, const char *formula);
    Bool_t      BranchHasMethod(TLeaf* leaf, TBranch* branch, const char* method,const char* params, Long64_t readentry) const;
@@ -145,6 +156,9 @@ protected:
    virtual void*     GetValuePointerFromMethod(Int_t i, TLeaf *leaf) const;
    Int_t             GetRealInstance(Int_t instance, Int_t codeindex);
 
+   Double_t          EvalJit();
+   Bool_t            FillJitBlock(TTree *tree, Long64_t entry);
+   Bool_t            ReadJitColumn(TLeaf *leaf, Long64_t first, Long64_t n, Double_t *values);
    void              LoadBranches();
    Bool_t            LoadCurrentDim();
    void              ResetDimensions();
@@ -174,12 +188,14 @@ public:
    virtual TClass*     EvalClass() const;
 
    template<typename T> T EvalInstance(Int_t i=0, const char *stringStack[]=0);
-   virtual Double_t       EvalInstance(Int_t i=0, const char *stringStack[]=0) {return EvalInstance<Double_t>(i, stringStack); }
+   virtual Double_t       EvalInstance(Int_t i=0, const char *stringStack[]=0) {return (fJitFunc && i==0) ? EvalJit() : EvalInstance<Double_t>(i, stringStack); }
    virtual Long64_t       EvalInstance64(Int_t i=0, const char *stringStack[]=0) {return EvalInstance<Long64_t>(i, stringStack); }
    virtual LongDouble_t   EvalInstanceLD(Int_t i=0, const char *stringStack[]=0) {return EvalInstance<LongDouble_t>(i, stringStack); }
 
    virtual const char *EvalStringInstance(Int_t i=0);
    virtual void*       EvalObject(Int_t i=0);
+           void        DisableJit();
+           Bool_t      EnableJit();
    // EvalInstance should be const.  See comment on GetNdata()
    TFormLeafInfo      *GetLeafInfo(Int_t code) const;
    TTreeFormulaManager*GetManager() const { return fManager; }
@@ -194,6 +210,7 @@ public:
    //the mutable keyword.
    //NOTE: Also modify the code in PrintValue which current goes around this limitation :(
    virtual Bool_t      IsInteger(Bool_t fast=kTRUE) const;
+           Bool_t      IsJit() const { return fJitFunc != 0; }
            Bool_t      IsQuickLoad() const { return fQuickLoad; }
    virtual Bool_t      IsString() const;
    virtual Bool_t      Notify() { UpdateFormulaLeaves(); return kTRUE; }
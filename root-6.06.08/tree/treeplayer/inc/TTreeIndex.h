@@ -42,11 +42,15 @@ protected:
    TTreeFormula  *fMinorFormula;        //! Pointer to minor TreeFormula
    TTreeFormula  *fMajorFormulaParent;  //! Pointer to major TreeFormula in Parent tree (if any)
    TTreeFormula  *fMinorFormulaParent;  //! Pointer to minor TreeFormula in Parent tree (if any)
+   void          *fMapAddress;          //! Start of the memory mapped index file the arrays point into, 0 if they are owned
+   Long64_t       fMapLength;           //! Length of the mapping
 
 private:
    TTreeIndex(const TTreeIndex&);            // Not implemented.
    TTreeIndex &operator=(const TTreeIndex&); // Not implemented.
 
+   void           Unmap();
+
 public:
    TTreeIndex();
    TTreeIndex(const TTree *T, const char *majorname, const char *minorname);
@@ -63,6 +67,7 @@ public:
    const char            *GetMajorName()    const {return fMajorName.Data();}
    const char            *GetMinorName()    const {return fMinorName.Data();}
    virtual Long64_t       GetN()            const {return fN;}
+   Bool_t                 IsMapped()        const {return fMapAddress != 0;}
    virtual TTreeFormula  *GetMajorFormula();
    virtual TTreeFormula  *GetMinorFormula();
    virtual TTreeFormula  *GetMajorFormulaParent(const TTree *parent);
@@ -70,6 +75,9 @@ public:
    virtual void           Print(Option_t *option="") const;
    virtual void           UpdateFormulaLeaves(const TTree *parent);
    virtual void           SetTree(const TTree *T);
+   Long64_t               WriteMapped(const char *filename) const;
+
+   static TTreeIndex     *OpenMapped(const char *filename, const TTree *T);
 
    ClassDef(TTreeIndex,2);  //A Tree Index with majorname and minorname.
 };
@@ -52,6 +52,9 @@ protected:
    Double_t      fDiskTime;      //Time spent in pure raw disk IO
    Double_t      fUnzipTime;     //Time spent uncompressing the data.
    Double_t      fCompress;      //Tree compression factor
+   Int_t         fUnzipHits;     //Number of baskets found unzipped in advance (TTreeCacheUnzip)
+   Int_t         fUnzipStalls;   //Number of baskets still being unzipped in advance when read
+   Int_t         fUnzipMisses;   //Number of baskets unzipped by the reader with TTreeCacheUnzip
    TString       fName;          //name of this TTreePerfStats
    TString       fHostInfo;      //name of the host system, ROOT version and date
    TFile        *fFile;          //!pointer to the file containing the Tree
@@ -89,6 +92,9 @@ public:
    TStopwatch      *GetStopwatch() const {return fWatch;}
    virtual Int_t    GetTreeCacheSize() const {return fTreeCacheSize;}
    virtual Double_t GetUnzipTime() const {return fUnzipTime; }
+   virtual Int_t    GetUnzipHits() const {return fUnzipHits;}
+   virtual Int_t    GetUnzipMisses() const {return fUnzipMisses;}
+   virtual Int_t    GetUnzipStalls() const {return fUnzipStalls;}
    virtual void     Paint(Option_t *chopt="");
    virtual void     Print(Option_t *option="") const;
 
@@ -120,8 +126,11 @@ public:
    virtual void     SetRealTime(Double_t rtime) {fRealTime = rtime;}
    virtual void     SetTreeCacheSize(Int_t nbytes) {fTreeCacheSize = nbytes;}
    virtual void     SetUnzipTime(Double_t uztime) {fUnzipTime = uztime;}
+   virtual void     SetUnzipHits(Int_t n) {fUnzipHits = n;}
+   virtual void     SetUnzipMisses(Int_t n) {fUnzipMisses = n;}
+   virtual void     SetUnzipStalls(Int_t n) {fUnzipStalls = n;}
 
-   ClassDef(TTreePerfStats,1)  // TTree I/O performance measurement
+   ClassDef(TTreePerfStats,2)  // TTree I/O performance measurement
 };
 
 #endif
@@ -156,6 +156,7 @@ public:
    Bool_t IsChain() const { return TestBit(kBitIsChain); }
 
    Bool_t Next() { return SetEntry(GetCurrentEntry() + 1) == kEntryValid; }
+   Bool_t NextCluster(Long64_t &begin, Long64_t &end);
    EEntryStatus SetEntry(Long64_t entry) { return SetEntryBase(entry, kFALSE); }
    EEntryStatus SetLocalEntry(Long64_t entry) { return SetEntryBase(entry, kTRUE); }
    void SetLastEntry(Long64_t entry) { fLastEntry = entry; }
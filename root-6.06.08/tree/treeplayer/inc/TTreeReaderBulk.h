@@ -0,0 +1,80 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TTreeReaderBulk
+#define ROOT_TTreeReaderBulk
+
+
+////////////////////////////////////////////////////////////////////////////
+//                                                                        //
+// TTreeReaderBulk                                                        //
+//                                                                        //
+// Reads the values of a range of entries of a branch into a contiguous   //
+// array, directly from the baskets.                                      //
+//                                                                        //
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TString
+#include "TString.h"
+#endif
+#ifndef ROOT_TDataType
+#include "TDataType.h"
+#endif
+
+class TBranch;
+class TTree;
+class TTreeReader;
+
+namespace ROOT {
+namespace Internal {
+
+   class TTreeReaderBulkBase {
+   public:
+      TTreeReaderBulkBase(TTreeReader* reader, const char* branchname, EDataType type, Int_t typesize);
+      virtual ~TTreeReaderBulkBase() {}
+
+      const char* GetBranchName() const { return fBranchName; }
+      Int_t       GetValuesPerEntry();
+
+      static void Unpack(const char* src, void* dest, Long64_t n, Int_t size);
+
+   protected:
+      Long64_t ReadRange(Long64_t begin, Long64_t end, void* dest);
+
+   private:
+      Bool_t   Setup(TTree* tree);
+
+      TString      fBranchName; // name of the branch to read data from
+      TTreeReader* fTreeReader; // tree reader we belong to
+      EDataType    fType;       // type of the values in memory
+      Int_t        fTypeSize;   // size of one value in memory
+      TTree*       fTree;       // tree fBranch belongs to (the current tree of a chain)
+      Int_t        fTreeNumber; // number of fTree in the chain
+      TBranch*     fBranch;     // branch read, 0 if it cannot be read in bulk
+      Int_t        fLen;        // number of values per entry (fixed size arrays)
+   };
+
+} // namespace Internal
+} // namespace ROOT
+
+
+template <typename T>
+class TTreeReaderBulk: public ROOT::Internal::TTreeReaderBulkBase {
+public:
+   TTreeReaderBulk(TTreeReader& tr, const char* branchname):
+      TTreeReaderBulkBase(&tr, branchname, TDataType::GetType(typeid(T)), sizeof(T)) {}
+
+   // Read the entries [begin, end) into dest, which must hold
+   // (end - begin) * GetValuesPerEntry() values. Returns the number of
+   // entries read or -1 in case of error.
+   Long64_t Read(Long64_t begin, Long64_t end, T* dest) { return ReadRange(begin, end, dest); }
+};
+
+#endif // ROOT_TTreeReaderBulk
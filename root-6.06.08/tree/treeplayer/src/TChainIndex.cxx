@@ -22,6 +22,8 @@ and kept inside this chain index.
 
 #include "TChainIndex.h"
 #include "TChain.h"
+#include "TChainElement.h"
+#include "TChainMetadata.h"
 #include "TTreeFormula.h"
 #include "TTreeIndex.h"
 #include "TFile.h"
@@ -59,6 +61,10 @@ TChainIndex::TChainIndex(): TVirtualIndex()
 /// If any of those requirements isn't met the object becomes a zombie.
 /// If some subtrees don't have indices the indices are created and stored inside this
 /// TChainIndex.
+/// If the chain uses a metadata cache (see TChain::SetMetadataCache), the
+/// trees whose persistent index range is in the cache are not loaded, and
+/// the ranges of the persistent indices of the other trees are added to it
+/// (call TChain::SaveMetadataCache() to write them to the sidecar file).
 
 TChainIndex::TChainIndex(const TTree *T, const char *majorname, const char *minorname)
            : TVirtualIndex()
@@ -79,8 +85,22 @@ TChainIndex::TChainIndex(const TTree *T, const char *majorname, const char *mino
    fMinorName          = minorname;
    Int_t i = 0;
 
+   TChainMetadata *metadata = chain->GetMetadataCache();
+
    // Go through all the trees and check if they have indeces. If not then build them.
    for (i = 0; i < chain->GetNtrees(); i++) {
+      TChainElement *element = (TChainElement*) chain->GetListOfFiles()->At(i);
+      TChainMetadata::TFileEntry *cached = metadata ? metadata->Find(element->GetTitle(), element->GetName()) : 0;
+      if (cached && cached->HasIndex(majorname, minorname)) {
+         // The tree has a persistent index, GetSubTreeIndex will load it when needed.
+         TChainIndexEntry entry;
+         entry.fTreeIndex = 0;
+         cached->GetIndexRange(entry.fMinIndexValue, entry.fMinIndexValMinor,
+                               entry.fMaxIndexValue, entry.fMaxIndexValMinor);
+         fEntries.push_back(entry);
+         continue;
+      }
+
       chain->LoadTree((chain->GetTreeOffset())[i]);
       TVirtualIndex *index = chain->GetTree()->GetTreeIndex();
 
@@ -118,6 +138,12 @@ TChainIndex::TChainIndex(const TTree *T, const char *majorname, const char *mino
 
       entry.SetMinMaxFrom(ti_index);
       fEntries.push_back(entry);
+
+      if (metadata && !entry.fTreeIndex) {
+         metadata->SetIndexRange(element->GetTitle(), element->GetName(), majorname, minorname,
+                                 entry.fMinIndexValue, entry.fMinIndexValMinor,
+                                 entry.fMaxIndexValue, entry.fMaxIndexValMinor);
+      }
    }
 
    // Check if the indices of different trees are in order. If not then return an error.
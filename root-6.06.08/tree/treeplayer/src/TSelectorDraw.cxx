@@ -928,6 +928,19 @@ void TSelectorDraw::ClearFormula()
    fMultiplicity = 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the formulas of tree should be evaluated with compiled code
+/// (see TTreeFormula::EnableJit), i.e. if it has at least as many entries as
+/// the rootrc setting TTreeFormula.Jit (0, the default, disables it).
+/// The number of entries of a chain is computed (opening all its files) only
+/// if the setting is enabled.
+
+static Bool_t UseJit(TTree *tree)
+{
+   Long64_t threshold = gEnv->GetValue("TTreeFormula.Jit", 0);
+   return threshold > 0 && tree->GetEntries() >= threshold;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Compile input variables and selection expression.
 ///
@@ -986,6 +999,7 @@ Bool_t TSelectorDraw::CompileVariables(const char *varexp, const char *selection
          if (fManager->GetMultiplicity() == -1) fTree->SetBit(TTree::kForceRead);
          if (fManager->GetMultiplicity() >= 1) fMultiplicity = fManager->GetMultiplicity();
       }
+      if (fSelect && !fMultiplicity && UseJit(fTree)) fSelect->EnableJit();
 
       return kTRUE;
    }
@@ -1018,6 +1032,10 @@ Bool_t TSelectorDraw::CompileVariables(const char *varexp, const char *selection
          fObjEval = kTRUE;
       }
    }
+   if (!fMultiplicity && !fObjEval && UseJit(fTree)) {
+      if (fSelect) fSelect->EnableJit();
+      for (i = 0; i < ncols; ++i) fVar[i]->EnableJit();
+   }
    return kTRUE;
 }
 
@@ -45,6 +45,8 @@
 #include "TFormLeafInfoReference.h"
 
 #include "TEntryList.h"
+#include "TTreeReaderBulk.h"
+#include "TVirtualMutex.h"
 
 #include <ctype.h>
 #include <stdio.h>
@@ -52,6 +54,7 @@
 #include <stdlib.h>
 #include <typeinfo>
 #include <algorithm>
+#include <map>
 
 const Int_t kMaxLen     = 1024;
 
@@ -123,7 +126,8 @@ public:
 ////////////////////////////////////////////////////////////////////////////////
 
 TTreeFormula::TTreeFormula(): ROOT::v5::TFormula(), fQuickLoad(kFALSE), fNeedLoading(kTRUE),
-   fDidBooleanOptimization(kFALSE), fDimensionSetup(0)
+   fDidBooleanOptimization(kFALSE), fDimensionSetup(0), fJitFunc(0), fJitFirst(0), fJitEnd(0),
+   fJitBlockSize(0), fJitTree(0)
 
 {
    // Tree Formula default constructor
@@ -157,7 +161,8 @@ TTreeFormula::TTreeFormula(): ROOT::v5::TFormula(), fQuickLoad(kFALSE), fNeedLoa
 
 TTreeFormula::TTreeFormula(const char *name,const char *expression, TTree *tree)
    :ROOT::v5::TFormula(), fTree(tree), fQuickLoad(kFALSE), fNeedLoading(kTRUE),
-    fDidBooleanOptimization(kFALSE), fDimensionSetup(0)
+    fDidBooleanOptimization(kFALSE), fDimensionSetup(0), fJitFunc(0), fJitFirst(0), fJitEnd(0),
+    fJitBlockSize(0), fJitTree(0)
 {
    Init(name,expression);
 }
@@ -168,7 +173,8 @@ TTreeFormula::TTreeFormula(const char *name,const char *expression, TTree *tree)
 TTreeFormula::TTreeFormula(const char *name,const char *expression, TTree *tree,
                            const std::vector<std::string>& aliases)
    :ROOT::v5::TFormula(), fTree(tree), fQuickLoad(kFALSE), fNeedLoading(kTRUE),
-    fDidBooleanOptimization(kFALSE), fDimensionSetup(0), fAliasesUsed(aliases)
+    fDidBooleanOptimization(kFALSE), fDimensionSetup(0), fAliasesUsed(aliases), fJitFunc(0), fJitFirst(0),
+    fJitEnd(0), fJitBlockSize(0), fJitTree(0)
 {
    Init(name,expression);
 }
@@ -4381,6 +4387,395 @@ template double TTreeFormula::EvalInstance<double> (int, char const**);
 template long double TTreeFormula::EvalInstance<long double> (int, char const**);
 template long long TTreeFormula::EvalInstance<long long> (int, char const**);
 
+namespace {
+
+// Helpers of the code generated by TTreeFormula::EnableJit(), reproducing the
+// special cases of the interpreter in TTreeFormula::EvalInstance.
+const char *gJitPreamble =
+   "#include <cmath>\n"
+   "namespace R__TTreeFormulaJit {\n"
+   "inline double Div(double a, double b) { return b == 0 ? 0 : a / b; }\n"
+   "inline double Mod(double a, double b) { long long j = (long long)b; return j == 0 ? 0 : (double)((long long)a % j); }\n"
+   "inline double Min(double a, double b) { return b < a ? b : a; }\n"
+   "inline double Max(double a, double b) { return a < b ? b : a; }\n"
+   "inline double Sq(double x) { return x * x; }\n"
+   "inline double Sqrt(double x) { return std::sqrt(std::fabs(x)); }\n"
+   "inline double Tan(double x) { return std::cos(x) == 0 ? 0 : std::tan(x); }\n"
+   "inline double ACos(double x) { return std::fabs(x) > 1 ? 0 : std::acos(x); }\n"
+   "inline double ASin(double x) { return std::fabs(x) > 1 ? 0 : std::asin(x); }\n"
+   "inline double TanH(double x) { return std::cosh(x) == 0 ? 0 : std::tanh(x); }\n"
+   "inline double ACosH(double x) { return x < 1 ? 0 : std::acosh(x); }\n"
+   "inline double ATanH(double x) { return std::fabs(x) > 1 ? 0 : std::atanh(x); }\n"
+   "inline double Log(double x) { return x > 0 ? std::log(x) : 0; }\n"
+   "inline double Log10(double x) { return x > 0 ? std::log10(x) : 0; }\n"
+   "inline double Exp(double x) { return x < -700 ? 0 : std::exp(x > 700 ? 700 : x); }\n"
+   "inline double Sign(double x) { return x < 0 ? -1 : 1; }\n"
+   "inline double Int(double x) { return (double)(long long)x; }\n"
+   "}\n";
+
+std::map<std::string, void*> gJitFunctions; // Compiled formulas by source code, protected by gROOTMutex.
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the type of the values of leaf if it can be read by the compiled
+/// code of a formula, kOther_t otherwise.
+
+EDataType GetJitLeafType(TLeaf *leaf)
+{
+   if (!leaf || leaf->GetLeafCount() || leaf->GetLen() != 1 || leaf->IsA() == TLeafC::Class()) return kOther_t;
+   TBranch *branch = leaf->GetBranch();
+   if (!branch || branch->IsA() != TBranch::Class()) return kOther_t;
+
+   const char *type = leaf->GetTypeName();
+   if (!strcmp(type, "Double_t"))  return kDouble_t;
+   if (!strcmp(type, "Float_t"))   return kFloat_t;
+   if (!strcmp(type, "Int_t"))     return kInt_t;
+   if (!strcmp(type, "UInt_t"))    return kUInt_t;
+   if (!strcmp(type, "Short_t"))   return kShort_t;
+   if (!strcmp(type, "UShort_t"))  return kUShort_t;
+   if (!strcmp(type, "Char_t"))    return kChar_t;
+   if (!strcmp(type, "UChar_t"))   return kUChar_t;
+   if (!strcmp(type, "Bool_t"))    return kBool_t;
+   if (!strcmp(type, "Long64_t"))  return kLong64_t;
+   if (!strcmp(type, "ULong64_t")) return kULong64_t;
+   return kOther_t;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert in place the n values of type T stored at the beginning of values.
+
+template <typename T> void ConvertJitColumn(Double_t *values, Long64_t n)
+{
+   // Backward, so that a value is never overwritten before being converted.
+   const char *src = (const char*)values;
+   for (Long64_t i = n - 1; i >= 0; --i) {
+      T value;
+      memcpy(&value, src + i * sizeof(T), sizeof(T));
+      values[i] = value;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Replace the operand on the top of the stack by func(operand).
+
+Bool_t JitUnary(std::vector<std::string> &stack, const char *func)
+{
+   if (stack.empty()) return kFALSE;
+   stack.back() = std::string(func) + "(" + stack.back() + ")";
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Replace the two operands on the top of the stack by
+/// prefix + left + infix + right + suffix.
+
+Bool_t JitBinary(std::vector<std::string> &stack, const char *prefix, const char *infix, const char *suffix)
+{
+   if (stack.size() < 2) return kFALSE;
+   std::string right = stack.back();
+   stack.pop_back();
+   stack.back() = prefix + stack.back() + infix + right + suffix;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a C++ literal for the double value, or an empty string if it has
+/// none.
+
+std::string JitConstant(Double_t value)
+{
+   if (!TMath::Finite(value)) return "";
+   char literal[64];
+   snprintf(literal, sizeof(literal), "%.17g", value);
+   std::string result(literal);
+   if (result.find_first_of(".e") == std::string::npos) result += ".";
+   if (value < 0) result = "(" + result + ")";
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compile with cling the loop evaluating a formula, whose body is given,
+/// and return its address. Identical loops are compiled only once.
+
+void *CompileJit(const std::string &body)
+{
+   static Bool_t preambleDeclared = kFALSE;
+   Int_t id;
+   {
+      R__LOCKGUARD2(gROOTMutex);
+      std::map<std::string, void*>::const_iterator iter = gJitFunctions.find(body);
+      if (iter != gJitFunctions.end()) return iter->second;
+      if (!preambleDeclared) {
+         if (!gInterpreter->Declare(gJitPreamble)) return 0;
+         preambleDeclared = kTRUE;
+      }
+      // The name must be unique even if two threads compile the same body.
+      static Int_t counter = 0;
+      id = counter++;
+   }
+
+   TString code = TString::Format("namespace R__TTreeFormulaJit {\n"
+                                  "void Eval%d(long long n, const double * const *x, double *r)\n"
+                                  "%s\n"
+                                  "}\n", id, body.c_str());
+   void *func = 0;
+   if (gInterpreter->Declare(code)) {
+      func = (void*)gInterpreter->ProcessLine(TString::Format("(long)&R__TTreeFormulaJit::Eval%d;", id));
+   }
+
+   R__LOCKGUARD2(gROOTMutex);
+   // Failures are remembered too, so that they are not retried.
+   return gJitFunctions.insert(std::make_pair(body, func)).first->second;
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Evaluate this formula with compiled code instead of the interpreter.
+///
+/// The formula is translated to a C++ loop computing its value for a block
+/// of consecutive entries, which is compiled with cling. EvalInstance(0) then
+/// reads the leaves for a block of entries at a time, directly out of the
+/// baskets when possible, and runs the loop over the whole block. The blocks
+/// grow from 16 up to 4096 entries while the entries are read in order, and
+/// never cross the end of a cluster.
+///
+/// Only formulas of numbers, operators and the mathematical functions known
+/// to ROOT::v5::TFormula applied to non-array leaves of basic types of
+/// branches made with a leaf list are supported: arrays, objects, strings,
+/// aliases, casts, functions calls, Entry$-like variables, TCutG and friend
+/// trees are not. Returns kFALSE, and keeps using the interpreter, if the
+/// formula is not supported or cannot be compiled.
+///
+/// If a tree of a chain is not suitable (e.g. the leaf has another type),
+/// the formula silently falls back to the interpreter for the rest of the
+/// processing.
+
+Bool_t TTreeFormula::EnableJit()
+{
+   DisableJit();
+   if (!fTree || !gInterpreter || fNoper == 0 || fNcodes == 0 || fMultiplicity != 0 || fHasCast || fAxis || IsString()) {
+      return kFALSE;
+   }
+
+   std::vector<Int_t> columns;
+   std::vector<std::string> stack;
+   Bool_t supported = kTRUE;
+   for (Int_t i = 0; supported && i < fNoper; ++i) {
+      const Int_t oper = GetOper()[i];
+      const Int_t action = oper >> kTFOperShift;
+      const Int_t param = oper & kTFOperMask;
+      if (action == kEnd) break;
+
+      switch (action) {
+         case kConstant: {
+            std::string literal = JitConstant(fConst[param]);
+            supported = !literal.empty();
+            stack.push_back(literal);
+            break;
+         }
+         case kpi: stack.push_back(JitConstant(TMath::Pi())); break;
+         case kDefinedVariable: {
+            const Int_t code = param;
+            if (fLookupType[code] != kDirect || fCodes[code] < 0 || fNdimensions[code] != 0
+                || GetJitLeafType((TLeaf*)fLeaves.UncheckedAt(code)) == kOther_t) {
+               supported = kFALSE;
+               break;
+            }
+            Int_t column = std::find(columns.begin(), columns.end(), code) - columns.begin();
+            if (column == (Int_t)columns.size()) columns.push_back(code);
+            stack.push_back(TString::Format("x%d[i]", column).Data());
+            break;
+         }
+         // Evaluating both sides of && and || gives the same result.
+         case kBoolOptimize: break;
+
+         case kAdd:         supported = JitBinary(stack, "(", " + ", ")"); break;
+         case kSubstract:   supported = JitBinary(stack, "(", " - ", ")"); break;
+         case kMultiply:    supported = JitBinary(stack, "(", " * ", ")"); break;
+         case kDivide:      supported = JitBinary(stack, "Div(", ", ", ")"); break;
+         case kModulo:      supported = JitBinary(stack, "Mod(", ", ", ")"); break;
+         case katan2:       supported = JitBinary(stack, "std::atan2(", ", ", ")"); break;
+         case kfmod:        supported = JitBinary(stack, "std::fmod(", ", ", ")"); break;
+         case kpow:         supported = JitBinary(stack, "std::pow(", ", ", ")"); break;
+         case kmin:         supported = JitBinary(stack, "Min(", ", ", ")"); break;
+         case kmax:         supported = JitBinary(stack, "Max(", ", ", ")"); break;
+         case kAnd:         supported = JitBinary(stack, "double((", " != 0) & (", " != 0))"); break;
+         case kOr:          supported = JitBinary(stack, "double((", " != 0) | (", " != 0))"); break;
+         case kEqual:       supported = JitBinary(stack, "double(", " == ", ")"); break;
+         case kNotEqual:    supported = JitBinary(stack, "double(", " != ", ")"); break;
+         case kLess:        supported = JitBinary(stack, "double(", " < ", ")"); break;
+         case kGreater:     supported = JitBinary(stack, "double(", " > ", ")"); break;
+         case kLessThan:    supported = JitBinary(stack, "double(", " <= ", ")"); break;
+         case kGreaterThan: supported = JitBinary(stack, "double(", " >= ", ")"); break;
+         case kBitAnd:      supported = JitBinary(stack, "double((unsigned long long)", " & (unsigned long long)", ")"); break;
+         case kBitOr:       supported = JitBinary(stack, "double((unsigned long long)", " | (unsigned long long)", ")"); break;
+         case kLeftShift:   supported = JitBinary(stack, "double((unsigned long long)", " << (unsigned long long)", ")"); break;
+         case kRightShift:  supported = JitBinary(stack, "double((unsigned long long)", " >> (unsigned long long)", ")"); break;
+
+         case kcos:    supported = JitUnary(stack, "std::cos"); break;
+         case ksin:    supported = JitUnary(stack, "std::sin"); break;
+         case ktan:    supported = JitUnary(stack, "Tan"); break;
+         case kacos:   supported = JitUnary(stack, "ACos"); break;
+         case kasin:   supported = JitUnary(stack, "ASin"); break;
+         case katan:   supported = JitUnary(stack, "std::atan"); break;
+         case kcosh:   supported = JitUnary(stack, "std::cosh"); break;
+         case ksinh:   supported = JitUnary(stack, "std::sinh"); break;
+         case ktanh:   supported = JitUnary(stack, "TanH"); break;
+         case kacosh:  supported = JitUnary(stack, "ACosH"); break;
+         case kasinh:  supported = JitUnary(stack, "std::asinh"); break;
+         case katanh:  supported = JitUnary(stack, "ATanH"); break;
+         case ksq:     supported = JitUnary(stack, "Sq"); break;
+         case ksqrt:   supported = JitUnary(stack, "Sqrt"); break;
+         case klog:    supported = JitUnary(stack, "Log"); break;
+         case kexp:    supported = JitUnary(stack, "Exp"); break;
+         case klog10:  supported = JitUnary(stack, "Log10"); break;
+         case kabs:    supported = JitUnary(stack, "std::fabs"); break;
+         case ksign:   supported = JitUnary(stack, "Sign"); break;
+         case kint:    supported = JitUnary(stack, "Int"); break;
+         case kSignInv: supported = JitUnary(stack, "-"); break;
+         case kNot:
+            supported = !stack.empty();
+            if (supported) stack.back() = "double(" + stack.back() + " == 0)";
+            break;
+
+         default: supported = kFALSE; break;
+      }
+   }
+   if (!supported || stack.size() != 1) return kFALSE;
+
+   std::string body = "{\n";
+   for (UInt_t c = 0; c < columns.size(); ++c) {
+      body += TString::Format("   const double *x%u = x[%u];\n", c, c).Data();
+   }
+   body += "   for (long long i = 0; i < n; ++i) r[i] = " + stack.back() + ";\n}";
+
+   fJitFunc = (JitFunc_t)CompileJit(body);
+   if (!fJitFunc) return kFALSE;
+   fJitColumns = columns;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Go back to evaluating this formula with the interpreter.
+
+void TTreeFormula::DisableJit()
+{
+   fJitFunc = 0;
+   fJitColumns.clear();
+   fJitValues.clear();
+   fJitResults.clear();
+   fJitFirst = 0;
+   fJitEnd = 0;
+   fJitBlockSize = 0;
+   fJitTree = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the value of the formula for the current entry of the tree with
+/// the compiled code, reading a new block of entries if needed.
+
+Double_t TTreeFormula::EvalJit()
+{
+   if (TestBit(kMissingLeaf)) return 0;
+
+   TTree *tree = fTree->GetTree();
+   const Long64_t entry = tree ? tree->GetReadEntry() : -1;
+   if (tree != fJitTree || entry < fJitFirst || entry >= fJitEnd) {
+      if (entry < 0 || !FillJitBlock(tree, entry)) {
+         DisableJit();
+         return EvalInstance<Double_t>(0);
+      }
+   }
+   return fJitResults[entry - fJitFirst];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the leaves and compute the formula for the block of entries starting
+/// at entry. Returns kFALSE if the tree cannot be processed by the compiled
+/// code.
+
+Bool_t TTreeFormula::FillJitBlock(TTree *tree, Long64_t entry)
+{
+   const Long64_t kMinBlockSize = 16;
+   const Long64_t kMaxBlockSize = 4096;
+
+   // Grow the blocks while the entries are processed in order, e.g. not
+   // skipped by an entry list.
+   if (tree != fJitTree || entry != fJitEnd) fJitBlockSize = kMinBlockSize;
+   else fJitBlockSize = TMath::Min(2 * fJitBlockSize, kMaxBlockSize);
+
+   // Do not read ahead of the TTreeCache.
+   TTree::TClusterIterator clusters = tree->GetClusterIterator(entry);
+   clusters.Next();
+   Long64_t end = TMath::Min(entry + fJitBlockSize, tree->GetEntriesFast());
+   end = TMath::Min(end, clusters.GetNextEntry());
+   if (end <= entry) return kFALSE;
+
+   const Long64_t n = end - entry;
+   const Int_t ncolumns = fJitColumns.size();
+   fJitValues.resize(n * ncolumns);
+   fJitResults.resize(n);
+   const Double_t *columns[kMAXCODES];
+   for (Int_t c = 0; c < ncolumns; ++c) {
+      TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(fJitColumns[c]);
+      Double_t *values = &fJitValues[c * n];
+      if (GetJitLeafType(leaf) == kOther_t || leaf->GetBranch()->GetTree() != tree
+          || !ReadJitColumn(leaf, entry, n, values)) {
+         return kFALSE;
+      }
+      columns[c] = values;
+   }
+   fJitFunc(n, columns, &fJitResults[0]);
+
+   fJitTree = tree;
+   fJitFirst = entry;
+   fJitEnd = end;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the values of leaf for the n entries starting at first into values.
+
+Bool_t TTreeFormula::ReadJitColumn(TLeaf *leaf, Long64_t first, Long64_t n, Double_t *values)
+{
+   TBranch *branch = leaf->GetBranch();
+   const EDataType type = GetJitLeafType(leaf);
+   const Int_t size = leaf->GetLenType();
+
+   Long64_t entry = first;
+   while (entry < first + n) {
+      const char *data = 0;
+      Long64_t basketFirst = 0;
+      Int_t nentries = branch->GetBulkEntries(entry, data, basketFirst);
+      if (nentries <= 0) {
+         // Not a basket of fixed size entries of a single leaf, use the leaf.
+         if (branch->GetEntry(entry) < 0) return kFALSE;
+         values[entry - first] = leaf->GetValue(0);
+         ++entry;
+         continue;
+      }
+      const Long64_t last = TMath::Min(basketFirst + nentries, first + n);
+      Double_t *out = values + (entry - first);
+      const Long64_t count = last - entry;
+      ROOT::Internal::TTreeReaderBulkBase::Unpack(data + (entry - basketFirst) * size, out, count, size);
+      switch (type) {
+         case kFloat_t:    ConvertJitColumn<Float_t>(out, count); break;
+         case kInt_t:      ConvertJitColumn<Int_t>(out, count); break;
+         case kUInt_t:     ConvertJitColumn<UInt_t>(out, count); break;
+         case kShort_t:    ConvertJitColumn<Short_t>(out, count); break;
+         case kUShort_t:   ConvertJitColumn<UShort_t>(out, count); break;
+         case kChar_t:     ConvertJitColumn<Char_t>(out, count); break;
+         case kUChar_t:    ConvertJitColumn<UChar_t>(out, count); break;
+         case kBool_t:     ConvertJitColumn<UChar_t>(out, count); break;
+         case kLong64_t:   ConvertJitColumn<Long64_t>(out, count); break;
+         case kULong64_t:  ConvertJitColumn<ULong64_t>(out, count); break;
+         default:          break;
+      }
+      entry = last;
+   }
+   return kTRUE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return DataMember corresponding to code.
 ///
@@ -5031,6 +5426,7 @@ Bool_t TTreeFormula::StringToNumber(Int_t oper)
 void TTreeFormula::UpdateFormulaLeaves()
 {
    Int_t nleaves = fLeafNames.GetEntriesFast();
+   fJitTree = 0;
    ResetBit( kMissingLeaf );
    for (Int_t i=0;i<nleaves;i++) {
       if (!fTree) break;
@@ -11,33 +11,204 @@
 
 /** \class TTreeIndex
 A Tree Index with majorname and minorname.
+
+When majorname or minorname is simply the name of a branch holding one
+number per entry, its values are read directly out of the baskets instead
+of being evaluated entry by entry. Large indices are sorted in parallel on
+the global TTaskPool.
+
+An index can also be written to a flat file of its own with WriteMapped()
+and opened again with OpenMapped(). The file is memory mapped rather than
+read: the lookups only touch the pages they need, so even a very large
+index is usable at once and costs little resident memory.
+~~~{.cpp}
+   tree->BuildIndex("Run", "Event");
+   ((TTreeIndex*)tree->GetTreeIndex())->WriteMapped("run_event.idx");
+   ...
+   TTreeIndex *index = TTreeIndex::OpenMapped("run_event.idx", tree);
+   if (index) tree->SetTreeIndex(index);
+   tree->GetEntryWithIndex(1234, 56789);
+~~~
 */
 
 #include "TTreeIndex.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TSystem.h"
+#include "TTaskPool.h"
 #include "TTree.h"
+#include "TTreeReaderBulk.h"
 #include "TMath.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 ClassImp(TTreeIndex)
 
 
-struct IndexSortComparator {
+namespace {
+
+   // One entry of the index while it is being sorted.
+   struct TIndexValue {
+      Long64_t fMajor;
+      Long64_t fMinor;
+      Long64_t fEntry;
+
+      bool operator<(const TIndexValue &other) const {
+         if (fMajor != other.fMajor) return fMajor < other.fMajor;
+         if (fMinor != other.fMinor) return fMinor < other.fMinor;
+         return fEntry < other.fEntry;
+      }
+   };
+
+   // Smallest number of values sorted by one task.
+   const Long64_t kMinSortChunk = 1 << 15;
+
+   // Run the tasks on the global TTaskPool and wait for all of them, helping
+   // the pool meanwhile.
+   void RunTasks(std::vector<std::function<void()> > &tasks)
+   {
+      TTaskPool *pool = TTaskPool::GetGlobal();
+      std::mutex mutex;
+      std::condition_variable done;
+      size_t remaining = tasks.size();
+      for (size_t i = 0; i < tasks.size(); ++i) {
+         std::function<void()> *task = &tasks[i];
+         pool->Submit([task, &mutex, &done, &remaining]() {
+            (*task)();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) done.notify_all();
+         });
+      }
+      while (kTRUE) {
+         {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (remaining == 0) return;
+         }
+         if (pool->RunOne()) continue;
+         std::unique_lock<std::mutex> lock(mutex);
+         done.wait(lock, [&remaining] { return remaining == 0; });
+      }
+   }
+
+   // Sort the values, in parallel when there are enough of them: each thread
+   // of the pool sorts one chunk, then the sorted chunks are merged pairwise.
+   void SortIndexValues(std::vector<TIndexValue> &values)
+   {
+      const Long64_t n = values.size();
+      Long64_t nchunks = n / kMinSortChunk;
+      if (nchunks >= 2) {
+         Long64_t nthreads = TTaskPool::GetGlobal()->GetNThreads();
+         if (nchunks > nthreads) nchunks = nthreads;
+      }
+      if (nchunks < 2) {
+         std::sort(values.begin(), values.end());
+         return;
+      }
+
+      std::vector<std::vector<TIndexValue>::iterator> bounds(nchunks + 1);
+      for (Long64_t k = 0; k <= nchunks; ++k) bounds[k] = values.begin() + n * k / nchunks;
+
+      std::vector<std::function<void()> > tasks;
+      for (Long64_t k = 0; k < nchunks; ++k) {
+         auto begin = bounds[k], end = bounds[k + 1];
+         tasks.push_back([begin, end]() { std::sort(begin, end); });
+      }
+      RunTasks(tasks);
+
+      for (Long64_t width = 1; width < nchunks; width *= 2) {
+         tasks.clear();
+         for (Long64_t k = 0; k + width < nchunks; k += 2 * width) {
+            auto begin = bounds[k], middle = bounds[k + width];
+            auto end = bounds[std::min(k + 2 * width, nchunks)];
+            tasks.push_back([begin, middle, end]() { std::inplace_merge(begin, middle, end); });
+         }
+         RunTasks(tasks);
+      }
+   }
 
-  IndexSortComparator(Long64_t *major, Long64_t *minor)
-        : fValMajor(major), fValMinor(minor)
-  {}
+   // Read the values of branch for its entries [first, end) straight out of
+   // the baskets and convert them to Long64_t into out.
+   template <typename T>
+   Bool_t ReadBulkAs(TBranch *branch, Long64_t first, Long64_t end, Long64_t *out)
+   {
+      std::vector<T> values;
+      Long64_t entry = first;
+      while (entry < end) {
+         const char *data = 0;
+         Long64_t basketFirst = 0;
+         Int_t nentries = branch->GetBulkEntries(entry, data, basketFirst);
+         if (nentries <= 0) return kFALSE;
+         Long64_t last = std::min(basketFirst + nentries, end);
+         Long64_t n = last - entry;
+         values.resize(n);
+         ROOT::Internal::TTreeReaderBulkBase::Unpack(data + (entry - basketFirst) * sizeof(T), values.data(), n, sizeof(T));
+         for (Long64_t i = 0; i < n; ++i) out[entry - first + i] = (Long64_t)values[i];
+         entry = last;
+      }
+      return kTRUE;
+   }
 
-   template<typename Index>
-   bool operator()(Index i1, Index i2) {
-      if( *(fValMajor + i1) == *(fValMajor + i2) )
-         return *(fValMinor + i1) < *(fValMinor + i2);
-      else
-         return *(fValMajor + i1) < *(fValMajor + i2);
+   // Fill out with the values of the entries [first, end) of tree if name is
+   // the name of a branch of tree that holds one number per entry and can be
+   // read in bulk. Returns kFALSE if the values must be evaluated with the
+   // TTreeFormula instead.
+   Bool_t ReadBulk(TTree *tree, const char *name, Long64_t first, Long64_t end, Long64_t *out)
+   {
+      if (tree->GetAlias(name)) return kFALSE;
+      TBranch *branch = tree->GetBranch(name);
+      if (!branch || branch->GetTree() != tree || branch->IsA() != TBranch::Class()
+          || branch->GetListOfLeaves()->GetEntriesFast() != 1) {
+         return kFALSE;
+      }
+      TLeaf *leaf = (TLeaf*)branch->GetListOfLeaves()->UncheckedAt(0);
+      if (leaf->GetLeafCount() || leaf->GetLen() != 1 || tree->GetLeaf(name) != leaf) return kFALSE;
+
+      const char *type = leaf->GetTypeName();
+      Int_t size = leaf->GetLenType();
+      if (!strcmp(type, "Int_t") && size == sizeof(Int_t))             return ReadBulkAs<Int_t>(branch, first, end, out);
+      if (!strcmp(type, "UInt_t") && size == sizeof(UInt_t))           return ReadBulkAs<UInt_t>(branch, first, end, out);
+      if (!strcmp(type, "Long64_t") && size == sizeof(Long64_t))       return ReadBulkAs<Long64_t>(branch, first, end, out);
+      if (!strcmp(type, "ULong64_t") && size == sizeof(ULong64_t))     return ReadBulkAs<ULong64_t>(branch, first, end, out);
+      if (!strcmp(type, "Short_t") && size == sizeof(Short_t))         return ReadBulkAs<Short_t>(branch, first, end, out);
+      if (!strcmp(type, "UShort_t") && size == sizeof(UShort_t))       return ReadBulkAs<UShort_t>(branch, first, end, out);
+      if (!strcmp(type, "Char_t") && size == sizeof(Char_t))           return ReadBulkAs<Char_t>(branch, first, end, out);
+      if (!strcmp(type, "UChar_t") && size == sizeof(UChar_t))         return ReadBulkAs<UChar_t>(branch, first, end, out);
+      if (!strcmp(type, "Bool_t") && size == sizeof(Bool_t))           return ReadBulkAs<UChar_t>(branch, first, end, out);
+      if (!strcmp(type, "Float_t") && size == sizeof(Float_t))         return ReadBulkAs<Float_t>(branch, first, end, out);
+      if (!strcmp(type, "Double_t") && size == sizeof(Double_t))       return ReadBulkAs<Double_t>(branch, first, end, out);
+      return kFALSE;
    }
 
-  // pointers to the start of index values tables keeping uppder 64bit and lower 64bit
-  // of combined indexed 128bit value
-  Long64_t *fValMajor, *fValMinor;
-};
+   // Layout of the files written by TTreeIndex::WriteMapped: this header, the
+   // major and minor names, then at fDataOffset the fN major values, the fN
+   // minor values and the fN entry numbers, as Long64_t in the byte order of
+   // the machine that wrote the file so that they can be used in place.
+   struct TMappedHeader {
+      char     fMagic[8];      // kMappedMagic
+      UInt_t   fByteOrder;     // kMappedByteOrder, as seen by the writer
+      UInt_t   fMajorLength;   // length of the major name
+      UInt_t   fMinorLength;   // length of the minor name
+      UInt_t   fDataOffset;    // start of the arrays, a multiple of kMappedAlign
+      Long64_t fN;             // number of entries in the index
+   };
+
+   const char   kMappedMagic[8]  = "RTTIDX1";
+   const UInt_t kMappedByteOrder = 0x01020304;
+   const UInt_t kMappedAlign     = 64;
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -54,6 +225,8 @@ TTreeIndex::TTreeIndex(): TVirtualIndex()
    fMinorFormula       = 0;
    fMajorFormulaParent = 0;
    fMinorFormulaParent = 0;
+   fMapAddress         = 0;
+   fMapLength          = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -132,6 +305,8 @@ TTreeIndex::TTreeIndex(const TTree *T, const char *majorname, const char *minorn
    fMinorFormula       = 0;
    fMajorFormulaParent = 0;
    fMinorFormulaParent = 0;
+   fMapAddress         = 0;
+   fMapLength          = 0;
    fMajorName          = majorname;
    fMinorName          = minorname;
    if (!T) return;
@@ -161,12 +336,13 @@ TTreeIndex::TTreeIndex(const TTree *T, const char *majorname, const char *minorn
    //   return;
    //}
 
-   Long64_t *tmp_major = new Long64_t[fN];
-   Long64_t *tmp_minor = new Long64_t[fN];
-   Long64_t i;
+   // Evaluate the index one tree of the chain at a time: branches are read
+   // in bulk, constants once, and anything else entry by entry.
+   std::vector<Long64_t> tmp_major(fN), tmp_minor(fN);
+   Long64_t i = 0;
    Long64_t oldEntry = fTree->GetReadEntry();
    Int_t current = -1;
-   for (i=0;i<fN;i++) {
+   while (i < fN) {
       Long64_t centry = fTree->LoadTree(i);
       if (centry < 0) break;
       if (fTree->GetTreeNumber() != current) {
@@ -174,22 +350,46 @@ TTreeIndex::TTreeIndex(const TTree *T, const char *majorname, const char *minorn
          fMajorFormula->UpdateFormulaLeaves();
          fMinorFormula->UpdateFormulaLeaves();
       }
-      tmp_major[i] = (Long64_t) fMajorFormula->EvalInstance<LongDouble_t>();
-      tmp_minor[i] = (Long64_t) fMinorFormula->EvalInstance<LongDouble_t>();
+      TTree *tree = fTree->GetTree();
+      Long64_t iend = std::min(fN, i + tree->GetEntries() - centry);
+      if (iend <= i) break;
+
+      Bool_t majorDone = ReadBulk(tree, fMajorName, centry, centry + iend - i, &tmp_major[i]);
+      Bool_t minorDone = ReadBulk(tree, fMinorName, centry, centry + iend - i, &tmp_minor[i]);
+      if (!majorDone && fMajorFormula->GetNcodes() == 0) {
+         std::fill(&tmp_major[i], &tmp_major[0] + iend, (Long64_t) fMajorFormula->EvalInstance<LongDouble_t>());
+         majorDone = kTRUE;
+      }
+      if (!minorDone && fMinorFormula->GetNcodes() == 0) {
+         std::fill(&tmp_minor[i], &tmp_minor[0] + iend, (Long64_t) fMinorFormula->EvalInstance<LongDouble_t>());
+         minorDone = kTRUE;
+      }
+      for (Long64_t j = i; j < iend && !(majorDone && minorDone); j++) {
+         fTree->LoadTree(j);
+         if (!majorDone) tmp_major[j] = (Long64_t) fMajorFormula->EvalInstance<LongDouble_t>();
+         if (!minorDone) tmp_minor[j] = (Long64_t) fMinorFormula->EvalInstance<LongDouble_t>();
+      }
+      i = iend;
+   }
+
+   std::vector<TIndexValue> values(fN);
+   for (i = 0; i < fN; i++) {
+      values[i].fMajor = tmp_major[i];
+      values[i].fMinor = tmp_minor[i];
+      values[i].fEntry = i;
    }
+   std::vector<Long64_t>().swap(tmp_major);
+   std::vector<Long64_t>().swap(tmp_minor);
+   SortIndexValues(values);
+
    fIndex = new Long64_t[fN];
-   for(i = 0; i < fN; i++) { fIndex[i] = i; }
-   std::sort(fIndex, fIndex + fN, IndexSortComparator(tmp_major, tmp_minor) );
-   //TMath::Sort(fN,w,fIndex,0);
    fIndexValues = new Long64_t[fN];
    fIndexValuesMinor = new Long64_t[fN];
-   for (i=0;i<fN;i++) {
-      fIndexValues[i] = tmp_major[fIndex[i]];
-      fIndexValuesMinor[i] = tmp_minor[fIndex[i]];
+   for (i = 0; i < fN; i++) {
+      fIndex[i] = values[i].fEntry;
+      fIndexValues[i] = values[i].fMajor;
+      fIndexValuesMinor[i] = values[i].fMinor;
    }
-
-   delete [] tmp_major;
-   delete [] tmp_minor;
    fTree->LoadTree(oldEntry);
 }
 
@@ -199,6 +399,13 @@ TTreeIndex::TTreeIndex(const TTree *T, const char *majorname, const char *minorn
 TTreeIndex::~TTreeIndex()
 {
    if (fTree && fTree->GetTreeIndex() == this) fTree->SetTreeIndex(0);
+   if (fMapAddress) {
+#ifndef WIN32
+      munmap(fMapAddress, fMapLength);
+#endif
+      fMapAddress = 0;
+      fIndexValues = fIndexValuesMinor = fIndex = 0;
+   }
    delete [] fIndexValues;      fIndexValues = 0;
    delete [] fIndexValuesMinor;      fIndexValuesMinor = 0;
    delete [] fIndex;            fIndex = 0;
@@ -215,6 +422,7 @@ TTreeIndex::~TTreeIndex()
 
 void TTreeIndex::Append(const TVirtualIndex *add, Bool_t delaySort )
 {
+   Unmap();
 
    if (add && add->GetN()) {
       // Create new buffer (if needed)
@@ -262,29 +470,18 @@ void TTreeIndex::Append(const TVirtualIndex *add, Bool_t delaySort )
 
    // Sort.
    if (!delaySort) {
-      Long64_t *addValues = GetIndexValues();
-      Long64_t *addValues2 = GetIndexValuesMinor();
-      Long64_t *ind = fIndex;
-      Long64_t *conv = new Long64_t[fN];
-
-      for(Long64_t i = 0; i < fN; i++) { conv[i] = i; }
-      std::sort(conv, conv+fN, IndexSortComparator(addValues, addValues2) );
-      //Long64_t *w = fIndexValues;
-      //TMath::Sort(fN,w,conv,0);
-
-      fIndex = new Long64_t[fN];
-      fIndexValues = new Long64_t[fN];
-      fIndexValuesMinor = new Long64_t[fN];
-
-      for (Int_t i=0;i<fN;i++) {
-         fIndex[i] = ind[conv[i]];
-         fIndexValues[i] = addValues[conv[i]];
-         fIndexValuesMinor[i] = addValues2[conv[i]];
+      std::vector<TIndexValue> values(fN);
+      for (Long64_t i = 0; i < fN; i++) {
+         values[i].fMajor = fIndexValues[i];
+         values[i].fMinor = fIndexValuesMinor[i];
+         values[i].fEntry = fIndex[i];
+      }
+      SortIndexValues(values);
+      for (Long64_t i = 0; i < fN; i++) {
+         fIndex[i] = values[i].fEntry;
+         fIndexValues[i] = values[i].fMajor;
+         fIndexValuesMinor[i] = values[i].fMinor;
       }
-      delete [] addValues;
-      delete [] addValues2;
-      delete [] ind;
-      delete [] conv;
    }
 }
 
@@ -494,6 +691,101 @@ TTreeFormula *TTreeIndex::GetMinorFormulaParent(const TTree *parent)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Open an index written by WriteMapped() for the tree T.
+///
+/// The file is memory mapped and the arrays of the index point directly into
+/// it, so nothing is read until a lookup touches it. The file must not be
+/// modified as long as the index exists. Where memory mapping is not
+/// available (Windows) the file is read in full instead.
+///
+/// The file must have been written on a machine with the same byte order and
+/// for a tree with the same number of entries as T. Returns 0 in case of
+/// error, otherwise the index, which can be given to TTree::SetTreeIndex.
+
+TTreeIndex *TTreeIndex::OpenMapped(const char *filename, const TTree *T)
+{
+#ifndef WIN32
+   int fd = open(filename, O_RDONLY);
+   if (fd < 0) {
+      ::Error("TTreeIndex::OpenMapped", "Cannot open %s", filename);
+      return 0;
+   }
+   struct stat st;
+   Long64_t length = fstat(fd, &st) == 0 ? (Long64_t)st.st_size : 0;
+   void *address = length > 0 ? mmap(0, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+   close(fd);
+   if (address == MAP_FAILED) {
+      ::Error("TTreeIndex::OpenMapped", "Cannot map %s", filename);
+      return 0;
+   }
+   const char *buffer = (const char*)address;
+#else
+   FILE *file = fopen(filename, "rb");
+   if (!file) {
+      ::Error("TTreeIndex::OpenMapped", "Cannot open %s", filename);
+      return 0;
+   }
+   fseek(file, 0, SEEK_END);
+   Long64_t length = ftell(file);
+   fseek(file, 0, SEEK_SET);
+   char *buffer = new char[length > 0 ? length : 1];
+   Bool_t ok = length > 0 && fread(buffer, 1, length, file) == (size_t)length;
+   fclose(file);
+   if (!ok) {
+      ::Error("TTreeIndex::OpenMapped", "Cannot read %s", filename);
+      delete [] buffer;
+      return 0;
+   }
+#endif
+
+   const TMappedHeader *header = (const TMappedHeader*)buffer;
+   const char *error = 0;
+   if (length < (Long64_t)sizeof(TMappedHeader) || memcmp(header->fMagic, kMappedMagic, sizeof(header->fMagic)) != 0) {
+      error = "is not a TTreeIndex file";
+   } else if (header->fByteOrder != kMappedByteOrder) {
+      error = "was written on a machine with a different byte order";
+   } else if (header->fN < 0 || header->fDataOffset % kMappedAlign != 0
+              || sizeof(TMappedHeader) + header->fMajorLength + header->fMinorLength > header->fDataOffset
+              || header->fDataOffset + 3 * header->fN * (Long64_t)sizeof(Long64_t) != length) {
+      error = "is corrupted";
+   } else if (T && T->GetEntries() != header->fN) {
+      error = "does not have as many entries as the tree";
+   }
+   if (error) {
+      ::Error("TTreeIndex::OpenMapped", "The index in %s %s", filename, error);
+#ifndef WIN32
+      munmap(address, length);
+#else
+      delete [] buffer;
+#endif
+      return 0;
+   }
+
+   TTreeIndex *index = new TTreeIndex();
+   index->fTree = (TTree*)T;
+   index->fMajorName = TString(buffer + sizeof(TMappedHeader), header->fMajorLength);
+   index->fMinorName = TString(buffer + sizeof(TMappedHeader) + header->fMajorLength, header->fMinorLength);
+   index->fN = header->fN;
+   Long64_t *data = (Long64_t*)(buffer + header->fDataOffset);
+#ifndef WIN32
+   index->fMapAddress = address;
+   index->fMapLength = length;
+   index->fIndexValues = data;
+   index->fIndexValuesMinor = data + index->fN;
+   index->fIndex = data + 2 * index->fN;
+#else
+   index->fIndexValues = new Long64_t[index->fN];
+   index->fIndexValuesMinor = new Long64_t[index->fN];
+   index->fIndex = new Long64_t[index->fN];
+   memcpy(index->fIndexValues, data, index->fN * sizeof(Long64_t));
+   memcpy(index->fIndexValuesMinor, data + index->fN, index->fN * sizeof(Long64_t));
+   memcpy(index->fIndex, data + 2 * index->fN, index->fN * sizeof(Long64_t));
+   delete [] buffer;
+#endif
+   return index;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Print the table with : serial number, majorname, minorname.
 /// -  if option = "10" print only the first 10 entries
@@ -601,3 +893,69 @@ void TTreeIndex::SetTree(const TTree *T)
    fTree = (TTree*)T;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Copy the arrays of an index opened with OpenMapped() into memory owned by
+/// the index and release the mapping, so that they can be modified.
+
+void TTreeIndex::Unmap()
+{
+   if (!fMapAddress) return;
+   Long64_t *values = new Long64_t[fN];
+   Long64_t *valuesMinor = new Long64_t[fN];
+   Long64_t *index = new Long64_t[fN];
+   memcpy(values, fIndexValues, fN * sizeof(Long64_t));
+   memcpy(valuesMinor, fIndexValuesMinor, fN * sizeof(Long64_t));
+   memcpy(index, fIndex, fN * sizeof(Long64_t));
+#ifndef WIN32
+   munmap(fMapAddress, fMapLength);
+#endif
+   fMapAddress = 0;
+   fMapLength = 0;
+   fIndexValues = values;
+   fIndexValuesMinor = valuesMinor;
+   fIndex = index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write the index to filename in the format read by OpenMapped(). The tree
+/// itself is not written, only the sorted values and entry numbers. Returns
+/// the number of bytes written or -1 in case of error.
+
+Long64_t TTreeIndex::WriteMapped(const char *filename) const
+{
+   TMappedHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.fMagic, kMappedMagic, sizeof(header.fMagic));
+   header.fByteOrder = kMappedByteOrder;
+   header.fMajorLength = fMajorName.Length();
+   header.fMinorLength = fMinorName.Length();
+   UInt_t names = sizeof(header) + header.fMajorLength + header.fMinorLength;
+   header.fDataOffset = (names + kMappedAlign - 1) / kMappedAlign * kMappedAlign;
+   header.fN = fN;
+
+   FILE *file = fopen(filename, "wb");
+   if (!file) {
+      Error("WriteMapped", "Cannot open %s for writing", filename);
+      return -1;
+   }
+   auto put = [file](const void *data, size_t size) {
+      return size == 0 || fwrite(data, 1, size, file) == size;
+   };
+   const char padding[kMappedAlign] = { 0 };
+   const size_t size = fN * sizeof(Long64_t);
+   Bool_t ok = put(&header, sizeof(header))
+            && put(fMajorName.Data(), header.fMajorLength)
+            && put(fMinorName.Data(), header.fMinorLength)
+            && put(padding, header.fDataOffset - names)
+            && put(fIndexValues, size)
+            && put(fIndexValuesMinor, size)
+            && put(fIndex, size);
+   ok = (fclose(file) == 0) && ok;
+   if (!ok) {
+      Error("WriteMapped", "Cannot write the index to %s", filename);
+      gSystem->Unlink(filename);
+      return -1;
+   }
+   return header.fDataOffset + 3 * (Long64_t)size;
+}
+
@@ -67,6 +67,11 @@ The Draw or Print functions print the following information:
  -  ReadRT    = Zipped MBytes per RT second
  -  ReadCP    = Zipped MBytes per CP second
 
+With parallel unzipping (TTree::SetParallelUnzip) the following is added:
+ -  UnzipHits = Baskets found unzipped in advance
+ -  UnzipStal = Baskets being unzipped in advance, waited for
+ -  UnzipMiss = Baskets unzipped by the reader
+
  ### NOTE 1 :
 The ReadTotal value indicates the effective number of zipped bytes
 returned to the application. The physical number of bytes read
@@ -85,6 +90,7 @@ The Physical disk speed is DiskIO + DiskIO*ReadExtra/100.
 #include "Riostream.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TTreeCacheUnzip.h"
 #include "TAxis.h"
 #include "TBrowser.h"
 #include "TVirtualPad.h"
@@ -123,6 +129,9 @@ TTreePerfStats::TTreePerfStats() : TVirtualPerfStats()
    fDiskTime      = 0;
    fUnzipTime     = 0;
    fCompress      = 0;
+   fUnzipHits     = 0;
+   fUnzipStalls   = 0;
+   fUnzipMisses   = 0;
    fRealTimeAxis  = 0;
    fHostInfoText  = 0;
 }
@@ -158,6 +167,9 @@ TTreePerfStats::TTreePerfStats(const char *name, TTree *T) : TVirtualPerfStats()
    fCpuTime       = 0;
    fDiskTime      = 0;
    fUnzipTime     = 0;
+   fUnzipHits     = 0;
+   fUnzipStalls   = 0;
+   fUnzipMisses   = 0;
    fRealTimeAxis  = 0;
    fCompress      = (T->GetTotBytes()+0.00001)/T->GetZipBytes();
 
@@ -326,6 +338,12 @@ void TTreePerfStats::Finish()
    fBytesReadExtra= fFile->GetBytesReadExtra();
    fRealTime      = fWatch->RealTime();
    fCpuTime       = fWatch->CpuTime();
+   TTreeCacheUnzip *unzipCache = dynamic_cast<TTreeCacheUnzip*>(fFile->GetCacheRead(fTree));
+   if (unzipCache) {
+      fUnzipHits   = unzipCache->GetNFound();
+      fUnzipStalls = unzipCache->GetNStalls();
+      fUnzipMisses = unzipCache->GetNMissed();
+   }
    Int_t npoints  = fGraphIO->GetN();
    if (!npoints) return;
    Double_t iomax = TMath::MaxElement(npoints,fGraphIO->GetY());
@@ -410,6 +428,12 @@ void TTreePerfStats::Paint(Option_t *option)
       fPave->AddText(Form("ReadUZCP  = %7.3f MB/s",1e-6*fCompress*fBytesRead/fCpuTime));
       fPave->AddText(Form("ReadRT    = %7.3f MB/s",1e-6*fBytesRead/fRealTime));
       fPave->AddText(Form("ReadCP    = %7.3f MB/s",1e-6*fBytesRead/fCpuTime));
+      Int_t nunzip = fUnzipHits+fUnzipStalls+fUnzipMisses;
+      if (nunzip) {
+         fPave->AddText(Form("UnzipHits = %5.2f per cent",100.*fUnzipHits/nunzip));
+         fPave->AddText(Form("UnzipStal = %5.2f per cent",100.*fUnzipStalls/nunzip));
+         fPave->AddText(Form("UnzipMiss = %5.2f per cent",100.*fUnzipMisses/nunzip));
+      }
    }
    fPave->Paint();
 
@@ -457,6 +481,12 @@ void TTreePerfStats::Print(Option_t * option) const
       printf("ReadStrCP = %7.3f MBytes/s\n",1e-6*fCompress*fBytesRead/(fCpuTime-fUnzipTime));
       printf("ReadZipCP = %7.3f MBytes/s\n",1e-6*fCompress*fBytesRead/fUnzipTime);
    }
+   Int_t nunzip = fUnzipHits+fUnzipStalls+fUnzipMisses;
+   if (nunzip) {
+      printf("UnzipHits = %d baskets (%5.2f per cent)\n",fUnzipHits,100.*fUnzipHits/nunzip);
+      printf("UnzipStal = %d baskets (%5.2f per cent)\n",fUnzipStalls,100.*fUnzipStalls/nunzip);
+      printf("UnzipMiss = %d baskets (%5.2f per cent)\n",fUnzipMisses,100.*fUnzipMisses/nunzip);
+   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -496,6 +526,9 @@ void TTreePerfStats::SavePrimitive(std::ostream &out, Option_t *option /*= ""*/)
    out<<"   ps->SetDiskTime("<<fDiskTime<<");"<<std::endl;
    out<<"   ps->SetUnzipTime("<<fUnzipTime<<");"<<std::endl;
    out<<"   ps->SetCompress("<<fCompress<<");"<<std::endl;
+   out<<"   ps->SetUnzipHits("<<fUnzipHits<<");"<<std::endl;
+   out<<"   ps->SetUnzipStalls("<<fUnzipStalls<<");"<<std::endl;
+   out<<"   ps->SetUnzipMisses("<<fUnzipMisses<<");"<<std::endl;
 
    Int_t i, npoints = fGraphIO->GetN();
    out<<"   TGraphErrors *psGraphIO = new TGraphErrors("<<npoints<<");"<<std::endl;
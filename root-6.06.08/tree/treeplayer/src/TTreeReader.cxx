@@ -278,6 +278,54 @@ Long64_t TTreeReader::GetCurrentEntry() const {
    return currentTreeEntry;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Move to the next range of entries to be read in bulk (see TTreeReaderBulk):
+/// the entries from the one after the current entry to the end of its cluster,
+/// limited to the current tree of a chain and to the last entry set by
+/// SetLastEntry(). On success, begin and end (exclusive) are set to the global
+/// entry numbers of the range and the reader is positioned at the last entry
+/// of the range, such that the next call continues after it.
+/// \return kFALSE if there are no more entries (see GetEntryStatus()).
+///
+/// ~~~{.cpp}
+/// TTreeReaderBulk<Float_t> px(reader, "px");
+/// std::vector<Float_t> buf;
+/// Long64_t begin, end;
+/// while (reader.NextCluster(begin, end)) {
+///    buf.resize(end - begin);
+///    px.Read(begin, end, buf.data());
+///    ...
+/// }
+/// ~~~
+
+Bool_t TTreeReader::NextCluster(Long64_t &begin, Long64_t &end)
+{
+   Long64_t entry = GetCurrentEntry() + 1;
+   if (SetEntry(entry) != kEntryValid) {
+      return kFALSE;
+   }
+
+   TTree *tree = fTree->GetTree();
+   Long64_t localBegin = fDirector->GetReadEntry();
+   TTree::TClusterIterator clusterIter = tree->GetClusterIterator(localBegin);
+   clusterIter.Next();
+   Long64_t localEnd = clusterIter.GetNextEntry();
+   if (localEnd > tree->GetEntriesFast()) {
+      localEnd = tree->GetEntriesFast();
+   }
+   if (fLastEntry >= 0 && localEnd > fLastEntry) {
+      localEnd = fLastEntry;
+   }
+   if (localEnd <= localBegin) {
+      localEnd = localBegin + 1;
+   }
+
+   begin = entry;
+   end = entry + (localEnd - localBegin);
+   fDirector->SetReadEntry(localEnd - 1);
+   return kTRUE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Load an entry into the tree, return the status of the read.
 /// For chains, entry is the global (i.e. not tree-local) entry number.
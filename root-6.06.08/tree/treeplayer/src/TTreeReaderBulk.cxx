@@ -0,0 +1,216 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "TTreeReaderBulk.h"
+
+#include "TBranch.h"
+#include "TError.h"
+#include "TLeaf.h"
+#include "TTree.h"
+#include "TTreeReader.h"
+
+#include <string.h>
+
+/** \class TTreeReaderBulk
+
+Reads the values of a branch for a whole range of entries at once, typically
+a cluster as returned by TTreeReader::NextCluster(), into a contiguous array:
+
+~~~{.cpp}
+TTreeReader reader("ntuple", file);
+TTreeReaderBulk<Float_t> px(reader, "px");
+std::vector<Float_t> values;
+Long64_t begin, end;
+while (reader.NextCluster(begin, end)) {
+   values.resize(end - begin);
+   px.Read(begin, end, values.data());
+   for (auto v : values) ...
+}
+~~~
+
+The values are copied straight out of the basket buffers and converted from
+the big endian file format in one pass per basket, instead of being streamed
+entry by entry through the leaves. Only branches with a single leaf of a
+basic type, or a fixed size array of it, can be read this way; the type T
+must match the type of the leaf. The range must lie within the tree of a
+chain the TTreeReader is currently positioned in.
+
+Bulk readers do not interfere with TTreeReaderValue: both can be used on the
+same TTreeReader.
+*/
+
+namespace {
+   // Plain shifts rather than the inline assembly of Byteswap.h, so that the
+   // loops in Unpack() can be vectorized.
+   inline UShort_t Swap16(UShort_t x) { return (UShort_t)((x >> 8) | (x << 8)); }
+   inline UInt_t Swap32(UInt_t x) {
+      return ((x & 0xff000000u) >> 24) | ((x & 0x00ff0000u) >> 8) |
+             ((x & 0x0000ff00u) << 8) | ((x & 0x000000ffu) << 24);
+   }
+   inline ULong64_t Swap64(ULong64_t x) {
+      return ((ULong64_t)Swap32((UInt_t)x) << 32) | Swap32((UInt_t)(x >> 32));
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Construct a bulk reader of the values of type type and size typesize of
+/// the branch branchname.
+
+ROOT::Internal::TTreeReaderBulkBase::TTreeReaderBulkBase(TTreeReader* reader,
+                                                         const char* branchname,
+                                                         EDataType type,
+                                                         Int_t typesize) :
+   fBranchName(branchname),
+   fTreeReader(reader),
+   fType(type),
+   fTypeSize(typesize),
+   fTree(0),
+   fTreeNumber(-1),
+   fBranch(0),
+   fLen(0)
+{
+   if (!fTreeReader) {
+      ::Error("TTreeReaderBulkBase::TTreeReaderBulkBase", "TTreeReaderBulk must be constructed with a TTreeReader");
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the number of values per entry, 1 unless the leaf is a fixed size
+/// array, or -1 if the branch cannot be read in bulk.
+
+Int_t ROOT::Internal::TTreeReaderBulkBase::GetValuesPerEntry()
+{
+   TTree* tree = fTreeReader ? fTreeReader->GetTree() : 0;
+   if (!tree || !tree->GetTree()) {
+      return -1;
+   }
+   if (!Setup(tree->GetTree())) {
+      return -1;
+   }
+   return fLen;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Find the branch in tree and check that it can be read in bulk into values
+/// of our type. Returns kFALSE in case of error.
+
+Bool_t ROOT::Internal::TTreeReaderBulkBase::Setup(TTree* tree)
+{
+   Int_t treeNumber = fTreeReader->GetTree()->GetTreeNumber();
+   if (tree == fTree && treeNumber == fTreeNumber) {
+      return fBranch != 0;
+   }
+   fTree = tree;
+   fTreeNumber = treeNumber;
+   fBranch = 0;
+   fLen = 0;
+
+   TBranch* branch = tree->GetBranch(fBranchName);
+   if (!branch) {
+      ::Error("TTreeReaderBulkBase::Setup", "The tree does not have a branch called %s.", fBranchName.Data());
+      return kFALSE;
+   }
+   TLeaf* leaf = branch->IsA() == TBranch::Class() && branch->GetListOfLeaves()->GetEntriesFast() == 1
+      ? (TLeaf*)branch->GetListOfLeaves()->UncheckedAt(0) : 0;
+   if (!leaf || leaf->GetLeafCount() || leaf->GetLenType() != fTypeSize
+       || strcmp(leaf->GetTypeName(), TDataType::GetTypeName(fType)) != 0) {
+      ::Error("TTreeReaderBulkBase::Setup",
+              "The branch %s cannot be read in bulk as %s: it must have a single leaf of this type and of fixed size.",
+              fBranchName.Data(), TDataType::GetTypeName(fType));
+      return kFALSE;
+   }
+   fBranch = branch;
+   fLen = leaf->GetLen();
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the values of the entries [begin, end) into dest. The entry numbers
+/// are global for a chain. Returns the number of entries read or -1 in case of
+/// error.
+
+Long64_t ROOT::Internal::TTreeReaderBulkBase::ReadRange(Long64_t begin, Long64_t end, void* dest)
+{
+   if (end <= begin) {
+      return 0;
+   }
+   TTree* chainOrTree = fTreeReader ? fTreeReader->GetTree() : 0;
+   TTree* tree = chainOrTree ? chainOrTree->GetTree() : 0;
+   if (!tree) {
+      ::Error("TTreeReaderBulkBase::ReadRange", "No tree loaded, did you remember to call TTreeReader::NextCluster()?");
+      return -1;
+   }
+   if (!Setup(tree)) {
+      return -1;
+   }
+
+   Long64_t offset = tree->GetChainOffset();
+   Long64_t localBegin = begin - offset;
+   Long64_t localEnd = end - offset;
+   if (localBegin < 0 || localEnd > tree->GetEntriesFast()) {
+      ::Error("TTreeReaderBulkBase::ReadRange",
+              "The entries [%lld, %lld) are not all in the current tree, use TTreeReader::NextCluster().", begin, end);
+      return -1;
+   }
+   // Let the TTreeCache prefetch the cluster we are about to read.
+   tree->LoadTree(localBegin);
+
+   const Long64_t entrySize = (Long64_t)fTypeSize * fLen;
+   char* out = (char*)dest;
+   Long64_t entry = localBegin;
+   while (entry < localEnd) {
+      const char* data = 0;
+      Long64_t first = 0;
+      Int_t nentries = fBranch->GetBulkEntries(entry, data, first);
+      if (nentries <= 0) {
+         ::Error("TTreeReaderBulkBase::ReadRange", "Cannot read entry %lld of branch %s.", entry + offset, fBranchName.Data());
+         return -1;
+      }
+      Long64_t last = first + nentries < localEnd ? first + nentries : localEnd;
+      Long64_t n = last - entry;
+      Unpack(data + (entry - first) * entrySize, out, n * fLen, fTypeSize);
+      out += n * entrySize;
+      entry = last;
+   }
+   return localEnd - localBegin;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert n values of size bytes from the file format (big endian) at src to
+/// the machine representation at dest. src does not have to be aligned.
+///
+/// The byte swapping is done in place on dest with simple loops that the
+/// compiler turns into vector instructions.
+
+void ROOT::Internal::TTreeReaderBulkBase::Unpack(const char* src, void* dest, Long64_t n, Int_t size)
+{
+   memcpy(dest, src, n * size);
+#ifdef R__BYTESWAP
+   switch (size) {
+      case 2: {
+         UShort_t* values = (UShort_t*)dest;
+         for (Long64_t i = 0; i < n; ++i) values[i] = Swap16(values[i]);
+         break;
+      }
+      case 4: {
+         UInt_t* values = (UInt_t*)dest;
+         for (Long64_t i = 0; i < n; ++i) values[i] = Swap32(values[i]);
+         break;
+      }
+      case 8: {
+         ULong64_t* values = (ULong64_t*)dest;
+         for (Long64_t i = 0; i < n; ++i) values[i] = Swap64(values[i]);
+         break;
+      }
+      default:
+         break;
+   }
+#endif
+}